@@ -20,7 +20,7 @@
 #include "GIWindow.h"
 #include <QDir>
 #include <QTemporaryDir>
-#include <QProcess>
+#include <QImage>
 #include <QFile>
 #include <QTextStream>
 #include "AR.h"
@@ -28,16 +28,30 @@
 #include "TerrainGroup.h"
 #include "Model.h"
 #include "TerrainInstance.h"
-#include "FreeImage.h"
+#include "GIAtlas.h"
 #include "Path.h"
 #include "Compression.h"
 
-#include <DirectXTex.h>
-#include <BC.h>
-#include <DDS.h>
-
 const int GIWindow::MinimumTextureSize = 4;
 
+// Called concurrently by the atlas pipeline, only touches its own QImage.
+static bool importAtlasMap(QString filename, LibGens::GIAtlasImage *image) {
+	QImage import_image;
+	if (!import_image.load(filename)) {
+		return false;
+	}
+
+	import_image = import_image.convertToFormat(QImage::Format_RGBA8888);
+	int width = import_image.width();
+	int height = import_image.height();
+	image->create(width, height);
+	for (int y = 0; y < height; y++) {
+		memcpy(image->getRow(y), import_image.constScanLine(y), width * 4);
+	}
+
+	return true;
+}
+
 QString GIWindow::temporaryDirTemplate() {
 	return converter_settings.terrain_directory + "/GIAtlasConverter-temp-XXXXXX";
 }
@@ -202,8 +216,10 @@ bool GIWindow::convert() {
 				LibGens::ArFile *ar_file = group_ar_pack.getFile(model_name + LIBGENS_TERRAIN_MODEL_EXTENSION);
 				if (ar_file) {
 					LibGens::Model *model;
-					if (ar_file->getData()) {
-						LibGens::File ar_data_file(ar_file->getData(), ar_file->getSize());
+					vector<unsigned char> buffer;
+					const unsigned char *data = ar_file->viewData(&buffer);
+					if (data) {
+						LibGens::File ar_data_file(data, ar_file->getSize());
 						model = new LibGens::Model(&ar_data_file, true);
 					}
 					else {
@@ -235,8 +251,10 @@ bool GIWindow::convert() {
 				if (ar_file) {
 					LibGens::TerrainInstance *instance;
 
-					if (ar_file->getData()) {
-						LibGens::File ar_data_file(ar_file->getData(), ar_file->getSize());
+					vector<unsigned char> buffer;
+					const unsigned char *data = ar_file->viewData(&buffer);
+					if (data) {
+						LibGens::File ar_data_file(data, ar_file->getSize());
 						instance = new LibGens::TerrainInstance(&ar_data_file);
 					}
 					else {
@@ -303,7 +321,7 @@ bool GIWindow::convert() {
 
 		for (size_t g = 0; g < gi_groups_size; g++) {
 			logProgress(ProgressNormal, QString("Organizing subtextures for group %1 with texture size %2.").arg(g).arg(converter_settings.max_texture_size));
-			gi_groups[g]->organizeSubtextures(max(converter_settings.max_atlas_texture_size, converter_settings.max_texture_size));
+			gi_groups[g]->packSubtextures(max(converter_settings.max_atlas_texture_size, converter_settings.max_texture_size));
 			logProgress(ProgressNormal, QString("Done organizing subtextures for group %1.").arg(g));
 
 			// Create the atlas textures and save it to the AR file
@@ -315,21 +333,9 @@ bool GIWindow::convert() {
 				unsigned int w = (*it)->getWidth();
 				unsigned int h = (*it)->getHeight();
 
-				vector<unsigned char> atlas_image(DirectX::DDS_MIN_HEADER_SIZE + ((w / 4) * (h / 4) * 16));
-
-				DirectX::TexMetadata metadata;
-				metadata.width = w;
-				metadata.height = h;
-				metadata.depth = 1;
-				metadata.arraySize = 1;
-				metadata.mipLevels = 1;
-				metadata.miscFlags = 0;
-				metadata.miscFlags2 = 0;
-				metadata.format = DXGI_FORMAT_BC3_UNORM;
-				metadata.dimension = DirectX::TEX_DIMENSION_TEXTURE2D;
-
-				size_t required = 0;
-				DirectX::EncodeDDSHeader(metadata, DirectX::DDS_FLAGS_FORCE_DX9_LEGACY, atlas_image.data(), atlas_image.size(), required);
+				// Every subtexture is a solid debug color, so the fast encoder gives exact blocks.
+				LibGens::GIAtlasImage atlas;
+				atlas.create(w, h);
 
 				list<LibGens::GISubtexture *> subtextures = (*it)->getSubtextures();
 				for (list<LibGens::GISubtexture *>::iterator it2 = subtextures.begin(); it2 != subtextures.end(); it2++) {
@@ -337,39 +343,19 @@ bool GIWindow::convert() {
 					unsigned int sub_h = (*it2)->getPixelHeight();
 					QColor color = debugColor(gi_groups[g]->getQualityLevel(), max(sub_w, sub_h));
 
-					DirectX::XMVECTOR bc_colors[NUM_PIXELS_PER_BLOCK];
-					for (auto &bc_color : bc_colors) {
-						bc_color = {float(color.redF()), float(color.greenF()), float(color.blueF()), float(color.alphaF())};
-					}
-
-					unsigned char bc[16];
-					DirectX::D3DXEncodeBC3(bc, bc_colors, DirectX::BC_FLAGS_NONE);
-
-					unsigned int start_x = unsigned int((*it2)->getX() * w) / 4;
-					unsigned int start_y = unsigned int((*it2)->getY() * h) / 4;
-
-					for (unsigned int x = 0; x < (sub_w / 4); x++) {
-						for (unsigned int y = 0; y < (sub_h / 4); y++) {
-							unsigned int bc_x = start_x + x;
-							unsigned int bc_y = start_y + y;
-							unsigned int bc_pos = (bc_y * (w / 4) + bc_x);
-							unsigned int offset = DirectX::DDS_MIN_HEADER_SIZE + (bc_pos * sizeof(bc));
-
-							if ((offset + sizeof(bc)) > atlas_image.size()) {
-								logProgress(ProgressError, "Panic!!! Trying to write outside image boundaries.");
-							}
-							else {
-								memcpy(atlas_image.data() + offset, bc, sizeof(bc));
-							}
-						}
-					}
+					LibGens::GIAtlasImage subtexture_image(sub_w, sub_h);
+					subtexture_image.fill(color.red(), color.green(), color.blue(), color.alpha());
+					atlas.copy(&subtexture_image, 0, 0, sub_w, sub_h, (unsigned int)((*it2)->getX() * w), (unsigned int)((*it2)->getY() * h));
 				}
 
+				vector<unsigned char> atlas_image;
+				atlas.writeDDS(&atlas_image, LibGens::TEXTURE_COMPRESSION_BC3, LibGens::TEXTURE_COMPRESSION_FAST, false);
+
 				logProgress(ProgressNormal, QString("Saving texture atlas %1.dds.").arg((*it)->getName().c_str()));
 				gi_group_ar_pack.addFile((*it)->getName() + ".dds", std::move(atlas_image));
 
 				// Compute folder size. Since we generate no mipmaps for the Pre-Render step, using the size of the DDS file would be inaccurate for the Post-Render step.
-				folder_size += DirectX::DDS_MIN_HEADER_SIZE;
+				folder_size += LIBGENS_TEXTURE_COMPRESSION_DDS_HEADER_SIZE;
 				do
 				{
 					if (w > 1) {
@@ -463,16 +449,27 @@ bool GIWindow::convert() {
 		size_t gi_groups_size = gi_groups.size();
 		logProgress(ProgressNormal, QString("Found %1 existing GI Groups.").arg(gi_groups_size));
 
+		// Atlas textures are decoded, cut into subtextures, scaled and packed again entirely in memory.
+		LibGens::GIAtlasPipeline atlas_pipeline;
+		atlas_pipeline.setInvertedShadowmaps(converter_settings.inverted_shadowmaps);
+		atlas_pipeline.setScaleToLightmap(converter_settings.scale_to_lightmap);
+		atlas_pipeline.setScaleToShadowmap(converter_settings.scale_to_shadowmap);
+		atlas_pipeline.setLightmapOverride(converter_settings.override_lightmap, converter_settings.override_lightmap_r, converter_settings.override_lightmap_g, converter_settings.override_lightmap_b);
+		atlas_pipeline.setShadowmapOverride(converter_settings.override_shadowmap, converter_settings.override_shadowmap_a);
+
+		QString source_gi_directory = converter_settings.source_gi_directory;
+		atlas_pipeline.setImportFunction([source_gi_directory](const string &name, LibGens::GIAtlasMap map, LibGens::GIAtlasImage *image) {
+			QString suffix = (map == LibGens::GI_ATLAS_MAP_LIGHTMAP) ? "_lightmap.png" : "_shadowmap.png";
+			return importAtlasMap(source_gi_directory + "/" + QString::fromStdString(name) + suffix, image);
+		});
+
 		for (size_t g = 0; g < gi_groups_size; g++) {
 			//******************************************************
 			// Read the AR Pack and atlasinfo files for the group.
 			//******************************************************
 			LibGens::GITextureGroup *group = gi_groups[g];
 			unsigned int quality_level = group->getQualityLevel();
-			QString quality_level_string = QString("-level%1").arg(quality_level);
 
-			LibGens::ArPack *group_ar_pack = NULL;
-			LibGens::File *group_ar_file = NULL;
 			string group_ar_filename = "";
 			if (quality_level == LIBGENS_GI_TEXTURE_GROUP_LOWEST_QUALITY)
 				group_ar_filename = stage_temp_path.toStdString() + "/gia-" + ToString(g) + ".ar";
@@ -480,376 +477,39 @@ bool GIWindow::convert() {
 				group_ar_filename = stage_add_temp_path.toStdString() + "/gia-" + ToString(g) + ".ar";
 
 			logProgress(ProgressNormal, QString("Loading Group's AR Pack from %1.").arg(group_ar_filename.c_str()));
-			group_ar_pack = new LibGens::ArPack(group_ar_filename);
-			group_ar_file = new LibGens::File(group_ar_filename, LIBGENS_FILE_READ_BINARY);
-			
-			logProgress(ProgressNormal, QString("Reading atlasinfo file from group AR Pack."));
-			LibGens::ArFile *atlasinfo_file = group_ar_pack->getFile(LIBGENS_GI_TEXTURE_GROUP_ATLASINFO_FILE);
-			if (atlasinfo_file) {
-				if (atlasinfo_file->getData()) {
-					LibGens::File ar_data_file(atlasinfo_file->getData(), atlasinfo_file->getSize());
-					group->readAtlasinfo(&ar_data_file);
-				}
-				else {
-					group_ar_file->setGlobalOffset(atlasinfo_file->getAbsoluteDataAddress());
-					group->readAtlasinfo(group_ar_file);
-				}
-			}
-
-			group_ar_file->close();
-			delete group_ar_file;
-
-			//********************************************************************************
-			// Clone all the subtextures, delete the textures, and organize the subtextures.
-			//********************************************************************************
-			QTemporaryDir group_temp_dir(temporaryDirTemplate());
-			QString group_temp_path = group_temp_dir.path();
-			group_ar_pack->extract(group_temp_path.toStdString() + "/");
-
-			// Detect if any of the textures has a sub-texture that can be replaced by one of the ones in the GI import folder.
-			// Fill the filename map for both lightmaps and shadowmaps.
-			QMap<QString, QString> import_subtexture_lightmaps;
-			QMap<QString, QString> import_subtexture_shadowmaps;
-			list<LibGens::GITexture *> gi_textures = group->getTextures();
-
-			// Scan for any independent textures and create textures for them in the group since the atlasinfo file does not load them.
-			list<LibGens::GITexture *> gi_textures_to_delete;
-			QStringList independent_textures = QDir(group_temp_path).entryList(QStringList() << QString("*%1.dds").arg(quality_level_string));
-			foreach(QString texture_name, independent_textures) {
-				QFileInfo info(texture_name);
-				texture_name = info.baseName();
-
-				LibGens::GITexture *texture = new LibGens::GITexture();
-				texture->setName(texture_name.toStdString());
-
-				LibGens::GISubtexture *subtexture = new LibGens::GISubtexture();
-				subtexture->setName(texture_name.toStdString());
-				subtexture->setX(0.0f);
-				subtexture->setY(0.0f);
-				subtexture->setWidth(1.0f);
-				subtexture->setHeight(1.0f);
-				texture->addSubtexture(subtexture);
-				gi_textures.push_back(texture);
-				gi_textures_to_delete.push_back(texture);
-				logProgress(ProgressNormal, QString("Found independent texture %1.dds for this group. Added it to processing list.").arg(texture_name));
-			}
-
-			for (list<LibGens::GITexture *>::iterator it = gi_textures.begin(); it != gi_textures.end(); it++) {
-				list<LibGens::GISubtexture *> subtextures = (*it)->getSubtextures();
-				for (list<LibGens::GISubtexture *>::iterator it2 = subtextures.begin(); it2 != subtextures.end(); it2++) {
-					QString subtexture_name = (*it2)->getName().c_str();
-					if (subtexture_name.contains(quality_level_string)) {
-						subtexture_name.remove(quality_level_string);
-					}
-
-					QString lightmap_filename = converter_settings.source_gi_directory + "/" + subtexture_name + "_lightmap.png";
-					QString shadowmap_filename = converter_settings.source_gi_directory + "/" + subtexture_name + "_shadowmap.png";
-					if (QFileInfo(lightmap_filename).exists())
-						import_subtexture_lightmaps[subtexture_name] = lightmap_filename;
-
-					if (QFileInfo(shadowmap_filename).exists())
-						import_subtexture_shadowmaps[subtexture_name] = shadowmap_filename;
-				}
+			LibGens::ArPack *group_ar_pack = new LibGens::ArPack(group_ar_filename);
+			atlas_pipeline.open(group, group_ar_pack);
+
+			// Detect if any of the subtextures can be replaced by one of the ones in the GI import folder.
+			vector<string> subtexture_names = atlas_pipeline.getSubtextureNames();
+			int import_count = 0;
+			for (size_t i = 0; i < subtexture_names.size(); i++) {
+				QString import_filename = converter_settings.source_gi_directory + "/" + subtexture_names[i].c_str();
+				if (QFileInfo(import_filename + "_lightmap.png").exists() || QFileInfo(import_filename + "_shadowmap.png").exists())
+					import_count++;
 			}
 
-			// If any of both maps aren't empty, we start re-generating the atlasfile by merging it with the existing content.
-			if (!import_subtexture_lightmaps.isEmpty() || !import_subtexture_shadowmaps.isEmpty() || converter_settings.override_lightmap || converter_settings.override_shadowmap) {
-				unsigned int folder_size = 0;
-				unsigned int max_atlas_texture_size = converter_settings.max_atlas_texture_size;
+			logProgress(ProgressNormal, QString("Found %1 textures with %2 subtextures for this group, %3 of them with maps to import.").arg(atlas_pipeline.getTextureCount()).arg(subtexture_names.size()).arg(import_count));
 
-				for (list<LibGens::GITexture *>::iterator it = gi_textures.begin(); it != gi_textures.end(); it++) {
-					string texture_name = (*it)->getName();
-					QString texture_filename = QString("%1/%2.dds").arg(group_temp_path).arg(texture_name.c_str());
-					string texture_filename_c = texture_filename.toStdString();
+			// If there's anything to import or override, we start re-generating the atlas textures by merging them with the existing content.
+			if (import_count || converter_settings.override_lightmap || converter_settings.override_shadowmap) {
+				int previous_folder_size = group->getFolderSize();
 
-					// Use FreeImage to convert the DDS to a png properly, since Qt doesn't load the alpha channels like it should.
-					FIBITMAP *bitmap = NULL;
-					FREE_IMAGE_FORMAT fif = FreeImage_GetFileType(texture_filename_c.c_str());
-					if (fif == FIF_UNKNOWN)
-						fif = FreeImage_GetFIFFromFilename(texture_filename_c.c_str());
-
-					if (fif != FIF_UNKNOWN) {
-						bitmap = FreeImage_Load(fif, texture_filename_c.c_str());
-					}
-
-					// Load the converter texture and use it to extract information from there.
-					if (bitmap) {
-						unsigned int texture_width = FreeImage_GetWidth(bitmap);
-						unsigned int texture_height = FreeImage_GetHeight(bitmap);
-						logProgress(ProgressNormal, QString("Loaded %1.dds for this group. Texture size is %2x%3.").arg(texture_name.c_str()).arg(texture_width).arg(texture_height));
-						(*it)->setWidth(texture_width);
-						(*it)->setHeight(texture_height);
-
-						// Extract all subtextures from the existing image into their own textures and store them in the folder.
-						list<LibGens::GISubtexture *> subtextures = (*it)->getSubtextures();
-						for (list<LibGens::GISubtexture *>::iterator it2 = subtextures.begin(); it2 != subtextures.end(); it2++) {
-							QString subtexture_name = (*it2)->getName().c_str();
-							if (subtexture_name.contains(quality_level_string)) {
-								subtexture_name.remove(quality_level_string);
-							}
-
-							QString target_lightmap_filename = group_temp_path + "/" + subtexture_name + "_lightmap.png";
-							QString target_shadowmap_filename = group_temp_path + "/" + subtexture_name + "_shadowmap.png";
-
-							// If we have a lightmap to import, copy that instead.
-							unsigned int subtexture_width = texture_width * (*it2)->getWidth();
-							unsigned int subtexture_height = texture_height * (*it2)->getHeight();
-							(*it2)->setPixelWidth(subtexture_width);
-							(*it2)->setPixelHeight(subtexture_height);
-							if (subtexture_width && subtexture_height) {
-								unsigned int scaled_width = subtexture_width;
-								unsigned int scaled_height = subtexture_height;
-								logProgress(ProgressNormal, QString("Processing %1.").arg(subtexture_name));
-
-								for (int step = 0; step < 2; step++) {
-									// Do shadowmap first so lightmap gets scaled to that.
-									bool do_shadowmap = converter_settings.scale_to_shadowmap ? (step == 0) : (step == 1);
-								
-									if (do_shadowmap) {
-										// Import and scale existing image from import folder.
-										if (converter_settings.override_shadowmap) {
-											QImage override_image(scaled_width, scaled_height, QImage::Format_RGBA8888);
-											int alpha = converter_settings.inverted_shadowmaps ? (255 - converter_settings.override_shadowmap_a) : converter_settings.override_shadowmap_a;
-											override_image.fill(QColor(alpha, alpha, alpha));
-											override_image.save(target_shadowmap_filename);
-										}
-										else if (import_subtexture_shadowmaps.contains(subtexture_name)) {
-											logProgress(ProgressNormal, QString("Importing shadowmap texture from %1 into %2...").arg(import_subtexture_shadowmaps[subtexture_name]).arg(target_shadowmap_filename));
-											QFile::copy(import_subtexture_shadowmaps[subtexture_name], target_shadowmap_filename);
-
-											QImage import_image;
-											if (import_image.load(target_shadowmap_filename)) {
-												int import_image_width = import_image.width();
-												int import_image_height = import_image.height();
-
-												if (converter_settings.scale_to_shadowmap) {
-													int downscale_factor = (1 << quality_level);
-													scaled_width = import_image_width / downscale_factor;
-													scaled_height = import_image_height / downscale_factor;
-												}
-											
-												if ((scaled_width != import_image_width) || (scaled_height != import_image_height)) {
-													QImage scaled_image = import_image.scaled(scaled_width, scaled_height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-													scaled_image.save(target_shadowmap_filename);
-												}
-											}
-										}
-										// Otherwise, extract the existing content of the image.
-										else {
-											logProgress(ProgressNormal, QString("Extracting shadowmap texture into %1...").arg(target_shadowmap_filename));
-											QImage extract_image(subtexture_width, subtexture_height, QImage::Format_RGBA8888);
-											int start_x = texture_width * (*it2)->getX();
-											int start_y = texture_height * (*it2)->getY();
-
-											// Turn the alpha into the RGB channel. (And also take inverted shadowmaps into account)
-											int image_width = extract_image.width();
-											int image_height = extract_image.height();
-											for (int x = 0; x < image_width; x++) {
-												for (int y = 0; y < image_height; y++) {
-													// FreeImage works on bottom-left as 0, 0
-													RGBQUAD quad;
-													FreeImage_GetPixelColor(bitmap, start_x + x, texture_height - 1 - (start_y + y), &quad);
-												
-													int alpha = converter_settings.inverted_shadowmaps ? (255 - quad.rgbReserved) : quad.rgbReserved;
-													extract_image.setPixel(x, y, QColor(alpha, alpha, alpha).rgb());
-												}
-											}
-
-											// Scale the extracted image if it's different than the desired width or height.
-											if ((scaled_width != extract_image.width()) || (scaled_height != extract_image.height()))
-												extract_image = extract_image.scaled(scaled_width, scaled_height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-
-											extract_image.save(target_shadowmap_filename);
-										}
-									}
-									else {
-										// Import and scale existing image from import folder.
-										if (converter_settings.override_lightmap) {
-											QImage override_image(scaled_width, scaled_height, QImage::Format_RGBA8888);
-											override_image.fill(QColor(converter_settings.override_lightmap_r, converter_settings.override_lightmap_g, converter_settings.override_lightmap_b));
-											override_image.save(target_lightmap_filename);
-										}
-										else if (import_subtexture_lightmaps.contains(subtexture_name)) {
-											logProgress(ProgressNormal, QString("Importing lightmap texture from %1 into %2...").arg(import_subtexture_lightmaps[subtexture_name]).arg(target_lightmap_filename));
-											QFile::copy(import_subtexture_lightmaps[subtexture_name], target_lightmap_filename);
-
-											QImage import_image;
-											if (import_image.load(target_lightmap_filename)) {
-												int import_image_width = import_image.width();
-												int import_image_height = import_image.height();
-
-												if (converter_settings.scale_to_lightmap) {
-													int downscale_factor = (1 << quality_level);
-													scaled_width = import_image_width / downscale_factor;
-													scaled_height = import_image_height / downscale_factor;
-												}
-											
-												if ((scaled_width != import_image_width) || (scaled_height != import_image_height)) {
-													QImage scaled_image = import_image.scaled(scaled_width, scaled_height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-													scaled_image.save(target_lightmap_filename);
-												}
-											}
-										}
-										// Otherwise, extract the existing content of the image.
-										else {
-											logProgress(ProgressNormal, QString("Extracting lightmap texture into %1...").arg(target_lightmap_filename));
-											QImage extract_image(subtexture_width, subtexture_height, QImage::Format_RGBA8888);
-											int start_x = texture_width * (*it2)->getX();
-											int start_y = texture_height * (*it2)->getY();
-											int image_width = extract_image.width();
-											int image_height = extract_image.height();
-											for (int x = 0; x < image_width; x++) {
-												for (int y = 0; y < image_height; y++) {
-													// FreeImage works on bottom-left as 0, 0
-													RGBQUAD quad;
-													FreeImage_GetPixelColor(bitmap, start_x + x, texture_height - 1 - (start_y + y), &quad);
-													extract_image.setPixel(x, y, QColor(quad.rgbRed, quad.rgbGreen, quad.rgbBlue).rgb());
-												}
-											}
-
-											// Scale the extracted image if it's different than the desired width or height.
-											if ((scaled_width != extract_image.width()) || (scaled_height != extract_image.height()))
-												extract_image = extract_image.scaled(scaled_width, scaled_height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-
-											extract_image.save(target_lightmap_filename);
-										}
-									}
-								}
-							
-								// Once we have the final width and height, we clone the subtexture with the desired size.
-								LibGens::GISubtexture *clone_subtexture = new LibGens::GISubtexture();
-								clone_subtexture->setPixelWidth(scaled_width);
-								clone_subtexture->setPixelHeight(scaled_height);
-								clone_subtexture->setName(subtexture_name.toStdString());
-								max_atlas_texture_size = max(max_atlas_texture_size, scaled_width);
-								max_atlas_texture_size = max(max_atlas_texture_size, scaled_height);
-								group->addSubtextureToOrganize(clone_subtexture);
-								logProgress(ProgressNormal, QString("Created subtexture with size %1x%2 for %3.").arg(scaled_width).arg(scaled_height).arg(subtexture_name));
-							}
-							else {
-								logProgress(ProgressError, QString("Subtexture %1 has an invalid width and height %2x%3.").arg(subtexture_name).arg(subtexture_width).arg(subtexture_height));
-							}
-						}
-
-						FreeImage_Unload(bitmap);
-					}
-					else {
-						logProgress(ProgressError, QString("Couldn't load %1.dds for this group. Skipping texture.").arg(texture_name.c_str()));
-					}
-				}
-
-				logProgress(ProgressNormal, QString("Organizing subtextures for group #%1 with size %2.").arg(g).arg(max_atlas_texture_size));
-				group->deleteTextures();
-				group->organizeSubtextures(max_atlas_texture_size);
-
-				QTemporaryDir new_group_dir(temporaryDirTemplate());
-				QString new_group_temp_path = new_group_dir.path();
-
-				logProgress(ProgressNormal, QString("Saving textures and atlasinfo file..."));
-				gi_textures = group->getTextures();
-				for (list<LibGens::GITexture *>::iterator it = gi_textures.begin(); it != gi_textures.end(); it++) {
-					QString atlas_image_filename = QString("%1/%2.png").arg(new_group_temp_path).arg((*it)->getName().c_str());
-					QString atlas_texture_filename = QString("%1/%2.dds").arg(new_group_temp_path).arg((*it)->getName().c_str());
-
-					int atlas_width = (*it)->getWidth();
-					int atlas_height = (*it)->getHeight();
-
-					FIBITMAP *atlas_bitmap = FreeImage_Allocate(atlas_width, atlas_height, 32);
-
-					list<LibGens::GISubtexture *> subtextures = (*it)->getSubtextures();
-					for (list<LibGens::GISubtexture *>::iterator it2 = subtextures.begin(); it2 != subtextures.end(); it2++) {
-						QString subtexture_name = (*it2)->getName().c_str();
-						if (subtexture_name.contains(quality_level_string)) {
-							subtexture_name.remove(quality_level_string);
-						}
-
-						QString target_lightmap_filename = group_temp_path + "/" + subtexture_name + "_lightmap.png";
-						QString target_shadowmap_filename = group_temp_path + "/" + subtexture_name + "_shadowmap.png";
-						QImage lightmap_image;
-						QImage shadowmap_image;
-						if (lightmap_image.load(target_lightmap_filename) && shadowmap_image.load(target_shadowmap_filename)) {
-							if ((lightmap_image.width() == shadowmap_image.width()) && (lightmap_image.height() == shadowmap_image.height())) {
-								int target_x = (*it2)->getX() * atlas_width;
-								int target_y = (*it2)->getY() * atlas_height;
-								int width = lightmap_image.width();
-								int height = lightmap_image.height();
-								logProgress(ProgressNormal, QString("Merging lightmap and shadowmap textures for %1 at [%2, %3][%4, %5]...").arg(subtexture_name).arg(target_x).arg(target_y).arg(width).arg(height));
-
-								for (int x = 0; x < width; x++) {
-									for (int y = 0; y < height; y++) {
-										QColor lightmap_color = lightmap_image.pixel(x, y);
-										QColor shadowmap_color = shadowmap_image.pixel(x, y);
-										int alpha = min((shadowmap_color.red() + shadowmap_color.green() + shadowmap_color.blue()) / 3, 255);
-										if (converter_settings.inverted_shadowmaps)
-											alpha = 255 - alpha;
-
-										RGBQUAD rgbquad;
-										rgbquad.rgbRed = lightmap_color.red();
-										rgbquad.rgbGreen = lightmap_color.green();
-										rgbquad.rgbBlue = lightmap_color.blue();
-										rgbquad.rgbReserved = alpha;
-										FreeImage_SetPixelColor(atlas_bitmap, target_x + x, atlas_height - 1 - (target_y + y), &rgbquad);
-									}
-								}
-							}
-							else {
-								logProgress(ProgressError, QString("Lightmap and Shadowmap sizes are somehow different! %1x%2 vs %3x%4").arg(lightmap_image.width()).arg(lightmap_image.height()).arg(shadowmap_image.width()).arg(shadowmap_image.height()));
-							}
-						}
-						else {
-							logProgress(ProgressError, QString("Couldn't load %1 and/or %2. Cannot merge into GI Atlas texture.").arg(target_lightmap_filename).arg(target_shadowmap_filename));
-						}
-					}
-
-					FreeImage_Save(FIF_PNG, atlas_bitmap, atlas_image_filename.toStdString().c_str());
-					FreeImage_Unload(atlas_bitmap);
-
-					const QString temp_texture = "temp.dds";
-					QStringList arguments;
-					arguments << "-file" << atlas_image_filename << "-output" << temp_texture;
-
-					logProgress(ProgressNormal, QString("Converting with NVDXT " + atlas_image_filename));
-					QProcess conversion_process;
-					conversion_process.start("nvdxt", arguments);
-					conversion_process.waitForFinished();
-					QString conversion_output = conversion_process.readAllStandardOutput();
-					logProgress(ProgressNormal, QString("NVDXT Output: " + conversion_output));
-					QFile::remove(atlas_texture_filename);
-					if (QFile::copy(temp_texture, atlas_texture_filename)) {
-						logProgress(ProgressNormal, QString("Converter NVDXT finished with %1 to %2").arg(atlas_image_filename).arg(atlas_texture_filename));
-						folder_size += QFileInfo(atlas_texture_filename).size();
-					}
-					else {
-						logProgress(ProgressError, QString("Couldn't copy NVDXT's result to %1. Is this directory write-protected?").arg(atlas_texture_filename));
-					}
-				}
-				
-				logProgress(ProgressNormal, QString("Updating folder size from %1 to %2.").arg(group->getFolderSize()).arg(folder_size));
-				group->setFolderSize(folder_size);
-				group->saveAtlasinfo(new_group_temp_path.toStdString() + "/atlasinfo");
-
-				// Pack GI Group AR
 				LibGens::ArPack gi_group_ar_pack;
-				QStringList entry_list = QDir(new_group_temp_path).entryList(QStringList() << "*.dds" << "atlasinfo");
-				foreach(QString entry, entry_list) {
-					gi_group_ar_pack.addFile((new_group_temp_path + "/" + entry).toStdString());
-				}
+				atlas_pipeline.process(converter_settings.max_atlas_texture_size, &gi_group_ar_pack);
+				atlas_pipeline.clear();
+				logProgress(ProgressNormal, QString("Organized group #%1 into %2 textures.").arg(g).arg(group->getTextures().size()));
+				logProgress(ProgressNormal, QString("Updating folder size from %1 to %2.").arg(previous_folder_size).arg(group->getFolderSize()));
 
-				logProgress(ProgressNormal, QString("Packing Group #%1's AR Pack.").arg(g));
-				QString gi_group_name = QString("gia-%1.ar").arg(g);
-				if (quality_level == LIBGENS_GI_TEXTURE_GROUP_LOWEST_QUALITY) {
-					gi_group_ar_pack.save((stage_temp_path + "/" + gi_group_name).toStdString());
-				}
-				else {
-					gi_group_ar_pack.save((stage_add_temp_path + "/" + gi_group_name).toStdString());
-				}
-			}
+				// The old pack can still be mapped from the file that is about to be replaced.
+				delete group_ar_pack;
+				group_ar_pack = NULL;
 
-			for (list<LibGens::GITexture *>::iterator it = gi_textures_to_delete.begin(); it != gi_textures_to_delete.end(); it++) {
-				delete *it;
+				logProgress(ProgressNormal, QString("Packing Group #%1's AR Pack.").arg(g));
+				gi_group_ar_pack.save(group_ar_filename);
 			}
-			gi_textures_to_delete.clear();
 
+			atlas_pipeline.clear();
 			delete group_ar_pack;
 		}
 
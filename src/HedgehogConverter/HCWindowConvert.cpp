@@ -23,6 +23,7 @@
 #include <QDir>
 #include <QTemporaryDir>
 #include <QProcess>
+#include <QImage>
 #include <QtConcurrent>
 #include "assimp/postprocess.h"
 #include "assimp/Importer.hpp"
@@ -38,6 +39,7 @@
 #include "Material.h"
 #include "Parameter.h"
 #include "Texture.h"
+#include "TextureCompression.h"
 #include "Tags.h"
 #include "AR.h"
 #include "GITextureGroup.h"
@@ -741,6 +743,39 @@ bool HCWindow::convert() {
 				if (QFileInfo(source_file).exists()) {
 					textures_to_convert.removeAll(texture_filename);
 
+					// Anything Qt can load is compressed in-process, as DXT1 when it's fully opaque and DXT5 otherwise.
+					QImage source_image;
+					if (source_image.load(source_file)) {
+						source_image = source_image.convertToFormat(QImage::Format_RGBA8888);
+						unsigned int width = source_image.width();
+						unsigned int height = source_image.height();
+						vector<unsigned char> pixels((size_t) width * height * 4);
+						for (unsigned int y = 0; y < height; y++) {
+							memcpy(pixels.data() + (size_t) y * width * 4, source_image.constScanLine(y), width * 4);
+						}
+
+						LibGens::TextureCompressionFormat format = LibGens::TEXTURE_COMPRESSION_BC1;
+						for (size_t i = 3; i < pixels.size(); i += 4) {
+							if (pixels[i] < 255) {
+								format = LibGens::TEXTURE_COMPRESSION_BC3;
+								break;
+							}
+						}
+
+						vector<unsigned char> dds;
+						LibGens::TextureCompression::writeDDS(pixels.data(), width, height, format, LibGens::TEXTURE_COMPRESSION_NORMAL, true, &dds);
+
+						QFile output(output_file);
+						if (output.open(QIODevice::WriteOnly) && (output.write((const char *) dds.data(), dds.size()) == (qint64) dds.size())) {
+							logProgress(ProgressNormal, QString("Compressed " + source_file + " to " + output_file + (format == LibGens::TEXTURE_COMPRESSION_BC1 ? " as DXT1." : " as DXT5.")));
+						}
+						else {
+							logProgress(ProgressWarning, QString("Couldn't write " + output_file + ". Is this directory write-protected?"));
+						}
+
+						continue;
+					}
+
 					logProgress(ProgressNormal, QString("Calling NVDXT converter for " + source_file + " to " + output_file));
 
 					const QString temp_texture = "temp.dds";
@@ -831,7 +866,13 @@ bool HCWindow::convert() {
 			delete terrain;
 
 			LibGens::TerrainBlock *terrain_block = new LibGens::TerrainBlock();
-			terrain_block->build(std::vector<LibGens::TerrainGroup*>(terrain_groups.begin(), terrain_groups.end()));
+			terrain_block->build(std::vector<LibGens::TerrainGroup*>(terrain_groups.begin(), terrain_groups.end()), LibGens::TERRAIN_BLOCK_BUILD_SAH);
+
+			LibGens::TerrainBlockQuality terrain_block_quality;
+			terrain_block->getQuality(&terrain_block_quality);
+			logProgress(ProgressNormal, QString("Built terrain block with %1 nodes, depth %2 (average leaf depth %3), SAH cost %4, overlap %5.")
+				.arg(terrain_block_quality.node_count).arg(terrain_block_quality.max_depth).arg(terrain_block_quality.average_leaf_depth, 0, 'f', 2)
+				.arg(terrain_block_quality.sah_cost, 0, 'f', 2).arg(terrain_block_quality.overlap, 0, 'f', 3));
 
 			string terrain_block_filename = configuration_path.toStdString() + "/terrain-block.tbst";
 			terrain_block->save(terrain_block_filename.c_str());
@@ -22,10 +22,18 @@
 
 namespace LibGens {
 	ArFile::ArFile() {
+		data_view = NULL;
+		data_size = 0;
+		absolute_data_address = 0;
+		source_address = 0;
 	}
 
 	ArFile::ArFile(string filename) {
 		name = filename;
+		data_view = NULL;
+		data_size = 0;
+		absolute_data_address = 0;
+		source_address = 0;
 	}
 
 	void ArFile::read(File *file, bool read_data) {
@@ -44,6 +52,7 @@ namespace LibGens {
 
 		file->goToAddress(header_address + data_address);
 		data.clear();
+		data_view = NULL;
 
 		if (read_data) {
 			data.resize(data_size);
@@ -54,39 +63,83 @@ namespace LibGens {
 		}
 	}
 
+	void ArFile::read(FileReader *reader) {
+		unsigned int entry_size=0;
+		unsigned int data_address=0;
+
+		size_t header_address = reader->getCurrentAddress();
+
+		reader->readInt32(&entry_size);
+		reader->readInt32(&data_size);
+		reader->readInt32(&data_address);
+		reader->moveAddress(8);
+		reader->readString(&name);
+
+		absolute_data_address = header_address + data_address;
+		data.clear();
+
+		reader->goToAddress(absolute_data_address);
+		data_view = reader->getCurrentData();
+		reader->moveAddress(data_size);
+
+		if (reader->hasOverflowed()) data_view = NULL;
+	}
+
 	void ArFile::readData(File *file) {
 		data_size=file->getFileSize();
 		data.resize(data_size);
 		file->read(data.data(), data_size);
 	}
 
+	unsigned int ArFile::computeDataOffset(size_t header_address, unsigned int padding) {
+		size_t data_address = header_address + LIBGENS_AR_ENTRY_HEADER_SIZE + name.size() + 1;
+		if (padding > 1) {
+			data_address = ((data_address + padding - 1) / padding) * padding;
+		}
+
+		return data_address - header_address;
+	}
+
 	void ArFile::write(File *file, unsigned int padding) {
-		unsigned int entry_size=0;
-		unsigned int data_address=0;
+		bool loaded = hasData();
+		if (!loaded && !loadData()) {
+			Error::addMessage(Error::FILE_NOT_FOUND, LIBGENS_AR_ERROR_MESSAGE_MISSING_DATA + name);
+			data.resize(data_size);
+		}
 
+		// The header only depends on the name and the address, so it's built in one piece instead of patched afterwards
 		size_t header_address = file->getCurrentAddress();
-		file->writeNull(4);
-		file->writeInt32(&data_size);
-		file->writeNull(12);
-		file->writeString(&name);
-		file->fixPadding(padding);
-
-		data_address = file->getCurrentAddress() - header_address;
-		absolute_data_address = file->getCurrentAddress();
-		file->write(data.data(), data_size);
-
-		entry_size = file->getCurrentAddress() - header_address;
-		file->goToAddress(header_address);
-		file->writeInt32(&entry_size);
-		file->moveAddress(4);
-		file->writeInt32(&data_address);
+		unsigned int data_address = computeDataOffset(header_address, padding);
+		unsigned int entry_size = data_address + data_size;
 
-		file->goToEnd();
+		vector<unsigned char> header(data_address, 0);
+		memcpy(&header[0], &entry_size, sizeof(unsigned int));
+		memcpy(&header[4], &data_size, sizeof(unsigned int));
+		memcpy(&header[8], &data_address, sizeof(unsigned int));
+		memcpy(&header[LIBGENS_AR_ENTRY_HEADER_SIZE], name.c_str(), name.size());
+		file->write(header.data(), header.size());
+
+		absolute_data_address = header_address + data_address;
+		file->write(getData(), data_size);
+
+		if (!loaded) releaseData();
 	}
 
 	void ArFile::save(string filename) {
+		bool loaded = hasData();
+		if (!loaded && !loadData()) {
+			Error::addMessage(Error::FILE_NOT_FOUND, LIBGENS_AR_ERROR_MESSAGE_MISSING_DATA + name);
+			return;
+		}
+
+		save(filename, getData());
+
+		if (!loaded) releaseData();
+	}
+
+	void ArFile::save(string filename, const unsigned char *data_p) {
 		File file(filename, LIBGENS_FILE_WRITE_BINARY, LIBGENS_FILE_PREFER_DISK_FILE);
-		file.write(data.data(), data_size);
+		file.write((void *) data_p, data_size);
 		file.close();
 	}
 
@@ -95,6 +148,7 @@ namespace LibGens {
 	}
 
 	unsigned char *ArFile::getData() {
+		if (data_view) return const_cast<unsigned char *>(data_view);
 		return data.data();
 	}
 
@@ -107,14 +161,98 @@ namespace LibGens {
 	}
 
 	void ArFile::setData(vector<unsigned char> &&data_p) {
+		data_view = NULL;
 		data = move(data_p);
 		data_size = data.size();
 	}
 
 	vector<unsigned char> ArFile::detach() {
+		if (data_view) {
+			vector<unsigned char> data_copy(data_view, data_view + data_size);
+			data_view = NULL;
+			return data_copy;
+		}
+
 		return move(data);
 	}
 
+	void ArFile::setSource(string filename, unsigned int address, unsigned int size) {
+		source_filename = filename;
+		source_address = address;
+		data_size = size;
+	}
+
+	const string& ArFile::getSourceFilename() {
+		return source_filename;
+	}
+
+	unsigned int ArFile::getSourceAddress() {
+		return source_address;
+	}
+
+	bool ArFile::hasData() {
+		return data_view || (data.size() == data_size);
+	}
+
+	bool ArFile::loadData() {
+		if (hasData()) return true;
+		if (source_filename.empty()) return false;
+
+		File file(source_filename, LIBGENS_FILE_READ_BINARY, LIBGENS_FILE_PREFER_DISK_FILE);
+		if (!file.valid()) return false;
+
+		data.resize(data_size);
+		file.goToAddress(source_address);
+		size_t read_size = file.read(data.data(), data_size);
+		file.close();
+
+		if (read_size != data_size) {
+			data.clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	void ArFile::releaseData() {
+		if (source_filename.empty()) return;
+		vector<unsigned char>().swap(data);
+	}
+
+	const unsigned char *ArFile::viewData(vector<unsigned char> *buffer) {
+		// Reads unloaded data into buffer instead of the entry, so several readers can share an entry
+		if (hasData()) return getData();
+		if (source_filename.empty()) return NULL;
+
+		File file(source_filename, LIBGENS_FILE_READ_BINARY, LIBGENS_FILE_PREFER_DISK_FILE);
+		if (!file.valid()) return NULL;
+
+		buffer->resize(data_size);
+		file.goToAddress(source_address);
+		size_t read_size = file.read(buffer->data(), data_size);
+		file.close();
+
+		if (read_size != data_size) {
+			buffer->clear();
+			return NULL;
+		}
+
+		return buffer->data();
+	}
+
+	XXH128_hash_t ArFile::computeHash() {
+		bool loaded = hasData();
+		if (!loaded && !loadData()) {
+			Error::addMessage(Error::FILE_NOT_FOUND, LIBGENS_AR_ERROR_MESSAGE_MISSING_DATA + name);
+			return XXH3_128bits(NULL, 0);
+		}
+
+		XXH128_hash_t hash = XXH3_128bits(getData(), data_size);
+
+		if (!loaded) releaseData();
+		return hash;
+	}
+
 	ArFile::~ArFile() {
 	}
 
@@ -136,17 +274,40 @@ namespace LibGens {
 					if (name[0]=='.') continue;
 
 					string new_filename=filename+ToString(name);
-					addFile(new_filename);
+					addFile(new_filename, "", data);
 				} while (FindNextFile(hFind, &FindFileData) != 0);
 				FindClose(hFind);
 			}
 			return;
 		}
 		
-		File file(filename, LIBGENS_FILE_READ_BINARY, LIBGENS_FILE_PREFER_DISK_FILE);
-		if (file.valid()) {
-			read(&file);
-			file.close();
+		// Index-only opens map the archive and keep the mapping for the entry views
+		File *file=new File(filename, LIBGENS_FILE_READ_BINARY, data ? LIBGENS_FILE_PREFER_DISK_FILE : false);
+		if (!data && !file->valid()) {
+			delete file;
+			file=new File(filename, LIBGENS_FILE_READ_BINARY, LIBGENS_FILE_PREFER_DISK_FILE);
+		}
+
+		if (file->valid()) {
+			// The pack owns the mapping, so read can leave the entries as views into it
+			size_t memory_size=0;
+			bool mapped = !data && file->getMemoryData(&memory_size);
+			if (mapped) {
+				mapped_files.push_back(file);
+			}
+
+			read(file, data);
+
+			if (!mapped) {
+				file->close();
+				delete file;
+			}
+			file=NULL;
+
+			// Entries read without data can load it later from this volume
+			for (size_t i=0; i<files.size(); i++) {
+				if (!files[i]->hasData()) files[i]->setSource(filename, files[i]->getAbsoluteDataAddress(), files[i]->getSize());
+			}
 
 			size_t pos=filename.find(LIBGENS_AR_MULTIPLE_START);
 			if ((pos != string::npos) && pos==(filename.size()-6)) {
@@ -192,7 +353,8 @@ namespace LibGens {
 					filename += extension;
 
 					if (File::check(filename)) {
-						LibGens::ArPack *extension_ar_pack=new LibGens::ArPack(filename);
+						// Entries without data keep this volume as their source
+						LibGens::ArPack *extension_ar_pack=new LibGens::ArPack(filename, data);
 						merge(extension_ar_pack);
 					}
 					else break;
@@ -201,17 +363,44 @@ namespace LibGens {
 				}
 			}
 		}
+		else {
+			delete file;
+		}
 	}
 
 	void ArPack::merge(ArPack *pack) {
 		size_t file_count=pack->files.size();
 		for (size_t i=0; i<file_count; i++) {
 			files.push_back(pack->files[i]);
+			indexFile(pack->files[i]);
 		}
 		pack->files.clear();
+		pack->file_index.clear();
+
+		mapped_files.insert(mapped_files.end(), pack->mapped_files.begin(), pack->mapped_files.end());
+		pack->mapped_files.clear();
 		delete pack;
 	}
 
+	void ArPack::indexFile(ArFile *file) {
+		// The first entry with a name wins, like the linear search did
+		file_index.emplace(file->getName(), file);
+	}
+
+	void ArPack::readIndex(File *file) {
+		FileReader reader;
+		file->prepareReader(&reader, 0, file->getFileSize());
+		reader.goToAddress(LIBGENS_AR_HEADER_SIZE);
+
+		while (reader.getRemaining() && !reader.hasOverflowed()) {
+			ArFile* ar_file = new ArFile();
+			ar_file->read(&reader);
+
+			files.push_back(ar_file);
+			indexFile(ar_file);
+		}
+	}
+
 	void ArPack::read(File* file, bool data) {
 		unsigned int ar_header_0 = 0;
 		unsigned int ar_header_1 = 0;
@@ -235,18 +424,38 @@ namespace LibGens {
 		file->readInt32(&ar_header_2);
 		file->readInt32(&padding);
 		files.clear();
+		file_index.clear();
+
+		// Without data, memory backed archives only get their headers walked. Entries stay views into the memory
+		// when the pack owns it, and get a copy of their data otherwise, since the caller's File can go away first.
+		size_t memory_size=0;
+		if (!data && file->getMemoryData(&memory_size)) {
+			readIndex(file);
+
+			if (std::find(mapped_files.begin(), mapped_files.end(), file) == mapped_files.end()) {
+				for (size_t i=0; i<files.size(); i++) {
+					if (files[i]->hasData()) files[i]->setData(files[i]->detach());
+				}
+			}
+			return;
+		}
 
 		while (!file->endOfFile()) {
 			ArFile* ar_file = new ArFile();
 			ar_file->read(file, data);
 
 			files.push_back(ar_file);
+			indexFile(ar_file);
 
 			if (file->getCurrentAddress() >= file->getFileSize()) break;
 		}
 	}
 
 	void ArPack::write(File *file) {
+		writeEntries(file, 0, files.size());
+	}
+
+	void ArPack::writeEntries(File *file, size_t first, size_t last) {
 		unsigned int ar_header_0 = 0;
 		unsigned int ar_header_1 = 0x10;
 		unsigned int ar_header_2 = 0x14;
@@ -255,19 +464,35 @@ namespace LibGens {
 		file->writeInt32(&ar_header_2);
 		file->writeInt32(&padding);
 
-		for (LibGens::ArFile *ar_file : files) {
-			ar_file->write(file, padding);
+		for (size_t i=first; i<last; i++) {
+			files[i]->write(file, padding);
 		}
 	}
 
+	void ArPack::buildLayout(size_t base_address, bool split_file_mode, vector<size_t> *volume_starts) {
+		split_sizes.clear();
+		volume_starts->clear();
+		volume_starts->push_back(0);
+
+		size_t address = base_address + LIBGENS_AR_HEADER_SIZE;
+		for (size_t i=0; i<files.size(); i++) {
+			address += files[i]->computeDataOffset(address, padding) + files[i]->getSize();
+
+			if (split_file_mode && (address > LIBGENS_AR_MAX_SPLIT_FILE_BYTES) && (i<files.size()-1)) {
+				split_sizes.push_back(address);
+				volume_starts->push_back(i+1);
+				address = LIBGENS_AR_HEADER_SIZE;
+			}
+		}
+
+		split_sizes.push_back(address);
+	}
+
 	void ArPack::save(string filename, unsigned int padding_p) {
 		bool split_file_mode=false;
 		string pack_name=filename;
-		char extension[]="00";
-		size_t ar_split_index=1;
 
 		padding = padding_p;
-		split_sizes.clear();
 
 		size_t pos=filename.find(LIBGENS_AR_MULTIPLE_START);
 		if ((pos != string::npos) && pos==(filename.size()-6)) {
@@ -291,49 +516,29 @@ namespace LibGens {
 			}
 		}
 
-		File *current_file=new LibGens::File(filename, LIBGENS_FILE_WRITE_BINARY, LIBGENS_FILE_PREFER_DISK_FILE);
-		if (current_file->valid()) {
-			unsigned int ar_header_0=0;
-			unsigned int ar_header_1=0x10;
-			unsigned int ar_header_2=0x14;
-			current_file->writeInt32(&ar_header_0);
-			current_file->writeInt32(&ar_header_1);
-			current_file->writeInt32(&ar_header_2);
-			current_file->writeInt32(&padding);
+		// Every entry's offset is known up front, so each volume can be written on its own
+		vector<size_t> volume_starts;
+		buildLayout(0, split_file_mode, &volume_starts);
 
-			
-			char extension[]="00";
+		Parallel::forEach(volume_starts.size(), [&](size_t volume) {
+			string volume_filename=filename;
+			if (volume) {
+				char extension[]="00";
+				sprintf_s(extension, "%02d", volume);
+				volume_filename=pack_name+ToString(extension);
+			}
 
-			for (size_t i=0; i<files.size(); i++) {
-				files[i]->write(current_file, padding);
-
-				if (split_file_mode && (current_file->getCurrentAddress() > LIBGENS_AR_MAX_SPLIT_FILE_BYTES) && (i<files.size()-1)) {
-					split_sizes.push_back(current_file->getFileSize());
-					current_file->close();
-					delete current_file;
-
-					sprintf_s(extension, "%02d", ar_split_index);
-					string new_filename=pack_name+ToString(extension);
-					current_file=new LibGens::File(new_filename, LIBGENS_FILE_WRITE_BINARY, LIBGENS_FILE_PREFER_DISK_FILE);
-					if (!current_file->valid()) {
-						printf("Couldn't write to AR File %s\n", new_filename.c_str());
-						getchar();
-						break;
-					}
-					else {
-						current_file->writeInt32(&ar_header_0);
-						current_file->writeInt32(&ar_header_1);
-						current_file->writeInt32(&ar_header_2);
-						current_file->writeInt32(&padding);
-						ar_split_index++;
-					}
-				}
+			File volume_file(volume_filename, LIBGENS_FILE_WRITE_BINARY, LIBGENS_FILE_PREFER_DISK_FILE);
+			if (!volume_file.valid()) {
+				Error::addMessage(Error::FILE_NOT_FOUND, LIBGENS_AR_ERROR_MESSAGE_WRITE_FILE + volume_filename);
+				printf("Couldn't write to AR File %s\n", volume_filename.c_str());
+				return;
 			}
 
-			split_sizes.push_back(current_file->getFileSize());
-			current_file->close();
-			delete current_file;
-		}
+			size_t last = (volume+1 < volume_starts.size()) ? volume_starts[volume+1] : files.size();
+			writeEntries(&volume_file, volume_starts[volume], last);
+			volume_file.close();
+		});
 
 		if (split_file_mode) {
 			string arl_filename=pack_name;
@@ -424,7 +629,7 @@ namespace LibGens {
 	}
 
 
-	void ArPack::addFile(string filepath, string override_name) {
+	void ArPack::addFile(string filepath, string override_name, bool data) {
 		File file(filepath, LIBGENS_FILE_READ_BINARY, LIBGENS_FILE_PREFER_DISK_FILE);
 
 		if (file.valid()) {
@@ -437,8 +642,10 @@ namespace LibGens {
 			}
 
 			ArFile *ar_file=new ArFile(name);
-			ar_file->readData(&file);
+			if (data) ar_file->readData(&file);
+			else ar_file->setSource(filepath, 0, file.getFileSize());
 			files.push_back(ar_file);
+			indexFile(ar_file);
 
 			file.close();
 		}
@@ -448,26 +655,55 @@ namespace LibGens {
 		ArFile *ar_file = new ArFile(filename);
 		ar_file->setData(move(data));
 		files.push_back(ar_file);
+		indexFile(ar_file);
 	}
 
 	void ArPack::addFile(string filename, LibGens::File &file) {
 		ArFile *ar_file = new ArFile(filename);
 		ar_file->readData(&file);
 		files.push_back(ar_file);
+		indexFile(ar_file);
 	}
 
 	void ArPack::extract(string folder, string add_extension, string add_prefix, vector<string> *output_filenames) {
+		vector<string> filenames(files.size());
+		map<string, size_t> source_counts;
 		for (size_t i=0; i<files.size(); i++) {
-			string new_filename=folder + add_prefix + files[i]->getName() + add_extension;
-			files[i]->save(new_filename);
-			if (output_filenames) output_filenames->push_back(new_filename);
+			filenames[i]=folder + add_prefix + files[i]->getName() + add_extension;
+			if (!files[i]->hasData()) source_counts[files[i]->getSourceFilename()]++;
 		}
-	}
 
-	ArFile *ArPack::getFile(string filename) {
+		// Entries that aren't in memory are read in place from their archive volume, mapped once for all of them.
+		// Sources with a single entry, like loose files, are loaded by the entry itself.
+		map<string, File *> sources;
+		vector<FileReader> views(files.size());
 		for (size_t i=0; i<files.size(); i++) {
-			if (files[i]->getName() == filename) return files[i];
+			const string &source_filename=files[i]->getSourceFilename();
+			if (files[i]->hasData() || source_filename.empty() || (source_counts[source_filename] < 2)) continue;
+
+			File *&source=sources[source_filename];
+			if (!source) source=new File(source_filename, LIBGENS_FILE_READ_BINARY);
+			if (source->valid()) source->prepareReader(&views[i], files[i]->getSourceAddress(), files[i]->getSize());
+		}
+
+		Parallel::forEach(files.size(), [&](size_t i) {
+			if (views[i].valid() && (views[i].getSize() == files[i]->getSize())) files[i]->save(filenames[i], views[i].getData());
+			else files[i]->save(filenames[i]);
+		});
+
+		for (map<string, File *>::iterator it=sources.begin(); it!=sources.end(); it++) {
+			it->second->close();
+			delete it->second;
+		}
+
+		if (output_filenames) {
+			output_filenames->insert(output_filenames->end(), filenames.begin(), filenames.end());
 		}
+	}
+
+	ArFile *ArPack::getFile(string filename) {
+		unordered_map<string, ArFile *>::iterator it=file_index.find(filename);
+		if (it != file_index.end()) return it->second;
 
 		return NULL;
 	}
@@ -484,10 +720,16 @@ namespace LibGens {
 		XXH3_state_t state;
 		XXH3_128bits_reset(&state);
 
+		// Entries that aren't loaded are read from their source, the pack hashes the same either way
 		for (auto& file : files) {
-			if (file->getData() != NULL) {
-				XXH3_128bits_update(&state, file->getData(), file->getSize());
+			vector<unsigned char> buffer;
+			const unsigned char *data = file->viewData(&buffer);
+			if (!data) {
+				Error::addMessage(Error::FILE_NOT_FOUND, LIBGENS_AR_ERROR_MESSAGE_MISSING_DATA + file->getName());
+				continue;
 			}
+
+			XXH3_128bits_update(&state, data, file->getSize());
 		}
 
 		return XXH3_128bits_digest(&state);
@@ -505,5 +747,13 @@ namespace LibGens {
 		}
 
 		files.clear();
+		file_index.clear();
+
+		for (size_t i=0; i<mapped_files.size(); i++) {
+			mapped_files[i]->close();
+			delete mapped_files[i];
+		}
+
+		mapped_files.clear();
 	}
 }
\ No newline at end of file
@@ -22,31 +22,53 @@
 #define LIBGENS_AR_H_ERROR_READ_FILE_BEFORE            "Can't open the AR File: "
 #define LIBGENS_AR_H_ERROR_READ_FILE_AFTER             ". Unknown header format."
 #define LIBGENS_AR_PFI_ERROR_MESSAGE_WRITE_NULL_FILE   "Trying to write PFI data to an unreferenced file."
+#define LIBGENS_AR_ERROR_MESSAGE_WRITE_FILE            "Couldn't write to AR File "
+#define LIBGENS_AR_ERROR_MESSAGE_MISSING_DATA          "Couldn't read the data of AR entry "
 #define LIBGENS_AR_PFI_ROOT_GENERATIONS                0
 #define LIBGENS_AR_MULTIPLE_START                      ".ar.00"
 #define LIBGENS_AR_MAX_SEARCH                          999
 #define LIBGENS_AR_MAX_SPLIT_FILE_BYTES                10485760
 #define LIBGENS_ARL_HEADER                             0x324C5241
+#define LIBGENS_AR_HEADER_SIZE                         16
+#define LIBGENS_AR_ENTRY_HEADER_SIZE                   20
 
 namespace LibGens {
+	// Entries opened without data, or added from a path without data, remember where their payload
+	// lives (source filename and address) and only hold it in memory between loadData and releaseData.
+	// Entries indexed from a memory mapped archive instead point straight into the mapping (data_view),
+	// which stays valid while the ArPack that owns the entry is alive.
 	class ArFile {
 		protected:
 			string name;
 			vector<unsigned char> data;
+			const unsigned char *data_view;
 			unsigned int data_size;
 			unsigned int absolute_data_address;
+			string source_filename;
+			unsigned int source_address;
 		public:
 			ArFile();
 			ArFile(string filename);
 			void read(File *file, bool data=true);
+			void read(FileReader *reader);
 			void readData(File *file);
 			void save(string filename);
+			void save(string filename, const unsigned char *data_p);
 			void write(File *file, unsigned int padding=0x40);
+			unsigned int computeDataOffset(size_t header_address, unsigned int padding);
 			const string& getName();
 			unsigned char *getData();
 			unsigned int getSize();
 			unsigned int getAbsoluteDataAddress();
 			void setData(vector<unsigned char> &&data_p);
+			void setSource(string filename, unsigned int address, unsigned int size);
+			const string& getSourceFilename();
+			unsigned int getSourceAddress();
+			bool hasData();
+			bool loadData();
+			void releaseData();
+			const unsigned char *viewData(vector<unsigned char> *buffer);
+			XXH128_hash_t computeHash();
 			vector<unsigned char> detach();
 			~ArFile();
 	};
@@ -56,11 +78,20 @@ namespace LibGens {
 
 		protected:
 			vector<ArFile *> files;
+			unordered_map<string, ArFile *> file_index;
+			vector<File *> mapped_files;
 			vector<unsigned int> split_sizes;
 			unsigned int padding;
+
+			void indexFile(ArFile *file);
+			void readIndex(File *file);
+			void buildLayout(size_t base_address, bool split_file_mode, vector<size_t> *volume_starts);
+			void writeEntries(File *file, size_t first, size_t last);
 		public:
 			ArPack(unsigned int padding_p=0x40);
 			ArPack(string filename, bool data=true);
+			// Without data, entries of a memory backed file are copied out of it, only the archives the pack
+			// maps itself are read in place.
 			void read(File* file, bool data=true);
 			void write(File* file);
 			void save(string filename, unsigned int padding_p=0x40);
@@ -72,7 +103,7 @@ namespace LibGens {
 			ArFile *getFile(string filename);
 			ArFile *getFileByIndex(size_t index);
 			void merge(ArPack *pack);
-			void addFile(string filepath, string override_name="");
+			void addFile(string filepath, string override_name="", bool data=true);
 			void addFile(string filename, vector<unsigned char> &&data);
 			void addFile(string filename, LibGens::File &file);
 			unsigned int getFileCount();
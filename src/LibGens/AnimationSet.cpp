@@ -36,14 +36,47 @@ namespace LibGens {
 		}
 	}
 
-	float AnimationSet::getCurrentValue(unsigned int flag) {
+	size_t AnimationSet::findKeyframeSet(unsigned int flag) {
 		for (size_t i=0; i<keyframe_sets.size(); i++) {
 			if (keyframe_sets[i]->getFlag() == flag) {
-				return keyframe_sets[i]->getValue(current_frame);
+				return i;
 			}
 		}
 
-		return 0.0f;
+		return keyframe_sets.size();
+	}
+
+	float AnimationSet::getCurrentValue(unsigned int flag) {
+		float value = 0.0f;
+		getCurrentValues(&flag, &value, 1);
+		return value;
+	}
+
+	KeyframeSet *AnimationSet::getKeyframeSet(unsigned int flag) {
+		size_t index = findKeyframeSet(flag);
+		return (index < keyframe_sets.size()) ? keyframe_sets[index] : NULL;
+	}
+
+	void AnimationSet::getCurrentValues(const unsigned int *flags, float *values, size_t count) {
+		if (keyframe_cursors.size() != keyframe_sets.size()) {
+			keyframe_cursors.assign(keyframe_sets.size(), 0);
+		}
+
+		for (size_t i=0; i<count; i++) {
+			size_t index = findKeyframeSet(flags[i]);
+			values[i] = (index < keyframe_sets.size()) ? keyframe_sets[index]->getValue(current_frame, &keyframe_cursors[index]) : 0.0f;
+		}
+	}
+
+	void AnimationSet::sample(float frame, const unsigned int *flags, float *values, size_t count) {
+		for (size_t i=0; i<count; i++) {
+			size_t index = findKeyframeSet(flags[i]);
+			values[i] = (index < keyframe_sets.size()) ? keyframe_sets[index]->getValue(frame) : 0.0f;
+		}
+	}
+
+	float AnimationSet::getCurrentFrame() {
+		return current_frame;
 	}
 
 	string AnimationSet::getName() {
@@ -53,4 +86,12 @@ namespace LibGens {
 	float AnimationSet::getFPS() {
 		return fps;
 	}
+
+	float AnimationSet::getStartTime() {
+		return start_time;
+	}
+
+	float AnimationSet::getEndTime() {
+		return end_time;
+	}
 };
\ No newline at end of file
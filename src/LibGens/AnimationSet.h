@@ -30,11 +30,24 @@ namespace LibGens {
 			float end_time;
 			string animation_name;
 			float current_frame;
+			vector<size_t> keyframe_cursors;
+
+			size_t findKeyframeSet(unsigned int flag);
 		public:
 			AnimationSet();
 			void addTime(float time_s);
 			float getCurrentValue(unsigned int flag);
+			KeyframeSet *getKeyframeSet(unsigned int flag);
+
+			// Sample count channels, picked by keyframe set flag, in one call. Flags the set doesn't have
+			// read 0. getCurrentValues samples at the current frame and keeps a cursor per keyframe set,
+			// which makes forward playback O(1) per channel; sample is stateless.
+			void getCurrentValues(const unsigned int *flags, float *values, size_t count);
+			void sample(float frame, const unsigned int *flags, float *values, size_t count);
+			float getCurrentFrame();
 			string getName();
 			float getFPS();
+			float getStartTime();
+			float getEndTime();
 	};
 }
\ No newline at end of file
@@ -107,35 +107,59 @@ namespace {
 #include <lzxd.c>
 
 namespace {
+	// Memory streams over a single XCompress block, so independent blocks can be decoded concurrently.
 	struct ReadStream {
-			LibGens::File *file = NULL;
-			int size = 0;
+			const unsigned char *data = NULL;
+			size_t size = 0;
+			int chunk_size = 0;
 	};
 
+	bool readStreamInt16BE(ReadStream *stream, unsigned short *value) {
+		if (stream->size < 2) {
+			return false;
+		}
+
+		*value = (stream->data[0] << 8) | stream->data[1];
+		stream->data += 2;
+		stream->size -= 2;
+		return true;
+	}
+
 	int mspackRead(mspack_file *file, void *buffer, int bytes) {
 		ReadStream *stream = reinterpret_cast<ReadStream *>(file);
 
-		if (stream->size == 0) {
-			unsigned short size;
-			stream->file->readInt16BE(&size);
+		if (stream->chunk_size == 0) {
+			unsigned short size = 0;
+			if (!readStreamInt16BE(stream, &size)) {
+				return 0;
+			}
 
 			if ((size & 0xFF00) == 0xFF00) {
-				stream->file->moveAddress(1);
-				stream->file->readInt16BE(&size);
+				if (stream->size < 1) {
+					return 0;
+				}
+
+				stream->data += 1;
+				stream->size -= 1;
+				if (!readStreamInt16BE(stream, &size)) {
+					return 0;
+				}
 			}
 
-			stream->size = size;
+			stream->chunk_size = size;
 		}
 
-		int size_to_read = min(stream->size, bytes);
-		stream->file->read(buffer, size_to_read);
+		size_t size_to_read = min(min(static_cast<size_t>(stream->chunk_size), static_cast<size_t>(bytes)), stream->size);
+		memcpy(buffer, stream->data, size_to_read);
+		stream->data += size_to_read;
 		stream->size -= size_to_read;
+		stream->chunk_size -= static_cast<int>(size_to_read);
 
-		return size_to_read;
+		return static_cast<int>(size_to_read);
 	}
 
 	struct WriteStream {
-			LibGens::File *file = NULL;
+			unsigned char *data = NULL;
 			size_t size = 0;
 	};
 
@@ -143,7 +167,8 @@ namespace {
 		WriteStream *stream = reinterpret_cast<WriteStream *>(file);
 
 		size_t size_to_write = min(stream->size, static_cast<size_t>(bytes));
-		stream->file->write(buffer, size_to_write);
+		memcpy(stream->data, buffer, size_to_write);
+		stream->data += size_to_write;
 		stream->size -= size_to_write;
 
 		return static_cast<int>(size_to_write);
@@ -188,6 +213,14 @@ namespace {
 				Endian::swap(compressed_block_size);
 			}
 	};
+
+	struct XCompressBlock {
+			size_t src_offset;
+			size_t src_size;
+			size_t dst_offset;
+			size_t dst_size;
+			size_t decompressed_size;
+	};
 }
 
 // PS3 Compression
@@ -223,6 +256,38 @@ namespace {
 	};
 }
 
+namespace {
+	// Returns the whole source file as a contiguous buffer: the mapping itself for memory-backed files,
+	// or a copy read into buffer otherwise. Block tables store absolute offsets into this buffer.
+	const unsigned char *getSourceData(LibGens::File *file, vector<unsigned char> *buffer, size_t *size) {
+		size_t file_size = file->getFileSize();
+		size_t memory_size = 0;
+		const unsigned char *memory = file->getMemoryData(&memory_size);
+
+		if (memory && (memory_size >= file_size)) {
+			*size = file_size;
+			return memory;
+		}
+
+		size_t address = file->getCurrentAddress();
+		buffer->resize(file_size);
+		file->goToAddress(0);
+		*size = file->read(buffer->data(), file_size);
+		file->goToAddress(address);
+		return buffer->data();
+	}
+
+	// Blocks are decoded into slots sized for their full output. Moves a block that came out short to
+	// the end of the blocks before it so the output stays contiguous, and returns the new end.
+	size_t packDecompressedBlock(unsigned char *dst_data, size_t packed_size, size_t block_offset, size_t block_size) {
+		if (block_offset != packed_size) {
+			memmove(dst_data + packed_size, dst_data + block_offset, block_size);
+		}
+
+		return packed_size + block_size;
+	}
+}
+
 namespace LibGens {
 	bool Compression::check(uint32_t signature) {
 		return (signature == COMPRESSION_CAB) || (signature == COMPRESSION_X) || (signature == COMPRESSION_SEGS);
@@ -251,13 +316,10 @@ namespace LibGens {
 			case COMPRESSION_X :
 				{
 					XCompressHeader header;
+					size_t header_address = src_file->getCurrentAddress();
 					src_file->read(&header, sizeof(XCompressHeader));
 					header.endianSwap();
 
-					WriteStream dst_stream;
-					dst_stream.file = dst_file;
-					dst_stream.size = header.uncompressed_size;
-
 					int window_bits = 0;
 					unsigned int window_size = header.window_size;
 					while ((window_size & 0x1) == 0) {
@@ -265,23 +327,75 @@ namespace LibGens {
 						window_size >>= 1;
 					}
 
-					while (src_file->getCurrentAddress() < src_file->getFileSize() && dst_file->getCurrentAddress() < header.uncompressed_size) {
-						unsigned int compressed_size;
-						src_file->readInt32BE(&compressed_size);
-						size_t end_offset = src_file->getCurrentAddress() + compressed_size;
+					vector<unsigned char> src_buffer;
+					size_t src_size = 0;
+					const unsigned char *src_data = getSourceData(src_file, &src_buffer, &src_size);
+
+					// Every block starts a fresh LZX stream, so the block table is enough to place each block's output
+					// up front and decode all of them in parallel.
+					vector<XCompressBlock> blocks;
+					size_t src_offset = header_address + sizeof(XCompressHeader);
+					size_t dst_offset = 0;
+					size_t uncompressed_size = static_cast<size_t>(header.uncompressed_size);
+
+					while ((src_offset + sizeof(unsigned int) <= src_size) && (dst_offset < uncompressed_size)) {
+						const unsigned char *block_size_data = src_data + src_offset;
+						size_t compressed_size = (block_size_data[0] << 24) | (block_size_data[1] << 16) | (block_size_data[2] << 8) | block_size_data[3];
+						src_offset += sizeof(unsigned int);
+
+						XCompressBlock block;
+						block.src_offset = src_offset;
+						block.src_size = min(compressed_size, src_size - src_offset);
+						block.dst_offset = dst_offset;
+						block.dst_size = min(static_cast<size_t>(header.uncompressed_block_size), uncompressed_size - dst_offset);
+						block.decompressed_size = 0;
+						blocks.push_back(block);
+
+						src_offset += block.src_size;
+						dst_offset += block.dst_size;
+					}
+
+					// In-memory destinations are decoded in place, anything else through a buffer.
+					vector<unsigned char> dst_buffer;
+					unsigned char *dst_data = dst_file->reserveMemoryData(dst_offset);
+					bool in_place = (dst_data != NULL);
+					if (!in_place) {
+						dst_buffer.resize(dst_offset);
+						dst_data = dst_buffer.data();
+					}
+
+					Parallel::forEach(blocks.size(), [&](size_t i) {
+						XCompressBlock &block = blocks[i];
 
 						ReadStream src_stream;
-						src_stream.file = src_file;
+						src_stream.data = src_data + block.src_offset;
+						src_stream.size = block.src_size;
 
-						size_t uncompressed_block_size = min(static_cast<size_t>(header.uncompressed_block_size), dst_stream.size);
+						WriteStream dst_stream;
+						dst_stream.data = dst_data + block.dst_offset;
+						dst_stream.size = block.dst_size;
 
 						lzxd_stream *lzx = lzxd_init(&lzx_system, reinterpret_cast<mspack_file *>(&src_stream), reinterpret_cast<mspack_file *>(&dst_stream), window_bits, 0, static_cast<int>(header.compressed_block_size),
-													 static_cast<off_t>(uncompressed_block_size), 0);
+													 static_cast<off_t>(block.dst_size), 0);
+
+						if (lzx) {
+							lzxd_decompress(lzx, block.dst_size);
+							lzxd_free(lzx);
+						}
+
+						block.decompressed_size = block.dst_size - dst_stream.size;
+					});
 
-						lzxd_decompress(lzx, uncompressed_block_size);
-						lzxd_free(lzx);
+					size_t written_size = 0;
+					for (size_t i = 0; i < blocks.size(); i++) {
+						written_size = packDecompressedBlock(dst_data, written_size, blocks[i].dst_offset, blocks[i].decompressed_size);
+					}
 
-						src_file->goToAddress(end_offset);
+					if (in_place) {
+						dst_file->commitMemoryData(written_size);
+					}
+					else if (written_size) {
+						dst_file->write(dst_data, written_size);
 					}
 
 					break;
@@ -293,55 +407,96 @@ namespace LibGens {
 					src_file->read(&header, sizeof(SEGSHeader));
 					header.endianSwap();
 
-					for (int i = 0; i < header.chunk_count; i++) {
-						SEGSChunk chunk;
-						src_file->read(&chunk, sizeof(SEGSChunk));
-						chunk.endianSwap();
+					vector<SEGSChunk> chunks(header.chunk_count);
+					if (header.chunk_count) {
+						src_file->read(chunks.data(), sizeof(SEGSChunk) * header.chunk_count);
+					}
+
+					vector<unsigned char> src_buffer;
+					size_t src_size = 0;
+					const unsigned char *src_data = getSourceData(src_file, &src_buffer, &src_size);
+
+					// Chunks are independent raw deflate streams with known output sizes, so they are inflated
+					// concurrently into their slots and appended in order afterwards.
+					vector<size_t> dst_offsets(header.chunk_count);
+					vector<size_t> decompressed_sizes(header.chunk_count, 0);
+					vector<char> failed(header.chunk_count, 0);
+					size_t dst_size = 0;
+
+					for (size_t i = 0; i < chunks.size(); i++) {
+						chunks[i].endianSwap();
+						dst_offsets[i] = dst_size;
+						dst_size += chunks[i].uncompressed_size ? chunks[i].uncompressed_size : 0x10000;
+					}
 
-						size_t next_chunk_offset = src_file->getCurrentAddress();
-						unsigned int chunk_data_offset = chunk.offset;
+					// In-memory destinations are decoded in place, anything else through a buffer.
+					vector<unsigned char> dst_buffer;
+					unsigned char *dst_data = dst_file->reserveMemoryData(dst_size);
+					bool in_place = (dst_data != NULL);
+					if (!in_place) {
+						dst_buffer.resize(dst_size);
+						dst_data = dst_buffer.data();
+					}
 
-						vector<unsigned char> src_data;
-						src_data.resize(chunk.compressed_size);
+					Parallel::forEach(chunks.size(), [&](size_t i) {
+						const SEGSChunk &chunk = chunks[i];
+						unsigned char *out_data = dst_data + dst_offsets[i];
+						size_t chunk_data_offset = chunk.offset;
 
 						if (chunk.compressed_size == chunk.uncompressed_size) {
-							src_file->goToAddress(chunk_data_offset);
-							src_file->read(src_data.data(), chunk.compressed_size);
-							dst_file->write(src_data.data(), chunk.compressed_size);
-							continue;
-						}
-						else {
-							chunk_data_offset -= 1;
+							size_t size = (chunk_data_offset < src_size) ? min(static_cast<size_t>(chunk.compressed_size), src_size - chunk_data_offset) : 0;
+							memcpy(out_data, src_data + chunk_data_offset, size);
+							decompressed_sizes[i] = size;
+							return;
 						}
 
-						src_file->goToAddress(chunk_data_offset);
-						src_file->read(src_data.data(), chunk.compressed_size);
+						chunk_data_offset -= 1;
+						if (chunk_data_offset >= src_size) {
+							failed[i] = 1;
+							return;
+						}
 
 						unsigned int uncomp_size = chunk.uncompressed_size;
 						if (uncomp_size == 0) {
 							uncomp_size = 0x10000;
 						}
 
-						vector<unsigned char> out_data;
-						out_data.resize(uncomp_size);
-
 						z_stream zs = {0};
 
 						if (inflateInit2(&zs, -MAX_WBITS) != Z_OK) {
-							break;
+							failed[i] = 1;
+							return;
 						}
 
-						zs.next_in = (Bytef *)src_data.data();
-						zs.avail_in = src_data.size();
-						zs.next_out = (Bytef *)out_data.data();
-						zs.avail_out = out_data.size();
+						zs.next_in = (Bytef *)(src_data + chunk_data_offset);
+						zs.avail_in = static_cast<uInt>(min(static_cast<size_t>(chunk.compressed_size), src_size - chunk_data_offset));
+						zs.next_out = (Bytef *)out_data;
+						zs.avail_out = uncomp_size;
 
 						if (inflate(&zs, Z_SYNC_FLUSH) < Z_OK) {
+							failed[i] = 1;
+						}
+						else {
+							decompressed_sizes[i] = zs.total_out;
+						}
+
+						inflateEnd(&zs);
+					});
+
+					size_t written_size = 0;
+					for (size_t i = 0; i < chunks.size(); i++) {
+						if (failed[i]) {
 							break;
 						}
 
-						dst_file->write(out_data.data(), zs.total_out);
-						src_file->goToAddress(next_chunk_offset);
+						written_size = packDecompressedBlock(dst_data, written_size, dst_offsets[i], decompressed_sizes[i]);
+					}
+
+					if (in_place) {
+						dst_file->commitMemoryData(written_size);
+					}
+					else if (written_size) {
+						dst_file->write(dst_data, written_size);
 					}
 
 					break;
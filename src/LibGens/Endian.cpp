@@ -19,12 +19,16 @@
 
 #include "Endian.h"
 
+#ifdef LIBGENS_ENDIAN_SSE2
+#include <emmintrin.h>
+#endif
+
 void Endian::swap(unsigned long long& x) {
-	x = _byteswap_uint64(x);
+	x = LIBGENS_ENDIAN_SWAP_64(x);
 }
 
 void Endian::swap(unsigned int& x) {
-	x = _byteswap_ulong(x);
+	x = LIBGENS_ENDIAN_SWAP_32(x);
 }
 
 void Endian::swap(int& x) {
@@ -32,5 +36,45 @@ void Endian::swap(int& x) {
 }
 
 void Endian::swap(unsigned short& x) {
-	x = _byteswap_ushort(x);
+	x = LIBGENS_ENDIAN_SWAP_16(x);
+}
+
+void Endian::swapArray(unsigned short *dest, const void *source, size_t count) {
+	const unsigned char *source_bytes = reinterpret_cast<const unsigned char *>(source);
+	size_t i = 0;
+
+#ifdef LIBGENS_ENDIAN_SSE2
+	for (; i + 8 <= count; i += 8) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source_bytes + i * 2));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i), v);
+	}
+#endif
+
+	for (; i < count; i++) {
+		unsigned short v = 0;
+		memcpy(&v, source_bytes + i * 2, 2);
+		dest[i] = LIBGENS_ENDIAN_SWAP_16(v);
+	}
+}
+
+void Endian::swapArray(unsigned int *dest, const void *source, size_t count) {
+	const unsigned char *source_bytes = reinterpret_cast<const unsigned char *>(source);
+	size_t i = 0;
+
+#ifdef LIBGENS_ENDIAN_SSE2
+	// SSE2 has no byte shuffle, so swap the 16-bit halves of every word first and then the bytes inside each half.
+	for (; i + 4 <= count; i += 4) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source_bytes + i * 4));
+		v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i), v);
+	}
+#endif
+
+	for (; i < count; i++) {
+		unsigned int v = 0;
+		memcpy(&v, source_bytes + i * 4, 4);
+		dest[i] = LIBGENS_ENDIAN_SWAP_32(v);
+	}
 }
\ No newline at end of file
@@ -19,10 +19,29 @@
 
 #pragma once
 
+#ifdef _MSC_VER
+#include <stdlib.h>
+#define LIBGENS_ENDIAN_SWAP_16(x)    _byteswap_ushort(x)
+#define LIBGENS_ENDIAN_SWAP_32(x)    _byteswap_ulong(x)
+#define LIBGENS_ENDIAN_SWAP_64(x)    _byteswap_uint64(x)
+#else
+#define LIBGENS_ENDIAN_SWAP_16(x)    __builtin_bswap16(x)
+#define LIBGENS_ENDIAN_SWAP_32(x)    __builtin_bswap32(x)
+#define LIBGENS_ENDIAN_SWAP_64(x)    __builtin_bswap64(x)
+#endif
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define LIBGENS_ENDIAN_SSE2
+#endif
+
 class Endian {
 public:
 	static void swap(unsigned long long& x);
 	static void swap(unsigned int& x);
 	static void swap(int& x);
 	static void swap(unsigned short& x);
+
+	// Byte swap count elements from an unaligned source buffer into dest. Source and dest may be the same buffer.
+	static void swapArray(unsigned short *dest, const void *source, size_t count);
+	static void swapArray(unsigned int *dest, const void *source, size_t count);
 };
\ No newline at end of file
@@ -22,6 +22,9 @@
 namespace LibGens {
 	bool Error::FileLogging=false;
 
+	// Workers of Parallel::forEach can report errors at the same time
+	static mutex error_log_mutex;
+
 	int Error::initialize() {
 		FILE *fp=fopen(LIBGENS_ERROR_H_FILE_LOG, "wt");
 		
@@ -65,6 +68,7 @@ namespace LibGens {
 
 	void Error::addMessage(Code error_code_p, string description_p) {
 		if (FileLogging) {
+			lock_guard<mutex> lock(error_log_mutex);
 			FILE *fp=fopen(LIBGENS_ERROR_H_FILE_LOG, "at");
 			if (fp) {
 				fprintf(fp, "%s - %s\n", ErrorCodeID(error_code_p).c_str(), description_p.c_str());
@@ -32,6 +32,14 @@ namespace LibGens {
 		virtual bool eof() = 0;
 		virtual void close() = 0;
 		virtual vector<unsigned char> detach() { return {}; }
+
+		// Contiguous view of the whole file for implementations that keep it in memory, NULL otherwise.
+		virtual const unsigned char* getMemoryData(size_t* size) { *size = 0; return NULL; }
+
+		// Writable room for size bytes at the current position of in-memory files, NULL otherwise.
+		// commitMemoryData keeps the first size bytes of the reserved room and moves past them.
+		virtual unsigned char* reserveMemoryData(size_t size) { return NULL; }
+		virtual void commitMemoryData(size_t size) {}
 	};
 
 	class DiskFile : public FileImpl {
@@ -148,8 +156,14 @@ namespace LibGens {
 
 		void close() override {
 		}
+
+		const unsigned char* getMemoryData(size_t* size) override {
+			*size = data_size;
+			return reinterpret_cast<const unsigned char*>(data);
+		}
 	};
 
+#ifdef _WIN32
 	class ReadOnlyMemoryMappedFile : public ReadOnlyMemoryFile {
 	private:
 		HANDLE file_handle;
@@ -204,14 +218,71 @@ namespace LibGens {
 			}
 		}
 	};
+#else
+	class ReadOnlyMemoryMappedFile : public ReadOnlyMemoryFile {
+	private:
+		int file_descriptor;
+
+	public:
+		ReadOnlyMemoryMappedFile(const char* filename)
+			: ReadOnlyMemoryFile(nullptr, 0), file_descriptor(-1) {
+
+			file_descriptor = open(filename, O_RDONLY);
+			if (file_descriptor < 0) {
+				return;
+			}
+
+			struct stat file_stat;
+			if ((fstat(file_descriptor, &file_stat) != 0) || (file_stat.st_size <= 0)) {
+				::close(file_descriptor);
+				file_descriptor = -1;
+				return;
+			}
+
+			void* mapped_data = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+			if (mapped_data == MAP_FAILED) {
+				::close(file_descriptor);
+				file_descriptor = -1;
+				return;
+			}
+
+			// Most formats are parsed front to back with short backwards jumps, so ask the kernel
+			// for aggressive read-ahead and start paging the file in right away.
+			madvise(mapped_data, static_cast<size_t>(file_stat.st_size), MADV_SEQUENTIAL);
+			madvise(mapped_data, static_cast<size_t>(file_stat.st_size), MADV_WILLNEED);
+
+			data = mapped_data;
+			data_size = static_cast<size_t>(file_stat.st_size);
+			data_offset = 0;
+		}
+
+		~ReadOnlyMemoryMappedFile() override {
+			close();
+		}
+
+		void close() override {
+			if (data) {
+				munmap(const_cast<void*>(data), data_size);
+				data = nullptr;
+				data_size = 0;
+				data_offset = 0;
+			}
+			if (file_descriptor >= 0) {
+				::close(file_descriptor);
+				file_descriptor = -1;
+			}
+		}
+	};
+#endif
 
 	class MemoryFile : public FileImpl {
 	public:
 		vector<unsigned char> data;
 		size_t data_offset;
+		size_t reserved_data_base;
 
 		MemoryFile()
-			: data_offset(0) {
+			: data_offset(0), reserved_data_base(0) {
 		}
 
 		~MemoryFile() override {
@@ -291,6 +362,25 @@ namespace LibGens {
 		vector<unsigned char> detach() override {
 			return move(data);
 		}
+
+		const unsigned char* getMemoryData(size_t* size) override {
+			*size = data.size();
+			return data.data();
+		}
+
+		unsigned char* reserveMemoryData(size_t size) override {
+			reserved_data_base = data.size();
+			if (data.size() < (data_offset + size)) {
+				data.resize(data_offset + size);
+			}
+
+			return data.data() + data_offset;
+		}
+
+		void commitMemoryData(size_t size) override {
+			data_offset += size;
+			data.resize(max(reserved_data_base, data_offset));
+		}
 	};
 
 	class MemoryFileFlushToDiskOnClose : public MemoryFile {
@@ -466,14 +556,15 @@ namespace LibGens {
 			file_impl->seek(4, SEEK_CUR);
 		}
 
-		file_impl->read(dest, sizeof(size_t));
+		unsigned int address=0;
+		file_impl->read(&address, sizeof(int));
 
 		if (relative_address_mode) {
-			*dest += getCurrentAddress() - 4;
+			*dest = address + getCurrentAddress() - 4;
 		}
 		else {
-			Endian::swap(*dest);
-			*dest += root_node_address;
+			Endian::swap(address);
+			*dest = address + root_node_address;
 		}
 
 		address_read_count++;
@@ -486,25 +577,6 @@ namespace LibGens {
 		*dest = v / 256.0f;
 	}
 
-	// from meshoptimizer
-	union FloatBits {
-		float f;
-		unsigned int ui;
-	};
-
-	float dequantizeHalf(unsigned short h) {
-		unsigned int s = unsigned(h & 0x8000) << 16;
-		int em = h & 0x7fff;
-
-		int r = (em + (112 << 10)) << 13;
-		r = (em < (1 << 10)) ? 0 : r;
-		r += (em >= (31 << 10)) ? (112 << 23) : 0;
-
-		FloatBits u;
-		u.ui = s | r;
-		return u.f;
-	}
-
 	void File::readFloat16(float *dest) {
 		if (!readSafeCheck(dest)) return;
 		
@@ -539,6 +611,24 @@ namespace LibGens {
 
 	void File::readString(string *dest) {
 		if (!readSafeCheck(dest)) return;
+
+		size_t memory_size=0;
+		const unsigned char *memory=file_impl->getMemoryData(&memory_size);
+		if (memory) {
+			size_t offset=file_impl->tell();
+			if (offset >= memory_size) {
+				*dest = "";
+				return;
+			}
+
+			const unsigned char *start=memory+offset;
+			const unsigned char *end=(const unsigned char *) memchr(start, 0, memory_size-offset);
+			size_t length=(end ? end : memory+memory_size) - start;
+			dest->assign((const char *) start, length);
+			file_impl->seek(offset + length + (end ? 1 : 0), SEEK_SET);
+			return;
+		}
+
 		char c=1;
 		*dest = "";
 		while (c && !endOfFile()) {
@@ -547,6 +637,55 @@ namespace LibGens {
 		}
 	}
 
+	const unsigned char *File::getMemoryData(size_t *size) {
+		*size = 0;
+		if (!file_impl) return NULL;
+
+		size_t memory_size=0;
+		const unsigned char *memory=file_impl->getMemoryData(&memory_size);
+		if (!memory || (global_offset > memory_size)) return NULL;
+
+		*size = memory_size - global_offset;
+		return memory + global_offset;
+	}
+
+	unsigned char *File::reserveMemoryData(size_t size) {
+		if (!file_impl) return NULL;
+		return file_impl->reserveMemoryData(size);
+	}
+
+	void File::commitMemoryData(size_t size) {
+		if (!file_impl) return;
+		file_impl->commitMemoryData(size);
+	}
+
+	bool File::prepareReader(FileReader *reader, size_t address, size_t size) {
+		if (!readSafeCheck(reader)) return false;
+
+		reader->root_node_address = root_node_address;
+		reader->relative_address_mode = relative_address_mode;
+		reader->address_64_bit_mode = address_64_bit_mode;
+
+		size_t memory_size=0;
+		const unsigned char *memory=file_impl->getMemoryData(&memory_size);
+		if (memory) {
+			size_t offset=address+global_offset;
+			if (offset > memory_size) offset = memory_size;
+			if (size > (memory_size - offset)) size = memory_size - offset;
+
+			reader->setData(memory + offset, size, address);
+		}
+		else {
+			reader->buffer.resize(size);
+			goToAddress(address);
+			size = file_impl->read(reader->buffer.data(), size);
+			reader->setData(reader->buffer.data(), size, address);
+		}
+
+		goToAddress(address + size);
+		return true;
+	}
+
 	bool File::readLine(string *dest) {
 		char string_buffer[LIBGENS_FILE_STRING_BUFFER];
 		if (file_impl->gets(string_buffer, LIBGENS_FILE_STRING_BUFFER)) {
@@ -683,22 +822,6 @@ namespace LibGens {
 		file_impl->write(&target, sizeof(int));
 	}
 
-	// from meshoptimizer
-	unsigned short quantizeHalf(float v) {
-		FloatBits u = { v };
-		unsigned int ui = u.ui;
-
-		int s = (ui >> 16) & 0x8000;
-		int em = ui & 0x7fffffff;
-
-		int h = (em - (112 << 23) + (1 << 12)) >> 13;
-		h = (em < (113 << 23)) ? 0 : h;
-		h = (em >= (143 << 23)) ? 0x7c00 : h;
-		h = (em > (255 << 23)) ? 0x7e00 : h;
-
-		return (unsigned short)(s | h);
-	}
-
 	void File::writeFloat8(float *dest) {
 		if (!readSafeCheck(dest)) return;
 		unsigned char v = (int)((*dest) * 256.0f);
@@ -855,7 +978,8 @@ namespace LibGens {
 
 		if (root_node_type != LIBGENS_FILE_HEADER_ROOT_TYPE_LOST_WORLD) writeInt32BE(&final_table_size);
 		for (list<size_t>::iterator it=final_address_table.begin(); it!=final_address_table.end(); it++) {
-			writeInt32BE(&(*it));
+			unsigned int address=*it;
+			writeInt32BE(&address);
 		}
 
 		if (!no_extra_foot) writeNull(4);
@@ -960,24 +1084,7 @@ namespace LibGens {
 	}
 
 	void File::sortAddressTable() {
-		list<size_t> new_address_table;
-
-		for (list<size_t>::iterator it=final_address_table.begin(); it!=final_address_table.end(); it++) {
-			bool found=false;
-
-			for (list<size_t>::iterator it2=new_address_table.begin(); it2!=new_address_table.end(); it2++) {
-				if ((*it) <= (*it2)) {
-					new_address_table.insert(it2, (*it));
-					found = true;
-					break;
-				}
-			}
-
-			if (!found) new_address_table.push_back(*it);
-		}
-
-
-		final_address_table = new_address_table;
+		final_address_table.sort();
 	}
 
 	void File::createComparison(size_t sz) {
@@ -50,6 +50,7 @@
 
 namespace LibGens {
 	class FileImpl;
+	class FileReader;
 
 	class File {
 		protected:
@@ -118,6 +119,19 @@ namespace LibGens {
 			void readFloat16E(float *dest, bool big_endian);
 			void readFloat32E(float *dest, bool big_endian);
 			bool readLine(string *dest);
+
+			// Prepares a FileReader over [address, address+size). Memory mapped and in-memory files are read
+			// in place, disk files get the range buffered into the reader. Leaves the file after the range.
+			bool prepareReader(FileReader *reader, size_t address, size_t size);
+
+			// In-place data of memory mapped and in-memory files from the global offset on, NULL for disk files.
+			const unsigned char *getMemoryData(size_t *size);
+
+			// Lets in-memory files be written in place: reserveMemoryData returns room for size bytes at the
+			// current address, or NULL for other files, and commitMemoryData keeps the first size bytes of it.
+			unsigned char *reserveMemoryData(size_t size);
+			void commitMemoryData(size_t size);
+
 			size_t write(void *dest, size_t sz);
 			void writeString(const char *dest);
 			void writeString(string *dest);
@@ -0,0 +1,70 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+
+#include "FileReader.h"
+
+namespace LibGens {
+	void FileReader::readString(string *dest) {
+		if (data_offset >= data_size) {
+			dest->clear();
+			return;
+		}
+
+		const unsigned char *start = data + data_offset;
+		size_t available = data_size - data_offset;
+		const unsigned char *end = reinterpret_cast<const unsigned char *>(memchr(start, 0, available));
+
+		if (end) {
+			dest->assign(reinterpret_cast<const char *>(start), end - start);
+			data_offset += (end - start) + 1;
+		}
+		else {
+			dest->assign(reinterpret_cast<const char *>(start), available);
+			data_offset = data_size;
+		}
+	}
+
+	void FileReader::readInt16BEArray(unsigned short *dest, size_t count) {
+		if (count > (getRemaining() / sizeof(unsigned short))) {
+			Error::addMessage(Error::WARNING, LIBGENS_FILE_READER_ERROR_OVERFLOW);
+			count = getRemaining() / sizeof(unsigned short);
+			overflow = true;
+		}
+
+		Endian::swapArray(dest, data + data_offset, count);
+		data_offset += count * sizeof(unsigned short);
+	}
+
+	void FileReader::readInt32BEArray(unsigned int *dest, size_t count) {
+		if (count > (getRemaining() / sizeof(unsigned int))) {
+			Error::addMessage(Error::WARNING, LIBGENS_FILE_READER_ERROR_OVERFLOW);
+			count = getRemaining() / sizeof(unsigned int);
+			overflow = true;
+		}
+
+		Endian::swapArray(dest, data + data_offset, count);
+		data_offset += count * sizeof(unsigned int);
+	}
+
+	void FileReader::readFloat32BEArray(float *dest, size_t count) {
+		static_assert(sizeof(float) == sizeof(unsigned int), "Float and integer sizes don't match");
+		readInt32BEArray(reinterpret_cast<unsigned int *>(dest), count);
+	}
+};
@@ -0,0 +1,275 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+
+#pragma once
+
+#define LIBGENS_FILE_READER_ERROR_OVERFLOW    "Attempted to read past the end of a file reader range."
+
+namespace LibGens {
+	// from meshoptimizer
+	union FloatBits {
+		float f;
+		unsigned int ui;
+	};
+
+	inline float dequantizeHalf(unsigned short h) {
+		unsigned int s = unsigned(h & 0x8000) << 16;
+		int em = h & 0x7fff;
+
+		int r = (em + (112 << 10)) << 13;
+		r = (em < (1 << 10)) ? 0 : r;
+		r += (em >= (31 << 10)) ? (112 << 23) : 0;
+
+		FloatBits u;
+		u.ui = s | r;
+		return u.f;
+	}
+
+	inline unsigned short quantizeHalf(float v) {
+		FloatBits u = { v };
+		unsigned int ui = u.ui;
+
+		int s = (ui >> 16) & 0x8000;
+		int em = ui & 0x7fffffff;
+
+		int h = (em - (112 << 23) + (1 << 12)) >> 13;
+		h = (em < (113 << 23)) ? 0 : h;
+		h = (em >= (143 << 23)) ? 0x7c00 : h;
+		h = (em > (255 << 23)) ? 0x7e00 : h;
+
+		return (unsigned short)(s | h);
+	}
+
+	// Bounds-checked read cursor over a contiguous range of a file. File::prepareReader points it straight
+	// at the memory mapped or in-memory data when it can, so the typed readers below inline down to a load
+	// and a byte swap instead of a virtual FileImpl call per scalar. Addresses use the same coordinates
+	// as File::goToAddress, so parsers can mix both freely.
+	//
+	// Reading past the end of the range doesn't touch the destination and flags the reader as overflowed.
+	class FileReader {
+		friend class File;
+
+		protected:
+			const unsigned char *data;
+			size_t data_size;
+			size_t data_offset;
+			size_t base_address;
+			size_t root_node_address;
+			bool relative_address_mode;
+			bool address_64_bit_mode;
+			bool overflow;
+			vector<unsigned char> buffer;
+
+			inline const unsigned char *advance(size_t sz) {
+				if (sz > (data_size - data_offset)) {
+					data_offset = data_size;
+					overflow = true;
+					return NULL;
+				}
+
+				const unsigned char *pointer = data + data_offset;
+				data_offset += sz;
+				return pointer;
+			}
+
+			void setData(const unsigned char *data_p, size_t data_size_p, size_t base_address_p) {
+				data = data_p;
+				data_size = data_size_p;
+				data_offset = 0;
+				base_address = base_address_p;
+				overflow = false;
+			}
+		public:
+			FileReader() : data(NULL), data_size(0), data_offset(0), base_address(0), root_node_address(0), relative_address_mode(false), address_64_bit_mode(false), overflow(false) {
+			}
+
+			FileReader(const void *data_p, size_t data_size_p, size_t base_address_p=0) : root_node_address(0), relative_address_mode(false), address_64_bit_mode(false) {
+				setData(reinterpret_cast<const unsigned char *>(data_p), data_size_p, base_address_p);
+			}
+
+			FileReader(const FileReader &) = delete;
+			FileReader &operator=(const FileReader &) = delete;
+
+			inline bool valid() const {
+				return (data != NULL) && !overflow;
+			}
+
+			inline bool hasOverflowed() const {
+				return overflow;
+			}
+
+			inline const unsigned char *getData() const {
+				return data;
+			}
+
+			inline const unsigned char *getCurrentData() const {
+				return data + data_offset;
+			}
+
+			inline size_t getSize() const {
+				return data_size;
+			}
+
+			inline size_t getCurrentAddress() const {
+				return base_address + data_offset;
+			}
+
+			inline size_t getRemaining() const {
+				return data_size - data_offset;
+			}
+
+			inline void goToAddress(size_t address) {
+				if ((address < base_address) || ((address - base_address) > data_size)) {
+					data_offset = data_size;
+					overflow = true;
+					return;
+				}
+
+				data_offset = address - base_address;
+			}
+
+			inline void moveAddress(size_t offset) {
+				if (offset > (data_size - data_offset)) {
+					data_offset = data_size;
+					overflow = true;
+					return;
+				}
+
+				data_offset += offset;
+			}
+
+			inline void fixPaddingRead(size_t multiple=4) {
+				size_t extra = getCurrentAddress() % multiple;
+				if (extra) moveAddress(multiple - extra);
+			}
+
+			inline size_t read(void *dest, size_t sz) {
+				const unsigned char *source = advance(sz);
+				if (!source) return 0;
+				memcpy(dest, source, sz);
+				return sz;
+			}
+
+			inline void readUChar(unsigned char *dest) {
+				const unsigned char *source = advance(1);
+				if (source) *dest = *source;
+			}
+
+			inline void readInt16(unsigned short *dest) {
+				const unsigned char *source = advance(2);
+				if (source) memcpy(dest, source, 2);
+			}
+
+			inline void readInt16BE(unsigned short *dest) {
+				const unsigned char *source = advance(2);
+				if (!source) return;
+
+				unsigned short v;
+				memcpy(&v, source, 2);
+				*dest = LIBGENS_ENDIAN_SWAP_16(v);
+			}
+
+			inline void readInt32(unsigned int *dest) {
+				const unsigned char *source = advance(4);
+				if (source) memcpy(dest, source, 4);
+			}
+
+			inline void readInt32BE(unsigned int *dest) {
+				const unsigned char *source = advance(4);
+				if (!source) return;
+
+				unsigned int v;
+				memcpy(&v, source, 4);
+				*dest = LIBGENS_ENDIAN_SWAP_32(v);
+			}
+
+			inline void readInt32BE(int *dest) {
+				readInt32BE(reinterpret_cast<unsigned int *>(dest));
+			}
+
+			inline void readFloat32(float *dest) {
+				const unsigned char *source = advance(4);
+				if (source) memcpy(dest, source, 4);
+			}
+
+			inline void readFloat32BE(float *dest) {
+				const unsigned char *source = advance(4);
+				if (!source) return;
+
+				FloatBits v;
+				memcpy(&v.ui, source, 4);
+				v.ui = LIBGENS_ENDIAN_SWAP_32(v.ui);
+				*dest = v.f;
+			}
+
+			inline void readFloat32E(float *dest, bool big_endian) {
+				if (big_endian) readFloat32BE(dest);
+				else readFloat32(dest);
+			}
+
+			inline void readFloat16(float *dest) {
+				unsigned short v = 0;
+				readInt16(&v);
+				*dest = dequantizeHalf(v);
+			}
+
+			inline void readFloat16BE(float *dest) {
+				unsigned short v = 0;
+				readInt16BE(&v);
+				*dest = dequantizeHalf(v);
+			}
+
+			inline void readFloat16E(float *dest, bool big_endian) {
+				if (big_endian) readFloat16BE(dest);
+				else readFloat16(dest);
+			}
+
+			inline void readInt32E(unsigned int *dest, bool big_endian) {
+				if (big_endian) readInt32BE(dest);
+				else readInt32(dest);
+			}
+
+			// Mirrors File::readInt32BEA, including the 64-bit and relative address modes of the file the reader was prepared from.
+			inline void readInt32BEA(size_t *dest) {
+				if (address_64_bit_mode) {
+					fixPaddingRead(8);
+					moveAddress(4);
+				}
+
+				const unsigned char *source = advance(4);
+				if (!source) return;
+
+				unsigned int v;
+				memcpy(&v, source, 4);
+
+				if (relative_address_mode) {
+					*dest = v + getCurrentAddress() - 4;
+				}
+				else {
+					*dest = LIBGENS_ENDIAN_SWAP_32(v) + root_node_address;
+				}
+			}
+
+			void readString(string *dest);
+			void readInt16BEArray(unsigned short *dest, size_t count);
+			void readInt32BEArray(unsigned int *dest, size_t count);
+			void readFloat32BEArray(float *dest, size_t count);
+	};
+};
@@ -0,0 +1,637 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "GIAtlas.h"
+#include "GITextureGroup.h"
+#include "AR.h"
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(__SSE2__)
+#define LIBGENS_GI_ATLAS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace LibGens {
+	// Separable resampling weights: output pixel i reads weights[offsets[i]..offsets[i+1]) from indices.
+	struct GIAtlasFilter {
+		vector<unsigned int> offsets;
+		vector<unsigned int> indices;
+		vector<float> weights;
+
+		void build(unsigned int source_size, unsigned int target_size) {
+			offsets.resize(target_size + 1);
+			indices.clear();
+			weights.clear();
+
+			float scale = (float) source_size / (float) target_size;
+			for (unsigned int i=0; i<target_size; i++) {
+				offsets[i] = indices.size();
+
+				if (scale > 1.0f) {
+					// Area average over the source pixels covered by the target pixel.
+					float start = i * scale;
+					float end = min(start + scale, (float) source_size);
+					unsigned int first = (unsigned int) start;
+					for (unsigned int j=first; (j < source_size) && ((float) j < end); j++) {
+						float overlap = min(end, (float) (j+1)) - max(start, (float) j);
+						if (overlap <= 0.0f) continue;
+						indices.push_back(j);
+						weights.push_back(overlap / scale);
+					}
+				}
+				else {
+					float center = (i + 0.5f) * scale - 0.5f;
+					if (center < 0.0f) center = 0.0f;
+					unsigned int first = min((unsigned int) center, source_size - 1);
+					unsigned int second = min(first + 1, source_size - 1);
+					float fraction = center - first;
+					indices.push_back(first);
+					weights.push_back(1.0f - fraction);
+					indices.push_back(second);
+					weights.push_back(fraction);
+				}
+			}
+
+			offsets[target_size] = indices.size();
+		}
+	};
+
+
+	GIAtlasImage::GIAtlasImage() {
+		width = height = 0;
+	}
+
+	GIAtlasImage::GIAtlasImage(unsigned int width_p, unsigned int height_p) {
+		width = height = 0;
+		create(width_p, height_p);
+	}
+
+	void GIAtlasImage::create(unsigned int width_p, unsigned int height_p) {
+		width = width_p;
+		height = height_p;
+		pixels.assign((size_t) width * height * 4, 0);
+	}
+
+	void GIAtlasImage::clear() {
+		width = height = 0;
+		vector<unsigned char>().swap(pixels);
+	}
+
+	void GIAtlasImage::swap(GIAtlasImage *image) {
+		std::swap(width, image->width);
+		std::swap(height, image->height);
+		pixels.swap(image->pixels);
+	}
+
+	bool GIAtlasImage::readDDS(const unsigned char *data, size_t size) {
+		clear();
+		return TextureCompression::readDDS(data, size, &width, &height, &pixels);
+	}
+
+	void GIAtlasImage::writeDDS(vector<unsigned char> *data, TextureCompressionFormat format, TextureCompressionQuality quality, bool mipmaps) {
+		TextureCompression::writeDDS(pixels.data(), width, height, format, quality, mipmaps, data);
+	}
+
+	void GIAtlasImage::fill(unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+		unsigned int value = r | (g << 8) | (b << 16) | ((unsigned int) a << 24);
+		unsigned int *target = (unsigned int *) pixels.data();
+		size_t count = (size_t) width * height;
+		for (size_t i=0; i<count; i++) target[i] = value;
+	}
+
+	void GIAtlasImage::fillColor(unsigned char r, unsigned char g, unsigned char b) {
+		unsigned int value = r | (g << 8) | (b << 16);
+		unsigned int *target = (unsigned int *) pixels.data();
+		size_t count = (size_t) width * height;
+		for (size_t i=0; i<count; i++) target[i] = (target[i] & 0xFF000000) | value;
+	}
+
+	void GIAtlasImage::fillAlpha(unsigned char a) {
+		unsigned int value = (unsigned int) a << 24;
+		unsigned int *target = (unsigned int *) pixels.data();
+		size_t count = (size_t) width * height;
+		for (size_t i=0; i<count; i++) target[i] = (target[i] & 0x00FFFFFF) | value;
+	}
+
+	void GIAtlasImage::copy(GIAtlasImage *source, unsigned int source_x, unsigned int source_y, unsigned int w, unsigned int h, unsigned int x, unsigned int y) {
+		if (!source || (source_x >= source->width) || (source_y >= source->height) || (x >= width) || (y >= height)) {
+			return;
+		}
+
+		w = min(w, min(source->width - source_x, width - x));
+		h = min(h, min(source->height - source_y, height - y));
+		for (unsigned int row=0; row<h; row++) {
+			memcpy(getRow(y + row) + x*4, source->getRow(source_y + row) + source_x*4, w * 4);
+		}
+	}
+
+	void GIAtlasImage::mergeLightmap(GIAtlasImage *lightmap) {
+		if (!lightmap || (lightmap->width != width) || (lightmap->height != height)) {
+			return;
+		}
+
+		unsigned int *target = (unsigned int *) pixels.data();
+		const unsigned int *source = (const unsigned int *) lightmap->pixels.data();
+		size_t count = (size_t) width * height;
+		size_t i = 0;
+
+#ifdef LIBGENS_GI_ATLAS_SSE2
+		const __m128i alpha_mask = _mm_set1_epi32((int) 0xFF000000);
+		for (; i + 4 <= count; i += 4) {
+			__m128i t = _mm_loadu_si128((const __m128i *) (target + i));
+			__m128i s = _mm_loadu_si128((const __m128i *) (source + i));
+			_mm_storeu_si128((__m128i *) (target + i), _mm_or_si128(_mm_and_si128(t, alpha_mask), _mm_andnot_si128(alpha_mask, s)));
+		}
+#endif
+
+		for (; i < count; i++) {
+			target[i] = (target[i] & 0xFF000000) | (source[i] & 0x00FFFFFF);
+		}
+	}
+
+	void GIAtlasImage::mergeShadowmap(GIAtlasImage *shadowmap, bool inverted) {
+		if (!shadowmap || (shadowmap->width != width) || (shadowmap->height != height)) {
+			return;
+		}
+
+		unsigned int *target = (unsigned int *) pixels.data();
+		const unsigned int *source = (const unsigned int *) shadowmap->pixels.data();
+		unsigned int invert = inverted ? 0xFF : 0x00;
+		size_t count = (size_t) width * height;
+		size_t i = 0;
+
+#ifdef LIBGENS_GI_ATLAS_SSE2
+		// (r + g + b) / 3 as (sum * 43691) >> 17, exact for any sum of three bytes.
+		const __m128i byte_mask = _mm_set1_epi32(0xFF);
+		const __m128i color_mask = _mm_set1_epi32(0x00FFFFFF);
+		const __m128i third = _mm_set1_epi32(43691);
+		const __m128i invert_mask = _mm_set1_epi32(invert);
+		for (; i + 4 <= count; i += 4) {
+			__m128i s = _mm_loadu_si128((const __m128i *) (source + i));
+			__m128i sum = _mm_add_epi32(_mm_add_epi32(_mm_and_si128(s, byte_mask), _mm_and_si128(_mm_srli_epi32(s, 8), byte_mask)), _mm_and_si128(_mm_srli_epi32(s, 16), byte_mask));
+			__m128i alpha = _mm_srli_epi32(_mm_mulhi_epu16(sum, third), 1);
+			alpha = _mm_xor_si128(alpha, invert_mask);
+
+			__m128i t = _mm_loadu_si128((const __m128i *) (target + i));
+			_mm_storeu_si128((__m128i *) (target + i), _mm_or_si128(_mm_and_si128(t, color_mask), _mm_slli_epi32(alpha, 24)));
+		}
+#endif
+
+		for (; i < count; i++) {
+			unsigned int s = source[i];
+			unsigned int alpha = (((s & 0xFF) + ((s >> 8) & 0xFF) + ((s >> 16) & 0xFF)) / 3) ^ invert;
+			target[i] = (target[i] & 0x00FFFFFF) | (alpha << 24);
+		}
+	}
+
+	void GIAtlasImage::resize(GIAtlasImage *target, unsigned int target_width, unsigned int target_height) {
+		if (!target) {
+			return;
+		}
+
+		if (empty() || !target_width || !target_height) {
+			target->clear();
+			return;
+		}
+
+		GIAtlasFilter filter_x;
+		GIAtlasFilter filter_y;
+		filter_x.build(width, target_width);
+		filter_y.build(height, target_height);
+
+		// Horizontal pass into a float buffer, then vertical pass into the target.
+		vector<float> horizontal((size_t) target_width * height * 4);
+		for (unsigned int y=0; y<height; y++) {
+			const unsigned char *row = getRow(y);
+			float *target_row = horizontal.data() + (size_t) y * target_width * 4;
+			for (unsigned int x=0; x<target_width; x++) {
+				float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+				for (unsigned int k=filter_x.offsets[x]; k<filter_x.offsets[x+1]; k++) {
+					const unsigned char *pixel = row + filter_x.indices[k] * 4;
+					float weight = filter_x.weights[k];
+					for (size_t c=0; c<4; c++) sum[c] += pixel[c] * weight;
+				}
+
+				memcpy(target_row + x*4, sum, sizeof(sum));
+			}
+		}
+
+		target->create(target_width, target_height);
+		for (unsigned int y=0; y<target_height; y++) {
+			unsigned char *target_row = target->getRow(y);
+			for (unsigned int x=0; x<target_width; x++) {
+				float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+				for (unsigned int k=filter_y.offsets[y]; k<filter_y.offsets[y+1]; k++) {
+					const float *pixel = horizontal.data() + ((size_t) filter_y.indices[k] * target_width + x) * 4;
+					float weight = filter_y.weights[k];
+					for (size_t c=0; c<4; c++) sum[c] += pixel[c] * weight;
+				}
+
+				for (size_t c=0; c<4; c++) {
+					target_row[x*4 + c] = (unsigned char) min(max(sum[c] + 0.5f, 0.0f), 255.0f);
+				}
+			}
+		}
+	}
+
+	unsigned int GIAtlasImage::getWidth() {
+		return width;
+	}
+
+	unsigned int GIAtlasImage::getHeight() {
+		return height;
+	}
+
+	unsigned char *GIAtlasImage::getData() {
+		return pixels.data();
+	}
+
+	unsigned char *GIAtlasImage::getRow(unsigned int y) {
+		return pixels.data() + (size_t) y * width * 4;
+	}
+
+	bool GIAtlasImage::empty() {
+		return !width || !height;
+	}
+
+
+	static string giAtlasStripQualityLevel(string name, unsigned int quality_level) {
+		string level = LIBGENS_GI_TEXTURE_GROUP_SUBTEXTURE_LEVEL + ToString(quality_level);
+		size_t position = 0;
+		while ((position = name.find(level)) != string::npos) {
+			name.erase(position, level.size());
+		}
+		return name;
+	}
+
+	GIAtlasPipeline::GIAtlasPipeline() {
+		group = NULL;
+		inverted_shadowmaps = false;
+		scale_to_lightmap = false;
+		scale_to_shadowmap = false;
+		override_lightmap = false;
+		override_shadowmap = false;
+		override_lightmap_color[0] = override_lightmap_color[1] = override_lightmap_color[2] = 0;
+		override_shadowmap_alpha = 0;
+		max_subtexture_size = 0;
+		compression_format = TEXTURE_COMPRESSION_BC3;
+		compression_quality = TEXTURE_COMPRESSION_NORMAL;
+	}
+
+	GIAtlasPipeline::~GIAtlasPipeline() {
+		clear();
+	}
+
+	void GIAtlasPipeline::setInvertedShadowmaps(bool v) {
+		inverted_shadowmaps = v;
+	}
+
+	void GIAtlasPipeline::setScaleToLightmap(bool v) {
+		scale_to_lightmap = v;
+	}
+
+	void GIAtlasPipeline::setScaleToShadowmap(bool v) {
+		scale_to_shadowmap = v;
+	}
+
+	void GIAtlasPipeline::setLightmapOverride(bool enabled, unsigned char r, unsigned char g, unsigned char b) {
+		override_lightmap = enabled;
+		override_lightmap_color[0] = r;
+		override_lightmap_color[1] = g;
+		override_lightmap_color[2] = b;
+	}
+
+	void GIAtlasPipeline::setShadowmapOverride(bool enabled, unsigned char a) {
+		override_shadowmap = enabled;
+		override_shadowmap_alpha = a;
+	}
+
+	void GIAtlasPipeline::setImportFunction(function<bool(const string &, GIAtlasMap, GIAtlasImage *)> v) {
+		import_function = v;
+	}
+
+	void GIAtlasPipeline::setCompression(TextureCompressionFormat format, TextureCompressionQuality quality) {
+		compression_format = format;
+		compression_quality = quality;
+	}
+
+	bool GIAtlasPipeline::open(GITextureGroup *group_p, ArPack *pack) {
+		clear();
+
+		if (!group_p || !pack) {
+			Error::addMessage(Error::NULL_REFERENCE, LIBGENS_GI_TEXTURE_GROUP_ERROR_MESSAGE_NULL_FILE);
+			return false;
+		}
+
+		group = group_p;
+		unsigned int quality_level = group->getQualityLevel();
+
+		ArFile *atlasinfo_file = pack->getFile(LIBGENS_GI_TEXTURE_GROUP_ATLASINFO_FILE);
+		if (atlasinfo_file) {
+			bool loaded = atlasinfo_file->hasData();
+			if (loaded || atlasinfo_file->loadData()) {
+				File file(atlasinfo_file->getData(), atlasinfo_file->getSize());
+				group->readAtlasinfo(&file);
+				if (!loaded) atlasinfo_file->releaseData();
+			}
+		}
+
+		list<GITexture *> group_textures = group->getTextures();
+		set<string> texture_names;
+		for (list<GITexture *>::iterator it=group_textures.begin(); it!=group_textures.end(); it++) {
+			texture_names.insert((*it)->getName());
+		}
+
+		// Textures of the group's quality level that the atlasinfo doesn't list are used as a single subtexture.
+		string independent_suffix = LIBGENS_GI_TEXTURE_GROUP_SUBTEXTURE_LEVEL + ToString(quality_level) + LIBGENS_GI_ATLAS_DDS_EXTENSION;
+		unsigned int file_count = pack->getFileCount();
+		for (unsigned int i=0; i<file_count; i++) {
+			const string &filename = pack->getFileByIndex(i)->getName();
+			if ((filename.size() <= independent_suffix.size()) || filename.compare(filename.size() - independent_suffix.size(), independent_suffix.size(), independent_suffix)) {
+				continue;
+			}
+
+			string texture_name = filename.substr(0, filename.size() - strlen(LIBGENS_GI_ATLAS_DDS_EXTENSION));
+			if (texture_names.count(texture_name)) {
+				continue;
+			}
+
+			GITexture *texture = new GITexture();
+			texture->setName(texture_name);
+
+			GISubtexture *subtexture = new GISubtexture();
+			subtexture->setName(texture_name);
+			subtexture->setX(0.0f);
+			subtexture->setY(0.0f);
+			subtexture->setWidth(1.0f);
+			subtexture->setHeight(1.0f);
+			texture->addSubtexture(subtexture);
+
+			group_textures.push_back(texture);
+			independent_textures.push_back(texture);
+			texture_names.insert(texture_name);
+		}
+
+		textures.resize(group_textures.size());
+		size_t texture_index = 0;
+		for (list<GITexture *>::iterator it=group_textures.begin(); it!=group_textures.end(); it++, texture_index++) {
+			TextureEntry &entry = textures[texture_index];
+			entry.texture = *it;
+			entry.file = pack->getFile((*it)->getName() + LIBGENS_GI_ATLAS_DDS_EXTENSION);
+			entry.valid = false;
+
+			if (!entry.file) {
+				Error::addMessage(Error::FILE_NOT_FOUND, LIBGENS_GI_ATLAS_ERROR_MESSAGE_MISSING_TEXTURE + (*it)->getName() + LIBGENS_GI_ATLAS_DDS_EXTENSION);
+			}
+
+			list<GISubtexture *> texture_subtextures = (*it)->getSubtextures();
+			for (list<GISubtexture *>::iterator it2=texture_subtextures.begin(); it2!=texture_subtextures.end(); it2++) {
+				SubtextureEntry subtexture_entry;
+				subtexture_entry.name = giAtlasStripQualityLevel((*it2)->getName(), quality_level);
+				subtexture_entry.subtexture = *it2;
+				subtexture_entry.texture_index = texture_index;
+				subtexture_entry.clone = NULL;
+				subtextures.push_back(move(subtexture_entry));
+			}
+		}
+
+		return true;
+	}
+
+	vector<string> GIAtlasPipeline::getSubtextureNames() {
+		vector<string> names;
+		names.reserve(subtextures.size());
+		for (size_t i=0; i<subtextures.size(); i++) {
+			names.push_back(subtextures[i].name);
+		}
+		return names;
+	}
+
+	void GIAtlasPipeline::decode() {
+		Parallel::forEach(textures.size(), [this](size_t i) {
+			TextureEntry &entry = textures[i];
+			if (!entry.file) return;
+
+			bool loaded = entry.file->hasData();
+			if (!loaded && !entry.file->loadData()) return;
+
+			entry.valid = entry.image.readDDS(entry.file->getData(), entry.file->getSize());
+			if (!loaded) entry.file->releaseData();
+		});
+
+		for (size_t i=0; i<textures.size(); i++) {
+			TextureEntry &entry = textures[i];
+			if (entry.valid) {
+				entry.texture->setWidth(entry.image.getWidth());
+				entry.texture->setHeight(entry.image.getHeight());
+			}
+			else if (entry.file) {
+				Error::addMessage(Error::WARNING, LIBGENS_GI_ATLAS_ERROR_MESSAGE_DDS + entry.file->getName());
+			}
+		}
+	}
+
+	void GIAtlasPipeline::extractSubtexture(SubtextureEntry *entry) {
+		TextureEntry &texture = textures[entry->texture_index];
+		if (!texture.valid) {
+			return;
+		}
+
+		unsigned int texture_width = texture.image.getWidth();
+		unsigned int texture_height = texture.image.getHeight();
+		unsigned int subtexture_width = texture_width * entry->subtexture->getWidth();
+		unsigned int subtexture_height = texture_height * entry->subtexture->getHeight();
+		entry->subtexture->setPixelWidth(subtexture_width);
+		entry->subtexture->setPixelHeight(subtexture_height);
+		if (!subtexture_width || !subtexture_height) {
+			return;
+		}
+
+		GIAtlasImage lightmap;
+		GIAtlasImage shadowmap;
+		bool import_lightmap = !override_lightmap && import_function && import_function(entry->name, GI_ATLAS_MAP_LIGHTMAP, &lightmap) && !lightmap.empty();
+		bool import_shadowmap = !override_shadowmap && import_function && import_function(entry->name, GI_ATLAS_MAP_SHADOWMAP, &shadowmap) && !shadowmap.empty();
+
+		// The imported map that the settings scale to decides the final size, downscaled to the group's quality level.
+		// With both set, the lightmap wins, as it did when the converter scaled the shadowmap first and the lightmap last.
+		unsigned int scaled_width = subtexture_width;
+		unsigned int scaled_height = subtexture_height;
+		unsigned int downscale_factor = 1 << group->getQualityLevel();
+		GIAtlasImage *scale_source = NULL;
+		if (scale_to_lightmap && import_lightmap) scale_source = &lightmap;
+		else if (scale_to_shadowmap && import_shadowmap) scale_source = &shadowmap;
+
+		if (scale_source) {
+			scaled_width = max(scale_source->getWidth() / downscale_factor, 1u);
+			scaled_height = max(scale_source->getHeight() / downscale_factor, 1u);
+		}
+
+		// Both maps share the atlas texture, so extracting either is a single rectangle copy.
+		if ((!import_lightmap && !override_lightmap) || (!import_shadowmap && !override_shadowmap)) {
+			unsigned int start_x = texture_width * entry->subtexture->getX();
+			unsigned int start_y = texture_height * entry->subtexture->getY();
+			if ((scaled_width == subtexture_width) && (scaled_height == subtexture_height)) {
+				entry->image.create(subtexture_width, subtexture_height);
+				entry->image.copy(&texture.image, start_x, start_y, subtexture_width, subtexture_height, 0, 0);
+			}
+			else {
+				GIAtlasImage extracted(subtexture_width, subtexture_height);
+				extracted.copy(&texture.image, start_x, start_y, subtexture_width, subtexture_height, 0, 0);
+				extracted.resize(&entry->image, scaled_width, scaled_height);
+			}
+		}
+		else {
+			entry->image.create(scaled_width, scaled_height);
+		}
+
+		if (override_lightmap) {
+			entry->image.fillColor(override_lightmap_color[0], override_lightmap_color[1], override_lightmap_color[2]);
+		}
+		else if (import_lightmap) {
+			if ((lightmap.getWidth() != scaled_width) || (lightmap.getHeight() != scaled_height)) {
+				GIAtlasImage scaled;
+				lightmap.resize(&scaled, scaled_width, scaled_height);
+				lightmap.swap(&scaled);
+			}
+
+			entry->image.mergeLightmap(&lightmap);
+		}
+
+		if (override_shadowmap) {
+			entry->image.fillAlpha(override_shadowmap_alpha);
+		}
+		else if (import_shadowmap) {
+			if ((shadowmap.getWidth() != scaled_width) || (shadowmap.getHeight() != scaled_height)) {
+				GIAtlasImage scaled;
+				shadowmap.resize(&scaled, scaled_width, scaled_height);
+				shadowmap.swap(&scaled);
+			}
+
+			entry->image.mergeShadowmap(&shadowmap, inverted_shadowmaps);
+		}
+	}
+
+	void GIAtlasPipeline::extract() {
+		Parallel::forEach(subtextures.size(), [this](size_t i) {
+			extractSubtexture(&subtextures[i]);
+		});
+
+		// The atlas textures are no longer needed once every subtexture has its own image.
+		for (size_t i=0; i<textures.size(); i++) {
+			textures[i].image.clear();
+		}
+
+		for (size_t i=0; i<subtextures.size(); i++) {
+			SubtextureEntry &entry = subtextures[i];
+			if (entry.image.empty()) {
+				if (textures[entry.texture_index].valid) {
+					Error::addMessage(Error::WARNING, LIBGENS_GI_ATLAS_ERROR_MESSAGE_INVALID_SUBTEXTURE + entry.subtexture->getName());
+				}
+				continue;
+			}
+
+			entry.clone = new GISubtexture();
+			entry.clone->setPixelWidth(entry.image.getWidth());
+			entry.clone->setPixelHeight(entry.image.getHeight());
+			entry.clone->setName(entry.name);
+			max_subtexture_size = max(max_subtexture_size, entry.image.getWidth());
+			max_subtexture_size = max(max_subtexture_size, entry.image.getHeight());
+			group->addSubtextureToOrganize(entry.clone);
+		}
+	}
+
+	void GIAtlasPipeline::organize(unsigned int max_atlas_texture_size) {
+		// Deleting the group's textures also deletes the subtextures read from the atlasinfo.
+		for (size_t i=0; i<subtextures.size(); i++) {
+			subtextures[i].subtexture = NULL;
+		}
+
+		group->deleteTextures();
+		group->packSubtextures(max(max_atlas_texture_size, max_subtexture_size));
+	}
+
+	void GIAtlasPipeline::write(ArPack *pack) {
+		if (!group || !pack) {
+			return;
+		}
+
+		list<GITexture *> group_textures = group->getTextures();
+		vector<GITexture *> atlases(group_textures.begin(), group_textures.end());
+
+		unordered_map<GISubtexture *, GIAtlasImage *> clone_images;
+		for (size_t i=0; i<subtextures.size(); i++) {
+			if (subtextures[i].clone) clone_images[subtextures[i].clone] = &subtextures[i].image;
+		}
+
+		// Blitting is just row copies, so the atlases are done one at a time and their block rows are encoded in parallel.
+		unsigned int folder_size = 0;
+		for (size_t i=0; i<atlases.size(); i++) {
+			unsigned int atlas_width = atlases[i]->getWidth();
+			unsigned int atlas_height = atlases[i]->getHeight();
+			GIAtlasImage image(atlas_width, atlas_height);
+
+			list<GISubtexture *> atlas_subtextures = atlases[i]->getSubtextures();
+			for (list<GISubtexture *>::iterator it=atlas_subtextures.begin(); it!=atlas_subtextures.end(); it++) {
+				unordered_map<GISubtexture *, GIAtlasImage *>::iterator source = clone_images.find(*it);
+				if (source == clone_images.end()) continue;
+
+				unsigned int x = (*it)->getX() * atlas_width;
+				unsigned int y = (*it)->getY() * atlas_height;
+				image.copy(source->second, 0, 0, source->second->getWidth(), source->second->getHeight(), x, y);
+			}
+
+			vector<unsigned char> encoded;
+			image.writeDDS(&encoded, compression_format, compression_quality);
+			folder_size += encoded.size();
+			pack->addFile(atlases[i]->getName() + LIBGENS_GI_ATLAS_DDS_EXTENSION, move(encoded));
+		}
+
+		group->setFolderSize(folder_size);
+
+		File atlasinfo_file;
+		group->writeAtlasinfo(&atlasinfo_file);
+		pack->addFile(LIBGENS_GI_TEXTURE_GROUP_ATLASINFO_FILE, atlasinfo_file.detach());
+	}
+
+	void GIAtlasPipeline::process(unsigned int max_atlas_texture_size, ArPack *pack) {
+		decode();
+		extract();
+		organize(max_atlas_texture_size);
+		write(pack);
+	}
+
+	size_t GIAtlasPipeline::getTextureCount() {
+		return textures.size();
+	}
+
+	size_t GIAtlasPipeline::getSubtextureCount() {
+		return subtextures.size();
+	}
+
+	void GIAtlasPipeline::clear() {
+		for (list<GITexture *>::iterator it=independent_textures.begin(); it!=independent_textures.end(); it++) {
+			delete *it;
+		}
+
+		independent_textures.clear();
+		textures.clear();
+		subtextures.clear();
+		group = NULL;
+		max_subtexture_size = 0;
+	}
+};
@@ -0,0 +1,160 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#pragma once
+
+#include "TextureCompression.h"
+
+#define LIBGENS_GI_ATLAS_DDS_EXTENSION                    ".dds"
+#define LIBGENS_GI_ATLAS_ERROR_MESSAGE_DDS                "Unsupported or truncated DDS in GI atlas texture "
+#define LIBGENS_GI_ATLAS_ERROR_MESSAGE_MISSING_TEXTURE    "Couldn't find GI atlas texture "
+#define LIBGENS_GI_ATLAS_ERROR_MESSAGE_INVALID_SUBTEXTURE "GI subtexture has an invalid size: "
+
+namespace LibGens {
+	class ArFile;
+	class ArPack;
+	class GISubtexture;
+	class GITexture;
+	class GITextureGroup;
+
+	enum GIAtlasMap {
+		GI_ATLAS_MAP_LIGHTMAP,
+		GI_ATLAS_MAP_SHADOWMAP
+	};
+
+	// Linear 8-bit RGBA image. Rows are stored top to bottom without padding.
+	class GIAtlasImage {
+		protected:
+			unsigned int width;
+			unsigned int height;
+			vector<unsigned char> pixels;
+		public:
+			GIAtlasImage();
+			GIAtlasImage(unsigned int width_p, unsigned int height_p);
+			void create(unsigned int width_p, unsigned int height_p);
+			void clear();
+			void swap(GIAtlasImage *image);
+
+			// Decodes the top level of any DDS that TextureCompression::readDDS supports.
+			bool readDDS(const unsigned char *data, size_t size);
+
+			void writeDDS(vector<unsigned char> *data, TextureCompressionFormat format, TextureCompressionQuality quality, bool mipmaps=true);
+
+			void fill(unsigned char r, unsigned char g, unsigned char b, unsigned char a);
+			void fillColor(unsigned char r, unsigned char g, unsigned char b);
+			void fillAlpha(unsigned char a);
+
+			// Copies a rectangle of the source image into this one, one row at a time. The rectangle is clipped to both images.
+			void copy(GIAtlasImage *source, unsigned int source_x, unsigned int source_y, unsigned int w, unsigned int h, unsigned int x, unsigned int y);
+
+			// Replaces the color channels with the ones of a lightmap of the same size.
+			void mergeLightmap(GIAtlasImage *lightmap);
+
+			// Replaces the alpha channel with the average of the color channels of a shadowmap of the same size.
+			void mergeShadowmap(GIAtlasImage *shadowmap, bool inverted);
+
+			// Bilinear when enlarging, area average when shrinking.
+			void resize(GIAtlasImage *target, unsigned int target_width, unsigned int target_height);
+
+			unsigned int getWidth();
+			unsigned int getHeight();
+			unsigned char *getData();
+			unsigned char *getRow(unsigned int y);
+			bool empty();
+	};
+
+	// Rebuilds the atlas textures of a GI texture group entirely in memory. The group's DDS textures are
+	// decoded once, every subtexture is cut out of them with row copies and optionally replaced by
+	// imported or overridden maps and scaled, then the subtextures are organized again and blitted into
+	// new atlas textures that are encoded straight into an ArPack.
+	//
+	// Decoding, extraction and encoding run on LibGens::Parallel, so the import function is called
+	// concurrently from its threads. The stages can be run one by one or all at once with process().
+	class GIAtlasPipeline {
+		protected:
+			struct TextureEntry {
+				GITexture *texture;
+				ArFile *file;
+				GIAtlasImage image;
+				bool valid;
+			};
+
+			struct SubtextureEntry {
+				string name;
+				GISubtexture *subtexture;
+				size_t texture_index;
+				GISubtexture *clone;
+				GIAtlasImage image;
+			};
+
+			GITextureGroup *group;
+			vector<TextureEntry> textures;
+			vector<SubtextureEntry> subtextures;
+			list<GITexture *> independent_textures;
+			function<bool(const string &, GIAtlasMap, GIAtlasImage *)> import_function;
+			TextureCompressionFormat compression_format;
+			TextureCompressionQuality compression_quality;
+			bool inverted_shadowmaps;
+			bool scale_to_lightmap;
+			bool scale_to_shadowmap;
+			bool override_lightmap;
+			bool override_shadowmap;
+			unsigned char override_lightmap_color[3];
+			unsigned char override_shadowmap_alpha;
+			unsigned int max_subtexture_size;
+
+			void extractSubtexture(SubtextureEntry *entry);
+		public:
+			GIAtlasPipeline();
+			~GIAtlasPipeline();
+
+			void setInvertedShadowmaps(bool v);
+			void setScaleToLightmap(bool v);
+			void setScaleToShadowmap(bool v);
+			void setLightmapOverride(bool enabled, unsigned char r, unsigned char g, unsigned char b);
+			void setShadowmapOverride(bool enabled, unsigned char a);
+
+			// Loads the imported map of a subtexture, named without its quality level suffix. Returns false when there's none.
+			void setImportFunction(function<bool(const string &, GIAtlasMap, GIAtlasImage *)> v);
+
+			// Format of the new atlas textures, BC3 at normal quality by default.
+			void setCompression(TextureCompressionFormat format, TextureCompressionQuality quality);
+
+			// Reads the group's atlasinfo from its pack and collects its textures, including the independent
+			// ones that the atlasinfo doesn't list. The pack must outlive the pipeline until write() or clear().
+			bool open(GITextureGroup *group_p, ArPack *pack);
+
+			// Names of all subtextures of the opened group, without their quality level suffix.
+			vector<string> getSubtextureNames();
+
+			void decode();
+			void extract();
+
+			// Replaces the group's textures with the extracted subtextures organized into new atlases.
+			void organize(unsigned int max_atlas_texture_size);
+
+			// Blits and encodes the new atlases, updates the group's folder size and adds them and the atlasinfo to the pack.
+			void write(ArPack *pack);
+
+			void process(unsigned int max_atlas_texture_size, ArPack *pack);
+			size_t getTextureCount();
+			size_t getSubtextureCount();
+			void clear();
+	};
+};
@@ -0,0 +1,359 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "GIAtlasPacker.h"
+#include <limits.h>
+
+namespace LibGens {
+	struct GIAtlasPackerRect {
+		unsigned int x, y, w, h;
+
+		bool contains(const GIAtlasPackerRect &rect) const {
+			return (rect.x >= x) && (rect.y >= y) && (rect.x + rect.w <= x + w) && (rect.y + rect.h <= y + h);
+		}
+
+		bool intersects(const GIAtlasPackerRect &rect) const {
+			return (rect.x < x + w) && (x < rect.x + rect.w) && (rect.y < y + h) && (y < rect.y + rect.h);
+		}
+	};
+
+	// Free space of one atlas as the maximal free rectangles, which may overlap.
+	class GIAtlasPackerBin {
+		protected:
+			vector<GIAtlasPackerRect> free_rects;
+			vector<GIAtlasPackerRect> split_rects;
+			GIAtlasPackerPlacement placement;
+		public:
+			GIAtlasPackerBin(GIAtlasPackerPlacement placement_p) {
+				placement = placement_p;
+			}
+
+			void reset(unsigned int width, unsigned int height) {
+				GIAtlasPackerRect rect = { 0, 0, width, height };
+				free_rects.assign(1, rect);
+			}
+
+			bool insert(unsigned int width, unsigned int height, unsigned int *x, unsigned int *y) {
+				size_t best = free_rects.size();
+				unsigned int best_score = UINT_MAX;
+				unsigned int best_second_score = UINT_MAX;
+				for (size_t i=0; i<free_rects.size(); i++) {
+					const GIAtlasPackerRect &rect = free_rects[i];
+					if ((rect.w < width) || (rect.h < height)) continue;
+
+					unsigned int score, second_score;
+					if (placement == GI_ATLAS_PACKER_PLACEMENT_BOTTOM_LEFT) {
+						score = rect.y + height;
+						second_score = rect.x;
+					}
+					else {
+						score = min(rect.w - width, rect.h - height);
+						second_score = max(rect.w - width, rect.h - height);
+					}
+
+					if ((score < best_score) || ((score == best_score) && (second_score < best_second_score))) {
+						best = i;
+						best_score = score;
+						best_second_score = second_score;
+					}
+				}
+
+				if (best == free_rects.size()) {
+					return false;
+				}
+
+				GIAtlasPackerRect used = { free_rects[best].x, free_rects[best].y, width, height };
+				split(used);
+				*x = used.x;
+				*y = used.y;
+				return true;
+			}
+
+		protected:
+			void split(const GIAtlasPackerRect &used) {
+				split_rects.clear();
+
+				size_t kept = 0;
+				for (size_t i=0; i<free_rects.size(); i++) {
+					GIAtlasPackerRect rect = free_rects[i];
+					if (!rect.intersects(used)) {
+						free_rects[kept++] = rect;
+						continue;
+					}
+
+					if (used.x > rect.x) {
+						GIAtlasPackerRect left = { rect.x, rect.y, used.x - rect.x, rect.h };
+						split_rects.push_back(left);
+					}
+
+					if (used.x + used.w < rect.x + rect.w) {
+						GIAtlasPackerRect right = { used.x + used.w, rect.y, rect.x + rect.w - (used.x + used.w), rect.h };
+						split_rects.push_back(right);
+					}
+
+					if (used.y > rect.y) {
+						GIAtlasPackerRect top = { rect.x, rect.y, rect.w, used.y - rect.y };
+						split_rects.push_back(top);
+					}
+
+					if (used.y + used.h < rect.y + rect.h) {
+						GIAtlasPackerRect bottom = { rect.x, used.y + used.h, rect.w, rect.y + rect.h - (used.y + used.h) };
+						split_rects.push_back(bottom);
+					}
+				}
+
+				free_rects.resize(kept);
+
+				// The untouched rectangles were maximal before, so only the new ones can be redundant.
+				for (size_t i=0; i<split_rects.size(); i++) {
+					bool contained = false;
+					for (size_t j=0; !contained && (j<split_rects.size()); j++) {
+						if ((i != j) && split_rects[j].contains(split_rects[i]) && (!split_rects[i].contains(split_rects[j]) || (j < i))) contained = true;
+					}
+
+					for (size_t j=0; !contained && (j<kept); j++) {
+						if (free_rects[j].contains(split_rects[i])) contained = true;
+					}
+
+					if (!contained) free_rects.push_back(split_rects[i]);
+				}
+			}
+	};
+
+	// Power of two atlas shapes, square or twice as wide, from smallest to biggest.
+	static void giAtlasPackerSizes(unsigned int max_texture_size, vector<pair<unsigned int, unsigned int>> *sizes) {
+		sizes->clear();
+		for (unsigned int height=LIBGENS_GI_ATLAS_PACKER_MIN_TEXTURE_SIZE; height<=max_texture_size; height*=2) {
+			sizes->push_back(make_pair(height, height));
+			if (height * 2 <= max_texture_size) sizes->push_back(make_pair(height * 2, height));
+		}
+	}
+
+	static unsigned int giAtlasPackerPowerOfTwo(unsigned int v) {
+		unsigned int power = LIBGENS_GI_ATLAS_PACKER_MIN_TEXTURE_SIZE;
+		while (power < v) power *= 2;
+		return power;
+	}
+
+	// Inserts the items in order. Positions of placed items go to x and y, the rest are appended to unplaced.
+	static void giAtlasPackerFill(GIAtlasPackerBin *bin, unsigned int width, unsigned int height, const vector<unsigned int> &items, const vector<unsigned int> &widths, const vector<unsigned int> &heights,
+		vector<unsigned int> *x, vector<unsigned int> *y, vector<unsigned int> *placed, vector<unsigned int> *unplaced) {
+		bin->reset(width, height);
+		for (size_t i=0; i<items.size(); i++) {
+			unsigned int item = items[i];
+			if (bin->insert(widths[item], heights[item], &(*x)[item], &(*y)[item])) placed->push_back(item);
+			else unplaced->push_back(item);
+		}
+	}
+
+	// Index of the smallest size that holds all items, or the size count if none does.
+	static size_t giAtlasPackerFit(GIAtlasPackerBin *bin, const vector<pair<unsigned int, unsigned int>> &sizes, const vector<unsigned int> &items, const vector<unsigned int> &widths, const vector<unsigned int> &heights,
+		vector<unsigned int> *x, vector<unsigned int> *y) {
+		unsigned long long area = 0;
+		unsigned int max_width = 0;
+		unsigned int max_height = 0;
+		for (size_t i=0; i<items.size(); i++) {
+			area += (unsigned long long) widths[items[i]] * heights[items[i]];
+			max_width = max(max_width, widths[items[i]]);
+			max_height = max(max_height, heights[items[i]]);
+		}
+
+		for (size_t s=0; s<sizes.size(); s++) {
+			unsigned int width = sizes[s].first;
+			unsigned int height = sizes[s].second;
+			if (((unsigned long long) width * height < area) || (width < max_width) || (height < max_height)) continue;
+
+			bin->reset(width, height);
+			bool packed_all = true;
+			for (size_t i=0; packed_all && (i<items.size()); i++) {
+				packed_all = bin->insert(widths[items[i]], heights[items[i]], &(*x)[items[i]], &(*y)[items[i]]);
+			}
+
+			if (packed_all) return s;
+		}
+
+		return sizes.size();
+	}
+
+	GIAtlasPacker::GIAtlasPacker() {
+		result.area = 0;
+	}
+
+	size_t GIAtlasPacker::addItem(unsigned int width, unsigned int height) {
+		item_widths.push_back(max(width, 1u));
+		item_heights.push_back(max(height, 1u));
+		return item_widths.size() - 1;
+	}
+
+	void GIAtlasPacker::packCandidate(GIAtlasPackerSort sort, GIAtlasPackerPlacement placement, unsigned int max_texture_size, Result *candidate) {
+		size_t item_count = item_widths.size();
+		candidate->atlas_widths.clear();
+		candidate->atlas_heights.clear();
+		candidate->item_atlases.assign(item_count, 0);
+		candidate->item_x.assign(item_count, 0);
+		candidate->item_y.assign(item_count, 0);
+		candidate->area = 0;
+
+		vector<unsigned long long> keys(item_count);
+		for (size_t i=0; i<item_count; i++) {
+			unsigned long long w = item_widths[i];
+			unsigned long long h = item_heights[i];
+			switch (sort) {
+				case GI_ATLAS_PACKER_SORT_AREA:     keys[i] = ((w * h) << 20) | max(w, h); break;
+				case GI_ATLAS_PACKER_SORT_MAX_SIDE: keys[i] = (max(w, h) << 32) | (w * h); break;
+				case GI_ATLAS_PACKER_SORT_WIDTH:    keys[i] = (w << 32) | h; break;
+				default:                            keys[i] = (h << 32) | w; break;
+			}
+		}
+
+		vector<unsigned int> remaining(item_count);
+		for (size_t i=0; i<item_count; i++) remaining[i] = i;
+		stable_sort(remaining.begin(), remaining.end(), [&](unsigned int a, unsigned int b) { return keys[a] > keys[b]; });
+
+		vector<pair<unsigned int, unsigned int>> sizes;
+		giAtlasPackerSizes(max_texture_size, &sizes);
+
+		GIAtlasPackerBin bin(placement);
+		vector<unsigned int> placed, unplaced;
+		vector<unsigned int> &x = candidate->item_x;
+		vector<unsigned int> &y = candidate->item_y;
+		while (!remaining.empty()) {
+			unsigned int atlas = candidate->atlas_widths.size();
+			unsigned int width = max_texture_size;
+			unsigned int height = max_texture_size;
+			placed.clear();
+			unplaced.clear();
+
+			size_t fit = giAtlasPackerFit(&bin, sizes, remaining, item_widths, item_heights, &x, &y);
+			if (fit < sizes.size()) {
+				// Everything left fits one atlas, but filling the next smaller size and starting another
+				// atlas for the rest can waste less.
+				bool split = false;
+				if (fit > 0) {
+					giAtlasPackerFill(&bin, sizes[fit-1].first, sizes[fit-1].second, remaining, item_widths, item_heights, &x, &y, &placed, &unplaced);
+					if (!placed.empty() && !unplaced.empty()) {
+						size_t rest_fit = giAtlasPackerFit(&bin, sizes, unplaced, item_widths, item_heights, &x, &y);
+						if (rest_fit < sizes.size()) {
+							unsigned long long split_area = (unsigned long long) sizes[fit-1].first * sizes[fit-1].second + (unsigned long long) sizes[rest_fit].first * sizes[rest_fit].second;
+							split = split_area < (unsigned long long) sizes[fit].first * sizes[fit].second;
+						}
+					}
+				}
+
+				if (split) {
+					width = sizes[fit-1].first;
+					height = sizes[fit-1].second;
+				}
+				else {
+					// The trial fills moved the items, so they're placed again.
+					placed.clear();
+					unplaced.clear();
+					giAtlasPackerFill(&bin, sizes[fit].first, sizes[fit].second, remaining, item_widths, item_heights, &x, &y, &placed, &unplaced);
+					width = sizes[fit].first;
+					height = sizes[fit].second;
+				}
+			}
+			else {
+				// Otherwise fill an atlas of the maximum size and leave the rest for the next one.
+				giAtlasPackerFill(&bin, max_texture_size, max_texture_size, remaining, item_widths, item_heights, &x, &y, &placed, &unplaced);
+				if (placed.empty()) {
+					// Bigger than the maximum size, so it gets an atlas of its own.
+					unsigned int item = unplaced.front();
+					width = giAtlasPackerPowerOfTwo(item_widths[item]);
+					height = giAtlasPackerPowerOfTwo(item_heights[item]);
+					x[item] = y[item] = 0;
+					placed.push_back(item);
+					unplaced.erase(unplaced.begin());
+				}
+			}
+
+			for (size_t i=0; i<placed.size(); i++) candidate->item_atlases[placed[i]] = atlas;
+			candidate->atlas_widths.push_back(width);
+			candidate->atlas_heights.push_back(height);
+			remaining.swap(unplaced);
+		}
+
+		for (size_t i=0; i<candidate->atlas_widths.size(); i++) {
+			candidate->area += (unsigned long long) candidate->atlas_widths[i] * candidate->atlas_heights[i];
+		}
+	}
+
+	void GIAtlasPacker::pack(unsigned int max_texture_size) {
+		max_texture_size = giAtlasPackerPowerOfTwo(max_texture_size);
+
+		size_t candidate_count = GI_ATLAS_PACKER_SORT_COUNT * GI_ATLAS_PACKER_PLACEMENT_COUNT;
+		vector<Result> candidates(candidate_count);
+		Parallel::forEach(candidate_count, [&](size_t i) {
+			packCandidate((GIAtlasPackerSort) (i / GI_ATLAS_PACKER_PLACEMENT_COUNT), (GIAtlasPackerPlacement) (i % GI_ATLAS_PACKER_PLACEMENT_COUNT), max_texture_size, &candidates[i]);
+		});
+
+		// Densest result first, then the one with fewer atlases. Ties keep the earliest heuristic so results are stable.
+		size_t best = 0;
+		for (size_t i=1; i<candidate_count; i++) {
+			if ((candidates[i].area < candidates[best].area) || ((candidates[i].area == candidates[best].area) && (candidates[i].atlas_widths.size() < candidates[best].atlas_widths.size()))) {
+				best = i;
+			}
+		}
+
+		result = candidates[best];
+	}
+
+	void GIAtlasPacker::clear() {
+		item_widths.clear();
+		item_heights.clear();
+		result = Result();
+		result.area = 0;
+	}
+
+	size_t GIAtlasPacker::getItemCount() {
+		return item_widths.size();
+	}
+
+	size_t GIAtlasPacker::getAtlasCount() {
+		return result.atlas_widths.size();
+	}
+
+	unsigned int GIAtlasPacker::getAtlasWidth(size_t atlas) {
+		return result.atlas_widths[atlas];
+	}
+
+	unsigned int GIAtlasPacker::getAtlasHeight(size_t atlas) {
+		return result.atlas_heights[atlas];
+	}
+
+	unsigned int GIAtlasPacker::getItemAtlas(size_t item) {
+		return result.item_atlases[item];
+	}
+
+	unsigned int GIAtlasPacker::getItemX(size_t item) {
+		return result.item_x[item];
+	}
+
+	unsigned int GIAtlasPacker::getItemY(size_t item) {
+		return result.item_y[item];
+	}
+
+	float GIAtlasPacker::getFillRatio() {
+		if (!result.area) return 0.0f;
+
+		unsigned long long item_area = 0;
+		for (size_t i=0; i<item_widths.size(); i++) item_area += (unsigned long long) item_widths[i] * item_heights[i];
+		return (float) ((double) item_area / (double) result.area);
+	}
+};
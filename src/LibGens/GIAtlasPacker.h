@@ -0,0 +1,78 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#pragma once
+
+#define LIBGENS_GI_ATLAS_PACKER_MIN_TEXTURE_SIZE  4
+
+namespace LibGens {
+	enum GIAtlasPackerSort {
+		GI_ATLAS_PACKER_SORT_AREA,
+		GI_ATLAS_PACKER_SORT_MAX_SIDE,
+		GI_ATLAS_PACKER_SORT_WIDTH,
+		GI_ATLAS_PACKER_SORT_HEIGHT,
+		GI_ATLAS_PACKER_SORT_COUNT
+	};
+
+	enum GIAtlasPackerPlacement {
+		GI_ATLAS_PACKER_PLACEMENT_BOTTOM_LEFT,
+		GI_ATLAS_PACKER_PLACEMENT_BEST_SHORT_SIDE,
+		GI_ATLAS_PACKER_PLACEMENT_COUNT
+	};
+
+	// MaxRects packer for GI subtextures. Every combination of sort order and placement rule is tried in
+	// parallel and the result with the smallest total atlas area is kept. Atlases are filled at the maximum
+	// size until the remaining items fit a smaller one, which is then the smallest power of two size, as wide
+	// or twice as wide as it is high, that holds all of them. All state lives in flat arrays indexed by item.
+	class GIAtlasPacker {
+		protected:
+			struct Result {
+				vector<unsigned int> atlas_widths;
+				vector<unsigned int> atlas_heights;
+				vector<unsigned int> item_atlases;
+				vector<unsigned int> item_x;
+				vector<unsigned int> item_y;
+				unsigned long long area;
+			};
+
+			vector<unsigned int> item_widths;
+			vector<unsigned int> item_heights;
+			Result result;
+
+			void packCandidate(GIAtlasPackerSort sort, GIAtlasPackerPlacement placement, unsigned int max_texture_size, Result *candidate);
+		public:
+			GIAtlasPacker();
+
+			// Returns the index of the item.
+			size_t addItem(unsigned int width, unsigned int height);
+			void pack(unsigned int max_texture_size);
+			void clear();
+
+			size_t getItemCount();
+			size_t getAtlasCount();
+			unsigned int getAtlasWidth(size_t atlas);
+			unsigned int getAtlasHeight(size_t atlas);
+			unsigned int getItemAtlas(size_t item);
+			unsigned int getItemX(size_t item);
+			unsigned int getItemY(size_t item);
+
+			// Item pixels over atlas pixels.
+			float getFillRatio();
+	};
+};
@@ -19,6 +19,7 @@
 
 #include "AR.h"
 #include "GITextureGroup.h"
+#include "GIAtlasPacker.h"
 #include "Material.h"
 #include <map>
 
@@ -546,8 +547,10 @@ namespace LibGens {
 		if (ar_pack && ar_pack_file) {
 			ArFile *entry=ar_pack->getFile(LIBGENS_GI_TEXTURE_GROUP_ATLASINFO_FILE);
 			if (entry) {
-				if (entry->getData()) {
-					File ar_data_file(entry->getData(), entry->getSize());
+				vector<unsigned char> buffer;
+				const unsigned char *data=entry->viewData(&buffer);
+				if (data) {
+					File ar_data_file(data, entry->getSize());
 					readAtlasinfo(&ar_data_file, group_folder, instance_names);
 				}
 				else {
@@ -789,6 +792,55 @@ namespace LibGens {
 		}
 	}
 	
+	void GITextureGroup::packSubtextures(unsigned int max_texture_size) {
+		vector<GISubtexture *> subtextures;
+		list<GISubtexture *> oversized_subtextures;
+		for (list<GISubtexture *>::iterator it=subtextures_to_organize.begin(); it!=subtextures_to_organize.end(); it++) {
+			if (((*it)->getPixelWidth() > max_texture_size) || ((*it)->getPixelHeight() > max_texture_size)) {
+				Error::addMessage(Error::WARNING, LIBGENS_GI_TEXTURE_GROUP_ERROR_MESSAGE_OVERSIZED + (*it)->getName());
+				oversized_subtextures.push_back(*it);
+			}
+			else {
+				subtextures.push_back(*it);
+			}
+		}
+		subtextures_to_organize = oversized_subtextures;
+
+		GIAtlasPacker packer;
+		for (size_t i=0; i<subtextures.size(); i++) {
+			if (subtextures[i]->getName().find(LIBGENS_GI_TEXTURE_GROUP_SUBTEXTURE_LEVEL) == string::npos)
+				subtextures[i]->setName(subtextures[i]->getName() + LIBGENS_GI_TEXTURE_GROUP_SUBTEXTURE_LEVEL + ToString(quality_level));
+
+			packer.addItem(subtextures[i]->getPixelWidth(), subtextures[i]->getPixelHeight());
+		}
+
+		packer.pack(max_texture_size);
+
+		vector<GITexture *> atlases(packer.getAtlasCount());
+		for (size_t i=0; i<atlases.size(); i++) {
+			char texture_name[16];
+			sprintf(texture_name, "a%04d", (int) textures.size());
+
+			atlases[i] = new GITexture();
+			atlases[i]->setName(texture_name);
+			atlases[i]->setWidth(packer.getAtlasWidth(i));
+			atlases[i]->setHeight(packer.getAtlasHeight(i));
+			textures.push_back(atlases[i]);
+		}
+
+		for (size_t i=0; i<subtextures.size(); i++) {
+			unsigned int atlas = packer.getItemAtlas(i);
+			float atlas_width = packer.getAtlasWidth(atlas);
+			float atlas_height = packer.getAtlasHeight(atlas);
+
+			subtextures[i]->setX(packer.getItemX(i) / atlas_width);
+			subtextures[i]->setY(packer.getItemY(i) / atlas_height);
+			subtextures[i]->setWidth(subtextures[i]->getPixelWidth() / atlas_width);
+			subtextures[i]->setHeight(subtextures[i]->getPixelHeight() / atlas_height);
+			atlases[atlas]->addSubtexture(subtextures[i]);
+		}
+	}
+	
 	void GITextureGroupInfo::read(File *file, string terrain_folder) {
 		if (!file) {
 			Error::addMessage(Error::NULL_REFERENCE, LIBGENS_GI_TEXTURE_GROUP_ERROR_MESSAGE_NULL_FILE);
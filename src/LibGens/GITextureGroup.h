@@ -23,6 +23,7 @@
 
 #define LIBGENS_GI_TEXTURE_GROUP_ERROR_MESSAGE_NULL_FILE       "Trying to read GI group texture info data from unreferenced file."
 #define LIBGENS_GI_TEXTURE_GROUP_ERROR_MESSAGE_WRITE_NULL_FILE "Trying to write GI group texture info data to an unreferenced file."
+#define LIBGENS_GI_TEXTURE_GROUP_ERROR_MESSAGE_OVERSIZED       "GI subtexture is bigger than the maximum atlas size and was left unpacked: "
 #define LIBGENS_GI_TEXTURE_GROUP_ATLASINFO_FILE                "atlasinfo"
 #define LIBGENS_GI_TEXTURE_GROUP_INFO_FILE                     "gi-texture.gi-texture-group-info"
 #define LIBGENS_GI_TEXTURE_GROUP_MIP_LEVEL_LIMIT_FILE		   "gi-lim.gil"
@@ -151,6 +152,11 @@ namespace LibGens {
 			void setFolderSize(unsigned int v);
 			int getFolderSize();
 			void organizeSubtextures(unsigned int max_texture_size);
+
+			// Same as organizeSubtextures, but with GIAtlasPacker instead of GITextureTree. Atlases are usually fewer and fuller.
+			// Subtextures bigger than max_texture_size are reported and stay in the list to organize.
+			void packSubtextures(unsigned int max_texture_size);
+
 			void fixIndices(std::map<int, int> index_map);
 			void addTexture(GITexture *texture);
 			void deleteTextures();
@@ -19,6 +19,7 @@
 
 #include "Ghost.h"
 #include "GhostNode.h"
+#include "Keyframe.h"
 #include "FBX.h"
 #include "FBXManager.h"
 
@@ -57,6 +58,7 @@ namespace LibGens {
 			GhostNode *ghost_node = new GhostNode();
 			ghost_node->read(file);
 			ghost_nodes.push_back(ghost_node);
+			node_times.push_back((node_times.empty() ? 0.0f : node_times.back()) + ghost_node->timer);
 		}
 	}
 
@@ -93,55 +95,72 @@ namespace LibGens {
 		}
 	}
 
-	void Ghost::calculate(float time, Vector3 &position, Quaternion &rotation, string &animation_name, float &animation_frame, bool &animation_ball) const {
-		GhostNode *previous_node=NULL;
-		GhostNode *next_node=NULL;
+	void Ghost::calculate(float time, Vector3 &position, Quaternion &rotation, string &animation_name, float &animation_frame, bool &animation_ball, size_t *cursor) const {
+		if (ghost_nodes.empty()) {
+			return;
+		}
 
-		float total_time=0;
-		float factor=0;
+		GhostSample sample;
+		sample.rotation = rotation;
+		calculate(time, &sample, cursor);
 
-		for (size_t i=0; i<ghost_nodes.size(); i++) {
-			previous_node = next_node;
-			next_node = ghost_nodes[i];
-			total_time += next_node->timer;
+		position = sample.position;
+		rotation = sample.rotation;
+		animation_name = animation_names[sample.animation_index];
+		animation_frame = sample.animation_frame;
+		animation_ball = sample.animation_ball;
+	}
 
-			if (total_time > time) {
-				break;
-			}
+	void Ghost::calculate(float time, GhostSample *sample, size_t *cursor) const {
+		size_t count = ghost_nodes.size();
+		if (!count) {
+			return;
 		}
 
-		if (previous_node && next_node) {
-			float previous_time = total_time - next_node->timer;
-			factor = (time - (previous_time)) / (next_node->timer);
-			position = previous_node->position + ((next_node->position - previous_node->position) * factor);
-			rotation = rotation.slerp(factor, previous_node->rotation, next_node->rotation);
-			animation_name = animation_names[previous_node->animation_index];
-			animation_frame = previous_node->animation_frame + ((next_node->animation_frame - previous_node->animation_frame) * factor);
-			animation_ball = previous_node->animation_ball;
+		// Same node pair as a forward scan over the timers: the first node to end after time, paired with
+		// the node before it. Past the end, the last two nodes keep extrapolating.
+		size_t next = findKeyframeIndex(node_times, time, cursor);
+		if (next == count) next = count - 1;
+
+		GhostNode *next_node = ghost_nodes[next];
+		if (next) {
+			GhostNode *previous_node = ghost_nodes[next-1];
+			float previous_time = node_times[next] - next_node->timer;
+			float factor = (time - (previous_time)) / (next_node->timer);
+			sample->position = previous_node->position + ((next_node->position - previous_node->position) * factor);
+			sample->rotation = sample->rotation.slerp(factor, previous_node->rotation, next_node->rotation);
+			sample->animation_index = previous_node->animation_index;
+			sample->animation_frame = previous_node->animation_frame + ((next_node->animation_frame - previous_node->animation_frame) * factor);
+			sample->animation_ball = (previous_node->animation_ball != 0);
 		}
-		else if (next_node) {
-			position = next_node->position;
-			rotation = next_node->rotation;
-			animation_name = animation_names[next_node->animation_index];
-			animation_frame = next_node->animation_frame;
-			animation_ball = next_node->animation_ball;
+		else {
+			sample->position = next_node->position;
+			sample->rotation = next_node->rotation;
+			sample->animation_index = next_node->animation_index;
+			sample->animation_frame = next_node->animation_frame;
+			sample->animation_ball = (next_node->animation_ball != 0);
 		}
-		else if (previous_node) {
-			position = previous_node->position;
-			rotation = previous_node->rotation;
-			animation_name = animation_names[previous_node->animation_index];
-			animation_frame = previous_node->animation_frame;
-			animation_ball = previous_node->animation_ball;
+	}
+
+	void Ghost::sample(const float *times, size_t count, GhostSample *samples, size_t *cursor) const {
+		size_t local_cursor = 0;
+		if (!cursor) cursor = &local_cursor;
+
+		for (size_t i=0; i<count; i++) {
+			calculate(times[i], &samples[i], cursor);
 		}
 	}
 
+	string Ghost::getAnimationName(unsigned short index) const {
+		return (index < animation_names.size()) ? animation_names[index] : "";
+	}
+
+	vector<GhostNode *> Ghost::getGhostNodes() const {
+		return ghost_nodes;
+	}
+
 	float Ghost::calculateDuration() const {
-		float duration = 0;
-		for (size_t i = 0; i < ghost_nodes.size(); i++)
-		{
-			duration += ghost_nodes[i]->timer;
-		}
-		return duration;
+		return node_times.empty() ? 0.0f : node_times.back();
 	}
 
 	FBX* Ghost::buildFbx(FBXManager* manager, Model* model, MaterialLibrary* material_lib) const
@@ -30,16 +30,31 @@ namespace LibGens {
 	class GhostNode;
 	class MaterialLibrary;
 
+	struct GhostSample {
+		Vector3 position;
+		Quaternion rotation;
+		unsigned short animation_index;
+		float animation_frame;
+		bool animation_ball;
+	};
+
+	// node_times holds the running sum of the node timers, so calculate finds the node pair for a time with
+	// a binary search. A cursor passed by a player that advances forward makes each step O(1).
 	class Ghost {
 		protected:
 			vector<string> animation_names;
 			vector<GhostNode *> ghost_nodes;
+			vector<float> node_times;
 		public:
 			Ghost(string filename);
 			void read(File *file);
 			void write(File *file);
 			void save(string filename);
-			void calculate(float time, Vector3 &position, Quaternion &rotation, string &animation_name, float &animation_frame, bool &animation_ball) const;
+			void calculate(float time, Vector3 &position, Quaternion &rotation, string &animation_name, float &animation_frame, bool &animation_ball, size_t *cursor=NULL) const;
+			void calculate(float time, GhostSample *sample, size_t *cursor=NULL) const;
+			void sample(const float *times, size_t count, GhostSample *samples, size_t *cursor=NULL) const;
+			string getAnimationName(unsigned short index) const;
+			vector<GhostNode *> getGhostNodes() const;
 			float calculateDuration() const;
 			FBX* buildFbx(FBXManager* manager, Model* model, MaterialLibrary* material_lib = nullptr) const;
 	};
@@ -42,4 +42,28 @@ namespace LibGens {
 		file->writeInt16BE(&animation_ball);
 		file->writeFloat32BE(&animation_frame);
 	}
+
+	float GhostNode::getTimer() {
+		return timer;
+	}
+
+	Vector3 GhostNode::getPosition() {
+		return position;
+	}
+
+	Quaternion GhostNode::getRotation() {
+		return rotation;
+	}
+
+	unsigned short GhostNode::getAnimationIndex() {
+		return animation_index;
+	}
+
+	bool GhostNode::getAnimationBall() {
+		return (animation_ball != 0);
+	}
+
+	float GhostNode::getAnimationFrame() {
+		return animation_frame;
+	}
 };
\ No newline at end of file
@@ -35,5 +35,11 @@ namespace LibGens {
 			GhostNode();
 			void read(File *file);
 			void write(File *file);
+			float getTimer();
+			Vector3 getPosition();
+			Quaternion getRotation();
+			unsigned short getAnimationIndex();
+			bool getAnimationBall();
+			float getAnimationFrame();
 	};
 };
\ No newline at end of file
@@ -44,7 +44,7 @@ namespace {
 		unsigned int tag;
 		string name;
 
-		HavokClassName() {}
+		HavokClassName() : tag(0) {}
 	};
 
 	class HavokTypeMember {
@@ -96,21 +96,6 @@ namespace {
 		}
 	};
 
-	class HavokLink {
-	public:
-		unsigned int type;
-		unsigned int address_1;
-		unsigned int address_2;
-		HavokType* type_parent;
-		HavokType* type_node;
-	};
-
-	class HavokPointer {
-	public:
-		unsigned abs_address;
-		unsigned target_address;
-	};
-
 	struct HavokPackfileHeader {
 		int magic[2];
 		int user_tag;
@@ -148,26 +133,150 @@ namespace {
 		}
 	};
 
+	// Cursor over the packfile in memory with the behaviour of a memory mapped File: seeks clamp to the
+	// end of the data and reads past it stop short, leaving the rest of the destination untouched.
+	class HavokPackfileReader {
+	protected:
+		const unsigned char* data;
+		size_t size;
+		size_t position;
+
+	public:
+		HavokPackfileReader(const unsigned char* data_p, size_t size_p) : data(data_p), size(size_p), position(0) {}
+
+		void seek(long offset, int origin) {
+			size_t target = (origin == SEEK_CUR) ? position + offset : (size_t)offset;
+			position = (target < size) ? target : size;
+		}
+
+		size_t read(void* dest, size_t sz) {
+			if (sz > size - position) sz = size - position;
+			memcpy(dest, data + position, sz);
+			position += sz;
+			return sz;
+		}
+
+		unsigned int readBE32(size_t address) {
+			if ((address >= size) || (size - address < 4)) return 0;
+			return ((unsigned int)data[address] << 24) | ((unsigned int)data[address + 1] << 16) | ((unsigned int)data[address + 2] << 8) | data[address + 3];
+		}
+
+		size_t getCurrentAddress() {
+			return position;
+		}
+
+		void fixPaddingRead(size_t multiple) {
+			size_t extra = multiple - (position % multiple);
+			if (extra != multiple) seek(position + extra, SEEK_SET);
+		}
+	};
+
+	// Every element type swaps swap_count consecutive words of swap_size bytes and moves on by advance
+	// bytes. Arrays swap their header in place without moving on, so it toggles on every element.
+	struct HavokElementLayout {
+		unsigned int swap_size;
+		unsigned int swap_count;
+		unsigned int advance;
+	};
+
+	HavokElementLayout getElementLayout(int main_type) {
+		HavokElementLayout layout = { 0, 0, 1 };
+
+		if ((main_type == TYPE_INT16) || (main_type == TYPE_UINT16) || (main_type == TYPE_HALF)) {
+			layout.swap_size = 2; layout.swap_count = 1; layout.advance = 2;
+		}
+		else if ((main_type == TYPE_INT32) || (main_type == TYPE_UINT32) || (main_type == TYPE_REAL) || (main_type == TYPE_POINTER) || (main_type == TYPE_ULONG) || (main_type == TYPE_STRING_POINTER) || (main_type == TYPE_CSTRING)) {
+			layout.swap_size = 4; layout.swap_count = 1; layout.advance = 4;
+		}
+		else if (main_type == TYPE_VARIANT) {
+			layout.swap_size = 4; layout.swap_count = 2; layout.advance = 8;
+		}
+		else if ((main_type == TYPE_INT64) || (main_type == TYPE_UINT64)) {
+			layout.swap_size = 8; layout.swap_count = 1; layout.advance = 8;
+		}
+		else if ((main_type == TYPE_VECTOR4) || (main_type == TYPE_QUATERNION)) {
+			layout.swap_size = 4; layout.swap_count = 4; layout.advance = 16;
+		}
+		else if ((main_type == TYPE_MATRIX3) || (main_type == TYPE_ROTATION) || (main_type == TYPE_QSTRANSFORM)) {
+			layout.swap_size = 4; layout.swap_count = 12; layout.advance = 4 * 12;
+		}
+		else if ((main_type == TYPE_MATRIX4) || (main_type == TYPE_TRANSFORM)) {
+			layout.swap_size = 4; layout.swap_count = 16; layout.advance = 4 * 16;
+		}
+		else if ((main_type == TYPE_ARRAY) || (main_type == TYPE_HOMOGENEOUS_ARRAY)) {
+			layout.swap_size = 4; layout.swap_count = 3; layout.advance = 0;
+		}
+
+		return layout;
+	}
+
+	enum {
+		SWAP_OP_WORDS,
+		SWAP_OP_ARRAY
+	};
+
+	// One step of a compiled structure, relative to the structure's address. Words swaps count words of
+	// size bytes. Array reads the element count of an array member and converts its elements, either
+	// as element_type values or, for structures, by running program on each of them stride bytes apart.
+	struct HavokSwapOp {
+		unsigned char op;
+		unsigned char element_type;
+		unsigned int offset;
+		unsigned int size;
+		unsigned int count;
+		unsigned int stride;
+		size_t program;
+	};
+
+	// Flattened conversion of every type with a given name: parents and embedded structures are inlined,
+	// so only arrays, whose contents depend on the data, still branch to other programs.
+	struct HavokSwapProgram {
+		vector<HavokSwapOp> ops;
+	};
+
+	// A structure being converted, or with count above 0, the elements of an array of structures still
+	// left to convert.
+	struct HavokSwapFrame {
+		size_t program;
+		size_t op;
+		unsigned int address;
+		unsigned int count;
+		unsigned int stride;
+	};
+
 	struct HavokEndianSwapImpl {
+		const unsigned char* in;
 		vector<unsigned char> out;
+		HavokPackfileReader reader;
 		unsigned int class_name_global_address = 0;
 
-		void endianSwap(int i, int sz) {
-			char t = 0;
+		HavokEndianSwapImpl(const unsigned char* data, size_t size) : in(data), out(data, data + size), reader(data, size) {}
 
-			for (int c = 0; c < sz / 2; c++) {
-				t = out[i + c];
-				out[i + c] = out[i + (sz - c) - 1];
-				out[i + (sz - c) - 1] = t;
+		void endianSwap(size_t i, size_t sz) {
+			if ((i >= out.size()) || (out.size() - i < sz)) return;
+			reverse(out.begin() + i, out.begin() + i + sz);
+		}
+
+		void endianSwapWords(size_t i, size_t sz, size_t count) {
+			if (i >= out.size()) return;
+
+			size_t available = (out.size() - i) / sz;
+			if (count > available) count = available;
+
+			for (size_t c = 0; c < count; c++) {
+				reverse(out.begin() + i + c * sz, out.begin() + i + (c + 1) * sz);
 			}
 		}
 
-		list<HavokClassName> class_names;
 		list<HavokType> types;
-		list<HavokLink> type_links;
-		list<HavokLink> data_links;
-		list<HavokPointer> data_pointers;
-		list<HavokPointer> data_global_pointers;
+		unordered_map<unsigned int, HavokType*> types_by_address;
+		unordered_map<string, vector<HavokType*>> types_by_name;
+		unordered_map<unsigned int, unsigned int> type_links;
+		unordered_map<unsigned int, unsigned int> data_pointers;
+
+		vector<HavokSwapProgram> programs;
+		unordered_map<string, size_t> program_indices;
+		vector<HavokSwapFrame> frames;
 
 		void endianSwap(HavokPackfileHeader& header) {
 			header.user_tag = 0;
@@ -197,141 +306,144 @@ namespace {
 			out[17] = 1;
 		}
 
-		void convertElement(LibGens::File* fp, int main_type) {
-			if ((main_type == TYPE_INT16) || (main_type == TYPE_UINT16) || (main_type == TYPE_HALF)) {
-				endianSwap(fp->getCurrentAddress(), 2);
-				fp->seek(2, SEEK_CUR);
-			}
-			else if ((main_type == TYPE_INT32) || (main_type == TYPE_UINT32) || (main_type == TYPE_REAL) || (main_type == TYPE_POINTER) || (main_type == TYPE_ULONG) || (main_type == TYPE_STRING_POINTER) || (main_type == TYPE_CSTRING)) {
-				endianSwap(fp->getCurrentAddress(), 4);
-				fp->seek(4, SEEK_CUR);
-			}
-			else if (main_type == TYPE_VARIANT) {
-				endianSwap(fp->getCurrentAddress(), 4);
-				endianSwap(fp->getCurrentAddress() + 4, 4);
-				fp->seek(8, SEEK_CUR);
-			}
-			else if ((main_type == TYPE_INT64) || (main_type == TYPE_UINT64)) {
-				endianSwap(fp->getCurrentAddress(), 8);
-				fp->seek(8, SEEK_CUR);
-			}
-			else if ((main_type == TYPE_VECTOR4) || (main_type == TYPE_QUATERNION)) {
-				endianSwap(fp->getCurrentAddress(), 4);
-				endianSwap(fp->getCurrentAddress() + 4, 4);
-				endianSwap(fp->getCurrentAddress() + 8, 4);
-				endianSwap(fp->getCurrentAddress() + 12, 4);
-				fp->seek(16, SEEK_CUR);
-			}
-			else if ((main_type == TYPE_MATRIX3) || (main_type == TYPE_ROTATION) || (main_type == TYPE_QSTRANSFORM)) {
-				for (int j = 0; j < 12; j++) endianSwap(fp->getCurrentAddress() + j * 4, 4);
+		void compileStructure(const string& type_name, unsigned int offset, vector<HavokSwapOp>* ops, set<string>* inlined) {
+			unordered_map<string, vector<HavokType*>>::iterator named = types_by_name.find(type_name);
+			if (named == types_by_name.end()) return;
 
-				fp->seek(4 * 12, SEEK_CUR);
-			}
-			else if ((main_type == TYPE_MATRIX4) || (main_type == TYPE_TRANSFORM)) {
-				for (int j = 0; j < 16; j++) endianSwap(fp->getCurrentAddress() + j * 4, 4);
+			// A structure that embeds itself has no finite layout
+			if (!inlined->insert(type_name).second) return;
 
-				fp->seek(4 * 16, SEEK_CUR);
-			}
-			else if ((main_type == TYPE_ARRAY) || (main_type == TYPE_HOMOGENEOUS_ARRAY)) {
-				endianSwap(fp->getCurrentAddress(), 4);
-				endianSwap(fp->getCurrentAddress() + 4, 4);
-				endianSwap(fp->getCurrentAddress() + 8, 4);
-			}
-			else fp->seek(1, SEEK_CUR);
-		}
+			for (size_t t = 0; t < named->second.size(); t++) {
+				HavokType* type = named->second[t];
 
-		void convertStructure(LibGens::File* fp, string type_name) {
-			unsigned int start = fp->getCurrentAddress();
-			bool found = false;
+				if (type->parent) compileStructure(type->parent->name, offset, ops, inlined);
 
-			for (list<HavokType>::iterator it = types.begin(); it != types.end(); it++) {
-				if ((*it).name != type_name) continue;
-				unsigned int array_offset = start + (*it).object_size;
-				found = true;
+				for (size_t i = 0; i < type->members.size(); i++) {
+					HavokTypeMember& member = type->members[i];
+					int main_type = member.tag[0];
+					int sub_type = member.tag[1];
+					unsigned int member_offset = offset + member.offset;
 
-				if ((*it).parent) convertStructure(fp, (*it).parent->name);
+					if (main_type == TYPE_ENUM) main_type = sub_type;
 
-				for (int i = 0; i < (*it).members.size(); i++) {
-					int main_type = (*it).members[i].tag[0];
-					int sub_type =(*it).members[i].tag[1];
+					if (main_type == TYPE_STRUCT) compileStructure(member.structure, member_offset, ops, inlined);
 
-					fp->seek(start + (*it).members[i].offset, SEEK_SET);
+					else if (main_type == TYPE_POINTER) {
+						HavokSwapOp op = { SWAP_OP_WORDS, 0, member_offset, 4, 1, 0, 0 };
+						ops->push_back(op);
+					}
+					else if ((main_type == TYPE_ARRAY) || (main_type == TYPE_SIMPLE_ARRAY)) {
+						HavokSwapOp header = { SWAP_OP_WORDS, 0, member_offset, 4, (main_type == TYPE_ARRAY) ? 3u : 2u, 0, 0 };
+						ops->push_back(header);
 
-					if (main_type == TYPE_ENUM) main_type = sub_type;
+						HavokSwapOp op = { SWAP_OP_ARRAY, (unsigned char)sub_type, member_offset, 0, 0, 1, 0 };
 
-					if (main_type == TYPE_STRUCT) convertStructure(fp, (*it).members[i].structure);
+						unordered_map<string, vector<HavokType*>>::iterator element = types_by_name.find(member.structure);
+						if (element != types_by_name.end()) {
+							op.stride = element->second.front()->object_size;
+						}
 
-					else if (main_type == TYPE_POINTER) {
-						endianSwap(fp->getCurrentAddress(), 4);
+						if (sub_type == TYPE_STRUCT) op.program = getProgram(member.structure);
+						ops->push_back(op);
+					}
+					else {
+						unsigned int count = member.array_size;
+						if (count == 0) count = 1;
 
-						for (list<HavokPointer>::iterator it2 = data_pointers.begin(); it2 != data_pointers.end(); it2++) {
-							if (fp->getCurrentAddress() == (*it2).abs_address) {
-								fp->seek((*it2).target_address, SEEK_SET);
-								break;
-							}
+						HavokElementLayout layout = getElementLayout(main_type);
+						if (!layout.swap_count) continue;
+						if (!layout.advance) {
+							if (!(count & 1)) continue;
+							count = 1;
 						}
+
+						HavokSwapOp op = { SWAP_OP_WORDS, 0, member_offset, layout.swap_size, layout.swap_count * count, 0, 0 };
+						ops->push_back(op);
 					}
-					else if ((main_type == TYPE_ARRAY) || (main_type == TYPE_SIMPLE_ARRAY)) {
-						unsigned int count = 0;
+				}
+			}
 
-						fp->seek(4, SEEK_CUR);
-						fp->read(&count, sizeof(unsigned int));
-						Endian::swap(count);
+			inlined->erase(type_name);
+		}
 
-						endianSwap(fp->getCurrentAddress() - 8, 4);
-						endianSwap(fp->getCurrentAddress() - 4, 4);
+		size_t getProgram(const string& type_name) {
+			unordered_map<string, size_t>::iterator it = program_indices.find(type_name);
+			if (it != program_indices.end()) return it->second;
 
-						if (main_type == TYPE_ARRAY) endianSwap(fp->getCurrentAddress(), 4);
+			// Registered before compiling so arrays of the structure inside itself refer back to it
+			size_t index = programs.size();
+			programs.push_back(HavokSwapProgram());
+			program_indices[type_name] = index;
 
-						if (count == 0) {
-							continue;
-						}
+			vector<HavokSwapOp> ops;
+			set<string> inlined;
+			compileStructure(type_name, 0, &ops, &inlined);
+			programs[index].ops = move(ops);
+			return index;
+		}
 
-						for (list<HavokPointer>::iterator it2 = data_pointers.begin(); it2 != data_pointers.end(); it2++) {
-							if ((fp->getCurrentAddress() - 8) == (*it2).abs_address) {
-								fp->seek((*it2).target_address, SEEK_SET);
-								break;
-							}
-						}
+		void convertStructure(const string& type_name, unsigned int address) {
+			HavokSwapFrame root = { getProgram(type_name), 0, address, 0, 0 };
+			frames.push_back(root);
 
-						unsigned int newaddr = fp->getCurrentAddress();
-						unsigned int sz = 1;
+			while (!frames.empty()) {
+				HavokSwapFrame& frame = frames.back();
 
-						for (list<HavokType>::iterator it2 = types.begin(); it2 != types.end(); it2++) {
-							if ((*it2).name == (*it).members[i].structure) {
-								sz = (*it2).object_size;
-								break;
-							}
-						}
+				if (frame.count) {
+					HavokSwapFrame element = { frame.program, 0, frame.address, 0, 0 };
+					frame.address += frame.stride;
+					frame.count--;
 
-						for (int j = 0; j < count; j++) {
-							if (sub_type == TYPE_STRUCT) {
-								fp->seek(newaddr + j * sz, SEEK_SET);
-								convertStructure(fp, (*it).members[i].structure);
-							}
-							else {
-								if (sub_type == TYPE_POINTER) {
-								}
-								else {
-									convertElement(fp, sub_type);
-								}
-							}
-						}
+					// Elements past the end of the data have nothing left to convert
+					if (!frame.count || (element.address >= out.size())) frames.pop_back();
+					if (element.address < out.size()) frames.push_back(element);
+					continue;
+				}
+
+				const vector<HavokSwapOp>& ops = programs[frame.program].ops;
+				if (frame.op >= ops.size()) {
+					frames.pop_back();
+					continue;
+				}
+
+				const HavokSwapOp& op = ops[frame.op++];
+				unsigned int op_address = frame.address + op.offset;
+
+				if (op.op == SWAP_OP_WORDS) {
+					endianSwapWords(op_address, op.size, op.count);
+					continue;
+				}
+
+				unsigned int count = reader.readBE32((size_t)op_address + 4);
+				if (count == 0) continue;
+
+				unsigned int elements_address = op_address + 8;
+				unordered_map<unsigned int, unsigned int>::iterator pointer = data_pointers.find(op_address);
+				if (pointer != data_pointers.end()) elements_address = pointer->second;
+
+				if (op.element_type == TYPE_STRUCT) {
+					HavokSwapFrame elements = { op.program, 0, elements_address, count, op.stride };
+					frames.push_back(elements);
+				}
+				else if (op.element_type != TYPE_POINTER) {
+					HavokElementLayout layout = getElementLayout(op.element_type);
+					if (!layout.swap_count) continue;
+
+					if (!layout.advance) {
+						if (count & 1) endianSwapWords(elements_address, layout.swap_size, layout.swap_count);
 					}
 					else {
-						unsigned int count = (*it).members[i].array_size;
-						if (count == 0) count = 1;
-
-						for (int j = 0; j < count; j++) {
-							convertElement(fp, main_type);
-						}
+						size_t available = (elements_address < out.size()) ? (out.size() - elements_address) / layout.advance : 0;
+						if (count > available) count = available;
+						endianSwapWords(elements_address, layout.swap_size, (size_t)layout.swap_count * count);
 					}
 				}
 			}
 		}
 
-		void readData(HavokPackfileSectionHeader& header, LibGens::File* fp) {
-			fp->seek(header.absolute_data_start, SEEK_SET);
+		// Fixup tables end at their terminator, their next table or, for truncated files, the end of the data
+		void readData(HavokPackfileSectionHeader& header) {
+			reader.seek(header.absolute_data_start, SEEK_SET);
 
 			if (!strcmp(header.section_tag, "__classnames__")) {
 				HavokClassName classname;
@@ -342,24 +454,23 @@ namespace {
 				while (classname.tag != (unsigned int)-1) {
 					classname.name = "";
 
-					fp->read(&classname.tag, sizeof(unsigned int));
+					if (reader.read(&classname.tag, sizeof(unsigned int)) != sizeof(unsigned int)) break;
 					Endian::swap(classname.tag);
-					endianSwap(fp->getCurrentAddress() - 4, 4);
+					endianSwap(reader.getCurrentAddress() - 4, 4);
 
 					if ((classname.tag == (unsigned int)-1) || (classname.tag == 0)) {
 						break;
 					}
 					else {
-						fp->seek(1, SEEK_CUR);
+						reader.seek(1, SEEK_CUR);
 						char c = 0;
 						for (int i = 0; i < 256; i++) {
-							fp->read(&c, sizeof(char));
+							reader.read(&c, sizeof(char));
 							if (!c) break;
 
 							classname.name += c;
 						}
 
-						class_names.push_back(classname);
 					}
 
 					i++;
@@ -369,83 +480,79 @@ namespace {
 			if (!strcmp(header.section_tag, "__types__")) {
 				int i = 0;
 				while (true) {
-					fp->seek(header.absolute_data_start + header.local_fixups_offset + i * 4, SEEK_SET);
+					reader.seek(header.absolute_data_start + header.local_fixups_offset + i * 4, SEEK_SET);
 
 					unsigned int address = 0;
-					fp->read(&address, sizeof(unsigned int));
+					if (reader.read(&address, sizeof(unsigned int)) != sizeof(unsigned int)) break;
 					Endian::swap(address);
 					if (address == (unsigned int)-1) break;
 
-					endianSwap(fp->getCurrentAddress() - 4, 4);
+					endianSwap(reader.getCurrentAddress() - 4, 4);
 
-					if (fp->getCurrentAddress() >= header.absolute_data_start + header.global_fixups_offset) break;
+					if (reader.getCurrentAddress() >= header.absolute_data_start + header.global_fixups_offset) break;
 
 					i++;
 				}
 
 				i = 0;
 				while (true) {
-					fp->seek(header.absolute_data_start + header.global_fixups_offset + i * 12, SEEK_SET);
+					reader.seek(header.absolute_data_start + header.global_fixups_offset + i * 12, SEEK_SET);
 
 					unsigned int address = 0;
 					unsigned int type = 0;
 					unsigned int meta_address = 0;
-					fp->read(&address, sizeof(unsigned int));
+					if (reader.read(&address, sizeof(unsigned int)) != sizeof(unsigned int)) break;
 					Endian::swap(address);
 					if (address == (unsigned int)-1) break;
 
-					fp->read(&type, sizeof(unsigned int));
+					reader.read(&type, sizeof(unsigned int));
 					Endian::swap(type);
 
-					fp->read(&meta_address, sizeof(unsigned int));
+					reader.read(&meta_address, sizeof(unsigned int));
 					Endian::swap(meta_address);
 
-					HavokLink link;
-					link.address_1 = header.absolute_data_start + address;
-					link.address_2 = header.absolute_data_start + meta_address;
-					link.type = type;
-					type_links.push_back(link);
+					type_links.emplace(header.absolute_data_start + address, header.absolute_data_start + meta_address);
 
-					endianSwap(fp->getCurrentAddress() - 12, 4);
-					endianSwap(fp->getCurrentAddress() - 8, 4);
-					endianSwap(fp->getCurrentAddress() - 4, 4);
+					endianSwap(reader.getCurrentAddress() - 12, 4);
+					endianSwap(reader.getCurrentAddress() - 8, 4);
+					endianSwap(reader.getCurrentAddress() - 4, 4);
 
-					if (fp->getCurrentAddress() >= header.absolute_data_start + header.virtual_fixups_offset) break;
+					if (reader.getCurrentAddress() >= header.absolute_data_start + header.virtual_fixups_offset) break;
 
 					i++;
 				}
 
 				i = 0;
 				while (true) {
-					fp->seek(header.absolute_data_start + header.virtual_fixups_offset + i * 12, SEEK_SET);
+					reader.seek(header.absolute_data_start + header.virtual_fixups_offset + i * 12, SEEK_SET);
 
 					unsigned int address = 0;
 					unsigned int name_address = 0;
 					string type_name = "";
 
-					fp->read(&address, sizeof(unsigned int));
-					fp->seek(4, SEEK_CUR);
+					if (reader.read(&address, sizeof(unsigned int)) != sizeof(unsigned int)) break;
+					reader.seek(4, SEEK_CUR);
 
 					if (((address == 0) && (i != 0)) || (address == (unsigned int)-1)) break;
 
-					fp->read(&name_address, sizeof(unsigned int));
+					reader.read(&name_address, sizeof(unsigned int));
 
 					Endian::swap(address);
 					Endian::swap(name_address);
 
-					endianSwap(fp->getCurrentAddress() - 4, 4);
-					endianSwap(fp->getCurrentAddress() - 8, 4);
-					endianSwap(fp->getCurrentAddress() - 12, 4);
+					endianSwap(reader.getCurrentAddress() - 4, 4);
+					endianSwap(reader.getCurrentAddress() - 8, 4);
+					endianSwap(reader.getCurrentAddress() - 12, 4);
 
-					fp->seek(class_name_global_address + name_address, SEEK_SET);
+					reader.seek(class_name_global_address + name_address, SEEK_SET);
 					for (int k = 0; k < 256; k++) {
 						char c = 0;
-						fp->read(&c, sizeof(char));
+						reader.read(&c, sizeof(char));
 						if (c) type_name += c;
 						else break;
 					}
 
-					fp->seek(header.absolute_data_start + address, SEEK_SET);
+					reader.seek(header.absolute_data_start + address, SEEK_SET);
 
 					HavokType type;
 					type.reset();
@@ -457,65 +564,63 @@ namespace {
 						continue;
 					}
 
-					fp->seek(4, SEEK_CUR);
+					reader.seek(4, SEEK_CUR);
 
-					for (list<HavokLink>::iterator it = type_links.begin(); it != type_links.end(); it++) {
-						if ((*it).address_1 == fp->getCurrentAddress()) {
-							type.parent_address = (*it).address_2;
-							break;
-						}
+					unordered_map<unsigned int, unsigned int>::iterator parent_link = type_links.find(reader.getCurrentAddress());
+					if (parent_link != type_links.end()) {
+						type.parent_address = parent_link->second;
 					}
 
-					fp->seek(4, SEEK_CUR);
-					fp->read(&type.object_size, sizeof(unsigned int));
+					reader.seek(4, SEEK_CUR);
+					reader.read(&type.object_size, sizeof(unsigned int));
 					Endian::swap(type.object_size);
-					endianSwap(fp->getCurrentAddress() - 4, 4);
+					endianSwap(reader.getCurrentAddress() - 4, 4);
 
-					fp->read(&type.num_implemented_interfaces, sizeof(unsigned int));
+					reader.read(&type.num_implemented_interfaces, sizeof(unsigned int));
 					Endian::swap(type.num_implemented_interfaces);
-					endianSwap(fp->getCurrentAddress() - 4, 4);
+					endianSwap(reader.getCurrentAddress() - 4, 4);
 
-					fp->seek(4, SEEK_CUR);
+					reader.seek(4, SEEK_CUR);
 
-					fp->read(&type.declared_enums, sizeof(unsigned int));
+					reader.read(&type.declared_enums, sizeof(unsigned int));
 					Endian::swap(type.declared_enums);
-					endianSwap(fp->getCurrentAddress() - 4, 4);
+					endianSwap(reader.getCurrentAddress() - 4, 4);
 
-					fp->seek(4, SEEK_CUR);
+					reader.seek(4, SEEK_CUR);
 
 					unsigned int membernum = 0;
-					fp->read(&membernum, sizeof(unsigned int));
+					reader.read(&membernum, sizeof(unsigned int));
 					Endian::swap(membernum);
-					endianSwap(fp->getCurrentAddress() - 4, 4);
+					endianSwap(reader.getCurrentAddress() - 4, 4);
 
 					if (type_name == "hkClass") {
-						fp->seek(12, SEEK_CUR);
-						fp->read(&type.described_version, sizeof(unsigned int));
+						reader.seek(12, SEEK_CUR);
+						reader.read(&type.described_version, sizeof(unsigned int));
 						Endian::swap(type.described_version);
-						endianSwap(fp->getCurrentAddress() - 4, 4);
+						endianSwap(reader.getCurrentAddress() - 4, 4);
 					}
 
 					char c = 0;
 					type.name = "";
 					for (int k = 0; k < 256; k++) {
-						fp->read(&c, sizeof(char));
+						reader.read(&c, sizeof(char));
 						if (!c) break;
 
 						type.name += c;
 					}
 
-					fp->fixPaddingRead(16);
+					reader.fixPaddingRead(16);
 
 					if (type_name == "hkClass") {
 						vector<int> subs_sizes;
 						for (int j = 0; j < type.declared_enums; j++) {
-							fp->seek(8, SEEK_CUR);
+							reader.seek(8, SEEK_CUR);
 							int sz = 0;
-							fp->read(&sz, sizeof(int));
+							reader.read(&sz, sizeof(int));
 							Endian::swap(sz);
-							endianSwap(fp->getCurrentAddress() - 4, 4);
+							endianSwap(reader.getCurrentAddress() - 4, 4);
 
-							fp->seek(8, SEEK_CUR);
+							reader.seek(8, SEEK_CUR);
 
 							subs_sizes.push_back(sz);
 						}
@@ -524,43 +629,43 @@ namespace {
 							string nm = "";
 							for (int k = 0; k < 256; k++) {
 								char c = 0;
-								fp->read(&c, sizeof(char));
+								reader.read(&c, sizeof(char));
 
 								if (c) nm += c;
 								else break;
 							}
-							fp->fixPaddingRead(16);
+							reader.fixPaddingRead(16);
 
 							vector<HavokEnum> subs;
 							subs.clear();
 							type.sub_enum_names.push_back(nm);
 
-							fp->fixPaddingRead(16);
+							reader.fixPaddingRead(16);
 
 							HavokEnum en;
 							for (int x = 0; x < subs_sizes[j]; x++) {
-								fp->read(&en.id, sizeof(unsigned int));
+								reader.read(&en.id, sizeof(unsigned int));
 								Endian::swap(en.id);
-								endianSwap(fp->getCurrentAddress() - 4, 4);
+								endianSwap(reader.getCurrentAddress() - 4, 4);
 
 								en.name = "";
-								fp->seek(4, SEEK_CUR);
+								reader.seek(4, SEEK_CUR);
 
 								subs.push_back(en);
 							}
 
-							fp->fixPaddingRead(16);
+							reader.fixPaddingRead(16);
 
 							for (int x = 0; x < subs_sizes[j]; x++) {
 								for (int k = 0; k < 256; k++) {
 									char c = 0;
-									fp->read(&c, sizeof(char));
+									reader.read(&c, sizeof(char));
 
 									if (c) subs[x].name += c;
 									else break;
 								}
 
-								fp->fixPaddingRead(16);
+								reader.fixPaddingRead(16);
 
 								type.sub_enums.push_back(subs);
 							}
@@ -568,216 +673,195 @@ namespace {
 
 						HavokTypeMember typemember;
 						for (int j = 0; j < membernum; j++) {
-							fp->seek(4, SEEK_CUR);
+							reader.seek(4, SEEK_CUR);
 
 							typemember.structure_address = 0;
 
-							for (list<HavokLink>::iterator it = type_links.begin(); it != type_links.end(); it++) {
-								if ((*it).address_1 == fp->getCurrentAddress()) {
-									typemember.structure_address = (*it).address_2;
-									break;
-								}
+							unordered_map<unsigned int, unsigned int>::iterator structure_link = type_links.find(reader.getCurrentAddress());
+							if (structure_link != type_links.end()) {
+								typemember.structure_address = structure_link->second;
 							}
 
-							fp->seek(8, SEEK_CUR);
+							reader.seek(8, SEEK_CUR);
 
-							fp->read(typemember.tag, 2);
+							reader.read(typemember.tag, 2);
 
-							fp->read(&typemember.array_size, sizeof(unsigned short));
+							reader.read(&typemember.array_size, sizeof(unsigned short));
 							Endian::swap(typemember.array_size);
 
-							fp->read(&typemember.struct_type, sizeof(unsigned short));
+							reader.read(&typemember.struct_type, sizeof(unsigned short));
 							Endian::swap(typemember.struct_type);
 
-							fp->read(&typemember.offset, sizeof(unsigned short));
+							reader.read(&typemember.offset, sizeof(unsigned short));
 							Endian::swap(typemember.offset);
 
-							endianSwap(fp->getCurrentAddress() - 6, 2);
-							endianSwap(fp->getCurrentAddress() - 4, 2);
-							endianSwap(fp->getCurrentAddress() - 2, 2);
+							endianSwap(reader.getCurrentAddress() - 6, 2);
+							endianSwap(reader.getCurrentAddress() - 4, 2);
+							endianSwap(reader.getCurrentAddress() - 2, 2);
 
 							typemember.name = "";
 							typemember.structure = "";
 
 							type.members.push_back(typemember);
-							fp->seek(4, SEEK_CUR);
+							reader.seek(4, SEEK_CUR);
 						}
 
 						for (int j = 0; j < membernum; j++) {
 							type.members[j].name = "";
 							for (int k = 0; k < 256; k++) {
 								char c = 0;
-								fp->read(&c, sizeof(char));
+								reader.read(&c, sizeof(char));
 
 								if (c) type.members[j].name += c;
 								else break;
 							}
 
-							fp->fixPaddingRead(16);
+							reader.fixPaddingRead(16);
 						}
 					}
 					else {
 						HavokEnum en;
 
 						for (int j = 0; j < type.object_size; j++) {
-							fp->read(&en.id, sizeof(unsigned int));
+							reader.read(&en.id, sizeof(unsigned int));
 							Endian::swap(en.id);
-							endianSwap(fp->getCurrentAddress() - 4, 4);
+							endianSwap(reader.getCurrentAddress() - 4, 4);
 
 							en.name = "";
 
-							fp->seek(4, SEEK_CUR);
+							reader.seek(4, SEEK_CUR);
 
 							type.enums.push_back(en);
 						}
-						fp->fixPaddingRead(16);
+						reader.fixPaddingRead(16);
 
 						for (int j = 0; j < type.object_size; j++) {
 							for (int k = 0; k < 256; k++) {
 								char c = 0;
-								fp->read(&c, sizeof(char));
+								reader.read(&c, sizeof(char));
 
 								if (c) type.enums[j].name += c;
 								else break;
 							}
 
-							fp->fixPaddingRead(16);
+							reader.fixPaddingRead(16);
 						}
 					}
 
 					types.push_back(type);
+					types_by_address.emplace(type.address, &types.back());
+					types_by_name[type.name].push_back(&types.back());
 					i++;
 				}
 
-				i = 0;
-				for (list<HavokLink>::iterator it = type_links.begin(); it != type_links.end(); it++) {
-					(*it).type_parent = NULL;
-					(*it).type_node = NULL;
-
-					i++;
-				}
-
-				int j = 0;
 				for (list<HavokType>::iterator it = types.begin(); it != types.end(); it++) {
 					if ((*it).class_name != "hkClass") continue;
 
 					if ((*it).parent_address) {
-						for (list<HavokType>::iterator it2 = types.begin(); it2 != types.end(); it2++) {
-							if ((*it2).address == (*it).parent_address) {
-								(*it).parent = &(*it2);
-								break;
-							}
+						unordered_map<unsigned int, HavokType*>::iterator parent = types_by_address.find((*it).parent_address);
+						if (parent != types_by_address.end()) {
+							(*it).parent = parent->second;
 						}
 					}
 
 					for (int x = 0; x < (*it).members.size(); x++) {
 						if ((*it).members[x].structure_address) {
-							for (list<HavokType>::iterator it2 = types.begin(); it2 != types.end(); it2++) {
-								if ((*it2).address == (*it).members[x].structure_address) {
-									(*it).members[x].structure = (*it2).name;
-									break;
-								}
+							unordered_map<unsigned int, HavokType*>::iterator structure = types_by_address.find((*it).members[x].structure_address);
+							if (structure != types_by_address.end()) {
+								(*it).members[x].structure = structure->second->name;
 							}
 						}
 					}
-
-					j++;
 				}
+
+				// Programs compiled so far may have missed the types of this section
+				programs.clear();
+				program_indices.clear();
 			}
 
 			if (!strcmp(header.section_tag, "__data__")) {
 				int i = 0;
 				while (true) {
-					fp->seek(header.absolute_data_start + header.local_fixups_offset + i * 8, SEEK_SET);
+					reader.seek(header.absolute_data_start + header.local_fixups_offset + i * 8, SEEK_SET);
 
 					unsigned int address = 0;
 					unsigned int address_2 = 0;
-					fp->read(&address, sizeof(unsigned int));
+					if (reader.read(&address, sizeof(unsigned int)) != sizeof(unsigned int)) break;
 					Endian::swap(address);
 					if (address == (unsigned int)-1) break;
 
-					fp->read(&address_2, sizeof(unsigned int));
+					reader.read(&address_2, sizeof(unsigned int));
 					Endian::swap(address_2);
 
-					endianSwap(fp->getCurrentAddress() - 8, 4);
-					endianSwap(fp->getCurrentAddress() - 4, 4);
-
-					HavokPointer pointer;
+					endianSwap(reader.getCurrentAddress() - 8, 4);
+					endianSwap(reader.getCurrentAddress() - 4, 4);
 
-					pointer.abs_address = address + header.absolute_data_start;
-					pointer.target_address = address_2 + header.absolute_data_start;
+					data_pointers.emplace(address + header.absolute_data_start, address_2 + header.absolute_data_start);
 
-					data_pointers.push_back(pointer);
-
-					if (fp->getCurrentAddress() >= header.absolute_data_start + header.global_fixups_offset) break;
+					if (reader.getCurrentAddress() >= header.absolute_data_start + header.global_fixups_offset) break;
 
 					i++;
 				}
 
 				i = 0;
 				while (true) {
-					fp->seek(header.absolute_data_start + header.global_fixups_offset + i * 12, SEEK_SET);
+					reader.seek(header.absolute_data_start + header.global_fixups_offset + i * 12, SEEK_SET);
 
 					unsigned int address = 0;
 					unsigned int type = 0;
 					unsigned int meta_address = 0;
-					fp->read(&address, sizeof(unsigned int));
+					if (reader.read(&address, sizeof(unsigned int)) != sizeof(unsigned int)) break;
 					Endian::swap(address);
 					if (address == (unsigned int)-1) break;
 
-					fp->read(&type, sizeof(unsigned int));
+					reader.read(&type, sizeof(unsigned int));
 					Endian::swap(type);
 
-					fp->read(&meta_address, sizeof(unsigned int));
+					reader.read(&meta_address, sizeof(unsigned int));
 					Endian::swap(meta_address);
 
-					endianSwap(fp->getCurrentAddress() - 12, 4);
-					endianSwap(fp->getCurrentAddress() - 8, 4);
-					endianSwap(fp->getCurrentAddress() - 4, 4);
-
-					HavokPointer pointer;
-					pointer.abs_address = address + header.absolute_data_start;
-					pointer.target_address = meta_address + header.absolute_data_start;
-					data_global_pointers.push_back(pointer);
+					endianSwap(reader.getCurrentAddress() - 12, 4);
+					endianSwap(reader.getCurrentAddress() - 8, 4);
+					endianSwap(reader.getCurrentAddress() - 4, 4);
 
-					if (fp->getCurrentAddress() >= header.absolute_data_start + header.virtual_fixups_offset) break;
+					if (reader.getCurrentAddress() >= header.absolute_data_start + header.virtual_fixups_offset) break;
 
 					i++;
 				}
 
 				i = 0;
 				while (true) {
-					fp->seek(header.absolute_data_start + header.virtual_fixups_offset + i * 12, SEEK_SET);
+					reader.seek(header.absolute_data_start + header.virtual_fixups_offset + i * 12, SEEK_SET);
 
 					unsigned int address = 0;
 					unsigned int name_address = 0;
 					string type_name = "";
 
-					fp->read(&address, sizeof(unsigned int));
-					fp->seek(4, SEEK_CUR);
+					if (reader.read(&address, sizeof(unsigned int)) != sizeof(unsigned int)) break;
+					reader.seek(4, SEEK_CUR);
 					Endian::swap(address);
 					if (address == (unsigned int)-1) break;
 
-					fp->read(&name_address, sizeof(unsigned int));
+					reader.read(&name_address, sizeof(unsigned int));
 
-					endianSwap(fp->getCurrentAddress() - 4, 4);
-					endianSwap(fp->getCurrentAddress() - 8, 4);
-					endianSwap(fp->getCurrentAddress() - 12, 4);
+					endianSwap(reader.getCurrentAddress() - 4, 4);
+					endianSwap(reader.getCurrentAddress() - 8, 4);
+					endianSwap(reader.getCurrentAddress() - 12, 4);
 
 					Endian::swap(name_address);
-					unsigned back = fp->getCurrentAddress();
+					unsigned back = reader.getCurrentAddress();
 
-					fp->seek(class_name_global_address + name_address, SEEK_SET);
+					reader.seek(class_name_global_address + name_address, SEEK_SET);
 					for (int k = 0; k < 256; k++) {
 						char c = 0;
-						fp->read(&c, sizeof(char));
+						reader.read(&c, sizeof(char));
 						if (c) type_name += c;
 						else break;
 					}
 
-					fp->seek(header.absolute_data_start + address, SEEK_SET);
+					reader.seek(header.absolute_data_start + address, SEEK_SET);
 
-					convertStructure(fp, type_name);
+					convertStructure(type_name, reader.getCurrentAddress());
 
 					if (back >= header.absolute_data_start + header.exports_offset) break;
 
@@ -789,34 +873,92 @@ namespace {
 }
 
 namespace LibGens {
-	vector<unsigned char> endianSwapHKX(File* file) {
-		HavokEndianSwapImpl impl;
-		impl.out.resize(file->getFileSize());
-		file->read(impl.out.data(), impl.out.size());
+	vector<unsigned char> endianSwapHKX(const unsigned char* data, size_t size) {
+		if (size < sizeof(HavokPackfileHeader)) {
+			Error::addMessage(Error::EXCEPTION, LIBGENS_HAVOK_ENDIAN_SWAP_H_ERROR_HEADER);
+			return vector<unsigned char>();
+		}
+
+		HavokEndianSwapImpl impl(data, size);
 
 		HavokPackfileHeader header;
-		file->goToAddress(0);
-		file->read(&header, sizeof(HavokPackfileHeader));
+		impl.reader.read(&header, sizeof(HavokPackfileHeader));
 		impl.endianSwap(header);
 
 		for (int i = 0; i < header.num_sections; i++) {
 			HavokPackfileSectionHeader section_header;
-			file->read(&section_header, sizeof(HavokPackfileSectionHeader));
+			if (impl.reader.read(&section_header, sizeof(HavokPackfileSectionHeader)) != sizeof(HavokPackfileSectionHeader)) break;
 			section_header.endianSwap();
 
-			impl.endianSwap(file->getCurrentAddress() - 28, 4);
-			impl.endianSwap(file->getCurrentAddress() - 24, 4);
-			impl.endianSwap(file->getCurrentAddress() - 20, 4);
-			impl.endianSwap(file->getCurrentAddress() - 16, 4);
-			impl.endianSwap(file->getCurrentAddress() - 12, 4);
-			impl.endianSwap(file->getCurrentAddress() - 8, 4);
-			impl.endianSwap(file->getCurrentAddress() - 4, 4);
-
-			unsigned int address = file->getCurrentAddress();
-			impl.readData(section_header, file);
-			file->seek(address, SEEK_SET);
+			impl.endianSwap(impl.reader.getCurrentAddress() - 28, 4);
+			impl.endianSwap(impl.reader.getCurrentAddress() - 24, 4);
+			impl.endianSwap(impl.reader.getCurrentAddress() - 20, 4);
+			impl.endianSwap(impl.reader.getCurrentAddress() - 16, 4);
+			impl.endianSwap(impl.reader.getCurrentAddress() - 12, 4);
+			impl.endianSwap(impl.reader.getCurrentAddress() - 8, 4);
+			impl.endianSwap(impl.reader.getCurrentAddress() - 4, 4);
+
+			size_t address = impl.reader.getCurrentAddress();
+			impl.readData(section_header);
+			impl.reader.seek(address, SEEK_SET);
 		}
 
 		return move(impl.out);
 	}
-}
\ No newline at end of file
+
+	vector<unsigned char> endianSwapHKX(File* file) {
+		size_t memory_size = 0;
+		const unsigned char* memory = file->getMemoryData(&memory_size);
+		if (memory) {
+			return endianSwapHKX(memory, memory_size);
+		}
+
+		vector<unsigned char> data(file->getFileSize());
+		file->goToAddress(0);
+		file->read(data.data(), data.size());
+		return endianSwapHKX(data.data(), data.size());
+	}
+
+	bool endianSwapHKX(const vector<string>& sources, const vector<string>& destinations) {
+		if (sources.size() != destinations.size()) {
+			Error::addMessage(Error::EXCEPTION, LIBGENS_HAVOK_ENDIAN_SWAP_H_ERROR_BATCH);
+			return false;
+		}
+
+		// Packfiles convert independently of each other, and each one owns its output buffer
+		atomic<bool> converted(true);
+		Parallel::forEach(sources.size(), [&](size_t i) {
+			if (!File::check(sources[i])) {
+				Error::addMessage(Error::FILE_NOT_FOUND, LIBGENS_HAVOK_ENDIAN_SWAP_H_ERROR_READ + sources[i]);
+				converted = false;
+				return;
+			}
+
+			vector<unsigned char> result;
+			{
+				File file(sources[i], LIBGENS_FILE_READ_BINARY);
+				if (file.valid()) {
+					result = endianSwapHKX(&file);
+					file.close();
+				}
+			}
+
+			if (result.empty()) {
+				converted = false;
+				return;
+			}
+
+			File file(destinations[i], LIBGENS_FILE_WRITE_BINARY);
+			if (!file.valid()) {
+				Error::addMessage(Error::FILE_NOT_FOUND, LIBGENS_HAVOK_ENDIAN_SWAP_H_ERROR_WRITE + destinations[i]);
+				converted = false;
+				return;
+			}
+
+			file.write(result.data(), result.size());
+			file.close();
+		});
+
+		return converted;
+	}
+}
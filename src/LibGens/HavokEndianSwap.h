@@ -1,5 +1,17 @@
 #pragma once
 
+#define LIBGENS_HAVOK_ENDIAN_SWAP_H_ERROR_HEADER    "Havok packfile is too small for its header."
+#define LIBGENS_HAVOK_ENDIAN_SWAP_H_ERROR_READ      "Couldn't read Havok packfile "
+#define LIBGENS_HAVOK_ENDIAN_SWAP_H_ERROR_WRITE     "Couldn't write converted Havok packfile "
+#define LIBGENS_HAVOK_ENDIAN_SWAP_H_ERROR_BATCH     "Havok packfile batch needs one destination per source."
+
 namespace LibGens {
+    // Converts a big endian Havok packfile to little endian, returning the converted copy, or nothing
+    // if the data can't hold a packfile header.
+    vector<unsigned char> endianSwapHKX(const unsigned char* data, size_t size);
     vector<unsigned char> endianSwapHKX(File* file);
-}
\ No newline at end of file
+
+    // Converts every source packfile into the destination with the same index, in parallel.
+    // Returns false if any of them failed.
+    bool endianSwapHKX(const vector<string>& sources, const vector<string>& destinations);
+}
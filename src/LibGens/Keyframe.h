@@ -32,4 +32,24 @@ namespace LibGens {
 			float getFrame();
 			float getValue();
 	};
+
+	// Index of the first time greater than time, or times.size(), for times sorted in ascending order. The cursor
+	// is checked first, then the key after it, before falling back to a binary search, so sampling forward in
+	// small steps stays constant time.
+	template<typename T> size_t findKeyframeIndex(const vector<T> &times, T time, size_t *cursor) {
+		size_t count = times.size();
+
+		if (cursor) {
+			for (size_t index=*cursor; (index <= count) && (index <= *cursor + 1); index++) {
+				if ((index == 0 || times[index-1] <= time) && (index == count || time < times[index])) {
+					*cursor = index;
+					return index;
+				}
+			}
+		}
+
+		size_t index = upper_bound(times.begin(), times.end(), time) - times.begin();
+		if (cursor) *cursor = index;
+		return index;
+	}
 };
\ No newline at end of file
@@ -29,6 +29,10 @@ namespace LibGens {
 		return flag;
 	}
 
+	vector<Keyframe *> KeyframeSet::getKeyframes() {
+		return keyframes;
+	}
+
 	void KeyframeSet::read(File *file, vector<Keyframe *> &keyframes_buffer) {
 		unsigned int keyframes_count=0;
 		unsigned int keyframes_index=0;
@@ -38,40 +42,28 @@ namespace LibGens {
 		
 		for (size_t i=keyframes_index; i<keyframes_index+keyframes_count; i++) {
 			keyframes.push_back(keyframes_buffer[i]);
+			frames.push_back(keyframes_buffer[i]->getFrame());
+			values.push_back(keyframes_buffer[i]->getValue());
 
 			//printf("    Keyframe #%d: %f %f\n", (i-keyframes_index), keyframes_buffer[i]->getFrame(), keyframes_buffer[i]->getValue());
 		}
 	}
 
-	float KeyframeSet::getValue(float current_frame) {
-		Keyframe *previous_key=NULL;
-		Keyframe *next_key=NULL;
-
-		float factor=0;
+	float KeyframeSet::getValue(float current_frame, size_t *cursor) {
+		size_t count = frames.size();
+		if (!count) return 0.0f;
 
-		for (size_t i=0; i<keyframes.size(); i++) {
-			previous_key = next_key;
-			next_key = keyframes[i];
-
-			if (next_key->getFrame() > current_frame) {
-				break;
-			}
-		}
+		// Same keys as the original forward scan: before the first key it holds the first value and past
+		// the last key it keeps extrapolating the last two.
+		size_t next = findKeyframeIndex(frames, current_frame, cursor);
+		if (next == 0 || count == 1) return values[0];
+		if (next == count) next = count - 1;
 
-		if (previous_key && next_key) {
-			float frame_offset = current_frame - previous_key->getFrame();
-			float frame_gap    = next_key->getFrame() - previous_key->getFrame();
-			factor = frame_offset / frame_gap;
-
-			return previous_key->getValue() + ((next_key->getValue() - previous_key->getValue()) * factor);
-		}
-		else if (next_key) {
-			return next_key->getValue();
-		}
-		else if (previous_key) {
-			return previous_key->getValue();
-		}
+		size_t previous = next - 1;
+		float frame_offset = current_frame - frames[previous];
+		float frame_gap    = frames[next] - frames[previous];
+		float factor = frame_offset / frame_gap;
 
-		return 0.0f;
+		return values[previous] + ((values[next] - values[previous]) * factor);
 	}
 }
\ No newline at end of file
@@ -23,14 +23,20 @@ namespace LibGens {
 	class File;
 	class Keyframe;
 
+	// Keyframe frames and values are also kept as flat arrays, so sampling is a binary search. Callers
+	// that play forward can pass a cursor: it remembers the last key position and makes consecutive
+	// samples O(1).
 	class KeyframeSet {
 		protected:
 			unsigned int flag;
 			vector<Keyframe *> keyframes;
+			vector<float> frames;
+			vector<float> values;
 		public:
 			KeyframeSet();
 			void read(File *file, vector<Keyframe *> &keyframes_buffer);
 			unsigned int getFlag();
-			float getValue(float current_frame);
+			vector<Keyframe *> getKeyframes();
+			float getValue(float current_frame, size_t *cursor=NULL);
 	};
 };
\ No newline at end of file
@@ -25,9 +25,10 @@
 
 namespace LibGens {
 	Level::Level() {
+		from_snapshot = false;
 	}
 
-	Level::Level(string folder_p, size_t game_mode_p) {
+	Level::Level(string folder_p, size_t game_mode_p, string snapshot_filename) {
 		folder = folder_p;
 		terrain_info_file = "terrain";
 		direct_light_name = "";
@@ -42,11 +43,21 @@ namespace LibGens {
 		spawn_time        = 0.0f;
 
 		game_mode = game_mode_p;
+		from_snapshot = false;
+
+		if (snapshot_filename.size() && File::check(snapshot_filename) && loadSnapshot(snapshot_filename)) {
+			from_snapshot = true;
+			return;
+		}
 
 		loadStage();
 		loadSceneEffect();
 		loadSets();
 		loadTerrain();
+
+		if (snapshot_filename.size()) {
+			saveSnapshot(snapshot_filename);
+		}
 	}
 
 	
@@ -125,6 +136,7 @@ namespace LibGens {
 		if (File::check(path_filename)) {
 			Path *path = new Path(path_filename);
 			paths.push_back(path);
+			path_filenames.push_back(path_filename);
 		}
 	}
 
@@ -191,28 +203,31 @@ namespace LibGens {
 			
 			if (element_name == LIBGENS_LEVEL_XML_CONTAINER) {
 				if (text_ptr) {
-					Path *path = new Path(folder + ToString(text_ptr) + LIBGENS_PATH_FULL_GENERATIONS_EXTENSION);
+					string path_filename = folder + ToString(text_ptr) + LIBGENS_PATH_FULL_GENERATIONS_EXTENSION;
+					Path *path = new Path(path_filename);
 					paths.push_back(path);
+					path_filenames.push_back(path_filename);
 				}
 			}
 		}
 	}
 
 	void Level::loadSets() {
+		vector<string> filenames;
+		vector<string> names;
+
 		// Generations loads all setdata_* files into the game
 		if (game_mode == LIBGENS_LEVEL_GAME_GENERATIONS) {
 			WIN32_FIND_DATA FindFileData;
 			HANDLE hFind;
-			hFind = FindFirstFile((folder+"setdata_*.set.xml").c_str(), &FindFileData);
+			hFind = FindFirstFile((folder+LIBGENS_LEVEL_DATA_SET_FILES).c_str(), &FindFileData);
 			if (hFind == INVALID_HANDLE_VALUE) {} 
 			else {
 				do {
 					const char *name=FindFileData.cFileName;
 					if (name[0]=='.') continue;
 
-					string new_filename=folder+ToString(name);
-					ObjectSet *object_set=new LibGens::ObjectSet(new_filename);
-					addSet(object_set);
+					filenames.push_back(folder+ToString(name));
 				} while (FindNextFile(hFind, &FindFileData) != 0);
 				FindClose(hFind);
 			}
@@ -220,13 +235,21 @@ namespace LibGens {
 		// Unleashed uses the set files that were loaded from Stage.stg.xml
 		else if (game_mode == LIBGENS_LEVEL_GAME_UNLEASHED) {
 			for (list<LevelSetEntry *>::iterator it=set_entries.begin(); it!=set_entries.end(); it++) {
-				string new_filename=folder+(*it)->filename;
-
-				ObjectSet *object_set=new LibGens::ObjectSet(new_filename);
-				object_set->setName((*it)->name);
-				addSet(object_set);
+				filenames.push_back(folder+(*it)->filename);
+				names.push_back((*it)->name);
 			}
 		}
+
+		// Set files don't depend on each other, so they're parsed in parallel and added in the listed order.
+		vector<ObjectSet *> object_sets(filenames.size(), NULL);
+		Parallel::forEach(filenames.size(), [&](size_t i) {
+			object_sets[i] = new LibGens::ObjectSet(filenames[i]);
+		});
+
+		for (size_t i=0; i<object_sets.size(); i++) {
+			if (game_mode == LIBGENS_LEVEL_GAME_UNLEASHED) object_sets[i]->setName(names[i]);
+			addSet(object_sets[i]);
+		}
 	}
 
 
@@ -621,6 +644,394 @@ namespace LibGens {
 	}
 
 
+	static string getSnapshotRelativeFilename(const string &folder, const string &filename) {
+		if (filename.compare(0, folder.size(), folder) == 0) {
+			return filename.substr(folder.size());
+		}
+
+		return filename;
+	}
+
+	static unsigned long long hashSnapshotSource(const string &filename) {
+		// Missing sources hash to 0, so one showing up later is a change too
+		if (!File::check(filename)) {
+			return 0;
+		}
+
+		File file(filename, LIBGENS_FILE_READ_BINARY);
+		if (!file.valid()) {
+			return 0;
+		}
+
+		size_t data_size=0;
+		const unsigned char *data=file.getMemoryData(&data_size);
+		vector<unsigned char> buffer;
+		if (!data) {
+			buffer.resize(file.getFileSize());
+			buffer.resize(file.read(buffer.data(), buffer.size()));
+			data = buffer.data();
+			data_size = buffer.size();
+		}
+
+		unsigned long long hash=XXH3_64bits(data, data_size);
+		file.close();
+		return hash;
+	}
+
+	void Level::listSnapshotSources(vector<string> *filenames) {
+		filenames->push_back(LIBGENS_LEVEL_DATA_STAGE);
+		filenames->push_back(LIBGENS_LEVEL_DATA_TERRAIN);
+		filenames->push_back(LIBGENS_LEVEL_DATA_SCENE_EFFECT);
+		filenames->push_back(ToString(LIBGENS_LEVEL_STAGE_GUIDE_PATH) + LIBGENS_PATH_FULL_GENERATIONS_EXTENSION);
+
+		if (game_mode == LIBGENS_LEVEL_GAME_GENERATIONS) {
+			WIN32_FIND_DATA FindFileData;
+			HANDLE hFind;
+			hFind = FindFirstFile((folder+LIBGENS_LEVEL_DATA_SET_FILES).c_str(), &FindFileData);
+			if (hFind == INVALID_HANDLE_VALUE) {} 
+			else {
+				do {
+					const char *name=FindFileData.cFileName;
+					if (name[0]=='.') continue;
+
+					filenames->push_back(ToString(name));
+				} while (FindNextFile(hFind, &FindFileData) != 0);
+				FindClose(hFind);
+			}
+		}
+	}
+
+	bool Level::loadSnapshot(string filename) {
+		File file(filename, LIBGENS_FILE_READ_BINARY);
+		if (!file.valid()) {
+			return false;
+		}
+
+		FileReader reader(NULL, 0);
+		file.prepareReader(&reader, 0, file.getFileSize());
+
+		unsigned int signature=0;
+		unsigned int version=0;
+		unsigned int snapshot_game_mode=0;
+		unsigned int source_count=0;
+		reader.readInt32(&signature);
+		reader.readInt32(&version);
+		reader.readInt32(&snapshot_game_mode);
+		reader.readInt32(&source_count);
+
+		if ((signature != LIBGENS_LEVEL_SNAPSHOT_SIGNATURE) || (version != LIBGENS_LEVEL_SNAPSHOT_VERSION) || (snapshot_game_mode != game_mode)) {
+			file.close();
+			return false;
+		}
+
+		vector<string> sources;
+		vector<unsigned long long> source_hashes;
+		for (size_t i=0; (i<source_count) && !reader.hasOverflowed(); i++) {
+			string source="";
+			unsigned int hash[2]={ 0, 0 };
+			reader.readString(&source);
+			reader.readInt32(&hash[0]);
+			reader.readInt32(&hash[1]);
+			sources.push_back(source);
+			source_hashes.push_back(hash[0] | ((unsigned long long) hash[1] << 32));
+		}
+
+		if (reader.hasOverflowed()) {
+			file.close();
+			return false;
+		}
+
+		// Every source has to be unchanged, and every set file in the folder has to be one of them
+		vector<unsigned long long> current_hashes(sources.size(), 0);
+		Parallel::forEach(sources.size(), [&](size_t i) {
+			current_hashes[i] = hashSnapshotSource(folder + sources[i]);
+		});
+
+		if (current_hashes != source_hashes) {
+			file.close();
+			return false;
+		}
+
+		set<string> known_sources(sources.begin(), sources.end());
+		vector<string> listed_sources;
+		listSnapshotSources(&listed_sources);
+		for (size_t i=0; i<listed_sources.size(); i++) {
+			if (known_sources.find(listed_sources[i]) == known_sources.end()) {
+				file.close();
+				return false;
+			}
+		}
+
+		// Read everything aside first, so a damaged snapshot leaves the level as it was
+		string snapshot_terrain_info_file="";
+		string snapshot_direct_light_name="";
+		vector<string> snapshot_skybox_names;
+		reader.readString(&snapshot_terrain_info_file);
+		reader.readString(&snapshot_direct_light_name);
+
+		unsigned int skybox_count=0;
+		reader.readInt32(&skybox_count);
+		for (size_t i=0; (i<skybox_count) && !reader.hasOverflowed(); i++) {
+			string skybox_name="";
+			reader.readString(&skybox_name);
+			snapshot_skybox_names.push_back(skybox_name);
+		}
+
+		string snapshot_spawn_type="";
+		float snapshot_spawn_yaw=0.0f;
+		float snapshot_spawn_dead_height=0.0f;
+		string snapshot_spawn_camera_view="";
+		Vector3 snapshot_spawn_position;
+		string snapshot_spawn_mode="";
+		float snapshot_spawn_speed=0.0f;
+		float snapshot_spawn_time=0.0f;
+		reader.readString(&snapshot_spawn_type);
+		reader.readFloat32(&snapshot_spawn_yaw);
+		reader.readFloat32(&snapshot_spawn_dead_height);
+		reader.readString(&snapshot_spawn_camera_view);
+		snapshot_spawn_position.read(&reader, false);
+		reader.readString(&snapshot_spawn_mode);
+		reader.readFloat32(&snapshot_spawn_speed);
+		reader.readFloat32(&snapshot_spawn_time);
+
+		SceneEffect snapshot_scene_effect;
+		reader.readFloat32(&snapshot_scene_effect.light_scattering_color.r);
+		reader.readFloat32(&snapshot_scene_effect.light_scattering_color.g);
+		reader.readFloat32(&snapshot_scene_effect.light_scattering_color.b);
+		reader.readFloat32(&snapshot_scene_effect.light_scattering_color.a);
+		reader.readFloat32(&snapshot_scene_effect.light_scattering_depth_scale);
+		reader.readFloat32(&snapshot_scene_effect.light_scattering_in_scattering_scale);
+		reader.readFloat32(&snapshot_scene_effect.light_scattering_rayleigh);
+		reader.readFloat32(&snapshot_scene_effect.light_scattering_mie);
+		reader.readFloat32(&snapshot_scene_effect.light_scattering_g);
+		reader.readFloat32(&snapshot_scene_effect.light_scattering_z_near);
+		reader.readFloat32(&snapshot_scene_effect.light_scattering_z_far);
+		reader.readFloat32(&snapshot_scene_effect.sky_follow_up_ratio_y);
+		reader.readFloat32(&snapshot_scene_effect.sky_intensity_scale);
+
+		list<LevelCollisionEntry *> snapshot_collision_entries;
+		unsigned int collision_entry_count=0;
+		reader.readInt32(&collision_entry_count);
+		for (size_t i=0; (i<collision_entry_count) && !reader.hasOverflowed(); i++) {
+			LevelCollisionEntry *entry=new LevelCollisionEntry();
+			unsigned char rendering=0;
+			reader.readString(&entry->name);
+			reader.readUChar(&rendering);
+			entry->rendering = (rendering != 0);
+			snapshot_collision_entries.push_back(entry);
+		}
+
+		list<LevelSetEntry *> snapshot_set_entries;
+		unsigned int set_entry_count=0;
+		reader.readInt32(&set_entry_count);
+		for (size_t i=0; (i<set_entry_count) && !reader.hasOverflowed(); i++) {
+			LevelSetEntry *entry=new LevelSetEntry();
+			unsigned int index=0;
+			unsigned char active=0;
+			reader.readString(&entry->name);
+			reader.readString(&entry->color);
+			reader.readString(&entry->filename);
+			reader.readInt32(&index);
+			reader.readUChar(&active);
+			entry->index = index;
+			entry->active = (active != 0);
+			snapshot_set_entries.push_back(entry);
+		}
+
+		list<Path *> snapshot_paths;
+		vector<string> snapshot_path_filenames;
+		unsigned int path_count=0;
+		reader.readInt32(&path_count);
+		for (size_t i=0; (i<path_count) && !reader.hasOverflowed(); i++) {
+			string path_filename="";
+			reader.readString(&path_filename);
+
+			Path *path=new Path();
+			path->readSnapshot(&reader);
+			snapshot_paths.push_back(path);
+			snapshot_path_filenames.push_back(folder + path_filename);
+		}
+
+		list<ObjectSet *> snapshot_sets;
+		unsigned int set_count=0;
+		bool valid=true;
+		reader.readInt32(&set_count);
+		for (size_t i=0; (i<set_count) && valid && !reader.hasOverflowed(); i++) {
+			string set_filename="";
+			reader.readString(&set_filename);
+
+			ObjectSet *set=new ObjectSet();
+			set->setFilename(folder + set_filename);
+			valid = set->readSnapshot(&reader);
+			snapshot_sets.push_back(set);
+		}
+
+		file.close();
+
+		if (!valid || reader.hasOverflowed()) {
+			for (list<LevelCollisionEntry *>::iterator it=snapshot_collision_entries.begin(); it!=snapshot_collision_entries.end(); it++) delete *it;
+			for (list<LevelSetEntry *>::iterator it=snapshot_set_entries.begin(); it!=snapshot_set_entries.end(); it++) delete *it;
+			for (list<Path *>::iterator it=snapshot_paths.begin(); it!=snapshot_paths.end(); it++) delete *it;
+			for (list<ObjectSet *>::iterator it=snapshot_sets.begin(); it!=snapshot_sets.end(); it++) {
+				list<Object *> objects=(*it)->getObjects();
+				for (list<Object *>::iterator obj=objects.begin(); obj!=objects.end(); obj++) delete *obj;
+				delete *it;
+			}
+
+			return false;
+		}
+
+		terrain_info_file = snapshot_terrain_info_file;
+		direct_light_name = snapshot_direct_light_name;
+		skybox_names = snapshot_skybox_names;
+
+		spawn_type = snapshot_spawn_type;
+		spawn_yaw = snapshot_spawn_yaw;
+		spawn_dead_height = snapshot_spawn_dead_height;
+		spawn_camera_view = snapshot_spawn_camera_view;
+		spawn_position = snapshot_spawn_position;
+		spawn_mode = snapshot_spawn_mode;
+		spawn_speed = snapshot_spawn_speed;
+		spawn_time = snapshot_spawn_time;
+
+		scene_effect = snapshot_scene_effect;
+
+		collision_entries.insert(collision_entries.end(), snapshot_collision_entries.begin(), snapshot_collision_entries.end());
+		set_entries.insert(set_entries.end(), snapshot_set_entries.begin(), snapshot_set_entries.end());
+		paths.insert(paths.end(), snapshot_paths.begin(), snapshot_paths.end());
+		path_filenames.insert(path_filenames.end(), snapshot_path_filenames.begin(), snapshot_path_filenames.end());
+
+		for (list<ObjectSet *>::iterator it=snapshot_sets.begin(); it!=snapshot_sets.end(); it++) {
+			addSet(*it);
+		}
+
+		return true;
+	}
+
+	void Level::saveSnapshot(string filename) {
+		// Every file the level was read from, including the ones that don't exist, so adding one is a change too
+		vector<string> listed_sources;
+		listSnapshotSources(&listed_sources);
+		for (list<ObjectSet *>::iterator it=sets.begin(); it!=sets.end(); it++) {
+			listed_sources.push_back(getSnapshotRelativeFilename(folder, (*it)->getFilename()));
+		}
+
+		for (size_t i=0; i<path_filenames.size(); i++) {
+			listed_sources.push_back(getSnapshotRelativeFilename(folder, path_filenames[i]));
+		}
+
+		vector<string> sources;
+		set<string> known_sources;
+		for (size_t i=0; i<listed_sources.size(); i++) {
+			if (known_sources.insert(listed_sources[i]).second) {
+				sources.push_back(listed_sources[i]);
+			}
+		}
+
+		vector<unsigned long long> source_hashes(sources.size(), 0);
+		Parallel::forEach(sources.size(), [&](size_t i) {
+			source_hashes[i] = hashSnapshotSource(folder + sources[i]);
+		});
+
+		File file(filename, LIBGENS_FILE_WRITE_BINARY);
+		if (!file.valid()) {
+			return;
+		}
+
+		unsigned int signature=LIBGENS_LEVEL_SNAPSHOT_SIGNATURE;
+		unsigned int version=LIBGENS_LEVEL_SNAPSHOT_VERSION;
+		unsigned int snapshot_game_mode=game_mode;
+		unsigned int source_count=sources.size();
+		file.writeInt32(&signature);
+		file.writeInt32(&version);
+		file.writeInt32(&snapshot_game_mode);
+		file.writeInt32(&source_count);
+
+		for (size_t i=0; i<sources.size(); i++) {
+			unsigned int hash[2]={ (unsigned int) source_hashes[i], (unsigned int) (source_hashes[i] >> 32) };
+			file.writeString(&sources[i]);
+			file.writeInt32(&hash[0]);
+			file.writeInt32(&hash[1]);
+		}
+
+		file.writeString(&terrain_info_file);
+		file.writeString(&direct_light_name);
+
+		unsigned int skybox_count=skybox_names.size();
+		file.writeInt32(&skybox_count);
+		for (size_t i=0; i<skybox_names.size(); i++) {
+			file.writeString(&skybox_names[i]);
+		}
+
+		file.writeString(&spawn_type);
+		file.writeFloat32(&spawn_yaw);
+		file.writeFloat32(&spawn_dead_height);
+		file.writeString(&spawn_camera_view);
+		spawn_position.write(&file, false);
+		file.writeString(&spawn_mode);
+		file.writeFloat32(&spawn_speed);
+		file.writeFloat32(&spawn_time);
+
+		file.writeFloat32(&scene_effect.light_scattering_color.r);
+		file.writeFloat32(&scene_effect.light_scattering_color.g);
+		file.writeFloat32(&scene_effect.light_scattering_color.b);
+		file.writeFloat32(&scene_effect.light_scattering_color.a);
+		file.writeFloat32(&scene_effect.light_scattering_depth_scale);
+		file.writeFloat32(&scene_effect.light_scattering_in_scattering_scale);
+		file.writeFloat32(&scene_effect.light_scattering_rayleigh);
+		file.writeFloat32(&scene_effect.light_scattering_mie);
+		file.writeFloat32(&scene_effect.light_scattering_g);
+		file.writeFloat32(&scene_effect.light_scattering_z_near);
+		file.writeFloat32(&scene_effect.light_scattering_z_far);
+		file.writeFloat32(&scene_effect.sky_follow_up_ratio_y);
+		file.writeFloat32(&scene_effect.sky_intensity_scale);
+
+		unsigned int collision_entry_count=collision_entries.size();
+		file.writeInt32(&collision_entry_count);
+		for (list<LevelCollisionEntry *>::iterator it=collision_entries.begin(); it!=collision_entries.end(); it++) {
+			unsigned char rendering=((*it)->rendering ? 1 : 0);
+			file.writeString(&(*it)->name);
+			file.writeUChar(&rendering);
+		}
+
+		unsigned int set_entry_count=set_entries.size();
+		file.writeInt32(&set_entry_count);
+		for (list<LevelSetEntry *>::iterator it=set_entries.begin(); it!=set_entries.end(); it++) {
+			unsigned int index=(*it)->index;
+			unsigned char active=((*it)->active ? 1 : 0);
+			file.writeString(&(*it)->name);
+			file.writeString(&(*it)->color);
+			file.writeString(&(*it)->filename);
+			file.writeInt32(&index);
+			file.writeUChar(&active);
+		}
+
+		unsigned int path_count=paths.size();
+		file.writeInt32(&path_count);
+		size_t path_index=0;
+		for (list<Path *>::iterator it=paths.begin(); it!=paths.end(); it++, path_index++) {
+			string path_filename=(path_index < path_filenames.size()) ? getSnapshotRelativeFilename(folder, path_filenames[path_index]) : "";
+			file.writeString(&path_filename);
+			(*it)->writeSnapshot(&file);
+		}
+
+		unsigned int set_count=sets.size();
+		file.writeInt32(&set_count);
+		for (list<ObjectSet *>::iterator it=sets.begin(); it!=sets.end(); it++) {
+			string set_filename=getSnapshotRelativeFilename(folder, (*it)->getFilename());
+			file.writeString(&set_filename);
+			(*it)->writeSnapshot(&file);
+		}
+
+		file.close();
+	}
+
+
+	bool Level::isFromSnapshot() {
+		return from_snapshot;
+	}
+
+
 	ObjectSet *Level::getSet(string name) {
 		for (list<ObjectSet *>::iterator it=sets.begin(); it!=sets.end(); it++) {
 			if ((*it)->getName() == name) {
@@ -645,14 +1056,13 @@ namespace LibGens {
 	}
 
 	size_t Level::newObjectID() {
-		size_t id;
-
-		for (id=LIBGENS_LEVEL_START_ID_GENERATION; id<LIBGENS_LEVEL_END_ID_GENERATION; id++) {
-			Object *object=getObjectByID(id);
-			if (!object) break;
+		// IDs are unique across every set of the level
+		vector<ObjectIDIndex *> indices;
+		for (list<ObjectSet *>::iterator it=sets.begin(); it!=sets.end(); it++) {
+			indices.push_back((*it)->getIDIndex());
 		}
 
-		return id;
+		return ObjectIDIndex::newID(indices);
 	}
 
 	void Level::learnFromLibrary(ObjectLibrary *library) {
@@ -738,4 +1148,40 @@ namespace LibGens {
 	list<LevelCollisionEntry *> Level::getCollisionEntries() {
 		return collision_entries;
 	}
+
+	list<LevelSetEntry *> Level::getSetEntries() {
+		return set_entries;
+	}
+
+	string Level::getSpawnType() {
+		return spawn_type;
+	}
+
+	float Level::getSpawnYaw() {
+		return spawn_yaw;
+	}
+
+	float Level::getSpawnDeadHeight() {
+		return spawn_dead_height;
+	}
+
+	string Level::getSpawnCameraView() {
+		return spawn_camera_view;
+	}
+
+	Vector3 Level::getSpawnPosition() {
+		return spawn_position;
+	}
+
+	string Level::getSpawnMode() {
+		return spawn_mode;
+	}
+
+	float Level::getSpawnSpeed() {
+		return spawn_speed;
+	}
+
+	float Level::getSpawnTime() {
+		return spawn_time;
+	}
 }
\ No newline at end of file
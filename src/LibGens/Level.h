@@ -27,6 +27,10 @@
 #define LIBGENS_LEVEL_DATA_STAGE                     "Stage.stg.xml"
 #define LIBGENS_LEVEL_DATA_TERRAIN                   "Terrain.stg.xml"
 #define LIBGENS_LEVEL_DATA_SCENE_EFFECT              "SceneEffect.prm.xml"
+#define LIBGENS_LEVEL_DATA_SET_FILES                 "setdata_*.set.xml"
+
+#define LIBGENS_LEVEL_SNAPSHOT_SIGNATURE             0x4E53474C
+#define LIBGENS_LEVEL_SNAPSHOT_VERSION               1
 
 #define LIBGENS_LEVEL_STAGE_GUIDE_PATH               "StageGuidePath"
 #define LIBGENS_LEVEL_XML_PATH                       "Path"
@@ -158,6 +162,7 @@ namespace LibGens {
 		protected:
 			list<ObjectSet *> sets;
 			list<Path *> paths;
+			vector<string> path_filenames;
 			string slot;
 			string folder;
 			string terrain_info_file;
@@ -181,9 +186,12 @@ namespace LibGens {
 
 			list<LevelCollisionEntry *> collision_entries;
 			list<LevelSetEntry *> set_entries;
+			bool from_snapshot;
+
+			void listSnapshotSources(vector<string> *filenames);
 		public:
 			Level();
-			Level(string folder_p, size_t game_mode_p=LIBGENS_LEVEL_GAME_GENERATIONS);
+			Level(string folder_p, size_t game_mode_p=LIBGENS_LEVEL_GAME_GENERATIONS, string snapshot_filename="");
 			void setName(string nm);
 			size_t getGameMode();
 			void setGameMode(size_t v);
@@ -198,6 +206,7 @@ namespace LibGens {
 			list<Path *> getPaths();
 			Object *getObjectByID(size_t id);
 			list<LevelCollisionEntry *> getCollisionEntries();
+			list<LevelSetEntry *> getSetEntries();
 			LevelCollisionEntry *getCollisionEntry(string collision_filename);
 			void getObjectsByName(string name, list<Object *> &total_list);
 			void loadPath(TiXmlElement *root);
@@ -207,6 +216,23 @@ namespace LibGens {
 			void loadSceneEffect();
 			void loadSpawn(TiXmlElement *root);
 			void saveSpawn();
+			string getSpawnType();
+			float getSpawnYaw();
+			float getSpawnDeadHeight();
+			string getSpawnCameraView();
+			Vector3 getSpawnPosition();
+			string getSpawnMode();
+			float getSpawnSpeed();
+			float getSpawnTime();
+
+			// Binary copy of everything the level loads from its XML files, along with a hash of each of those
+			// files. Loading fails without touching the level when any of them changed or a set file was added.
+			bool loadSnapshot(string filename);
+			void saveSnapshot(string filename);
+
+			// True when the constructor was given a snapshot and loaded the level from it instead of the XML files.
+			bool isFromSnapshot();
+
 			SceneEffect &getSceneEffect();
 			ObjectSet *getSet(string name);
 			size_t newObjectID();
@@ -21,6 +21,12 @@
 
 namespace LibGens {
 	void ColorPoint::read(File *file) {
+		for (size_t x=0; x<8; x++) {
+			for (size_t y=0; y<3; y++) {
+				file->readUChar(&rgb[x][y]);
+			}
+		}
+		file->readUChar(&flag);
 	}
 
 	void ColorPoint::write(File *file) {
@@ -33,10 +39,11 @@ namespace LibGens {
 	}
 
 
-	void LightFieldCube::read(File *file, size_t head_address, AABB aabb) {
+	void LightFieldCube::read(File *file, size_t head_address, AABB aabb_p) {
 		file->readInt32BE(&type);
 		file->readInt32BE(&value);
 
+		aabb = aabb_p;
 		point = aabb.center();
 
 		if (type != LIBGENS_LIGHTFIELD_CUBE_NO_SPLIT) {
@@ -109,6 +116,46 @@ namespace LibGens {
 		file->goToAddress(cube_address);
 		cube=new LightFieldCube();
 		cube->read(file, cube_address, world_aabb);
+
+		file->goToAddress(color_address);
+		for (int i=0; i<color_count; i++) {
+			ColorPoint *color=new ColorPoint();
+			color->read(file);
+			color->index = i;
+			color_palette.push_back(color);
+		}
+
+		vector<unsigned int> indices(index_count > 0 ? index_count : 0, 0);
+		file->goToAddress(index_address);
+		for (size_t i=0; i<indices.size(); i++) {
+			file->readInt32BE(&indices[i]);
+		}
+
+		// Leaves point at 8 consecutive indices into the color palette, one per corner
+		vector<LightFieldCube *> stack;
+		stack.push_back(cube);
+		while (!stack.empty()) {
+			LightFieldCube *current=stack.back();
+			stack.pop_back();
+
+			if (current->getType() != LIBGENS_LIGHTFIELD_CUBE_NO_SPLIT) {
+				stack.push_back(current->getRight());
+				stack.push_back(current->getLeft());
+				continue;
+			}
+
+			AABB aabb=current->getAABB();
+			for (size_t j=0; j<LIBGENS_LIGHTFIELD_CORNER_COUNT; j++) {
+				size_t index=current->getValue() + j;
+				if ((index >= indices.size()) || (indices[index] >= color_palette.size())) continue;
+
+				SamplingPoint *sampling_point=new SamplingPoint();
+				sampling_point->color = color_palette[indices[index]];
+				sampling_point->point = Vector3((j & 1) ? aabb.end.x : aabb.start.x, (j & 2) ? aabb.end.y : aabb.start.y, (j & 4) ? aabb.end.z : aabb.start.z);
+				sampling_points.push_back(sampling_point);
+				current->setCorner(sampling_point, j);
+			}
+		}
 	}
 
 	void LightField::save(string filename) {
@@ -217,4 +264,112 @@ namespace LibGens {
 		color_palette.push_back(color);
 		return color;
 	}
-};
\ No newline at end of file
+
+
+	LightFieldSampler::LightFieldSampler(LightField *light_field) {
+		world_aabb = light_field->getAABB();
+
+		vector<ColorPoint *> color_palette=light_field->getColorPalette();
+		unordered_map<ColorPoint *, unsigned int> palette_indices;
+		for (size_t i=0; i<color_palette.size(); i++) {
+			palette_indices.emplace(color_palette[i], palette.size());
+			palette.push_back(*color_palette[i]);
+		}
+
+		// Children are added in pairs, so the right one always follows the left one. A light field without
+		// cubes becomes a single leaf.
+		vector<pair<LightFieldCube *, size_t>> stack;
+		nodes.push_back(LightFieldSamplerNode());
+		stack.push_back(make_pair(light_field->getCube(), (size_t) 0));
+
+		while (!stack.empty()) {
+			LightFieldCube *current=stack.back().first;
+			size_t node=stack.back().second;
+			stack.pop_back();
+
+			if (current && (current->getType() <= LIBGENS_LIGHTFIELD_CUBE_Z_SPLIT) && current->getLeft() && current->getRight()) {
+				nodes[node].type = current->getType();
+				nodes[node].value = nodes.size();
+				nodes.push_back(LightFieldSamplerNode());
+				nodes.push_back(LightFieldSamplerNode());
+				stack.push_back(make_pair(current->getRight(), nodes.size() - 1));
+				stack.push_back(make_pair(current->getLeft(), nodes.size() - 2));
+				continue;
+			}
+
+			nodes[node].type = LIBGENS_LIGHTFIELD_CUBE_NO_SPLIT;
+			nodes[node].value = corner_indices.size();
+			for (size_t j=0; j<LIBGENS_LIGHTFIELD_CORNER_COUNT; j++) {
+				SamplingPoint *corner=(current ? current->getCorner(j) : NULL);
+				ColorPoint *color=(corner ? corner->color : NULL);
+
+				unordered_map<ColorPoint *, unsigned int>::iterator it=palette_indices.find(color);
+				if (it == palette_indices.end()) {
+					it = palette_indices.emplace(color, palette.size()).first;
+					palette.push_back(color ? *color : ColorPoint());
+				}
+
+				corner_indices.push_back(it->second);
+			}
+		}
+	}
+
+	LightFieldSample LightFieldSampler::sample(Vector3 position) const {
+		float coordinates[3]={ position.x, position.y, position.z };
+		float start[3]={ world_aabb.start.x, world_aabb.start.y, world_aabb.start.z };
+		float end[3]={ world_aabb.end.x, world_aabb.end.y, world_aabb.end.z };
+		for (size_t axis=0; axis<3; axis++) {
+			coordinates[axis] = max(start[axis], min(end[axis], coordinates[axis]));
+		}
+
+		size_t node=0;
+		while (nodes[node].type != LIBGENS_LIGHTFIELD_CUBE_NO_SPLIT) {
+			unsigned int axis=nodes[node].type;
+			float center=(start[axis] + end[axis]) / 2.0f;
+
+			if (coordinates[axis] < center) {
+				end[axis] = center;
+				node = nodes[node].value;
+			}
+			else {
+				start[axis] = center;
+				node = nodes[node].value + 1;
+			}
+		}
+
+		float weights[3];
+		for (size_t axis=0; axis<3; axis++) {
+			float size=end[axis] - start[axis];
+			weights[axis] = (size > 0.0f) ? (coordinates[axis] - start[axis]) / size : 0.0f;
+		}
+
+		LightFieldSample result;
+		const unsigned int *corners=&corner_indices[nodes[node].value];
+		for (size_t j=0; j<LIBGENS_LIGHTFIELD_CORNER_COUNT; j++) {
+			float weight=((j & 1) ? weights[0] : 1.0f - weights[0]) * ((j & 2) ? weights[1] : 1.0f - weights[1]) * ((j & 4) ? weights[2] : 1.0f - weights[2]) / 255.0f;
+			const ColorPoint &color=palette[corners[j]];
+
+			for (size_t x=0; x<8; x++) {
+				for (size_t y=0; y<3; y++) {
+					result.rgb[x][y] += color.rgb[x][y] * weight;
+				}
+			}
+			result.flag += color.flag * weight;
+		}
+
+		return result;
+	}
+
+	void LightFieldSampler::sample(const Vector3 *positions, size_t count, LightFieldSample *samples) const {
+		// Points are cheap, so threads take them in runs instead of one at a time
+		size_t run_size=LIBGENS_LIGHTFIELD_SAMPLER_PARALLEL_MIN_POINTS;
+		size_t run_count=(count + run_size - 1) / run_size;
+
+		Parallel::forEach(run_count, [&](size_t run) {
+			size_t run_end=min(count, (run + 1) * run_size);
+			for (size_t i=run * run_size; i<run_end; i++) {
+				samples[i] = sample(positions[i]);
+			}
+		});
+	}
+};
@@ -32,6 +32,9 @@
 
 #define LIBGENS_LIGHTFIELD_FILE_ROOT_TYPE                 1
 
+#define LIBGENS_LIGHTFIELD_CORNER_COUNT                   8
+#define LIBGENS_LIGHTFIELD_SAMPLER_PARALLEL_MIN_POINTS    1024
+
 
 namespace LibGens {
 	class ColorPoint {
@@ -75,6 +78,7 @@ namespace LibGens {
 			unsigned int index;
 
 			Vector3 point;
+			AABB aabb;
 		public:
 			LightFieldCube() : left(NULL), right(NULL), type(3), value(0) {
 				for (size_t i=0; i<8; i++) {
@@ -91,7 +95,7 @@ namespace LibGens {
 				else return corners[corner];
 			}
 
-			void read(File *file, size_t head_address, AABB aabb);
+			void read(File *file, size_t head_address, AABB aabb_p);
 			void write(File *file);
 
 			void setType(unsigned int v) {
@@ -108,6 +112,10 @@ namespace LibGens {
 				return value;
 			}
 
+			AABB getAABB() {
+				return aabb;
+			}
+
 			void setIndex(unsigned int v) {
 				index = v;
 			}
@@ -156,5 +164,69 @@ namespace LibGens {
 			void write(File *file);
 
 			ColorPoint *createColorPoint(unsigned char rgb[8][3], unsigned char flag);
+
+			LightFieldCube *getCube() {
+				return cube;
+			}
+
+			vector<ColorPoint *> getColorPalette() {
+				return color_palette;
+			}
+
+			AABB getAABB() {
+				return world_aabb;
+			}
+	};
+
+	// Lighting at a point: every channel of the ColorPoints at the corners of the cube around it,
+	// blended trilinearly and scaled to [0, 1].
+	class LightFieldSample {
+		public:
+			float rgb[8][3];
+			float flag;
+
+			LightFieldSample() {
+				for (size_t x=0; x<8; x++) {
+					for (size_t y=0; y<3; y++) {
+						rgb[x][y]=0.0f;
+					}
+				}
+
+				flag=0.0f;
+			}
+	};
+
+	class LightFieldSamplerNode {
+		public:
+			unsigned int type;
+			unsigned int value;
+	};
+
+	// Read-only form of a LightField for lighting queries. The cube tree is flattened into one node array
+	// laid out like the file: a split node has its children at value and value+1, and a leaf has its
+	// corners' palette indices at value in the corner index array. Corner i of a cube is on the end side
+	// of X, Y and Z when bits 0, 1 and 2 of i are set. Corners without a color sample as a default ColorPoint.
+	class LightFieldSampler {
+		protected:
+			AABB world_aabb;
+			vector<LightFieldSamplerNode> nodes;
+			vector<unsigned int> corner_indices;
+			vector<ColorPoint> palette;
+		public:
+			LightFieldSampler(LightField *light_field);
+
+			// Positions outside the light field sample its closest point.
+			LightFieldSample sample(Vector3 position) const;
+
+			// Samples every position into the sample with the same index, on every thread for large batches.
+			void sample(const Vector3 *positions, size_t count, LightFieldSample *samples) const;
+
+			size_t getNodeCount() {
+				return nodes.size();
+			}
+
+			size_t getPaletteSize() {
+				return palette.size();
+			}
 	};
 };
@@ -104,8 +104,8 @@ namespace LibGens {
 		for (int o = 0; o < numObjects; o++)
 			file->readInt32BEA(&objOffsets[o]);
 
-		// Objects
-		objects.resize(numObjects, 0);
+		// Objects, resolved in file order so the set keeps the order they have in the source file
+		vector<Object *> resolved(numObjects, (Object *) NULL);
 
 		for (int t = 0; t < numObjTypes; t++)
 		{
@@ -121,26 +121,22 @@ namespace LibGens {
 			for (int o = 0; o < type.count; o++)
 			{
 				unsigned short index = type.indices[o];
+				if (index >= numObjects) continue;
+
 				size_t offset = objOffsets[index];
 				file->goToAddress(offset);
 
 				Object *obj = new Object(temp);
 				obj->readORC(file);
 				obj->setParentSet(this);
-
-				list<Object*>::iterator it = objects.begin();
-				it = std::next(it, index);
-				*it = obj;
+				resolved[index] = obj;
 			}
 		}
 
-		// Hack - erase invalid objects (ie objects with missing templates)
-		// I do this because I'm trying to preserve the order objects are in in the source file
-		// but having null objects in the list causes crashes
-		for (list<Object*>::iterator it = objects.begin(); it != objects.end(); it++) {
-			if (!*it) {
-				it = objects.erase(it);
-				it--;
+		// Objects with missing templates are left out
+		for (size_t o = 0; o < resolved.size(); o++) {
+			if (resolved[o]) {
+				indexObject(resolved[o]);
 			}
 		}
 	}
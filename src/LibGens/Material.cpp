@@ -17,6 +17,7 @@
 //    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
 //=========================================================================
 
+#include "AR.h"
 #include "Material.h"
 #include "Parameter.h"
 #include "Texture.h"
@@ -37,14 +38,41 @@ namespace LibGens {
 		gi_extra="";
 		alpha_threshold = 0x80;
 		layer = LayerOpaq;
+		source_pack = NULL;
 	}
 
 	Material::Material(string filename) {
 		File file(filename, LIBGENS_FILE_READ_BINARY);
+		initialize(filename);
 
+		if (file.valid()) {
+			file.readHeader();
+			read(&file);
+			file.close();
+		}
+	}
+
+	Material::Material(ArPack *pack, string folder_p, string id) {
+		initialize(folder_p + id + LIBGENS_MATERIAL_EXTENSION);
+		source_pack = pack;
+
+		vector<unsigned char> buffer;
+		File *file = openResource(folder, id + LIBGENS_MATERIAL_EXTENSION, &buffer);
+		if (file) {
+			file->readHeader();
+			read(file);
+			file->close();
+			delete file;
+		}
+
+		source_pack = NULL;
+	}
+
+	void Material::initialize(string filename) {
 		name = filename;
 		folder = "";
 		layer = LayerOpaq;
+		source_pack = NULL;
 
 		size_t sep = name.find_last_of("\\/");
 		if (sep != std::string::npos) {
@@ -63,12 +91,26 @@ namespace LibGens {
 		color_blend = false;
 		alpha_threshold = 0x80;
 		root_node_type = LIBGENS_MATERIAL_ROOT_GENERATIONS;
+	}
 
-		if (file.valid()) {
-			file.readHeader();
-			read(&file);
-			file.close();
+	File *Material::openResource(string folder_p, string resource_name, vector<unsigned char> *buffer) {
+		if (source_pack) {
+			ArFile *entry = source_pack->getFile(resource_name);
+			if (entry) {
+				const unsigned char *data = entry->viewData(buffer);
+				if (data) {
+					return new File(data, entry->getSize());
+				}
+			}
+		}
+
+		File *file = new File(folder_p + resource_name, LIBGENS_FILE_READ_BINARY);
+		if (file->valid()) {
+			return file;
 		}
+
+		delete file;
+		return NULL;
 	}
 
 	Material::~Material() {
@@ -133,7 +175,6 @@ namespace LibGens {
 		size_t texset_address = 0;
 		size_t texture_address = 0;
 		size_t parameters_address = 0;
-		size_t address = 0;
 
 		file->readInt32BEA(&shader_address);
 		file->readInt32BEA(&sub_shader_address);
@@ -165,27 +206,40 @@ namespace LibGens {
 		// HACK: We read the layer string if it's available right after the sub-shader one.
 		file->readString(&layer);
 
+		FileReader reader;
+		vector<size_t> parameter_addresses(parameter_count, 0);
+		file->prepareReader(&reader, parameters_address, parameter_count * file->getAddressSize());
+		for (size_t i = 0; i<(size_t)parameter_count; i++) {
+			reader.readInt32BEA(&parameter_addresses[i]);
+		}
+
 		parameters.reserve(parameter_count);
 		for (size_t i = 0; i<(size_t)parameter_count; i++) {
-			file->goToAddress(parameters_address + i * file->getAddressSize());
-			file->readInt32BEA(&address);
-			file->goToAddress(address);
+			file->goToAddress(parameter_addresses[i]);
 			Parameter *parameter = new Parameter();
 			parameter->read(file);
 			parameters.push_back(parameter);
 		}
 
+		vector<size_t> texset_addresses(texture_count, 0);
+		file->prepareReader(&reader, texset_address, texture_count * file->getAddressSize());
+		for (size_t i = 0; i<(size_t)texture_count; i++) {
+			reader.readInt32BEA(&texset_addresses[i]);
+		}
+
+		vector<size_t> texture_addresses(texture_count, 0);
+		file->prepareReader(&reader, texture_address, texture_count * file->getAddressSize());
+		for (size_t i = 0; i<(size_t)texture_count; i++) {
+			reader.readInt32BEA(&texture_addresses[i]);
+		}
+
 		textures.reserve(texture_count);
 		for (size_t i = 0; i<(size_t)texture_count; i++) {
 			string internal_name = "";
-			file->goToAddress(texset_address + i * file->getAddressSize());
-			file->readInt32BEA(&address);
-			file->goToAddress(address);
+			file->goToAddress(texset_addresses[i]);
 			file->readString(&internal_name);
 
-			file->goToAddress(texture_address + i * file->getAddressSize());
-			file->readInt32BEA(&address);
-			file->goToAddress(address);
+			file->goToAddress(texture_addresses[i]);
 			Texture *texture = new Texture();
 			texture->read(file, internal_name);
 			textures.push_back(texture);
@@ -237,11 +291,16 @@ namespace LibGens {
 		// HACK: We read the layer string if it's available right after the texset one.
 		file->readString(&layer);
 
+		FileReader reader;
+		vector<size_t> parameter_addresses(parameter_count, 0);
+		file->prepareReader(&reader, parameters_address, parameter_count * file->getAddressSize());
+		for (size_t i = 0; i<(size_t)parameter_count; i++) {
+			reader.readInt32BEA(&parameter_addresses[i]);
+		}
+
 		parameters.reserve(parameter_count);
 		for (size_t i = 0; i<(size_t)parameter_count; i++) {
-			file->goToAddress(parameters_address + i * file->getAddressSize());
-			file->readInt32BEA(&address);
-			file->goToAddress(address);
+			file->goToAddress(parameter_addresses[i]);
 			Parameter *parameter = new Parameter();
 			parameter->read(file);
 			parameters.push_back(parameter);
@@ -249,26 +308,38 @@ namespace LibGens {
 
 		// Look for the texset file in current directory.
 		string folder = File::folderFromFilename(file->getPath());
-		File texset(folder + texset_name + LIBGENS_TEXSET_EXTENSION, LIBGENS_FILE_READ_BINARY);
+		if (folder.empty()) folder = this->folder;
 
-		if (texset.valid()) {
-			texset.readHeader();
-			texset.readInt32BE(&texture_count);
-			texset.readInt32BEA(&texture_address);
+		vector<unsigned char> texset_buffer;
+		File *texset = openResource(folder, texset_name + LIBGENS_TEXSET_EXTENSION, &texset_buffer);
+
+		if (texset) {
+			texset->readHeader();
+			texset->readInt32BE(&texture_count);
+			texset->readInt32BEA(&texture_address);
 
 			textures.reserve(texture_count);
 			for (size_t i = 0; i < texture_count; i++) {
 				string internal_name = "";
-				texset.goToAddress(texture_address + i * texset.getAddressSize());
-				texset.readInt32BEA(&address);
-				texset.goToAddress(address);
-				texset.readString(&internal_name);
-
-				Texture *texture = new Texture(folder + internal_name + LIBGENS_TEXTURE_EXTENSION, internal_name);
+				texset->goToAddress(texture_address + i * texset->getAddressSize());
+				texset->readInt32BEA(&address);
+				texset->goToAddress(address);
+				texset->readString(&internal_name);
+
+				Texture *texture = new Texture();
+				vector<unsigned char> texture_buffer;
+				File *texture_file = openResource(folder, internal_name + LIBGENS_TEXTURE_EXTENSION, &texture_buffer);
+				if (texture_file) {
+					texture_file->readHeader();
+					texture->read(texture_file, internal_name);
+					texture_file->close();
+					delete texture_file;
+				}
 				textures.push_back(texture);
 			}
 
-			texset.close();
+			texset->close();
+			delete texset;
 		}
 	}
 
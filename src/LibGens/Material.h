@@ -36,6 +36,7 @@
 #define LIBGENS_MATERIAL_ROOT_GENERATIONS               3
 
 namespace LibGens {
+	class ArPack;
 	class Texture;
 	class Parameter;
 	class SampleChunkProperty;
@@ -56,6 +57,10 @@ namespace LibGens {
 			bool no_culling;
 			bool color_blend;
 			int root_node_type;
+			ArPack *source_pack;
+
+			void initialize(string filename);
+			File *openResource(string folder_p, string resource_name, vector<unsigned char> *buffer);
 		public:
 			static const string LayerOpaq;
 			static const string LayerTrans;
@@ -63,6 +68,10 @@ namespace LibGens {
 
 			Material();
 			Material(string filename);
+
+			// Reads id + LIBGENS_MATERIAL_EXTENSION from pack. The texset and textures it refers to are looked
+			// up in pack first and then in folder_p, the way Material(filename) looks them up next to the file.
+			Material(ArPack *pack, string folder_p, string id);
 			~Material();
 			void read(File *file);
 			void readRootNodeGenerations(File *file);
@@ -18,8 +18,10 @@
 //=========================================================================
 
 
+#include "AR.h"
 #include "Material.h"
 #include "MaterialLibrary.h"
+#include "Parallel.h"
 
 
 namespace LibGens {
@@ -27,71 +29,127 @@ namespace LibGens {
 		folder = folder_p;
 	}
 
-	void MaterialLibrary::addMaterial(Material *material) {
+	void MaterialLibrary::indexMaterial(Material *material, string id) {
 		materials.push_back(material);
+		material_index.insert(pair<string, Material *>(id, material));
+	}
+
+	void MaterialLibrary::addMaterial(Material *material) {
+		lock_guard<mutex> lock(library_mutex);
+		indexMaterial(material, material->getName());
 	}
 
 	
 	bool MaterialLibrary::checkMaterial(string id) {
-		for (list<Material *>::iterator it=materials.begin(); it!=materials.end(); it++) {
-			if ((*it)->getName() == id) {
-				return true;
-			}
+		lock_guard<mutex> lock(library_mutex);
+		return material_index.find(id) != material_index.end();
+	}
+
+
+	Material *MaterialLibrary::loadMaterial(string id, ArPack *pack) {
+		if (pack && pack->getFile(id + LIBGENS_MATERIAL_EXTENSION)) {
+			return new Material(pack, folder, id);
 		}
 
-		return false;
+		return new Material(folder + id + LIBGENS_MATERIAL_EXTENSION);
 	}
 
 
 	Material *MaterialLibrary::getMaterial(string id) {
-		for (list<Material *>::iterator it=materials.begin(); it!=materials.end(); it++) {
-			if ((*it)->getName() == id) {
-				return *it;
-			}
+		unique_lock<mutex> lock(library_mutex);
+		library_condition.wait(lock, [&]() { return loading_materials.find(id) == loading_materials.end(); });
+
+		unordered_map<string, Material *>::iterator it = material_index.find(id);
+		if (it != material_index.end()) {
+			return it->second;
 		}
-		
-		Material *mat=new Material(folder + id + LIBGENS_MATERIAL_EXTENSION);
-		materials.push_back(mat);
+
+		loading_materials.insert(id);
+		lock.unlock();
+
+		Material *mat = loadMaterial(id, NULL);
+
+		lock.lock();
+		indexMaterial(mat, id);
+		loading_materials.erase(id);
+		lock.unlock();
+
+		library_condition.notify_all();
 		return mat;
 	}
 
 
+	void MaterialLibrary::prefetch(const vector<string> &ids, ArPack *pack) {
+		vector<string> load_ids;
+
+		{
+			lock_guard<mutex> lock(library_mutex);
+			for (vector<string>::const_iterator it=ids.begin(); it!=ids.end(); it++) {
+				if (material_index.find(*it) != material_index.end()) continue;
+				if (loading_materials.find(*it) != loading_materials.end()) continue;
+
+				loading_materials.insert(*it);
+				load_ids.push_back(*it);
+			}
+		}
+
+		if (load_ids.empty()) return;
+
+		vector<Material *> loaded(load_ids.size(), NULL);
+		Parallel::forEach(load_ids.size(), [&](size_t i) {
+			loaded[i] = loadMaterial(load_ids[i], pack);
+		});
+
+		{
+			lock_guard<mutex> lock(library_mutex);
+			for (size_t i=0; i<load_ids.size(); i++) {
+				indexMaterial(loaded[i], load_ids[i]);
+				loading_materials.erase(load_ids[i]);
+			}
+		}
+
+		library_condition.notify_all();
+	}
+
+
 	list<Material*> MaterialLibrary::getMaterials() {
+		lock_guard<mutex> lock(library_mutex);
 		return materials;
 	}
 
 	void MaterialLibrary::merge(MaterialLibrary *library, bool overwrite) {
-		list<Material *> to_push;
+		lock_guard<mutex> lock(library_mutex);
 
 		for (list<Material *>::iterator it=library->materials.begin(); it!=library->materials.end(); it++) {
-			bool found=false;
-
-			for (list<Material *>::iterator it2=materials.begin(); it2!=materials.end(); it2++) {
-				if ((*it)->getName() == (*it2)->getName()) {
-					found = true;
-
-					if (overwrite) {
-						delete (*it2);
-						(*it2) = (*it);
-					}
-					else {
-						delete (*it);
-					}
-				}
+			Material *material = *it;
+
+			unordered_map<string, Material *>::iterator found = material_index.find(material->getName());
+			if (found == material_index.end()) {
+				indexMaterial(material, material->getName());
+				continue;
 			}
 
-			if (!found) to_push.push_back(*it);
-		}
-		library->materials.clear();
+			if (found->second == material) {
+				continue;
+			}
 
-		for (list<Material *>::iterator it=to_push.begin(); it!=to_push.end(); it++) {
-			materials.push_back(*it);
+			if (overwrite) {
+				replace(materials.begin(), materials.end(), found->second, material);
+				delete found->second;
+				found->second = material;
+			}
+			else {
+				delete material;
+			}
 		}
+		library->materials.clear();
+		library->material_index.clear();
 
 		delete library;
 	}
 
 	void MaterialLibrary::save(string folder_target, int root_type) {
+		lock_guard<mutex> lock(library_mutex);
 		folder = folder_target;
 
 		for (list<Material *>::iterator it=materials.begin(); it!=materials.end(); it++) {
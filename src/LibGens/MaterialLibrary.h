@@ -20,20 +20,37 @@
 #pragma once
 
 namespace LibGens {
+	class ArPack;
 	class Material;
 
+	// Materials are indexed by name. getMaterial and prefetch are safe to call from several threads:
+	// a missing material is loaded once, outside the library lock, and concurrent requests for the
+	// same name wait on library_condition until that load finishes. addMaterial, merge and save
+	// are expected to run while no loads are in flight.
 	class MaterialLibrary {
 		friend class MaterialLibrary;
 
 		protected:
 			list<Material *> materials;
+			unordered_map<string, Material *> material_index;
+			set<string> loading_materials;
 			string folder;
+			mutex library_mutex;
+			condition_variable library_condition;
+
+			void indexMaterial(Material *material, string id);
+			Material *loadMaterial(string id, ArPack *pack);
 		public:
 			MaterialLibrary(string folder_p);
 			void addMaterial(Material *material);
 			Material *getMaterial(string id);
 			list<Material*> getMaterials();
 			bool checkMaterial(string id);
+
+			// Loads every material in ids that isn't in the library yet, in parallel. Entries are read
+			// from pack when it holds id + LIBGENS_MATERIAL_EXTENSION, otherwise from the library folder.
+			void prefetch(const vector<string> &ids, ArPack *pack=NULL);
+
 			void merge(MaterialLibrary *library, bool overwrite=false);
 			void save(string folder_target, int root_type);
 	};
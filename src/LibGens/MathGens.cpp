@@ -31,6 +31,7 @@ THE SOFTWARE.
 //=========================================================================
 
 #include "MathGens.h"
+#include "XMLReader.h"
 
 namespace LibGens {
 	float asm_rsq(float r) {
@@ -397,16 +398,28 @@ namespace LibGens {
 	void Vector3::readNormal360(File *file, bool big_endian) {
 		unsigned int value=0;
 		file->readInt32E(&value, big_endian);
-
-		x = ((value&0x00000400 ? -1 : 0) + (float)((value>>0)&0x3FF)  / 1024.0f);
-		y = ((value&0x00200000 ? -1 : 0) + (float)((value>>11)&0x3FF) / 1024.0f);
-		z = ((value&0x80000000 ? -1 : 0) + (float)((value>>22)&0x1FF) / 512.0f);
+		fromNormal360(value);
 	}
 
 	void Vector3::readNormalForces(File * file, bool big_endian) {
 		unsigned int value = 0;
 		file->readInt32E(&value, big_endian);
+		fromNormalForces(value);
+	}
+
+	void Vector3::read(FileReader *reader, bool big_endian) {
+		reader->readFloat32E(&x, big_endian);
+		reader->readFloat32E(&y, big_endian);
+		reader->readFloat32E(&z, big_endian);
+	}
+
+	void Vector3::fromNormal360(unsigned int value) {
+		x = ((value&0x00000400 ? -1 : 0) + (float)((value>>0)&0x3FF)  / 1024.0f);
+		y = ((value&0x00200000 ? -1 : 0) + (float)((value>>11)&0x3FF) / 1024.0f);
+		z = ((value&0x80000000 ? -1 : 0) + (float)((value>>22)&0x1FF) / 512.0f);
+	}
 
+	void Vector3::fromNormalForces(unsigned int value) {
 		x = ((value & 0x00000200 ? -1 : 0) + (float)((value) & 0x1FF) / 512.0f);
 		y = ((value & 0x00080000 ? -1 : 0) + (float)((value >> 10) & 0x1FF) / 512.0f);
 		z = ((value & 0x20000000 ? -1 : 0) + (float)((value >> 20) & 0x1FF) / 512.0f);
@@ -472,6 +485,15 @@ namespace LibGens {
 		}
 	}
 
+	void Vector3::readXML(XMLReader *reader) {
+		size_t depth=reader->getDepth();
+		while (reader->nextChild(depth)) {
+			if      (reader->isName(LIBGENS_MATH_AXIS_X_TEXT)) reader->readFloat(&x);
+			else if (reader->isName(LIBGENS_MATH_AXIS_Y_TEXT)) reader->readFloat(&y);
+			else if (reader->isName(LIBGENS_MATH_AXIS_Z_TEXT)) reader->readFloat(&z);
+		}
+	}
+
 	void Vector3::readSingleXML(TiXmlElement *root) {
 		char *text_ptr=(char *) root->GetText();
 
@@ -513,6 +535,13 @@ namespace LibGens {
 		}
 	}
 
+	void Color::read(FileReader *reader, bool big_endian) {
+		reader->readFloat32E(&r, big_endian);
+		reader->readFloat32E(&g, big_endian);
+		reader->readFloat32E(&b, big_endian);
+		reader->readFloat32E(&a, big_endian);
+	}
+
 	void Color::write(File *file, bool big_endian) {
 		if (big_endian) {
 			file->writeFloat32BE(&r);
@@ -692,6 +721,16 @@ namespace LibGens {
 		}
 	}
 
+	void Quaternion::readXML(XMLReader *reader) {
+		size_t depth=reader->getDepth();
+		while (reader->nextChild(depth)) {
+			if      (reader->isName(LIBGENS_MATH_AXIS_X_TEXT)) reader->readFloat(&x);
+			else if (reader->isName(LIBGENS_MATH_AXIS_Y_TEXT)) reader->readFloat(&y);
+			else if (reader->isName(LIBGENS_MATH_AXIS_Z_TEXT)) reader->readFloat(&z);
+			else if (reader->isName(LIBGENS_MATH_AXIS_W_TEXT)) reader->readFloat(&w);
+		}
+	}
+
 	void Quaternion::readSingleXML(TiXmlElement *root) {
 		char *text_ptr=(char *) root->GetText();
 
@@ -731,6 +770,11 @@ namespace LibGens {
 		}
 	}
 
+	void Matrix4::read(FileReader *reader, bool big_endian) {
+		if (big_endian) reader->readFloat32BEArray(&m[0][0], 16);
+		else reader->read(&m[0][0], sizeof(m));
+	}
+
 	void Matrix4::write(File *file, bool big_endian) {
 		for (size_t x=0; x<4; x++) {
 			for (size_t y=0; y<4; y++) {
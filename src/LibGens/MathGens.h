@@ -65,6 +65,8 @@ THE SOFTWARE.
 
 namespace LibGens {
 	class File;
+	class FileReader;
+	class XMLReader;
 	class Matrix3;
 	class Matrix4;
 	class Vector3;
@@ -128,11 +130,15 @@ namespace LibGens {
 			void read(File *file, bool big_endian=true);
 			void readNormal360(File *file, bool big_endian=true);
 			void readNormalForces(File *file, bool big_endian = true);
+			void read(FileReader *reader, bool big_endian=true);
+			void fromNormal360(unsigned int value);
+			void fromNormalForces(unsigned int value);
 			void write(File *file, bool big_endian=true);
 			void writeNormal360(File *file, bool big_endian = true);
 			void writeNormalForces(File *file, bool big_endian = true);
 
 			void readXML(TiXmlElement *root);
+			void readXML(XMLReader *reader);
 			void readSingleXML(TiXmlElement *root);
 			void writeXML(TiXmlElement *root);
 
@@ -263,7 +269,7 @@ namespace LibGens {
 				return *this;
 			}
 
-			Quaternion Quaternion::operator* (const Quaternion& rkQ) {
+			Quaternion operator* (const Quaternion& rkQ) {
 				return Quaternion
 				(
 					w * rkQ.w - x * rkQ.x - y * rkQ.y - z * rkQ.z,
@@ -356,6 +362,7 @@ namespace LibGens {
 			void read(File *file);
 			void write(File *file);
 			void readXML(TiXmlElement *root);
+			void readXML(XMLReader *reader);
 			void readSingleXML(TiXmlElement *root);
 			void writeXML(TiXmlElement *root);
 	};
@@ -463,8 +470,7 @@ namespace LibGens {
 										 a(((float)rgba[3])/LIBGENS_MATH_COLOR_CHAR) {
 			}
 
-			Color(Color8 col) {
-				Color::Color((unsigned char *) &col);
+			Color(Color8 col) : Color((unsigned char *) &col) {
 			}
 
 			inline bool operator == (const Color& color) {
@@ -488,6 +494,7 @@ namespace LibGens {
 			void readARGB8(File *file);
 			void readABGR8(File *file);
 			void readRGBA8(File *file);
+			void read(FileReader *reader, bool big_endian=false);
 
 			void write(File *file, bool big_endian=false);
 			void writeARGB8(File *file);
@@ -564,6 +571,7 @@ namespace LibGens {
 		public:
 			float m[4][4];
 			void read(File *file, bool big_endian=true);
+			void read(FileReader *reader, bool big_endian=true);
 			void write(File *file, bool big_endian=true);
 
 			Matrix4() {
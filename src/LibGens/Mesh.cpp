@@ -318,6 +318,18 @@ namespace LibGens {
 		return vertices;
 	}
 
+	size_t Mesh::getVerticesSize() {
+		size_t vertices_size=0;
+
+		for (size_t slot=0; slot<LIBGENS_MODEL_SUBMESH_SLOTS; slot++) {
+			for (vector<Submesh *>::iterator it=submeshes[slot].begin(); it!=submeshes[slot].end(); it++) {
+				vertices_size += (*it)->getVerticesSize();
+			}
+		}
+
+		return vertices_size;
+	}
+
 	list<unsigned int> Mesh::getFaceList() {
 		list<unsigned int> faces;
 		list<unsigned int> submesh_faces;
@@ -331,7 +343,7 @@ namespace LibGens {
 					faces.push_back((*it_f) + face_offset);
 				}
 
-				face_offset += (*it)->getVertexList().size();
+				face_offset += (*it)->getVerticesSize();
 			}
 		}
 
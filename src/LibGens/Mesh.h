@@ -54,6 +54,7 @@ namespace LibGens {
 			std::vector<Submesh *> getSubmeshes(size_t slot);
 			std::vector<Submesh *> *getSubmeshSlots();
 			list<Vertex *> getVertexList();
+			size_t getVerticesSize();
 			list<unsigned int> getFaceList();
 			list<string> getMaterialNames();
 			vector<unsigned int> getMaterialMappings(list<string> &material_names);
@@ -460,7 +460,7 @@ namespace LibGens {
 				faces.push_back((*it_f) + face_offset);
 			}
 
-			face_offset += (*it)->getVertexList().size();
+			face_offset += (*it)->getVerticesSize();
 		}
 
 		return faces;
@@ -17,18 +17,28 @@
 //    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
 //=========================================================================
 
+#include "AR.h"
 #include "Model.h"
 #include "ModelLibrary.h"
+#include "Parallel.h"
 
 namespace LibGens {
 	ModelLibrary::ModelLibrary(string folder_p) {
 		folder = folder_p;
 	}
 
-	Model *ModelLibrary::getModel(string filename) {
-		for (list<Model *>::iterator it=models.begin(); it!=models.end(); it++) {
-			if ((*it)->getName() == filename) {
-				return (*it);
+	Model *ModelLibrary::loadModel(string filename, ArPack *pack) {
+		if (pack) {
+			ArFile *entry = pack->getFile(filename + ".model");
+			if (entry) {
+				vector<unsigned char> buffer;
+				const unsigned char *data = entry->viewData(&buffer);
+				if (data) {
+					File file(data, entry->getSize());
+					Model *model = new Model(&file, false);
+					model->setName(filename);
+					return model;
+				}
 			}
 		}
 
@@ -40,10 +50,80 @@ namespace LibGens {
 
 			Model *model = new Model(new_filename);
 			model->setName(filename);
-			models.push_back(model);
 			return model;
 		}
 
 		return NULL;
 	}
+
+	Model *ModelLibrary::getModel(string filename) {
+		unique_lock<mutex> lock(library_mutex);
+
+		bool waited = false;
+		while (loading_models.find(filename) != loading_models.end()) {
+			library_condition.wait(lock);
+			waited = true;
+		}
+
+		unordered_map<string, Model *>::iterator it = model_index.find(filename);
+		if (it != model_index.end()) {
+			return it->second;
+		}
+
+		// Another caller just tried this name and found no model file.
+		if (waited) {
+			return NULL;
+		}
+
+		loading_models.insert(filename);
+		lock.unlock();
+
+		Model *model = loadModel(filename, NULL);
+
+		lock.lock();
+		if (model) {
+			models.push_back(model);
+			model_index[filename] = model;
+		}
+		loading_models.erase(filename);
+		lock.unlock();
+
+		library_condition.notify_all();
+		return model;
+	}
+
+	void ModelLibrary::prefetch(const vector<string> &filenames, ArPack *pack) {
+		vector<string> load_filenames;
+
+		{
+			lock_guard<mutex> lock(library_mutex);
+			for (vector<string>::const_iterator it=filenames.begin(); it!=filenames.end(); it++) {
+				if (model_index.find(*it) != model_index.end()) continue;
+				if (loading_models.find(*it) != loading_models.end()) continue;
+
+				loading_models.insert(*it);
+				load_filenames.push_back(*it);
+			}
+		}
+
+		if (load_filenames.empty()) return;
+
+		vector<Model *> loaded(load_filenames.size(), NULL);
+		Parallel::forEach(load_filenames.size(), [&](size_t i) {
+			loaded[i] = loadModel(load_filenames[i], pack);
+		});
+
+		{
+			lock_guard<mutex> lock(library_mutex);
+			for (size_t i=0; i<load_filenames.size(); i++) {
+				if (loaded[i]) {
+					models.push_back(loaded[i]);
+					model_index[load_filenames[i]] = loaded[i];
+				}
+				loading_models.erase(load_filenames[i]);
+			}
+		}
+
+		library_condition.notify_all();
+	}
 };
\ No newline at end of file
@@ -20,14 +20,28 @@
 #pragma once
 
 namespace LibGens {
+	class ArPack;
 	class Model;
 
+	// Models are indexed by name and loaded once, like MaterialLibrary: concurrent getModel calls for
+	// the same name wait on library_condition while the first caller reads it outside the lock.
+	// Names with no model file aren't cached, so a model created later is still picked up.
 	class ModelLibrary {
 		protected:
 			string folder;
 			list<Model *> models;
+			unordered_map<string, Model *> model_index;
+			set<string> loading_models;
+			mutex library_mutex;
+			condition_variable library_condition;
+
+			Model *loadModel(string filename, ArPack *pack);
 		public:
 			ModelLibrary(string folder_p);
 			Model *getModel(string filename);
+
+			// Loads every model in filenames that isn't in the library yet, in parallel. Entries are read
+			// from pack when it holds filename + ".model", otherwise from the library folder.
+			void prefetch(const vector<string> &filenames, ArPack *pack=NULL);
 	};
 };
\ No newline at end of file
@@ -22,18 +22,19 @@
 #include "ObjectElement.h"
 #include "ObjectLibrary.h"
 #include "Level.h"
+#include "ObjectSet.h"
 #include "StringTable.h"
+#include "XMLReader.h"
 
 namespace LibGens {
-	void MultiSetNode::readXML(TiXmlElement *root) {
-		for (TiXmlElement *pElem=root->FirstChildElement(); pElem; pElem=pElem->NextSiblingElement()) {
-			string element_name=pElem->ValueStr();
-
-			if (element_name == LIBGENS_OBJECT_ELEMENT_POSITION) {
-				position.readXML(pElem);
+	void MultiSetNode::readXML(XMLReader *reader) {
+		size_t depth=reader->getDepth();
+		while (reader->nextChild(depth)) {
+			if (reader->isName(LIBGENS_OBJECT_ELEMENT_POSITION)) {
+				position.readXML(reader);
 			}
-			else if (element_name == LIBGENS_OBJECT_ELEMENT_ROTATION) {
-				rotation.readXML(pElem);
+			else if (reader->isName(LIBGENS_OBJECT_ELEMENT_ROTATION)) {
+				rotation.readXML(reader);
 			}
 		}
 	}
@@ -82,37 +83,33 @@ namespace LibGens {
 		rotation = parent->getRotation() * local_rotation;
 	}
 
-	void MultiSetParam::readXML(TiXmlElement *root) {
-		for (TiXmlElement *pElem=root->FirstChildElement(); pElem; pElem=pElem->NextSiblingElement()) {
-			string element_name=pElem->ValueStr();
-			char *text_ptr=(char *) pElem->GetText();
-
-			if (text_ptr) {
-				string text=ToString(text_ptr);
-
-				if (element_name == LIBGENS_OBJECT_ELEMENT_MULTI_SET_PARAM_BASE_LINE) {
-					FromString<float>(base_line, text, std::dec);
+	void MultiSetParam::readXML(XMLReader *reader) {
+		size_t depth=reader->getDepth();
+		while (reader->nextChild(depth)) {
+			if (reader->hasText()) {
+				if (reader->isName(LIBGENS_OBJECT_ELEMENT_MULTI_SET_PARAM_BASE_LINE)) {
+					reader->readFloat(&base_line);
 				}
-				else if (element_name == LIBGENS_OBJECT_ELEMENT_MULTI_SET_PARAM_DIRECTION) {
-					FromString<float>(direction, text, std::dec);
+				else if (reader->isName(LIBGENS_OBJECT_ELEMENT_MULTI_SET_PARAM_DIRECTION)) {
+					reader->readFloat(&direction);
 				}
-				else if (element_name == LIBGENS_OBJECT_ELEMENT_MULTI_SET_PARAM_INTERVAL) {
-					FromString<float>(interval, text, std::dec);
+				else if (reader->isName(LIBGENS_OBJECT_ELEMENT_MULTI_SET_PARAM_INTERVAL)) {
+					reader->readFloat(&interval);
 				}
-				else if (element_name == LIBGENS_OBJECT_ELEMENT_MULTI_SET_PARAM_INTERVAL_BASE) {
-					FromString<float>(interval_base, text, std::dec);
+				else if (reader->isName(LIBGENS_OBJECT_ELEMENT_MULTI_SET_PARAM_INTERVAL_BASE)) {
+					reader->readFloat(&interval_base);
 				}
-				else if (element_name == LIBGENS_OBJECT_ELEMENT_MULTI_SET_PARAM_POSITION_BASE) {
-					FromString<float>(position_base, text, std::dec);
+				else if (reader->isName(LIBGENS_OBJECT_ELEMENT_MULTI_SET_PARAM_POSITION_BASE)) {
+					reader->readFloat(&position_base);
 				}
-				else if (element_name == LIBGENS_OBJECT_ELEMENT_MULTI_SET_PARAM_ROTATION_BASE) {
-					FromString<float>(rotation_base, text, std::dec);
+				else if (reader->isName(LIBGENS_OBJECT_ELEMENT_MULTI_SET_PARAM_ROTATION_BASE)) {
+					reader->readFloat(&rotation_base);
 				}
 			}
 			else {
-				if (element_name == LIBGENS_OBJECT_ELEMENT_MULTI_SET_PARAM_ELEMENT) {
+				if (reader->isName(LIBGENS_OBJECT_ELEMENT_MULTI_SET_PARAM_ELEMENT)) {
 					MultiSetNode *node=new MultiSetNode();
-					node->readXML(pElem);
+					node->readXML(reader);
 					nodes.push_back(node);
 				}
 			}
@@ -166,6 +163,47 @@ namespace LibGens {
 		root->LinkEndChild(mspRoot);
 	}
 
+	void MultiSetParam::readSnapshot(FileReader *reader) {
+		unsigned int node_count=0;
+		reader->readFloat32(&base_line);
+		reader->readFloat32(&direction);
+		reader->readFloat32(&interval);
+		reader->readFloat32(&interval_base);
+		reader->readFloat32(&position_base);
+		reader->readFloat32(&rotation_base);
+		reader->readInt32(&node_count);
+
+		for (size_t i=0; (i<node_count) && !reader->hasOverflowed(); i++) {
+			MultiSetNode *node=new MultiSetNode();
+			node->position.read(reader, false);
+			reader->readFloat32(&node->rotation.x);
+			reader->readFloat32(&node->rotation.y);
+			reader->readFloat32(&node->rotation.z);
+			reader->readFloat32(&node->rotation.w);
+			nodes.push_back(node);
+		}
+	}
+
+	void MultiSetParam::writeSnapshot(File *file) {
+		unsigned int node_count=nodes.size();
+		file->writeFloat32(&base_line);
+		file->writeFloat32(&direction);
+		file->writeFloat32(&interval);
+		file->writeFloat32(&interval_base);
+		file->writeFloat32(&position_base);
+		file->writeFloat32(&rotation_base);
+		file->writeInt32(&node_count);
+
+		for (list<MultiSetNode *>::iterator it=nodes.begin(); it!=nodes.end(); it++) {
+			MultiSetNode *node=*it;
+			node->position.write(file, false);
+			file->writeFloat32(&node->rotation.x);
+			file->writeFloat32(&node->rotation.y);
+			file->writeFloat32(&node->rotation.z);
+			file->writeFloat32(&node->rotation.w);
+		}
+	}
+
 	void MultiSetParam::readORC(File *file, unsigned int count) {
 		for (int i = 0; i < count; i++) {
 			LibGens::MultiSetNode *node = new LibGens::MultiSetNode();
@@ -428,28 +466,36 @@ namespace LibGens {
 	}
 
 	void Object::readXML(TiXmlElement *root) {
-		for(TiXmlElement *pElem=root->FirstChildElement(); pElem; pElem=pElem->NextSiblingElement()) {
-			string element_name=pElem->ValueStr();
-			char *text_ptr=(char *) pElem->GetText();
+		// Objects that only exist as a TinyXML tree, like pasted ones, are printed back and read like set files.
+		TiXmlPrinter printer;
+		root->Accept(&printer);
+
+		XMLReader reader(printer.CStr(), printer.Size());
+		if (reader.nextChild(0)) {
+			readXML(&reader);
+		}
+	}
+
+	void Object::readXML(XMLReader *reader) {
+		size_t depth=reader->getDepth();
+		while (reader->nextChild(depth)) {
+			string element_name=reader->getName();
 
 			if (element_name == LIBGENS_OBJECT_ELEMENT_POSITION) {
-				position.readXML(pElem);
+				position.readXML(reader);
 			}
 			else if (element_name == LIBGENS_OBJECT_ELEMENT_ROTATION) {
-				rotation.readXML(pElem);
+				rotation.readXML(reader);
 			}
 			else if (element_name == LIBGENS_OBJECT_ELEMENT_SET_ID) {
-				if (text_ptr) {
-					FromString<size_t>(id, ToString(text_ptr), std::dec);
-				}
+				reader->readSizeT(&id);
 			}
 			else if (element_name == LIBGENS_OBJECT_ELEMENT_MULTI_SET_PARAM) {
-				multi_set_param.readXML(pElem);
+				multi_set_param.readXML(reader);
 			}
 			else {
-				if (text_ptr) {
-					string text=ToString(text_ptr);
-
+				string text="";
+				if (reader->readText(&text)) {
 					bool is_number=true;
 					for (size_t i=0; i<text.size(); i++) {
 						if (!isdigit(text[i]) && (text[i] != '-') && (text[i] != '.') && (text[i] != 'e')) {
@@ -468,13 +514,13 @@ namespace LibGens {
 						if (element_name.find("Integer") != string::npos) {
 							ObjectElementInteger *element=new ObjectElementInteger();
 							element->setName(element_name);
-							FromString<unsigned int>(element->value, text, std::dec);
+							reader->readUInt(&element->value);
 							elements.push_back(element);
 						}
 						else {
 							ObjectElementFloat *element=new ObjectElementFloat();
 							element->setName(element_name);
-							FromString<float>(element->value, text, std::dec);
+							reader->readFloat(&element->value);
 							elements.push_back(element);
 						}
 					}
@@ -491,22 +537,22 @@ namespace LibGens {
 					}
 				}
 				else {
-					TiXmlElement *subElem=pElem->FirstChildElement();
+					// The first child decides the element type, so look ahead on a copy of the reader.
+					XMLReader lookahead=*reader;
+					size_t element_depth=reader->getDepth();
 
-					if (subElem) {
-						string sub_element_name=subElem->ValueStr();
+					if (lookahead.nextChild(element_depth)) {
+						string sub_element_name=lookahead.getName();
 
 						if (sub_element_name==LIBGENS_OBJECT_ELEMENT_SET_ID) {
-							if (subElem->NextSiblingElement()) {
+							if (lookahead.nextChild(element_depth)) {
 								ObjectElementIDList *element=new ObjectElementIDList();
 								element->setName(element_name);
 
-								for(subElem; subElem; subElem=subElem->NextSiblingElement()) {
-									char *sub_text_ptr=(char *) subElem->GetText();
-
-									if (sub_text_ptr) {
+								while (reader->nextChild(element_depth)) {
+									if (reader->hasText()) {
 										size_t new_id=0;
-										FromString<size_t>(new_id, ToString(sub_text_ptr), std::dec);
+										reader->readSizeT(&new_id);
 										element->value.push_back(new_id);
 									}
 								}
@@ -514,11 +560,11 @@ namespace LibGens {
 								elements.push_back(element);
 							}
 							else {
-								char *sub_text_ptr=(char *) subElem->GetText();
-								if (sub_text_ptr) {
+								reader->nextChild(element_depth);
+								if (reader->hasText()) {
 									ObjectElementID *element=new ObjectElementID();
 									element->setName(element_name);
-									FromString<size_t>(element->value, ToString(sub_text_ptr), std::dec);
+									reader->readSizeT(&element->value);
 									elements.push_back(element);
 								}
 							}
@@ -526,7 +572,7 @@ namespace LibGens {
 						else if ((sub_element_name==LIBGENS_MATH_AXIS_X_TEXT) || (sub_element_name==LIBGENS_MATH_AXIS_Y_TEXT) || (sub_element_name==LIBGENS_MATH_AXIS_Z_TEXT) || (sub_element_name== LIBGENS_MATH_AXIS_W_TEXT)) {
 							ObjectElementVector *element=new ObjectElementVector();
 							element->setName(element_name);
-							element->value.readXML(pElem);
+							element->value.readXML(reader);
 							elements.push_back(element);
 						}
 						else if (!sub_element_name.compare(0, LIBGENS_OBJECT_ELEMENT_POSITION_STR_SIZE, LIBGENS_OBJECT_ELEMENT_POSITION)) {
@@ -534,8 +580,8 @@ namespace LibGens {
 							Vector3 position;
 							element->setName(element_name);
 							
-							for(subElem; subElem; subElem=subElem->NextSiblingElement()) {
-								position.readXML(subElem);
+							while (reader->nextChild(element_depth)) {
+								position.readXML(reader);
 								element->value.push_back(position);
 							}
 
@@ -733,6 +779,353 @@ namespace LibGens {
 	}
 
 
+	static ObjectElement *createTemplateElement(ObjectElementType type) {
+		switch (type) {
+			case OBJECT_ELEMENT_UNDEFINED :   return new ObjectElement();
+			case OBJECT_ELEMENT_BOOL :        return new ObjectElementBool();
+			case OBJECT_ELEMENT_INTEGER :     return new ObjectElementInteger();
+			case OBJECT_ELEMENT_FLOAT :       return new ObjectElementFloat();
+			case OBJECT_ELEMENT_STRING :      return new ObjectElementString();
+			case OBJECT_ELEMENT_ID :          return new ObjectElementID();
+			case OBJECT_ELEMENT_ID_LIST :     return new ObjectElementIDList();
+			case OBJECT_ELEMENT_VECTOR :      return new ObjectElementVector();
+			case OBJECT_ELEMENT_VECTOR_LIST : return new ObjectElementVectorList();
+			case OBJECT_ELEMENT_SINT8 :       return new ObjectElementSint8();
+			case OBJECT_ELEMENT_UINT8 :       return new ObjectElementUint8();
+			case OBJECT_ELEMENT_SINT16 :      return new ObjectElementSint16();
+			case OBJECT_ELEMENT_UINT16 :      return new ObjectElementUint16();
+			case OBJECT_ELEMENT_SINT32 :      return new ObjectElementSint32();
+			case OBJECT_ELEMENT_UINT32 :      return new ObjectElementUint32();
+			case OBJECT_ELEMENT_ENUM :        return new ObjectElementEnum();
+			case OBJECT_ELEMENT_TARGET :      return new ObjectElementTarget();
+			case OBJECT_ELEMENT_POSITION :    return new ObjectElementPosition();
+			case OBJECT_ELEMENT_VECTOR3 :     return new ObjectElementVector3();
+			case OBJECT_ELEMENT_UINT32ARRAY : return new ObjectElementUint32Array();
+		}
+
+		return NULL;
+	}
+
+	bool Object::readTemplateCache(FileReader *reader) {
+		unsigned int element_count=0;
+		reader->readInt32(&element_count);
+
+		for (size_t i=0; (i<element_count) && !reader->hasOverflowed(); i++) {
+			unsigned int type=0;
+			string element_name="";
+			string description="";
+			reader->readInt32(&type);
+			reader->readString(&element_name);
+			reader->readString(&description);
+
+			ObjectElement *element=createTemplateElement((ObjectElementType) type);
+			if (!element) return false;
+			element->setName(element_name);
+			element->setDescription(description);
+			elements.push_back(element);
+
+			switch (element->getType()) {
+				case OBJECT_ELEMENT_BOOL :
+					{
+						unsigned char value=0;
+						reader->readUChar(&value);
+						static_cast<ObjectElementBool *>(element)->value = (value != 0);
+						break;
+					}
+
+				case OBJECT_ELEMENT_INTEGER :
+					reader->readInt32(&static_cast<ObjectElementInteger *>(element)->value);
+					break;
+
+				case OBJECT_ELEMENT_FLOAT :
+					reader->readFloat32(&static_cast<ObjectElementFloat *>(element)->value);
+					break;
+
+				case OBJECT_ELEMENT_STRING :
+					reader->readString(&static_cast<ObjectElementString *>(element)->value);
+					break;
+
+				case OBJECT_ELEMENT_ID :
+				case OBJECT_ELEMENT_TARGET :
+					{
+						unsigned int value=0;
+						reader->readInt32(&value);
+						static_cast<ObjectElementID *>(element)->value = value;
+						break;
+					}
+
+				case OBJECT_ELEMENT_ID_LIST :
+				case OBJECT_ELEMENT_UINT32ARRAY :
+					{
+						unsigned int count=0;
+						reader->readInt32(&count);
+						for (size_t j=0; (j<count) && !reader->hasOverflowed(); j++) {
+							unsigned int value=0;
+							reader->readInt32(&value);
+							static_cast<ObjectElementIDList *>(element)->value.push_back(value);
+						}
+						break;
+					}
+
+				case OBJECT_ELEMENT_VECTOR :
+				case OBJECT_ELEMENT_POSITION :
+				case OBJECT_ELEMENT_VECTOR3 :
+					{
+						Vector3 &value=static_cast<ObjectElementVector *>(element)->value;
+						reader->readFloat32(&value.x);
+						reader->readFloat32(&value.y);
+						reader->readFloat32(&value.z);
+						break;
+					}
+
+				case OBJECT_ELEMENT_VECTOR_LIST :
+					{
+						unsigned int count=0;
+						reader->readInt32(&count);
+						for (size_t j=0; (j<count) && !reader->hasOverflowed(); j++) {
+							Vector3 value;
+							reader->readFloat32(&value.x);
+							reader->readFloat32(&value.y);
+							reader->readFloat32(&value.z);
+							static_cast<ObjectElementVectorList *>(element)->value.push_back(value);
+						}
+						break;
+					}
+
+				case OBJECT_ELEMENT_SINT8 :
+					reader->readUChar((unsigned char *) &static_cast<ObjectElementSint8 *>(element)->value);
+					break;
+
+				case OBJECT_ELEMENT_UINT8 :
+					reader->readUChar(&static_cast<ObjectElementUint8 *>(element)->value);
+					break;
+
+				case OBJECT_ELEMENT_ENUM :
+					reader->readUChar(&static_cast<ObjectElementEnum *>(element)->value);
+					break;
+
+				case OBJECT_ELEMENT_SINT16 :
+					reader->readInt16((unsigned short *) &static_cast<ObjectElementSint16 *>(element)->value);
+					break;
+
+				case OBJECT_ELEMENT_UINT16 :
+					reader->readInt16(&static_cast<ObjectElementUint16 *>(element)->value);
+					break;
+
+				case OBJECT_ELEMENT_SINT32 :
+					{
+						unsigned int value=0;
+						reader->readInt32(&value);
+						static_cast<ObjectElementSint32 *>(element)->value = (signed int) value;
+						break;
+					}
+
+				case OBJECT_ELEMENT_UINT32 :
+					{
+						unsigned int value=0;
+						reader->readInt32(&value);
+						static_cast<ObjectElementUint32 *>(element)->value = value;
+						break;
+					}
+			}
+		}
+
+		unsigned int extra_count=0;
+		reader->readInt32(&extra_count);
+
+		for (size_t i=0; (i<extra_count) && !reader->hasOverflowed(); i++) {
+			string type="";
+			string extra_name="";
+			unsigned int parameter_count=0;
+			reader->readString(&type);
+			reader->readString(&extra_name);
+			reader->readInt32(&parameter_count);
+
+			ObjectExtra *extra = new ObjectExtra();
+			extra->setType(type);
+			extra->setName(extra_name);
+
+			for (size_t j=0; (j<parameter_count) && !reader->hasOverflowed(); j++) {
+				string parameter_name="";
+				string parameter_value="";
+				reader->readString(&parameter_name);
+				reader->readString(&parameter_value);
+				extra->addParameter(parameter_name, parameter_value);
+			}
+
+			extras.push_back(extra);
+		}
+
+		return !reader->hasOverflowed();
+	}
+
+	void Object::writeTemplateCache(File *file) {
+		unsigned int element_count=elements.size();
+		file->writeInt32(&element_count);
+
+		for (list<ObjectElement *>::iterator it=elements.begin(); it!=elements.end(); it++) {
+			ObjectElement *element=*it;
+			unsigned int type=element->getType();
+			string element_name=element->getName();
+			string description=element->getDescription();
+			file->writeInt32(&type);
+			file->writeString(&element_name);
+			file->writeString(&description);
+
+			switch (element->getType()) {
+				case OBJECT_ELEMENT_BOOL :
+					{
+						unsigned char value=(static_cast<ObjectElementBool *>(element)->value ? 1 : 0);
+						file->writeUChar(&value);
+						break;
+					}
+
+				case OBJECT_ELEMENT_INTEGER :
+					file->writeInt32(&static_cast<ObjectElementInteger *>(element)->value);
+					break;
+
+				case OBJECT_ELEMENT_FLOAT :
+					file->writeFloat32(&static_cast<ObjectElementFloat *>(element)->value);
+					break;
+
+				case OBJECT_ELEMENT_STRING :
+					file->writeString(&static_cast<ObjectElementString *>(element)->value);
+					break;
+
+				case OBJECT_ELEMENT_ID :
+				case OBJECT_ELEMENT_TARGET :
+					{
+						unsigned int value=static_cast<ObjectElementID *>(element)->value;
+						file->writeInt32(&value);
+						break;
+					}
+
+				case OBJECT_ELEMENT_ID_LIST :
+				case OBJECT_ELEMENT_UINT32ARRAY :
+					{
+						vector<size_t> &values=static_cast<ObjectElementIDList *>(element)->value;
+						unsigned int count=values.size();
+						file->writeInt32(&count);
+						for (size_t j=0; j<values.size(); j++) {
+							unsigned int value=values[j];
+							file->writeInt32(&value);
+						}
+						break;
+					}
+
+				case OBJECT_ELEMENT_VECTOR :
+				case OBJECT_ELEMENT_POSITION :
+				case OBJECT_ELEMENT_VECTOR3 :
+					{
+						Vector3 &value=static_cast<ObjectElementVector *>(element)->value;
+						file->writeFloat32(&value.x);
+						file->writeFloat32(&value.y);
+						file->writeFloat32(&value.z);
+						break;
+					}
+
+				case OBJECT_ELEMENT_VECTOR_LIST :
+					{
+						vector<Vector3> &values=static_cast<ObjectElementVectorList *>(element)->value;
+						unsigned int count=values.size();
+						file->writeInt32(&count);
+						for (size_t j=0; j<values.size(); j++) {
+							file->writeFloat32(&values[j].x);
+							file->writeFloat32(&values[j].y);
+							file->writeFloat32(&values[j].z);
+						}
+						break;
+					}
+
+				case OBJECT_ELEMENT_SINT8 :
+					file->writeUChar((unsigned char *) &static_cast<ObjectElementSint8 *>(element)->value);
+					break;
+
+				case OBJECT_ELEMENT_UINT8 :
+					file->writeUChar(&static_cast<ObjectElementUint8 *>(element)->value);
+					break;
+
+				case OBJECT_ELEMENT_ENUM :
+					file->writeUChar(&static_cast<ObjectElementEnum *>(element)->value);
+					break;
+
+				case OBJECT_ELEMENT_SINT16 :
+					file->writeInt16((unsigned short *) &static_cast<ObjectElementSint16 *>(element)->value);
+					break;
+
+				case OBJECT_ELEMENT_UINT16 :
+					file->writeInt16(&static_cast<ObjectElementUint16 *>(element)->value);
+					break;
+
+				case OBJECT_ELEMENT_SINT32 :
+					{
+						unsigned int value=(unsigned int) static_cast<ObjectElementSint32 *>(element)->value;
+						file->writeInt32(&value);
+						break;
+					}
+
+				case OBJECT_ELEMENT_UINT32 :
+					{
+						unsigned int value=(unsigned int) static_cast<ObjectElementUint32 *>(element)->value;
+						file->writeInt32(&value);
+						break;
+					}
+			}
+		}
+
+		unsigned int extra_count=extras.size();
+		file->writeInt32(&extra_count);
+
+		for (list<ObjectExtra *>::iterator it=extras.begin(); it!=extras.end(); it++) {
+			string type=(*it)->getType();
+			string extra_name=(*it)->getName();
+			vector<string> parameter_names=(*it)->getParameterNames();
+			vector<string> parameters=(*it)->getParameters();
+			unsigned int parameter_count=parameter_names.size();
+			file->writeString(&type);
+			file->writeString(&extra_name);
+			file->writeInt32(&parameter_count);
+
+			for (size_t j=0; j<parameter_names.size(); j++) {
+				string parameter_value=(j < parameters.size()) ? parameters[j] : "";
+				file->writeString(&parameter_names[j]);
+				file->writeString(&parameter_value);
+			}
+		}
+	}
+
+	bool Object::readSnapshot(FileReader *reader) {
+		unsigned int id_value=0;
+		reader->readInt32(&id_value);
+		id = id_value;
+
+		position.read(reader, false);
+		reader->readFloat32(&rotation.x);
+		reader->readFloat32(&rotation.y);
+		reader->readFloat32(&rotation.z);
+		reader->readFloat32(&rotation.w);
+
+		if (!readTemplateCache(reader)) return false;
+
+		multi_set_param.readSnapshot(reader);
+		return !reader->hasOverflowed();
+	}
+
+	void Object::writeSnapshot(File *file) {
+		unsigned int id_value=id;
+		file->writeInt32(&id_value);
+
+		position.write(file, false);
+		file->writeFloat32(&rotation.x);
+		file->writeFloat32(&rotation.y);
+		file->writeFloat32(&rotation.z);
+		file->writeFloat32(&rotation.w);
+
+		writeTemplateCache(file);
+		multi_set_param.writeSnapshot(file);
+	}
+
+
 	void Object::writeXML(TiXmlElement *root) {
 		TiXmlElement* objRoot=new TiXmlElement(name);
 
@@ -1234,7 +1627,10 @@ namespace LibGens {
 	}
 
 	void Object::setID(size_t v) {
+		size_t old_id=id;
 		id=v;
+
+		if (parent_set && (old_id != id)) parent_set->updateObjectID(this, old_id);
 	}
 
 	void Object::setPosition(Vector3 v) {
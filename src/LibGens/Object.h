@@ -96,6 +96,9 @@
 #define LIBGENS_LIBRARY_NAME_ATTRIBUTE    "name"
 #define LIBGENS_LIBRARY_FOLDER_ATTRIBUTE  "folder"
 #define LIBGENS_LIBRARY_ROOT              "LevelDatabase"
+#define LIBGENS_LIBRARY_CACHE_EXTENSION   ".cache"
+#define LIBGENS_LIBRARY_CACHE_SIGNATURE   0x4354474C
+#define LIBGENS_LIBRARY_CACHE_VERSION     1
 
 
 namespace LibGens {
@@ -115,7 +118,7 @@ namespace LibGens {
 
 			}
 
-			void readXML(TiXmlElement *root);
+			void readXML(XMLReader *reader);
 			void writeXML(TiXmlElement *root, size_t index);
 			void readORC(File *file);
 			void recalcTransform(Object *parent);
@@ -176,10 +179,13 @@ namespace LibGens {
 				return nodes;
 			}
 
-			void readXML(TiXmlElement *root);
+			void readXML(XMLReader *reader);
 
 			void writeXML(TiXmlElement *root);
 
+			void readSnapshot(FileReader *reader);
+			void writeSnapshot(File *file);
+
 			void readORC(File *file, unsigned int count);
 
 			void recalcTransform(Object *parent);
@@ -242,8 +248,15 @@ namespace LibGens {
 			ObjectElement *cloneElement(ObjectElement *element);
 			ObjectExtra *cloneExtra(ObjectExtra *extra);
 			void readXML(TiXmlElement *root);
+			void readXML(XMLReader *reader);
 			void readXMLTemplate(string filename);
 			void readXMLTemplateElement(TiXmlElement *root);
+			// Compact binary copy of the template elements and extras, used by the object library cache.
+			bool readTemplateCache(FileReader *reader);
+			void writeTemplateCache(File *file);
+			// The same with the ID, transform and multi set parameters of a placed object, used by level snapshots.
+			bool readSnapshot(FileReader *reader);
+			void writeSnapshot(File *file);
 			void writeXML(TiXmlElement *root);
 			void saveXMLTemplate(string filename);
 			void learnFromObject(Object *object);
@@ -23,9 +23,8 @@
 
 namespace LibGens {
 	Object *ObjectCategory::getTemplate(string name) {
-		for (vector<Object *>::iterator it=templates.begin(); it!=templates.end(); it++) {
-			if ((*it)->getName() == name) return *it;
-		}
+		unordered_map<string, Object *>::iterator it=template_index.find(name);
+		if (it != template_index.end()) return it->second;
 
 		return NULL;
 	}
@@ -39,11 +38,10 @@ namespace LibGens {
 	}
 
 	bool ObjectCategory::learnFromObject(Object *object) {
-		for (vector<Object *>::iterator it=templates.begin(); it!=templates.end(); it++) {
-			if ((*it)->getName() == object->getName()) {
-				(*it)->learnFromObject(object);
-				return true;
-			}
+		Object *templ=getTemplate(object->getName());
+		if (templ) {
+			templ->learnFromObject(object);
+			return true;
 		}
 
 		return false;
@@ -63,6 +61,7 @@ namespace LibGens {
 
 	void ObjectCategory::addTemplate(Object *obj) {
 		templates.push_back(obj);
+		template_index.insert(make_pair(obj->getName(), obj));
 	}
 
 	vector<Object *> ObjectCategory::getTemplates() {
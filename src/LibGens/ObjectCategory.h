@@ -22,9 +22,12 @@
 namespace LibGens {
 	class Object;
 
+	// Templates are also indexed by name; like the list scan it replaces, the first template added
+	// under a name wins.
 	class ObjectCategory {
 		protected:
 			vector<Object *> templates;
+			unordered_map<string, Object *> template_index;
 			string name;
 			string folder;
 		public:
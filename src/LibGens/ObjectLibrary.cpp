@@ -38,14 +38,17 @@ namespace LibGens {
 	}
 
 	Object *ObjectLibrary::getTemplate(string name) {
-		for (vector<ObjectCategory *>::iterator it=categories.begin(); it!=categories.end(); it++) {
-			Object *templ=(*it)->getTemplate(name);
-			if (templ) return templ;
-		}
+		unordered_map<string, Object *>::iterator it=template_index.find(name);
+		if (it != template_index.end()) return it->second;
 
 		return NULL;
 	}
 
+	void ObjectLibrary::indexTemplate(ObjectCategory *category, Object *templ) {
+		category->addTemplate(templ);
+		template_index.insert(make_pair(templ->getName(), templ));
+	}
+
 	Object *ObjectLibrary::createObject(string name) {
 		Object *templ=getTemplate(name);
 
@@ -93,7 +96,7 @@ namespace LibGens {
 			if (!result) {
 				Object *new_template = new Object(*it);
 				ObjectCategory *category=(default_category ? default_category : *(categories.begin()));
-				if (category) category->addTemplate(new_template);
+				if (category) indexTemplate(category, new_template);
 			}
 		}
 	}
@@ -107,7 +110,7 @@ namespace LibGens {
 	}
 
 
-	void ObjectLibrary::loadDatabase(string filename) {
+	void ObjectLibrary::loadDatabase(string filename, bool use_cache) {
 		TiXmlDocument doc(filename);
 		if (!doc.LoadFile()) {
 			Error::addMessage(Error::FILE_NOT_FOUND, LIBGENS_LIBRARY_ERROR_FILE + filename);
@@ -124,6 +127,9 @@ namespace LibGens {
 			return;
 		}
 
+		vector<ObjectTemplateFile> files;
+		string manifest="";
+
 		pElem=pElem->FirstChildElement();
 		for(pElem; pElem; pElem=pElem->NextSiblingElement()) {
 			string entry_name="";
@@ -135,16 +141,42 @@ namespace LibGens {
 			pElem->QueryValueAttribute(LIBGENS_LIBRARY_FOLDER_ATTRIBUTE, &folder_name);
 
 			if ((entry_name==LIBGENS_LIBRARY_ENTRY) && category_name.size() && folder_name.size()) {
-				loadCategory(category_name, folder_name);
+				ObjectCategory *category=getCategory(category_name);
+				category->setFolder(folder_name);
+				manifest += category_name + '\0' + folder_name + '\0';
+				listTemplateFiles(category, &files, &manifest);
 			}
 		}
+
+		// Templates from every category are parsed in one batch, so small categories don't serialize the load.
+		unsigned long long manifest_hash=XXH3_64bits(manifest.data(), manifest.size());
+		string cache_filename=getCacheFilename(filename);
+		if (use_cache && File::check(cache_filename) && loadCache(cache_filename, manifest_hash)) {
+			return;
+		}
+
+		loadTemplateFiles(files);
+
+		if (use_cache) {
+			saveCache(cache_filename, manifest_hash);
+		}
 	}
 
 
 	void ObjectLibrary::loadCategory(string category_name, string folder_name) {
 		LibGens::ObjectCategory *category=getCategory(category_name);
 		category->setFolder(folder_name);
-		string search_string=folder + folder_name + "/*.xml";
+
+		vector<ObjectTemplateFile> files;
+		string manifest="";
+		listTemplateFiles(category, &files, &manifest);
+		loadTemplateFiles(files);
+	}
+
+
+	void ObjectLibrary::listTemplateFiles(ObjectCategory *category, vector<ObjectTemplateFile> *files, string *manifest) {
+		string category_folder=folder + category->getFolder() + "/";
+		string search_string=category_folder + "*.xml";
 
 		WIN32_FIND_DATA FindFileData;
 		HANDLE hFind;
@@ -156,17 +188,147 @@ namespace LibGens {
 				if (name[0]=='.') continue;
 
 				string object_name=ToString(name);
-				string object_internal_name=object_name;
-				object_internal_name.resize(object_internal_name.size()-((string)LIBGENS_OBJECT_TEMPLATE_EXTENSION).size());
-				LibGens::Object *templ=new LibGens::Object(object_internal_name);
-				templ->readXMLTemplate(folder + folder_name + "/" + object_name);
-				category->addTemplate(templ);
+				ObjectTemplateFile file;
+				file.category = category;
+				file.name = object_name;
+				file.name.resize(file.name.size()-((string)LIBGENS_OBJECT_TEMPLATE_EXTENSION).size());
+				file.filename = category_folder + object_name;
+				files->push_back(file);
+
+				unsigned int stamp[4]={ FindFileData.ftLastWriteTime.dwLowDateTime, FindFileData.ftLastWriteTime.dwHighDateTime, FindFileData.nFileSizeLow, FindFileData.nFileSizeHigh };
+				*manifest += object_name + '\0';
+				manifest->append((const char *) stamp, sizeof(stamp));
 			} while (FindNextFile(hFind, &FindFileData) != 0);
 			FindClose(hFind);
 		}
 	}
 
 
+	void ObjectLibrary::loadTemplateFiles(vector<ObjectTemplateFile> &files) {
+		vector<Object *> templates(files.size(), NULL);
+
+		Parallel::forEach(files.size(), [&](size_t i) {
+			Object *templ=new Object(files[i].name);
+			templ->readXMLTemplate(files[i].filename);
+			templates[i] = templ;
+		});
+
+		for (size_t i=0; i<files.size(); i++) {
+			indexTemplate(files[i].category, templates[i]);
+		}
+	}
+
+
+	string ObjectLibrary::getCacheFilename(string filename) {
+		return filename + LIBGENS_LIBRARY_CACHE_EXTENSION;
+	}
+
+
+	bool ObjectLibrary::loadCache(string filename, unsigned long long manifest_hash) {
+		File file(filename, LIBGENS_FILE_READ_BINARY);
+		if (!file.valid()) {
+			return false;
+		}
+
+		FileReader reader(NULL, 0);
+		file.prepareReader(&reader, 0, file.getFileSize());
+
+		unsigned int signature=0;
+		unsigned int version=0;
+		unsigned int hash[2]={ 0, 0 };
+		unsigned int category_count=0;
+		reader.readInt32(&signature);
+		reader.readInt32(&version);
+		reader.readInt32(&hash[0]);
+		reader.readInt32(&hash[1]);
+		reader.readInt32(&category_count);
+
+		if ((signature != LIBGENS_LIBRARY_CACHE_SIGNATURE) || (version != LIBGENS_LIBRARY_CACHE_VERSION) ||
+			(hash[0] != (unsigned int) manifest_hash) || (hash[1] != (unsigned int) (manifest_hash >> 32))) {
+			file.close();
+			return false;
+		}
+
+		// Templates are only handed to the categories once the whole cache has been read back.
+		vector<ObjectTemplateFile> files;
+		vector<Object *> templates;
+		bool valid=true;
+
+		for (size_t c=0; (c<category_count) && valid; c++) {
+			string category_name="";
+			string folder_name="";
+			unsigned int template_count=0;
+			reader.readString(&category_name);
+			reader.readString(&folder_name);
+			reader.readInt32(&template_count);
+
+			ObjectCategory *category=getCategory(category_name);
+			for (size_t i=0; (i<template_count) && valid; i++) {
+				ObjectTemplateFile template_file;
+				template_file.category = category;
+				reader.readString(&template_file.name);
+
+				Object *templ=new Object(template_file.name);
+				valid = templ->readTemplateCache(&reader);
+				files.push_back(template_file);
+				templates.push_back(templ);
+			}
+		}
+
+		file.close();
+
+		if (!valid || reader.hasOverflowed()) {
+			for (size_t i=0; i<templates.size(); i++) {
+				delete templates[i];
+			}
+
+			return false;
+		}
+
+		for (size_t i=0; i<files.size(); i++) {
+			indexTemplate(files[i].category, templates[i]);
+		}
+
+		return true;
+	}
+
+
+	void ObjectLibrary::saveCache(string filename, unsigned long long manifest_hash) {
+		File file(filename, LIBGENS_FILE_WRITE_BINARY);
+		if (!file.valid()) {
+			return;
+		}
+
+		unsigned int signature=LIBGENS_LIBRARY_CACHE_SIGNATURE;
+		unsigned int version=LIBGENS_LIBRARY_CACHE_VERSION;
+		unsigned int hash[2]={ (unsigned int) manifest_hash, (unsigned int) (manifest_hash >> 32) };
+		unsigned int category_count=categories.size();
+		file.writeInt32(&signature);
+		file.writeInt32(&version);
+		file.writeInt32(&hash[0]);
+		file.writeInt32(&hash[1]);
+		file.writeInt32(&category_count);
+
+		for (vector<ObjectCategory *>::iterator it=categories.begin(); it!=categories.end(); it++) {
+			string category_name=(*it)->getName();
+			string folder_name=(*it)->getFolder();
+			vector<Object *> templates=(*it)->getTemplates();
+			unsigned int template_count=templates.size();
+			file.writeString(&category_name);
+			file.writeString(&folder_name);
+			file.writeInt32(&template_count);
+
+			for (size_t i=0; i<templates.size(); i++) {
+				string template_name=templates[i]->getName();
+				file.writeString(&template_name);
+				templates[i]->writeTemplateCache(&file);
+			}
+		}
+
+		file.close();
+	}
+
+
 	void ObjectLibrary::saveDatabase(string filename) {
 		TiXmlDocument doc;
 		TiXmlDeclaration *decl = new TiXmlDeclaration( "1.0", "", "" );
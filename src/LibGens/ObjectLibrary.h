@@ -25,10 +25,29 @@ namespace LibGens {
 	class ObjectSet;
 	class Level;
 
+	struct ObjectTemplateFile {
+		ObjectCategory *category;
+		string name;
+		string filename;
+	};
+
+	// Template XML files are parsed in parallel and every template is indexed by name across categories.
+	// loadDatabase also keeps a compiled binary cache next to the database file. The cache is keyed by a
+	// hash of the category list and of the name, size and write time of every template file, so editing,
+	// adding or removing a template rebuilds it on the next load.
+	//
+	// Templates must be added through the library to be found by getTemplate.
 	class ObjectLibrary {
 		protected:
 			vector<ObjectCategory *> categories;
+			unordered_map<string, Object *> template_index;
 			string folder;
+
+			void indexTemplate(ObjectCategory *category, Object *templ);
+			void listTemplateFiles(ObjectCategory *category, vector<ObjectTemplateFile> *files, string *manifest);
+			void loadTemplateFiles(vector<ObjectTemplateFile> &files);
+			bool loadCache(string filename, unsigned long long manifest_hash);
+			void saveCache(string filename, unsigned long long manifest_hash);
 		public:
 			ObjectLibrary(string folder_p);
 			ObjectCategory *getCategory(string name);
@@ -39,7 +58,8 @@ namespace LibGens {
 			Object *getTemplate(string name);
 			void learnFromSet(ObjectSet *set, ObjectCategory *default_category=NULL);
 			void learnFromLevel(Level *level, ObjectCategory *default_category=NULL);
-			void loadDatabase(string filename);
+			void loadDatabase(string filename, bool use_cache=true);
+			static string getCacheFilename(string filename);
 			void saveDatabase(string filename);
 	};
 };
\ No newline at end of file
@@ -20,23 +20,143 @@
 #include "ObjectSet.h"
 #include "Object.h"
 #include "Level.h"
+#include "XMLReader.h"
 
 namespace LibGens {
+	ObjectIDIndex::ObjectIDIndex() {
+		first_free_word = 0;
+	}
+
+	void ObjectIDIndex::setUsed(size_t id, bool used) {
+		if ((id < LIBGENS_LEVEL_START_ID_GENERATION) || (id - LIBGENS_LEVEL_START_ID_GENERATION >= LIBGENS_OBJECT_ID_BITMAP_LIMIT)) return;
+
+		size_t bit = id - LIBGENS_LEVEL_START_ID_GENERATION;
+		size_t word = bit / 64;
+		unsigned long long mask = 1ULL << (bit % 64);
+
+		if (used) {
+			if (word >= used_words.size()) used_words.resize(word + 1, 0);
+			used_words[word] |= mask;
+
+			while ((first_free_word < used_words.size()) && (used_words[first_free_word] == ~0ULL)) {
+				first_free_word++;
+			}
+		}
+		else if (word < used_words.size()) {
+			used_words[word] &= ~mask;
+			if (word < first_free_word) first_free_word = word;
+		}
+	}
+
+	void ObjectIDIndex::add(Object *obj, size_t id) {
+		vector<Object *> &id_objects = objects[id];
+		id_objects.push_back(obj);
+		if (id_objects.size() == 1) setUsed(id, true);
+	}
+
+	void ObjectIDIndex::remove(Object *obj, size_t id) {
+		unordered_map<size_t, vector<Object *>>::iterator it = objects.find(id);
+		if (it == objects.end()) return;
+
+		vector<Object *> &id_objects = it->second;
+		vector<Object *>::iterator obj_it = std::find(id_objects.begin(), id_objects.end(), obj);
+		if (obj_it == id_objects.end()) return;
+
+		id_objects.erase(obj_it);
+		if (id_objects.empty()) {
+			objects.erase(it);
+			setUsed(id, false);
+		}
+	}
+
+	Object *ObjectIDIndex::get(size_t id) {
+		unordered_map<size_t, vector<Object *>>::iterator it = objects.find(id);
+		if (it == objects.end()) return NULL;
+
+		return it->second.front();
+	}
+
+	bool ObjectIDIndex::has(size_t id) {
+		return objects.find(id) != objects.end();
+	}
+
+	unsigned long long ObjectIDIndex::getUsedWord(size_t word) {
+		if (word < used_words.size()) return used_words[word];
+		return 0;
+	}
+
+	size_t ObjectIDIndex::getFirstFreeWord() {
+		return first_free_word;
+	}
+
+	void ObjectIDIndex::clear() {
+		objects.clear();
+		used_words.clear();
+		first_free_word = 0;
+	}
+
+	size_t ObjectIDIndex::newID(const vector<ObjectIDIndex *> &indices) {
+		// Every word before an index's first free word is full in that index, so it's full in the union too
+		size_t word = 0;
+		for (size_t i=0; i<indices.size(); i++) {
+			word = max(word, indices[i]->getFirstFreeWord());
+		}
+
+		size_t bitmap_words = (LIBGENS_OBJECT_ID_BITMAP_LIMIT + 63) / 64;
+		for (; word < bitmap_words; word++) {
+			unsigned long long used = 0;
+			for (size_t i=0; i<indices.size(); i++) used |= indices[i]->getUsedWord(word);
+			if (used == ~0ULL) continue;
+
+			size_t bit = 0;
+			while (used & 1) {
+				used >>= 1;
+				bit++;
+			}
+
+			size_t id = LIBGENS_LEVEL_START_ID_GENERATION + word * 64 + bit;
+			if (id - LIBGENS_LEVEL_START_ID_GENERATION < LIBGENS_OBJECT_ID_BITMAP_LIMIT) return id;
+			break;
+		}
+
+		// Only reached with more than LIBGENS_OBJECT_ID_BITMAP_LIMIT objects
+		size_t id;
+		for (id=LIBGENS_LEVEL_START_ID_GENERATION + LIBGENS_OBJECT_ID_BITMAP_LIMIT; id<LIBGENS_LEVEL_END_ID_GENERATION; id++) {
+			bool used = false;
+			for (size_t i=0; (i<indices.size()) && !used; i++) used = indices[i]->has(id);
+			if (!used) break;
+		}
+
+		return id;
+	}
+
 	ObjectSet::ObjectSet() {
 		need_update=false;
+		object_indices_dirty=false;
 	}
 
 	ObjectSet::ObjectSet(string filename_p) {
 		filename = filename_p;
 
 		need_update = false;
+		object_indices_dirty = false;
 
-		TiXmlDocument doc(filename);
-		if (!doc.LoadFile()) {
-			Error::addMessage(Error::FILE_NOT_FOUND, LIBGENS_FILE_H_ERROR_READ_FILE_BEFORE + filename + LIBGENS_FILE_H_ERROR_READ_FILE_AFTER);
+		// Set files are read straight from the mapped file with the pull parser, without a DOM.
+		File file(filename, LIBGENS_FILE_READ_BINARY);
+		if (!file.valid()) {
 			return;
 		}
 
+		size_t data_size=0;
+		const unsigned char *data=file.getMemoryData(&data_size);
+		vector<unsigned char> buffer;
+		if (!data) {
+			buffer.resize(file.getFileSize());
+			buffer.resize(file.read(buffer.data(), buffer.size()));
+			data = buffer.data();
+			data_size = buffer.size();
+		}
+
 		name = filename;
 		size_t sep = name.find(LIBGENS_OBJECT_SET_NAME);
 		if (sep != std::string::npos) {
@@ -48,42 +168,47 @@ namespace LibGens {
 			name = name.substr(0, dot);
 		}
 
-		TiXmlHandle hDoc(&doc);
-		TiXmlElement* pElem;
-		TiXmlHandle hRoot(0);
-
-		pElem=hDoc.FirstChildElement().Element();
-		if (!pElem) {
+		XMLReader reader((const char *) data, data_size);
+		if (!reader.nextChild(0)) {
 			Error::addMessage(Error::EXCEPTION, LIBGENS_OBJECT_H_ERROR_READ_SET_BEFORE + filename + LIBGENS_OBJECT_H_ERROR_READ_SET_AFTER);
+			file.close();
 			return;
 		}
 		
 		// Go past SetObject
-		pElem=pElem->FirstChildElement();
-		for(pElem; pElem; pElem=pElem->NextSiblingElement()) {
-			if (pElem->ValueStr() != LIBGENS_OBJECT_SET_LAYER_DEFINE) {
-				Object *obj=new Object(pElem->ValueStr());
-				obj->readXML(pElem);
+		size_t depth=reader.getDepth();
+		while (reader.nextChild(depth)) {
+			if (!reader.isName(LIBGENS_OBJECT_SET_LAYER_DEFINE)) {
+				Object *obj=new Object(reader.getName());
+				obj->readXML(&reader);
 				obj->setParentSet(this);
-				objects.push_back(obj);
+				indexObject(obj);
 			}
 		}
+
+		file.close();
 	}
 
 
 	Object *ObjectSet::getByID(size_t id, unsigned int *output_index) {
-		size_t index = 0;
-		for (list<Object *>::iterator it=objects.begin(); it!=objects.end(); it++) {
-			if ((*it)->getID() == id) {
-				if (output_index) {
-					*output_index = index;
-				}
-				return *it;
-			}
-			index++;
+		Object *object = id_index.get(id);
+		if (object && output_index) {
+			if (object_indices_dirty) renumberObjects();
+			*output_index = object_positions[object].index;
 		}
 
-		return NULL;
+		return object;
+	}
+
+	void ObjectSet::updateObjectID(Object *obj, size_t old_id) {
+		if (object_positions.find(obj) == object_positions.end()) return;
+
+		id_index.remove(obj, old_id);
+		id_index.add(obj, obj->getID());
+	}
+
+	ObjectIDIndex *ObjectSet::getIDIndex() {
+		return &id_index;
 	}
 
 
@@ -114,6 +239,40 @@ namespace LibGens {
 		}
 	}
 
+	bool ObjectSet::readSnapshot(FileReader *reader) {
+		unsigned int object_count=0;
+		reader->readString(&name);
+		reader->readInt32(&object_count);
+
+		for (size_t i=0; (i<object_count) && !reader->hasOverflowed(); i++) {
+			string object_name="";
+			reader->readString(&object_name);
+
+			Object *obj=new Object(object_name);
+			if (!obj->readSnapshot(reader)) {
+				delete obj;
+				return false;
+			}
+
+			obj->setParentSet(this);
+			indexObject(obj);
+		}
+
+		return !reader->hasOverflowed();
+	}
+
+	void ObjectSet::writeSnapshot(File *file) {
+		unsigned int object_count=objects.size();
+		file->writeString(&name);
+		file->writeInt32(&object_count);
+
+		for (list<Object *>::iterator it=objects.begin(); it!=objects.end(); it++) {
+			string object_name=(*it)->getName();
+			file->writeString(&object_name);
+			(*it)->writeSnapshot(file);
+		}
+	}
+
 	void ObjectSet::getObjectsByName(string name, list<Object *> &total_list) {
 		for (list<Object *>::iterator it=objects.begin(); it!=objects.end(); it++) {
 			if ((*it)->getName() == name) {
@@ -124,14 +283,8 @@ namespace LibGens {
 
 
 	size_t ObjectSet::newObjectID() {
-		size_t id;
-
-		for (id=LIBGENS_LEVEL_START_ID_GENERATION; id<LIBGENS_LEVEL_END_ID_GENERATION; id++) {
-			Object *object=getByID(id);
-			if (!object) break;
-		}
-
-		return id;
+		vector<ObjectIDIndex *> indices(1, &id_index);
+		return ObjectIDIndex::newID(indices);
 	}
 
 	void ObjectSet::setName(string nm) {
@@ -150,26 +303,49 @@ namespace LibGens {
 		return filename;
 	}
 
+	void ObjectSet::indexObject(Object *obj) {
+		if (object_positions.find(obj) != object_positions.end()) return;
+
+		objects.push_back(obj);
+
+		ObjectPosition position;
+		position.it = std::prev(objects.end());
+		position.index = objects.size() - 1;
+		object_positions[obj] = position;
+		id_index.add(obj, obj->getID());
+	}
+
+	void ObjectSet::renumberObjects() {
+		size_t index = 0;
+		for (list<Object *>::iterator it=objects.begin(); it!=objects.end(); it++, index++) {
+			object_positions[*it].index = index;
+		}
+		object_indices_dirty = false;
+	}
+
 	void ObjectSet::addObject(Object *obj) {
 		if (obj) {
 			need_update = true;
-			objects.push_back(obj);
+			indexObject(obj);
 			obj->setParentSet(this);
 		}
 	}
 
 	bool ObjectSet::hasObject(Object *obj) {
-		return std::find(objects.begin(), objects.end(), obj) != objects.end();
+		return object_positions.find(obj) != object_positions.end();
 	}
 
 	void ObjectSet::eraseObject(Object *obj) {
-		for (list<Object *>::iterator it=objects.begin(); it!=objects.end(); it++) {
-			if ((*it) == obj) {
-				objects.erase(it);
-				need_update = true;
-				return;
-			}
-		}
+		unordered_map<Object *, ObjectPosition>::iterator it=object_positions.find(obj);
+		if (it == object_positions.end()) return;
+
+		// Only the objects after the erased one move
+		if (it->second.it != std::prev(objects.end())) object_indices_dirty = true;
+
+		id_index.remove(obj, obj->getID());
+		objects.erase(it->second.it);
+		object_positions.erase(it);
+		need_update = true;
 	}
 
 	list<Object *> ObjectSet::getObjects() {
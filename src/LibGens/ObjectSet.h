@@ -21,16 +21,56 @@
 
 #define LIBGENS_OBJECT_SET_BASE "base"
 
+#define LIBGENS_OBJECT_ID_BITMAP_LIMIT 0x1000000
+
 namespace LibGens {
 	class Object;
 	class ObjectLibrary;
 
+	// Objects by ID, plus a bitmap of the IDs in use from LIBGENS_LEVEL_START_ID_GENERATION so the lowest free ID
+	// is found a word at a time. IDs past the bitmap limit are only kept in the hash map.
+	// Several objects can share an ID for a while (a clone keeps its source's ID until it gets a new one),
+	// so each ID keeps its objects in insertion order and lookups return the first one.
+	class ObjectIDIndex {
+		protected:
+			unordered_map<size_t, vector<Object *>> objects;
+			vector<unsigned long long> used_words;
+			size_t first_free_word;
+
+			void setUsed(size_t id, bool used);
+		public:
+			ObjectIDIndex();
+			void add(Object *obj, size_t id);
+			void remove(Object *obj, size_t id);
+			Object *get(size_t id);
+			bool has(size_t id);
+			unsigned long long getUsedWord(size_t word);
+			size_t getFirstFreeWord();
+			void clear();
+
+			// Lowest ID from LIBGENS_LEVEL_START_ID_GENERATION that isn't used in any of the indices.
+			static size_t newID(const vector<ObjectIDIndex *> &indices);
+	};
+
 	class ObjectSet {
 		protected:
+			// Position of an object in the list and its index in it. Erasing an object shifts the
+			// indices after it, so they're renumbered in one pass the next time an index is asked for.
+			struct ObjectPosition {
+				list<Object *>::iterator it;
+				size_t index;
+			};
+
 			list<Object *> objects;
+			unordered_map<Object *, ObjectPosition> object_positions;
+			bool object_indices_dirty;
+			ObjectIDIndex id_index;
 			string name;
 			string filename;
 			bool need_update;
+
+			void indexObject(Object *obj);
+			void renumberObjects();
 		public:
 			ObjectSet(string filename_p);
 			ObjectSet();
@@ -44,8 +84,14 @@ namespace LibGens {
 			// Doesn't delete the object, only removes it from the list
 			void eraseObject(Object *obj);
 			Object *getByID(size_t id, unsigned int *output_index=NULL);
+
+			// Keeps the ID index in sync, called by Object::setID
+			void updateObjectID(Object *obj, size_t old_id);
+			ObjectIDIndex *getIDIndex();
 			void getObjectsByName(string name, list<Object *> &total_list);
 			void saveXML(string filename);
+			bool readSnapshot(FileReader *reader);
+			void writeSnapshot(File *file);
 			list<Object *> getObjects();
 			void learnFromLibrary(ObjectLibrary *library);
 			size_t newObjectID();
@@ -0,0 +1,63 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "Parallel.h"
+
+namespace LibGens {
+	unsigned int Parallel::thread_count=0;
+
+	// Set while a thread runs items of a forEach, so loops nested inside a task run inline instead of multiplying threads.
+	static thread_local bool parallel_inside_task=false;
+
+	void Parallel::setThreadCount(unsigned int v) {
+		thread_count = v;
+	}
+
+	unsigned int Parallel::getThreadCount() {
+		if (thread_count) return thread_count;
+
+		unsigned int hardware_count = thread::hardware_concurrency();
+		return hardware_count ? hardware_count : 1;
+	}
+
+	void Parallel::forEach(size_t count, const function<void(size_t)> &task) {
+		size_t workers = getThreadCount();
+		if (workers > count) workers = count;
+
+		if ((workers <= 1) || parallel_inside_task) {
+			for (size_t i=0; i<count; i++) task(i);
+			return;
+		}
+
+		atomic<size_t> next_index(0);
+		auto worker = [&]() {
+			parallel_inside_task = true;
+			for (size_t i=next_index++; i<count; i=next_index++) task(i);
+			parallel_inside_task = false;
+		};
+
+		vector<thread> threads;
+		threads.reserve(workers - 1);
+		for (size_t i=1; i<workers; i++) threads.push_back(thread(worker));
+
+		worker();
+
+		for (size_t i=0; i<threads.size(); i++) threads[i].join();
+	}
+};
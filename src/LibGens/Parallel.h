@@ -0,0 +1,37 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#pragma once
+
+namespace LibGens {
+	// Fork-join helper for data parallel loops. Items are handed out one at a time from a shared
+	// counter, so items of uneven cost (files of different sizes, etc.) still balance across threads.
+	// The calling thread works too; the task must be safe to run concurrently for different indices.
+	// A forEach called from inside a task runs inline on that thread.
+	class Parallel {
+		protected:
+			static unsigned int thread_count;
+		public:
+			// 0 selects the hardware concurrency.
+			static void setThreadCount(unsigned int v);
+			static unsigned int getThreadCount();
+
+			static void forEach(size_t count, const function<void(size_t)> &task);
+	};
+};
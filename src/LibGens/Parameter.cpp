@@ -40,8 +40,9 @@ namespace LibGens {
 		file->goToAddress(name_address);
 		file->readString(&name);
 
-		file->goToAddress(color_address);
-		color.read(file, true);
+		FileReader reader;
+		file->prepareReader(&reader, color_address, sizeof(float) * 4);
+		color.read(&reader, true);
 	}
 
 	
@@ -20,6 +20,11 @@
 #include "Path.h"
 
 namespace LibGens {
+	Path::Path() {
+		library = NULL;
+		scene = NULL;
+	}
+
 	Path::Path(string filename) {
 		library = NULL;
 		scene = NULL;
@@ -624,6 +629,186 @@ namespace LibGens {
 	}
 
 
+	void Knot::readSnapshot(FileReader *reader) {
+		reader->readString(&type);
+		invec.read(reader, false);
+		outvec.read(reader, false);
+		point.read(reader, false);
+	}
+
+	void Spline3D::readSnapshot(FileReader *reader) {
+		unsigned int knots_count=0;
+		reader->readInt32(&count);
+		reader->readInt32(&knots_count);
+
+		for (size_t i=0; (i<knots_count) && !reader->hasOverflowed(); i++) {
+			Knot *knot=new Knot();
+			knot->readSnapshot(reader);
+			knots.push_back(knot);
+		}
+	}
+
+	void Spline::readSnapshot(FileReader *reader) {
+		unsigned int spline3d_count=0;
+		reader->readInt32(&count);
+		reader->readFloat32(&width);
+		reader->readInt32(&spline3d_count);
+
+		for (size_t i=0; (i<spline3d_count) && !reader->hasOverflowed(); i++) {
+			Spline3D *spline=new Spline3D();
+			spline->readSnapshot(reader);
+			splines.push_back(spline);
+		}
+	}
+
+	void Geometry::readSnapshot(FileReader *reader) {
+		unsigned char has_spline=0;
+		reader->readString(&id);
+		reader->readString(&name);
+		reader->readUChar(&has_spline);
+
+		if (has_spline) {
+			spline = new Spline();
+			spline->readSnapshot(reader);
+		}
+	}
+
+	void Library::readSnapshot(FileReader *reader) {
+		unsigned int geoms_count=0;
+		reader->readString(&type);
+		reader->readInt32(&geoms_count);
+
+		for (size_t i=0; (i<geoms_count) && !reader->hasOverflowed(); i++) {
+			Geometry *geom=new Geometry();
+			geom->readSnapshot(reader);
+			geoms.push_back(geom);
+		}
+	}
+
+	void Node::readSnapshot(FileReader *reader) {
+		reader->readString(&id);
+		reader->readString(&name);
+		reader->readString(&instance_url);
+		translate.read(reader, false);
+		scale.read(reader, false);
+		reader->readFloat32(&rotate.x);
+		reader->readFloat32(&rotate.y);
+		reader->readFloat32(&rotate.z);
+		reader->readFloat32(&rotate.w);
+	}
+
+	void Scene::readSnapshot(FileReader *reader) {
+		unsigned int node_count=0;
+		reader->readString(&id);
+		reader->readInt32(&node_count);
+
+		for (size_t i=0; (i<node_count) && !reader->hasOverflowed(); i++) {
+			Node *node=new Node();
+			node->readSnapshot(reader);
+			nodes.push_back(node);
+		}
+	}
+
+	bool Path::readSnapshot(FileReader *reader) {
+		unsigned char has_library=0;
+		unsigned char has_scene=0;
+
+		reader->readUChar(&has_library);
+		if (has_library) {
+			library=new Library();
+			library->readSnapshot(reader);
+		}
+
+		reader->readUChar(&has_scene);
+		if (has_scene) {
+			scene=new Scene();
+			scene->readSnapshot(reader);
+		}
+
+		return !reader->hasOverflowed();
+	}
+
+	void Knot::writeSnapshot(File *file) {
+		file->writeString(&type);
+		invec.write(file, false);
+		outvec.write(file, false);
+		point.write(file, false);
+	}
+
+	void Spline3D::writeSnapshot(File *file) {
+		unsigned int knots_count=knots.size();
+		file->writeInt32(&count);
+		file->writeInt32(&knots_count);
+
+		for (vector<Knot *>::iterator it=knots.begin(); it!=knots.end(); it++) {
+			(*it)->writeSnapshot(file);
+		}
+	}
+
+	void Spline::writeSnapshot(File *file) {
+		unsigned int spline3d_count=splines.size();
+		file->writeInt32(&count);
+		file->writeFloat32(&width);
+		file->writeInt32(&spline3d_count);
+
+		for (list<Spline3D *>::iterator it=splines.begin(); it!=splines.end(); it++) {
+			(*it)->writeSnapshot(file);
+		}
+	}
+
+	void Geometry::writeSnapshot(File *file) {
+		unsigned char has_spline=(spline ? 1 : 0);
+		file->writeString(&id);
+		file->writeString(&name);
+		file->writeUChar(&has_spline);
+
+		if (spline) spline->writeSnapshot(file);
+	}
+
+	void Library::writeSnapshot(File *file) {
+		unsigned int geoms_count=geoms.size();
+		file->writeString(&type);
+		file->writeInt32(&geoms_count);
+
+		for (list<Geometry *>::iterator it=geoms.begin(); it!=geoms.end(); it++) {
+			(*it)->writeSnapshot(file);
+		}
+	}
+
+	void Node::writeSnapshot(File *file) {
+		file->writeString(&id);
+		file->writeString(&name);
+		file->writeString(&instance_url);
+		translate.write(file, false);
+		scale.write(file, false);
+		file->writeFloat32(&rotate.x);
+		file->writeFloat32(&rotate.y);
+		file->writeFloat32(&rotate.z);
+		file->writeFloat32(&rotate.w);
+	}
+
+	void Scene::writeSnapshot(File *file) {
+		unsigned int node_count=nodes.size();
+		file->writeString(&id);
+		file->writeInt32(&node_count);
+
+		for (list<Node *>::iterator it=nodes.begin(); it!=nodes.end(); it++) {
+			(*it)->writeSnapshot(file);
+		}
+	}
+
+	void Path::writeSnapshot(File *file) {
+		unsigned char has_library=(library ? 1 : 0);
+		unsigned char has_scene=(scene ? 1 : 0);
+
+		file->writeUChar(&has_library);
+		if (library) library->writeSnapshot(file);
+
+		file->writeUChar(&has_scene);
+		if (scene) scene->writeSnapshot(file);
+	}
+
+
 	Spline *Library::getSpline(string instance_name) {
 		for (list<Geometry *>::iterator it=geoms.begin(); it!=geoms.end(); it++) {
 			if ((*it)->getID() == instance_name) {
@@ -63,6 +63,8 @@ namespace LibGens {
 			void read(File *file);
 			void readXML(TiXmlElement *parent);
 			void writeXML(TiXmlElement *parent);
+			void readSnapshot(FileReader *reader);
+			void writeSnapshot(File *file);
 
 
 	};
@@ -76,6 +78,8 @@ namespace LibGens {
 			void read(File *file);
 			void readXML(TiXmlElement *parent);
 			void writeXML(TiXmlElement *parent);
+			void readSnapshot(FileReader *reader);
+			void writeSnapshot(File *file);
 
 			vector<Knot *> getKnots() {
 				return knots;
@@ -148,6 +152,8 @@ namespace LibGens {
 			void read(File *file);
 			void readXML(TiXmlElement *parent);
 			void writeXML(TiXmlElement *parent);
+			void readSnapshot(FileReader *reader);
+			void writeSnapshot(File *file);
 
 			list<Spline3D *> getSplines() {
 				return splines;
@@ -211,10 +217,14 @@ namespace LibGens {
 			string name;
 			string id;
 		public:
-			Geometry() {}
+			Geometry() {
+				spline = NULL;
+			}
 			void read(File *file);
 			void readXML(TiXmlElement *parent);
 			void writeXML(TiXmlElement *parent);
+			void readSnapshot(FileReader *reader);
+			void writeSnapshot(File *file);
 
 			string getID() {
 				return id;
@@ -238,6 +248,8 @@ namespace LibGens {
 			void read(File *file);
 			void readXML(TiXmlElement *parent);
 			void writeXML(TiXmlElement *parent);
+			void readSnapshot(FileReader *reader);
+			void writeSnapshot(File *file);
 
 			Spline *getSpline(string instance_name);
 	};
@@ -260,6 +272,8 @@ namespace LibGens {
 			void read(File *file);
 			void readXML(TiXmlElement *parent);
 			void writeXML(TiXmlElement *parent);
+			void readSnapshot(FileReader *reader);
+			void writeSnapshot(File *file);
 
 			void setStageID(size_t v) {
 				stage_id = v;
@@ -297,6 +311,8 @@ namespace LibGens {
 			void read(File *file);
 			void readXML(TiXmlElement *parent);
 			void writeXML(TiXmlElement *parent);
+			void readSnapshot(FileReader *reader);
+			void writeSnapshot(File *file);
 
 			list<Node *> getNodes() {
 				return nodes;
@@ -311,11 +327,16 @@ namespace LibGens {
 			Library *library;
 			Scene *scene;
 		public:
+			Path();
 			Path(string filename);
 			void read(File *file);
 			void readXML(string filename);
 			void save(string filename);
 
+			// Binary copy of the whole path, used by level snapshots.
+			bool readSnapshot(FileReader *reader);
+			void writeSnapshot(File *file);
+
 			Library *getLibrary() {
 				return library;
 			}
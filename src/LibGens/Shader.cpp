@@ -305,6 +305,7 @@ namespace LibGens {
 		ArPack* shader_ar_pack = new ArPack(folder + filename);
 		bool success = shader_ar_pack->getFileCount() != 0;
 		ar_pack->merge(shader_ar_pack);
+		binding_tables.clear();
 		return success;
 	}
 
@@ -424,6 +425,59 @@ namespace LibGens {
 		return pixel_shader_param;
 	}
 
+	void ShaderLibrary::setBindingKind(size_t slot, string name, int kind) {
+		if (slot >= LIBGENS_SHADER_PARAMS_SLOTS) return;
+
+		binding_kinds[slot][name] = kind;
+		binding_tables.clear();
+	}
+
+	bool ShaderLibrary::hasBindingKinds() {
+		for (size_t slot=0; slot<LIBGENS_SHADER_PARAMS_SLOTS; slot++) {
+			if (!binding_kinds[slot].empty()) return true;
+		}
+
+		return false;
+	}
+
+	const vector<ShaderParamBinding> &ShaderLibrary::getBindings(ShaderParams *params, ArFile *code) {
+		pair<ShaderParams *, ArFile *> key(params, code);
+		map<pair<ShaderParams *, ArFile *>, vector<ShaderParamBinding> >::iterator it = binding_tables.find(key);
+		if (it != binding_tables.end()) {
+			return it->second;
+		}
+
+		vector<ShaderParamBinding> &bindings = binding_tables[key];
+		if (!params) return bindings;
+
+		const char *code_begin = NULL;
+		const char *code_end = NULL;
+		if (code && (code->hasData() || code->loadData())) {
+			code_begin = reinterpret_cast<const char *>(code->getData());
+			code_end = code_begin + code->getSize();
+		}
+
+		for (size_t slot=0; slot<LIBGENS_SHADER_PARAMS_SLOTS; slot++) {
+			vector<ShaderParam *> parameter_list = params->getParameterList(slot);
+
+			for (size_t i=0; i<parameter_list.size(); i++) {
+				ShaderParamBinding binding;
+				binding.name = parameter_list[i]->getName();
+				binding.slot = slot;
+				binding.index = parameter_list[i]->getIndex();
+				binding.size = parameter_list[i]->getSize();
+
+				unordered_map<string, int>::iterator kind = binding_kinds[slot].find(binding.name);
+				binding.kind = (kind != binding_kinds[slot].end()) ? kind->second : LIBGENS_SHADER_BINDING_UNKNOWN;
+				binding.used = code_begin && (search(code_begin, code_end, binding.name.begin(), binding.name.end()) != code_end);
+
+				bindings.push_back(binding);
+			}
+		}
+
+		return bindings;
+	}
+
 	bool ShaderLibrary::getMaterialShaders(string shader_list_name, Shader *&vertex_shader, Shader *&pixel_shader, bool no_light, bool no_gi, bool const_tex_coord) {
 		ShaderList *shader_list=getShaderList(shader_list_name);
 		if (shader_list) {
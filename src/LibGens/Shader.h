@@ -25,6 +25,8 @@
 #define LIBGENS_PIXEL_SHADER_EXTENSION                ".pixelshader"
 #define LIBGENS_VERTEX_SHADER_PARAMS_EXTENSION        ".vsparam"
 #define LIBGENS_PIXEL_SHADER_PARAMS_EXTENSION         ".psparam"
+#define LIBGENS_SHADER_PARAMS_SLOTS                   5
+#define LIBGENS_SHADER_BINDING_UNKNOWN                -1
 
 namespace LibGens {
 	class ShaderParam {
@@ -182,6 +184,18 @@ namespace LibGens {
 	class ArPack;
 	class ArFile;
 
+	// A ShaderParams entry resolved against one shader code blob. kind is the id the caller registered
+	// for the name and slot with ShaderLibrary::setBindingKind, or LIBGENS_SHADER_BINDING_UNKNOWN.
+	// used tells if the name appears anywhere in the shader code.
+	struct ShaderParamBinding {
+		string name;
+		unsigned int slot;
+		unsigned char index;
+		unsigned char size;
+		int kind;
+		bool used;
+	};
+
 	class ShaderLibrary {
 		protected:
 			list<ShaderList *> shader_lists;
@@ -194,6 +208,9 @@ namespace LibGens {
 
 			string folder;
 			ArPack* ar_pack;
+
+			unordered_map<string, int> binding_kinds[LIBGENS_SHADER_PARAMS_SLOTS];
+			map<pair<ShaderParams *, ArFile *>, vector<ShaderParamBinding> > binding_tables;
 		public:
 			ShaderLibrary(string folder_p);
 
@@ -210,6 +227,12 @@ namespace LibGens {
 
 			bool getMaterialShaders(string shader_list_name, Shader *&vertex_shader, Shader *&pixel_shader, bool no_light=true, bool no_gi=true, bool const_tex_coord=true);
 
+			// Binding kinds are caller defined ids for parameter names, so binding a material becomes a walk
+			// over a table built once per ShaderParams and code blob instead of name compares and code
+			// searches. Changing the kinds or loading another archive drops the cached tables.
+			void setBindingKind(size_t slot, string name, int kind);
+			bool hasBindingKinds();
+			const vector<ShaderParamBinding> &getBindings(ShaderParams *params, ArFile *code);
 
 	};
 };
@@ -0,0 +1,532 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "SpatialIndex.h"
+
+namespace LibGens {
+	static inline float spatialIndexArea(const AABB &a) {
+		float x = a.end.x - a.start.x;
+		float y = a.end.y - a.start.y;
+		float z = a.end.z - a.start.z;
+		return 2.0f * (x*y + y*z + z*x);
+	}
+
+	// Area of the box holding both a and b.
+	static inline float spatialIndexMergedArea(AABB a, const AABB &b) {
+		a.merge(b);
+		return spatialIndexArea(a);
+	}
+
+	static inline bool spatialIndexContains(const AABB &outer, const AABB &inner) {
+		return (outer.start.x <= inner.start.x) && (outer.start.y <= inner.start.y) && (outer.start.z <= inner.start.z) &&
+			   (outer.end.x >= inner.end.x) && (outer.end.y >= inner.end.y) && (outer.end.z >= inner.end.z);
+	}
+
+	static inline bool spatialIndexOverlaps(const AABB &a, const AABB &b) {
+		return (a.start.x <= b.end.x) && (a.end.x >= b.start.x) &&
+			   (a.start.y <= b.end.y) && (a.end.y >= b.start.y) &&
+			   (a.start.z <= b.end.z) && (a.end.z >= b.start.z);
+	}
+
+	static inline bool spatialIndexSphere(const AABB &a, const Vector3 &center, float radius_squared) {
+		float distance = 0.0f;
+		float d;
+		if (center.x < a.start.x) { d = a.start.x - center.x; distance += d*d; }
+		else if (center.x > a.end.x) { d = center.x - a.end.x; distance += d*d; }
+		if (center.y < a.start.y) { d = a.start.y - center.y; distance += d*d; }
+		else if (center.y > a.end.y) { d = center.y - a.end.y; distance += d*d; }
+		if (center.z < a.start.z) { d = a.start.z - center.z; distance += d*d; }
+		else if (center.z > a.end.z) { d = center.z - a.end.z; distance += d*d; }
+		return distance <= radius_squared;
+	}
+
+	// Slab test, returns the entry distance in *hit_distance
+	static inline bool spatialIndexRay(const AABB &a, const Vector3 &origin, const Vector3 &inverse_direction, float max_distance, float *hit_distance) {
+		float t1 = (a.start.x - origin.x) * inverse_direction.x;
+		float t2 = (a.end.x - origin.x) * inverse_direction.x;
+		float near_t = min(t1, t2);
+		float far_t = max(t1, t2);
+
+		t1 = (a.start.y - origin.y) * inverse_direction.y;
+		t2 = (a.end.y - origin.y) * inverse_direction.y;
+		near_t = max(near_t, min(t1, t2));
+		far_t = min(far_t, max(t1, t2));
+
+		t1 = (a.start.z - origin.z) * inverse_direction.z;
+		t2 = (a.end.z - origin.z) * inverse_direction.z;
+		near_t = max(near_t, min(t1, t2));
+		far_t = min(far_t, max(t1, t2));
+
+		if ((far_t < 0.0f) || (near_t > far_t) || (near_t > max_distance)) return false;
+		*hit_distance = max(near_t, 0.0f);
+		return true;
+	}
+
+
+	Frustum::Frustum() {
+		for (int i=0; i<LIBGENS_SPATIAL_INDEX_FRUSTUM_PLANES; i++) {
+			normals[i] = Vector3(0.0f, 0.0f, 0.0f);
+			distances[i] = 0.0f;
+		}
+	}
+
+	Frustum::Frustum(const Matrix4 &m) {
+		// Left, right, bottom, top, near, far
+		for (int i=0; i<LIBGENS_SPATIAL_INDEX_FRUSTUM_PLANES; i++) {
+			int row = i / 2;
+			float sign = (i % 2) ? -1.0f : 1.0f;
+			setPlane(i, Vector3(m[3][0] + sign * m[row][0], m[3][1] + sign * m[row][1], m[3][2] + sign * m[row][2]), m[3][3] + sign * m[row][3]);
+		}
+	}
+
+	void Frustum::setPlane(int index, Vector3 normal, float distance) {
+		float length = normal.length();
+		if (length > 0.0f) {
+			normal = normal / length;
+			distance /= length;
+		}
+
+		normals[index] = normal;
+		distances[index] = distance;
+	}
+
+	bool Frustum::intersects(const AABB &aabb) const {
+		for (int i=0; i<LIBGENS_SPATIAL_INDEX_FRUSTUM_PLANES; i++) {
+			// Corner furthest along the plane normal
+			const Vector3 &n = normals[i];
+			float x = (n.x >= 0.0f) ? aabb.end.x : aabb.start.x;
+			float y = (n.y >= 0.0f) ? aabb.end.y : aabb.start.y;
+			float z = (n.z >= 0.0f) ? aabb.end.z : aabb.start.z;
+			if (n.x*x + n.y*y + n.z*z + distances[i] < 0.0f) return false;
+		}
+		return true;
+	}
+
+
+	SpatialIndex::SpatialIndex(float margin_p) {
+		root = LIBGENS_SPATIAL_INDEX_NULL_NODE;
+		free_node = LIBGENS_SPATIAL_INDEX_NULL_NODE;
+		margin = margin_p;
+	}
+
+	int SpatialIndex::allocateNode() {
+		int index;
+		if (free_node != LIBGENS_SPATIAL_INDEX_NULL_NODE) {
+			index = free_node;
+			free_node = nodes[index].parent;
+		}
+		else {
+			index = nodes.size();
+			nodes.push_back(Node());
+		}
+
+		Node &node = nodes[index];
+		node.data = NULL;
+		node.parent = LIBGENS_SPATIAL_INDEX_NULL_NODE;
+		node.children[0] = LIBGENS_SPATIAL_INDEX_NULL_NODE;
+		node.children[1] = LIBGENS_SPATIAL_INDEX_NULL_NODE;
+		node.height = 0;
+		return index;
+	}
+
+	void SpatialIndex::freeNode(int index) {
+		nodes[index].data = NULL;
+		nodes[index].height = -1;
+		nodes[index].parent = free_node;
+		free_node = index;
+	}
+
+	bool SpatialIndex::isLeaf(int index) const {
+		return nodes[index].children[0] == LIBGENS_SPATIAL_INDEX_NULL_NODE;
+	}
+
+	void SpatialIndex::refit(int index) {
+		Node &node = nodes[index];
+		const Node &a = nodes[node.children[0]];
+		const Node &b = nodes[node.children[1]];
+		node.aabb = a.aabb;
+		node.aabb.merge(b.aabb);
+		node.height = 1 + max(a.height, b.height);
+	}
+
+	void SpatialIndex::insertLeaf(int leaf) {
+		if (root == LIBGENS_SPATIAL_INDEX_NULL_NODE) {
+			root = leaf;
+			nodes[root].parent = LIBGENS_SPATIAL_INDEX_NULL_NODE;
+			return;
+		}
+
+		// Descend to the sibling that makes the tree grow the least
+		AABB leaf_aabb = nodes[leaf].aabb;
+		int index = root;
+		while (!isLeaf(index)) {
+			const Node &node = nodes[index];
+			float area = spatialIndexArea(node.aabb);
+			float combined_area = spatialIndexMergedArea(node.aabb, leaf_aabb);
+
+			// Cost of making a new parent for this node and the leaf, and the minimum cost of pushing it further down
+			float cost = 2.0f * combined_area;
+			float inheritance_cost = 2.0f * (combined_area - area);
+
+			float child_costs[2];
+			for (int c=0; c<2; c++) {
+				const Node &child = nodes[node.children[c]];
+				float merged_area = spatialIndexMergedArea(child.aabb, leaf_aabb);
+				if (isLeaf(node.children[c])) child_costs[c] = merged_area + inheritance_cost;
+				else child_costs[c] = (merged_area - spatialIndexArea(child.aabb)) + inheritance_cost;
+			}
+
+			if ((cost < child_costs[0]) && (cost < child_costs[1])) break;
+			index = (child_costs[0] < child_costs[1]) ? node.children[0] : node.children[1];
+		}
+
+		int sibling = index;
+		int old_parent = nodes[sibling].parent;
+		int new_parent = allocateNode();
+
+		nodes[new_parent].parent = old_parent;
+		nodes[new_parent].aabb = leaf_aabb;
+		nodes[new_parent].aabb.merge(nodes[sibling].aabb);
+		nodes[new_parent].height = nodes[sibling].height + 1;
+		nodes[new_parent].children[0] = sibling;
+		nodes[new_parent].children[1] = leaf;
+		nodes[sibling].parent = new_parent;
+		nodes[leaf].parent = new_parent;
+
+		if (old_parent != LIBGENS_SPATIAL_INDEX_NULL_NODE) {
+			if (nodes[old_parent].children[0] == sibling) nodes[old_parent].children[0] = new_parent;
+			else nodes[old_parent].children[1] = new_parent;
+		}
+		else {
+			root = new_parent;
+		}
+
+		// Fix the boxes and heights on the way up
+		index = nodes[leaf].parent;
+		while (index != LIBGENS_SPATIAL_INDEX_NULL_NODE) {
+			index = balance(index);
+			refit(index);
+			index = nodes[index].parent;
+		}
+	}
+
+	void SpatialIndex::removeLeaf(int leaf) {
+		if (leaf == root) {
+			root = LIBGENS_SPATIAL_INDEX_NULL_NODE;
+			return;
+		}
+
+		int parent = nodes[leaf].parent;
+		int grand_parent = nodes[parent].parent;
+		int sibling = (nodes[parent].children[0] == leaf) ? nodes[parent].children[1] : nodes[parent].children[0];
+
+		if (grand_parent != LIBGENS_SPATIAL_INDEX_NULL_NODE) {
+			if (nodes[grand_parent].children[0] == parent) nodes[grand_parent].children[0] = sibling;
+			else nodes[grand_parent].children[1] = sibling;
+			nodes[sibling].parent = grand_parent;
+			freeNode(parent);
+
+			int index = grand_parent;
+			while (index != LIBGENS_SPATIAL_INDEX_NULL_NODE) {
+				index = balance(index);
+				refit(index);
+				index = nodes[index].parent;
+			}
+		}
+		else {
+			root = sibling;
+			nodes[sibling].parent = LIBGENS_SPATIAL_INDEX_NULL_NODE;
+			freeNode(parent);
+		}
+	}
+
+	// Rotates the taller grandchild up if the children of index differ in height by more than one.
+	// Returns the node that ends up in the position of index.
+	int SpatialIndex::balance(int index_a) {
+		if (isLeaf(index_a) || (nodes[index_a].height < 2)) return index_a;
+
+		int index_b = nodes[index_a].children[0];
+		int index_c = nodes[index_a].children[1];
+		int difference = nodes[index_c].height - nodes[index_b].height;
+
+		for (int side=0; side<2; side++) {
+			// side 0 rotates c up, side 1 rotates b up
+			int up = side ? index_b : index_c;
+			int other = side ? index_c : index_b;
+			if ((side == 0) && (difference <= 1)) continue;
+			if ((side == 1) && (difference >= -1)) continue;
+
+			int index_f = nodes[up].children[0];
+			int index_g = nodes[up].children[1];
+
+			// Swap index_a and up
+			nodes[up].children[0] = index_a;
+			nodes[up].parent = nodes[index_a].parent;
+			nodes[index_a].parent = up;
+
+			if (nodes[up].parent != LIBGENS_SPATIAL_INDEX_NULL_NODE) {
+				int up_parent = nodes[up].parent;
+				if (nodes[up_parent].children[0] == index_a) nodes[up_parent].children[0] = up;
+				else nodes[up_parent].children[1] = up;
+			}
+			else {
+				root = up;
+			}
+
+			// The taller grandchild stays under up, the shorter one replaces up under index_a
+			int keep = index_f;
+			int move = index_g;
+			if (nodes[index_f].height <= nodes[index_g].height) {
+				keep = index_g;
+				move = index_f;
+			}
+
+			nodes[up].children[1] = keep;
+			nodes[index_a].children[0] = other;
+			nodes[index_a].children[1] = move;
+			nodes[move].parent = index_a;
+
+			refit(index_a);
+			refit(up);
+			return up;
+		}
+
+		return index_a;
+	}
+
+	int SpatialIndex::buildNodes(vector<int> &leaf_nodes, size_t begin, size_t end) {
+		if (end - begin == 1) return leaf_nodes[begin];
+
+		// Split at the median along the longest axis of the leaf centers
+		AABB centers;
+		for (size_t i=begin; i<end; i++) {
+			const AABB &box = nodes[leaf_nodes[i]].aabb;
+			centers.addPoint(Vector3((box.start.x + box.end.x) * 0.5f, (box.start.y + box.end.y) * 0.5f, (box.start.z + box.end.z) * 0.5f));
+		}
+
+		float extents[3] = { centers.end.x - centers.start.x, centers.end.y - centers.start.y, centers.end.z - centers.start.z };
+		int axis = 0;
+		if (extents[1] > extents[axis]) axis = 1;
+		if (extents[2] > extents[axis]) axis = 2;
+
+		size_t middle = begin + (end - begin) / 2;
+		nth_element(leaf_nodes.begin() + begin, leaf_nodes.begin() + middle, leaf_nodes.begin() + end, [this, axis](int a, int b) {
+			const AABB &box_a = nodes[a].aabb;
+			const AABB &box_b = nodes[b].aabb;
+			if (axis == 0) return (box_a.start.x + box_a.end.x) < (box_b.start.x + box_b.end.x);
+			if (axis == 1) return (box_a.start.y + box_a.end.y) < (box_b.start.y + box_b.end.y);
+			return (box_a.start.z + box_a.end.z) < (box_b.start.z + box_b.end.z);
+		});
+
+		int left = buildNodes(leaf_nodes, begin, middle);
+		int right = buildNodes(leaf_nodes, middle, end);
+
+		int index = allocateNode();
+		nodes[index].children[0] = left;
+		nodes[index].children[1] = right;
+		nodes[left].parent = index;
+		nodes[right].parent = index;
+		refit(index);
+		return index;
+	}
+
+	void SpatialIndex::build(const vector<void *> &objects, const vector<AABB> &boxes) {
+		clear();
+
+		size_t count = min(objects.size(), boxes.size());
+		nodes.reserve(count * 2);
+
+		vector<int> leaf_nodes;
+		leaf_nodes.reserve(count);
+		for (size_t i=0; i<count; i++) {
+			if (leaves.count(objects[i])) continue;
+
+			int leaf = allocateNode();
+			nodes[leaf].data = objects[i];
+			nodes[leaf].bounds = boxes[i];
+			nodes[leaf].aabb = boxes[i];
+			nodes[leaf].aabb.expand(margin);
+			leaves[objects[i]] = leaf;
+			leaf_nodes.push_back(leaf);
+		}
+
+		if (!leaf_nodes.empty()) {
+			root = buildNodes(leaf_nodes, 0, leaf_nodes.size());
+			nodes[root].parent = LIBGENS_SPATIAL_INDEX_NULL_NODE;
+		}
+	}
+
+	void SpatialIndex::insert(void *object, AABB aabb) {
+		if (leaves.count(object)) {
+			update(object, aabb);
+			return;
+		}
+
+		int leaf = allocateNode();
+		nodes[leaf].data = object;
+		nodes[leaf].bounds = aabb;
+		nodes[leaf].aabb = aabb;
+		nodes[leaf].aabb.expand(margin);
+		leaves[object] = leaf;
+		insertLeaf(leaf);
+	}
+
+	void SpatialIndex::remove(void *object) {
+		unordered_map<void *, int>::iterator it = leaves.find(object);
+		if (it == leaves.end()) return;
+
+		int leaf = it->second;
+		leaves.erase(it);
+		removeLeaf(leaf);
+		freeNode(leaf);
+	}
+
+	bool SpatialIndex::update(void *object, AABB aabb) {
+		unordered_map<void *, int>::iterator it = leaves.find(object);
+		if (it == leaves.end()) {
+			insert(object, aabb);
+			return true;
+		}
+
+		int leaf = it->second;
+		nodes[leaf].bounds = aabb;
+		if (spatialIndexContains(nodes[leaf].aabb, aabb)) return false;
+
+		removeLeaf(leaf);
+		nodes[leaf].aabb = aabb;
+		nodes[leaf].aabb.expand(margin);
+		insertLeaf(leaf);
+		return true;
+	}
+
+	bool SpatialIndex::has(void *object) {
+		return leaves.count(object) > 0;
+	}
+
+	void SpatialIndex::clear() {
+		nodes.clear();
+		leaves.clear();
+		root = LIBGENS_SPATIAL_INDEX_NULL_NODE;
+		free_node = LIBGENS_SPATIAL_INDEX_NULL_NODE;
+	}
+
+	void SpatialIndex::queryAABB(AABB aabb, vector<void *> *results) {
+		if (root == LIBGENS_SPATIAL_INDEX_NULL_NODE) return;
+
+		vector<int> stack;
+		stack.push_back(root);
+		while (!stack.empty()) {
+			const Node &node = nodes[stack.back()];
+			stack.pop_back();
+
+			if (!spatialIndexOverlaps(node.aabb, aabb)) continue;
+
+			if (node.children[0] == LIBGENS_SPATIAL_INDEX_NULL_NODE) {
+				if (spatialIndexOverlaps(node.bounds, aabb)) results->push_back(node.data);
+			}
+			else {
+				stack.push_back(node.children[0]);
+				stack.push_back(node.children[1]);
+			}
+		}
+	}
+
+	void SpatialIndex::querySphere(Vector3 center, float radius, vector<void *> *results) {
+		if (root == LIBGENS_SPATIAL_INDEX_NULL_NODE) return;
+
+		float radius_squared = radius * radius;
+		vector<int> stack;
+		stack.push_back(root);
+		while (!stack.empty()) {
+			const Node &node = nodes[stack.back()];
+			stack.pop_back();
+
+			if (!spatialIndexSphere(node.aabb, center, radius_squared)) continue;
+
+			if (node.children[0] == LIBGENS_SPATIAL_INDEX_NULL_NODE) {
+				if (spatialIndexSphere(node.bounds, center, radius_squared)) results->push_back(node.data);
+			}
+			else {
+				stack.push_back(node.children[0]);
+				stack.push_back(node.children[1]);
+			}
+		}
+	}
+
+	void SpatialIndex::queryFrustum(const Frustum &frustum, vector<void *> *results) {
+		if (root == LIBGENS_SPATIAL_INDEX_NULL_NODE) return;
+
+		vector<int> stack;
+		stack.push_back(root);
+		while (!stack.empty()) {
+			const Node &node = nodes[stack.back()];
+			stack.pop_back();
+
+			if (!frustum.intersects(node.aabb)) continue;
+
+			if (node.children[0] == LIBGENS_SPATIAL_INDEX_NULL_NODE) {
+				if (frustum.intersects(node.bounds)) results->push_back(node.data);
+			}
+			else {
+				stack.push_back(node.children[0]);
+				stack.push_back(node.children[1]);
+			}
+		}
+	}
+
+	void SpatialIndex::queryRay(Vector3 origin, Vector3 direction, float max_distance, vector<void *> *results, vector<float> *distances) {
+		if (root == LIBGENS_SPATIAL_INDEX_NULL_NODE) return;
+
+		Vector3 inverse_direction(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+		vector<pair<float, void *> > hits;
+
+		vector<int> stack;
+		stack.push_back(root);
+		while (!stack.empty()) {
+			const Node &node = nodes[stack.back()];
+			stack.pop_back();
+
+			float hit_distance = 0.0f;
+			if (!spatialIndexRay(node.aabb, origin, inverse_direction, max_distance, &hit_distance)) continue;
+
+			if (node.children[0] == LIBGENS_SPATIAL_INDEX_NULL_NODE) {
+				if (spatialIndexRay(node.bounds, origin, inverse_direction, max_distance, &hit_distance)) hits.push_back(pair<float, void *>(hit_distance, node.data));
+			}
+			else {
+				stack.push_back(node.children[0]);
+				stack.push_back(node.children[1]);
+			}
+		}
+
+		stable_sort(hits.begin(), hits.end(), [](const pair<float, void *> &a, const pair<float, void *> &b) { return a.first < b.first; });
+		for (size_t i=0; i<hits.size(); i++) {
+			results->push_back(hits[i].second);
+			if (distances) distances->push_back(hits[i].first);
+		}
+	}
+
+	size_t SpatialIndex::getSize() {
+		return leaves.size();
+	}
+
+	int SpatialIndex::getHeight() {
+		if (root == LIBGENS_SPATIAL_INDEX_NULL_NODE) return 0;
+		return nodes[root].height;
+	}
+};
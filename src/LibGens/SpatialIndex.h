@@ -0,0 +1,97 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#pragma once
+
+#define LIBGENS_SPATIAL_INDEX_NULL_NODE          -1
+#define LIBGENS_SPATIAL_INDEX_DEFAULT_MARGIN     1.0f
+#define LIBGENS_SPATIAL_INDEX_FRUSTUM_PLANES     6
+
+namespace LibGens {
+	// Planes point inwards: a point p is inside when normal.dotProduct(p) + distance >= 0 for every plane.
+	class Frustum {
+		public:
+			Vector3 normals[LIBGENS_SPATIAL_INDEX_FRUSTUM_PLANES];
+			float distances[LIBGENS_SPATIAL_INDEX_FRUSTUM_PLANES];
+
+			Frustum();
+
+			// Extracts the planes from a projection * view matrix with the same conventions as Matrix4
+			// (column vectors, clip space depth from -w to w, like Ogre).
+			Frustum(const Matrix4 &view_projection);
+
+			void setPlane(int index, Vector3 normal, float distance);
+			bool intersects(const AABB &aabb) const;
+	};
+
+	// Dynamic bounding volume hierarchy over arbitrary objects identified by pointer, e.g. terrain
+	// groups or instances. Leaves keep the exact box of their object and an enlarged one inside
+	// the tree, so objects that move by less than the margin don't change the tree at all. New
+	// leaves go where they grow the surface area of the tree the least, and the tree is rebalanced
+	// on the way up like an AVL tree, so queries stay logarithmic under incremental updates.
+	class SpatialIndex {
+		protected:
+			struct Node {
+				AABB aabb;
+				AABB bounds;
+				void *data;
+				int parent;
+				int children[2];
+				int height;
+			};
+
+			vector<Node> nodes;
+			int root;
+			int free_node;
+			float margin;
+			unordered_map<void *, int> leaves;
+
+			int allocateNode();
+			void freeNode(int index);
+			bool isLeaf(int index) const;
+			void insertLeaf(int leaf);
+			void removeLeaf(int leaf);
+			int balance(int index);
+			void refit(int index);
+			int buildNodes(vector<int> &leaf_nodes, size_t begin, size_t end);
+		public:
+			SpatialIndex(float margin_p=LIBGENS_SPATIAL_INDEX_DEFAULT_MARGIN);
+
+			// Replaces the contents with a top-down build, faster and better balanced than inserting one by one.
+			void build(const vector<void *> &objects, const vector<AABB> &boxes);
+			void insert(void *object, AABB aabb);
+			void remove(void *object);
+
+			// Returns true if the tree had to be changed, false if the new box still fits in the old leaf.
+			bool update(void *object, AABB aabb);
+			bool has(void *object);
+			void clear();
+
+			void queryAABB(AABB aabb, vector<void *> *results);
+			void querySphere(Vector3 center, float radius, vector<void *> *results);
+			void queryFrustum(const Frustum &frustum, vector<void *> *results);
+
+			// Objects whose box is hit by the ray, nearest hit first. distances receives the hit distances
+			// in units of direction's length when it's not NULL.
+			void queryRay(Vector3 origin, Vector3 direction, float max_distance, vector<void *> *results, vector<float> *distances=NULL);
+
+			size_t getSize();
+			int getHeight();
+	};
+};
@@ -21,56 +21,111 @@
 
 namespace LibGens {
 	GensStringTable::GensStringTable() {
-		null_string_count = 0;
 	}
 
-	void GensStringTable::writeString(File *file, string str) {
+	size_t GensStringTable::findSlot(const char *str, size_t size, unsigned long long hash) {
+		if (slots.empty()) slots.resize(LIBGENS_STRING_TABLE_INITIAL_SLOTS, 0);
+
+		size_t mask=slots.size()-1;
+		size_t slot=(size_t)hash & mask;
+		while (slots[slot]) {
+			const GensString &entry=strings[slots[slot]-1];
+			if ((entry.hash == hash) && (entry.size == size) && !memcmp(&pool[entry.offset], str, size)) break;
+			slot = (slot+1) & mask;
+		}
+
+		return slot;
+	}
+
+	void GensStringTable::growSlots() {
+		vector<size_t> new_slots(slots.size()*2, 0);
+		size_t mask=new_slots.size()-1;
+
+		for (size_t i=0; i<strings.size(); i++) {
+			size_t slot=(size_t)strings[i].hash & mask;
+			while (new_slots[slot]) slot = (slot+1) & mask;
+			new_slots[slot] = i+1;
+		}
+
+		slots.swap(new_slots);
+	}
+
+	void GensStringTable::writeString(File *file, const string &str) {
 		file->writeNull(4);
+		size_t address=file->getCurrentAddress()-4;
 
 		if (!str.size()) {
-			GensString new_string;
-			new_string.addresses.clear();
-			new_string.addresses.push_back(file->getCurrentAddress()-4);
-			new_string.value = "";
-			strings.insert(strings.begin()+null_string_count, new_string);
-			null_string_count++;
+			null_string_addresses.push_back(address);
 			return;
 		}
 
-		for (size_t i=0; i<strings.size(); i++) {
-			if (strings[i].value == str) {
-				strings[i].addresses.push_back(file->getCurrentAddress()-4);
-				return;
-			}
+		unsigned long long hash=XXH3_64bits(str.data(), str.size());
+		size_t slot=findSlot(str.data(), str.size(), hash);
+
+		size_t string_index=slots[slot]-1;
+		if (!slots[slot]) {
+			GensString new_string;
+			new_string.offset = pool.size();
+			new_string.size = str.size();
+			new_string.hash = hash;
+			strings.push_back(new_string);
+
+			pool.insert(pool.end(), str.begin(), str.end());
+			pool.push_back(0);
+
+			string_index = strings.size()-1;
+			slots[slot] = strings.size();
+			if (strings.size()*2 > slots.size()) growSlots();
 		}
 
-		GensString new_string;
-		new_string.addresses.clear();
-		new_string.addresses.push_back(file->getCurrentAddress()-4);
-		new_string.value = str;
-		strings.push_back(new_string);
+		GensStringReference reference;
+		reference.address = address;
+		reference.string_index = string_index;
+		references.push_back(reference);
 	}
 
 	void GensStringTable::write(File *file, bool big_endian) {
-		for (size_t i=0; i<strings.size(); i++) {
-			size_t address=file->getCurrentAddress();
-			if (strings[i].value.size()) file->writeString(&strings[i].value);
-			else {
-				file->writeNull(4);
-			}
-
-			for (size_t j=0; j<strings[i].addresses.size(); j++) {
-				file->goToAddress(strings[i].addresses[j]);
-				if (big_endian) file->writeInt32BEA(&address);
-				else file->writeInt32A(&address);
-			}
-
-			file->goToEnd();
+		// Null entries first, then every unique string in order of first use
+		size_t null_address=file->getCurrentAddress();
+		if (null_string_addresses.size()) {
+			vector<unsigned char> null_entries(null_string_addresses.size()*4, 0);
+			file->write(null_entries.data(), null_entries.size());
+		}
+
+		size_t pool_address=file->getCurrentAddress();
+		if (pool.size()) file->write(pool.data(), pool.size());
+
+		// Patch every reference in a single pass in address order
+		vector<pair<size_t, size_t>> patches;
+		patches.reserve(null_string_addresses.size() + references.size());
+		for (size_t i=0; i<null_string_addresses.size(); i++) {
+			patches.push_back(make_pair(null_string_addresses[i], null_address + i*4));
+		}
+
+		for (size_t i=0; i<references.size(); i++) {
+			patches.push_back(make_pair(references[i].address, pool_address + strings[references[i].string_index].offset));
+		}
+
+		sort(patches.begin(), patches.end());
+
+		for (size_t i=0; i<patches.size(); i++) {
+			file->goToAddress(patches[i].first);
+			if (big_endian) file->writeInt32BEA(&patches[i].second);
+			else file->writeInt32A(&patches[i].second);
 		}
+
+		file->goToEnd();
 	}
 
 	void GensStringTable::clear() {
 		strings.clear();
-		null_string_count = 0;
+		pool.clear();
+		slots.clear();
+		references.clear();
+		null_string_addresses.clear();
+	}
+
+	size_t GensStringTable::getStringCount() {
+		return strings.size();
 	}
 }
\ No newline at end of file
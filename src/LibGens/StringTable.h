@@ -19,21 +19,42 @@
 
 #pragma once
 
+#define LIBGENS_STRING_TABLE_INITIAL_SLOTS 256
+
 namespace LibGens {
+	// Unique string stored in the table's pool, NUL terminated.
 	class GensString {
 		public:
-			vector<size_t> addresses;
-			string value;
+			size_t offset;
+			size_t size;
+			unsigned long long hash;
 	};
 
+	// Location written by writeString, patched with its string's address by write.
+	class GensStringReference {
+		public:
+			size_t address;
+			size_t string_index;
+	};
+
+	// Strings are interned through an open addressing hash table over one shared byte pool, so
+	// writeString deduplicates in constant time and adding a string rarely allocates.
+	// Empty strings aren't deduplicated: each one gets its own null entry at the start of the table.
 	class GensStringTable {
 		protected:
 			vector<GensString> strings;
-			size_t null_string_count;
+			vector<char> pool;
+			vector<size_t> slots;
+			vector<GensStringReference> references;
+			vector<size_t> null_string_addresses;
+
+			size_t findSlot(const char *str, size_t size, unsigned long long hash);
+			void growSlots();
 		public:
 			GensStringTable();
-			void writeString(File *file, string str);
+			void writeString(File *file, const string &str);
 			void write(File *file, bool big_endian);
 			void clear();
+			size_t getStringCount();
 	};
 }
\ No newline at end of file
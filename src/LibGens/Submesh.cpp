@@ -22,20 +22,48 @@
 #include "Model.h"
 #include "Vertex.h"
 #include "VertexFormat.h"
+#include "VertexDecoder.h"
+#include "VertexPacker.h"
 
 namespace LibGens {
 	Submesh::Submesh() {
 		material_name=LIBGENS_MODEL_SUBMESH_UNKNOWN_MATERIAL;
+		vertex_arrays=new VertexArrays();
 		vertex_format=NULL;
 		extra="";
 	}
 
 	Submesh::Submesh(Submesh *clone, LibGens::Matrix4 transform, float uv2_left, float uv2_right, float uv2_top, float uv2_bottom) {
-		size_t vertex_sz = clone->vertices.size();
-		for (size_t v=0; v<vertex_sz; v++) {
-			 Vertex *vertex = new Vertex(clone->vertices[v], transform, uv2_left, uv2_right, uv2_top, uv2_bottom);
-			 vertex->setParent(this);
-			 vertices.push_back(vertex);
+		// Same transformation as the Vertex clone constructor, applied over each array
+		clone->commitVertexViews();
+		vertex_arrays = new VertexArrays(*clone->vertex_arrays);
+
+		Vector3 pos, sca;
+		Quaternion ori;
+		transform.decomposition(pos, sca, ori);
+
+		size_t vertex_sz = vertex_arrays->count;
+		for (size_t v=0; v<vertex_arrays->positions.size(); v++) {
+			vertex_arrays->positions[v] = transform * vertex_arrays->positions[v];
+		}
+
+		vector<Vector3> *directions[] = { &vertex_arrays->normals, &vertex_arrays->tangents, &vertex_arrays->binormals };
+		for (size_t d=0; d<3; d++) {
+			for (size_t v=0; v<directions[d]->size(); v++) {
+				Vector3 &direction = (*directions[d])[v];
+				direction = ori * direction;
+				direction.normalise();
+			}
+		}
+
+		if (vertex_arrays->uvs[1].empty() && vertex_sz) {
+			vertex_arrays->uvs[1].assign(vertex_sz, Vector2());
+		}
+
+		for (size_t v=0; v<vertex_arrays->uvs[1].size(); v++) {
+			Vector2 &uv = vertex_arrays->uvs[1][v];
+			uv.x = uv2_left + uv.x * (uv2_right - uv2_left);
+			uv.y = uv2_top + uv.y * (uv2_bottom - uv2_top);
 		}
 
 		faces = clone->faces;
@@ -49,10 +77,8 @@ namespace LibGens {
 	}
 
 	Submesh::~Submesh() {
-		for (vector<Vertex *>::iterator it=vertices.begin(); it!=vertices.end(); it++) {
-			delete (*it);
-		}
-		vertices.clear();
+		discardVertexViews();
+		delete vertex_arrays;
 
 		if (vertex_format) delete vertex_format;
 	}
@@ -87,13 +113,12 @@ namespace LibGens {
 		file->readInt32BE(&texture_units_size);
 		file->readInt32BEA(&texture_units_address);
 
+		FileReader reader;
+
 		// Faces in Triangle Strip format
-		file->goToAddress(faces_address);
-		for (size_t i=0; i<faces_count; i++) {
-			unsigned short face=0;
-			file->readInt16BE(&face);
-			faces.push_back(face);
-		}
+		faces.resize(faces_count);
+		file->prepareReader(&reader, faces_address, faces_count * sizeof(unsigned short));
+		reader.readInt16BEArray(faces.data(), faces_count);
 
 		// Convert Faces in Triangle Strip to Face Vectors
 		if (topology == TRIANGLE_STRIP) {
@@ -144,29 +169,24 @@ namespace LibGens {
 		vertex_format->setSize(vertex_size);
 
 		// Vertices
-		for (size_t i=0; i<vertices_count; i++) {
-			file->goToAddress(vertices_address + i*vertex_size);
+		file->prepareReader(&reader, vertices_address, vertices_count * vertex_size);
 
-			Vertex *v=new Vertex();
-			v->read(file, vertex_format);
-			v->setParent(this);
-			vertices.push_back(v);
-		}
+		discardVertexViews();
+		VertexDecoder vertex_decoder(vertex_format);
+		vertex_decoder.decode(reader.getData(), reader.getSize(), vertices_count, vertex_arrays);
 
 		// Bone Table
-		file->goToAddress(bones_address);
-
 		if (file->getRootNodeType() >= 6) {
-			for (size_t i = 0; i < bones_size; i++) {
-				unsigned short bone = 0;
-				file->readInt16BE(&bone);
-				bone_table.push_back(bone);
-			}
+			bone_table.resize(bones_size);
+			file->prepareReader(&reader, bones_address, bones_size * sizeof(unsigned short));
+			reader.readInt16BEArray(bone_table.data(), bones_size);
 		}
 		else {
+			file->prepareReader(&reader, bones_address, bones_size);
+			bone_table.reserve(bones_size);
 			for (size_t i = 0; i < bones_size; i++) {
 				unsigned char bone = 0;
-				file->readUChar(&bone);
+				reader.readUChar(&bone);
 				bone_table.push_back(bone);
 			}
 		}
@@ -203,7 +223,8 @@ namespace LibGens {
 		size_t material_name_address=0;
 		unsigned int faces_count=faces.size();
 		size_t faces_address=0;
-		unsigned int vertices_count=vertices.size();
+		commitVertexViews();
+		unsigned int vertices_count=vertex_arrays->count;
 		unsigned int vertex_size=vertex_format->getSize();
 		size_t vertices_address=0;
 		size_t vertex_format_address=0;
@@ -233,8 +254,10 @@ namespace LibGens {
 
 		// Vertices
 		vertices_address = file->getCurrentAddress();
+		Vertex vertex;
 		for (size_t i=0; i<vertices_count; i++) {
-			vertices[i]->write(file, vertex_format);
+			vertex_arrays->copyToVertex(i, &vertex);
+			vertex.write(file, vertex_format);
 		}
 
 		// Vertex Format
@@ -304,8 +327,11 @@ namespace LibGens {
 
 
 	list<Vertex *> Submesh::getVertexList() {
+		lock_guard<mutex> lock(vertex_views_mutex);
+		buildVertexViews();
+
 		list<Vertex *> new_verts;
-		copy(vertices.begin(), vertices.end(), back_inserter(new_verts));
+		copy(vertex_views.begin(), vertex_views.end(), back_inserter(new_verts));
 		return new_verts;
 	}
 
@@ -322,14 +348,31 @@ namespace LibGens {
 
 
 	void Submesh::build(vector<Vertex *> vertices_p, vector<Polygon> faces_vectors_p) {
-		vertices = std::move(vertices_p);
+		vector<Vertex *> vertices = std::move(vertices_p);
 		faces_vectors = std::move(faces_vectors_p);
 
 		meshopt_optimizeVertexCache(&faces_vectors[0].a, &faces_vectors[0].a, faces_vectors.size() * 3, vertices.size());
-		vertices.resize(meshopt_optimizeVertexFetch(vertices.data(), &faces_vectors[0].a, faces_vectors.size() * 3, vertices.data(), vertices.size(), sizeof(vertices[0])));
+
+		// Reordered through a remap table, so the input keeps every vertex once, unused ones included
+		vector<unsigned int> remap(vertices.size());
+		size_t vertex_count = meshopt_optimizeVertexFetchRemap(remap.data(), &faces_vectors[0].a, faces_vectors.size() * 3, vertices.size());
+		meshopt_remapIndexBuffer(&faces_vectors[0].a, &faces_vectors[0].a, faces_vectors.size() * 3, remap.data());
+
+		discardVertexViews();
+		vertex_arrays->allocate(vertex_count);
+		for (size_t i=0; i<vertices.size(); i++) {
+			if (remap[i] != ~0u) vertex_arrays->copyFromVertex(remap[i], vertices[i]);
+		}
+
+		// The submesh takes ownership of the built vertices and keeps their data in the arrays
+		sort(vertices.begin(), vertices.end());
+		vertices.erase(unique(vertices.begin(), vertices.end()), vertices.end());
+		for (size_t i=0; i<vertices.size(); i++) {
+			delete vertices[i];
+		}
 
 		faces.resize(meshopt_stripifyBound(faces_vectors.size() * 3));
-		faces.resize(meshopt_stripify(faces.data(), reinterpret_cast<unsigned short *>(faces_vectors.data()), faces_vectors.size() * 3, vertices.size(), unsigned short(0xFFFF)));
+		faces.resize(meshopt_stripify(faces.data(), reinterpret_cast<unsigned short *>(faces_vectors.data()), faces_vectors.size() * 3, vertex_count, unsigned short(0xFFFF)));
 
 		if (faces[faces.size() - 1] == 0xFFFF) faces.resize(faces.size() - 1);
 
@@ -343,11 +386,55 @@ namespace LibGens {
 	}
 
 	vector<Vertex *> Submesh::getVertices() {
-		return vertices;
+		lock_guard<mutex> lock(vertex_views_mutex);
+		buildVertexViews();
+		return vertex_views;
+	}
+
+	VertexArrays *Submesh::getVertexArrays() {
+		commitVertexViews();
+		return vertex_arrays;
+	}
+
+	// Vertex objects for callers of getVertices and getVertexList, built on first use from the arrays and
+	// owned by the submesh. Edits made to them are written back to the arrays before anything reads the
+	// arrays again. They're only thrown away when the arrays are replaced, so they're never stale.
+	// Callers hold vertex_views_mutex.
+	void Submesh::buildVertexViews() {
+		if (!vertex_views.empty() || !vertex_arrays->count) return;
+
+		vertex_views.reserve(vertex_arrays->count);
+		for (size_t i=0; i<vertex_arrays->count; i++) {
+			Vertex *vertex=new Vertex();
+			vertex_arrays->copyToVertex(i, vertex);
+			vertex->setParent(this);
+			vertex_views.push_back(vertex);
+		}
+	}
+
+	void Submesh::commitVertexViews() {
+		lock_guard<mutex> lock(vertex_views_mutex);
+		for (size_t i=0; i<vertex_views.size(); i++) {
+			vertex_arrays->copyFromVertex(i, vertex_views[i]);
+		}
+	}
+
+	void Submesh::releaseVertexViews() {
+		commitVertexViews();
+		discardVertexViews();
+	}
+
+	void Submesh::discardVertexViews() {
+		lock_guard<mutex> lock(vertex_views_mutex);
+		for (vector<Vertex *>::iterator it=vertex_views.begin(); it!=vertex_views.end(); it++) {
+			delete (*it);
+		}
+		vertex_views.clear();
+		vertex_views.shrink_to_fit();
 	}
 
 	size_t Submesh::getVerticesSize() {
-		return vertices.size();
+		return vertex_arrays->count;
 	}
 
 	vector<unsigned short> Submesh::getFacesIndices() {
@@ -366,10 +453,26 @@ namespace LibGens {
 		return faces_vectors.size();
 	}
 
+	size_t Submesh::packVertices(VertexPacker *packer, void *buffer, size_t buffer_size) {
+		if (!packer) return 0;
+		commitVertexViews();
+		return packer->pack(vertex_arrays, buffer, buffer_size);
+	}
+
+	size_t Submesh::packIndices(unsigned short *buffer, size_t buffer_count) {
+		if (!buffer) return 0;
+
+		size_t count = faces_vectors.size();
+		if (count > buffer_count / 3) count = buffer_count / 3;
+		if (count) memcpy(buffer, &faces_vectors[0], count * sizeof(Polygon));
+		return count * 3;
+	}
+
 	void Submesh::buildAABB() {
+		commitVertexViews();
 		aabb.reset();
-		for (size_t i=0; i<vertices.size(); i++) {
-			aabb.addPoint(vertices[i]->getPosition());
+		for (size_t i=0; i<vertex_arrays->positions.size(); i++) {
+			aabb.addPoint(vertex_arrays->positions[i]);
 		}
 	}
 
@@ -423,7 +526,7 @@ namespace LibGens {
 	}
 
 	unsigned int Submesh::getEstimatedMemorySize() {
-		return vertex_format->getSize() * vertices.size() + faces.size() * 2;
+		return vertex_format->getSize() * vertex_arrays->count + faces.size() * 2;
 	}
 
 	void Submesh::changeVertexFormat(int format) {
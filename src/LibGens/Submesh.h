@@ -28,7 +28,9 @@
 
 namespace LibGens {
 	class Vertex;
+	class VertexArrays;
 	class VertexFormat;
+	class VertexPacker;
 	enum Topology;
 
 	struct Polygon {
@@ -41,7 +43,9 @@ namespace LibGens {
 		friend class Submesh;
 
 		protected:
-			vector<Vertex *> vertices;
+			VertexArrays *vertex_arrays;
+			vector<Vertex *> vertex_views;
+			mutex vertex_views_mutex;
 			vector<unsigned short> faces;
 			vector<Polygon> faces_vectors;
 			vector<unsigned short> bone_table;
@@ -52,6 +56,10 @@ namespace LibGens {
 			AABB aabb;
 			string extra;
 			vector<Vector3> points;
+
+			void buildVertexViews();
+			void commitVertexViews();
+			void discardVertexViews();
 		public:
 			Submesh();
 			Submesh(Submesh *clone, LibGens::Matrix4 transform, float uv2_left, float uv2_right, float uv2_top, float uv2_bottom);
@@ -61,11 +69,20 @@ namespace LibGens {
 			list<Vertex *> getVertexList();
 			list<unsigned int> getFaceList();
 			vector<Vertex *> getVertices();
+			VertexArrays *getVertexArrays();
+
+			// Writes edits made through getVertices and getVertexList back to the arrays and frees the vertices.
+			void releaseVertexViews();
 			size_t getVerticesSize();
 			size_t getFacesSize();
 			vector<unsigned short> getFacesIndices();
 			size_t getFacesIndicesSize();
 			vector<Polygon> getFaces();
+
+			// Write the submesh straight into caller provided upload buffers, see VertexPacker.
+			// Indices are a 16-bit triangle list of getFacesSize() * 3 entries.
+			size_t packVertices(VertexPacker *packer, void *buffer, size_t buffer_size);
+			size_t packIndices(unsigned short *buffer, size_t buffer_count);
 			void buildAABB();
 			AABB getAABB();
 			void setExtra(string v);
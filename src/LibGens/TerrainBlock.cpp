@@ -94,6 +94,26 @@ namespace LibGens {
 	void TerrainBlockInstance::setRadius(float v) {
 		radius = v;
 	}
+
+	unsigned int TerrainBlockInstance::getType() {
+		return type;
+	}
+
+	unsigned int TerrainBlockInstance::getIdentifierA() {
+		return identifier_a;
+	}
+
+	unsigned int TerrainBlockInstance::getIdentifierB() {
+		return identifier_b;
+	}
+
+	Vector3 TerrainBlockInstance::getCenter() {
+		return center;
+	}
+
+	float TerrainBlockInstance::getRadius() {
+		return radius;
+	}
 	
 	void TerrainBlock::read(File *file) {
 		size_t header_address=file->getCurrentAddress();
@@ -239,7 +259,222 @@ namespace LibGens {
 		return index;
 	}
 
-	void TerrainBlock::build(const std::vector<TerrainGroup*>& groups) {
+	struct TerrainBlockItem {
+		AABB aabb;
+		Vector3 center;
+		uint32_t terrain_group_index;
+		uint32_t instance_index;
+	};
+
+	// A subtree over n items always has 2n-1 nodes, so every subtree gets a fixed range of the
+	// flat node array in pre-order and subtrees can be built on different threads.
+	struct TerrainBlockBuildNode {
+		AABB aabb;
+		size_t children[2];
+		size_t item;
+		bool leaf;
+	};
+
+	struct TerrainBlockBuildTask {
+		size_t begin;
+		size_t end;
+		size_t node;
+	};
+
+	static float terrainBlockArea(const AABB &aabb) {
+		if ((aabb.start.x > aabb.end.x) || (aabb.start.y > aabb.end.y) || (aabb.start.z > aabb.end.z)) return 0.0f;
+
+		float x = aabb.end.x - aabb.start.x;
+		float y = aabb.end.y - aabb.start.y;
+		float z = aabb.end.z - aabb.start.z;
+		return 2.0f * (x*y + y*z + z*x);
+	}
+
+	static float terrainBlockAxis(const Vector3 &v, int axis) {
+		return (axis == 0) ? v.x : ((axis == 1) ? v.y : v.z);
+	}
+
+	// Partitions the items in place and returns where the right side starts
+	static size_t terrainBlockSplitSAH(vector<TerrainBlockItem> &items, size_t begin, size_t end) {
+		AABB centers;
+		for (size_t i=begin; i<end; i++) centers.addPoint(items[i].center);
+
+		int best_axis = -1;
+		int best_bin = 0;
+		float best_cost = 0.0f;
+
+		for (int axis=0; axis<3; axis++) {
+			float axis_start = terrainBlockAxis(centers.start, axis);
+			float extent = terrainBlockAxis(centers.end, axis) - axis_start;
+			if (extent <= 0.0f) continue;
+
+			float scale = LIBGENS_TERRAIN_BLOCK_SAH_BINS / extent;
+			size_t bin_counts[LIBGENS_TERRAIN_BLOCK_SAH_BINS] = {};
+			AABB bin_boxes[LIBGENS_TERRAIN_BLOCK_SAH_BINS];
+
+			for (size_t i=begin; i<end; i++) {
+				int bin = min((int)((terrainBlockAxis(items[i].center, axis) - axis_start) * scale), LIBGENS_TERRAIN_BLOCK_SAH_BINS - 1);
+				bin_counts[bin]++;
+				bin_boxes[bin].merge(items[i].aabb);
+			}
+
+			// Sweep from the right to get the cost of every right side, then from the left
+			float right_costs[LIBGENS_TERRAIN_BLOCK_SAH_BINS];
+			size_t right_count = 0;
+			AABB right_box;
+			for (int bin=LIBGENS_TERRAIN_BLOCK_SAH_BINS-1; bin>0; bin--) {
+				right_count += bin_counts[bin];
+				right_box.merge(bin_boxes[bin]);
+				right_costs[bin] = right_count * terrainBlockArea(right_box);
+			}
+
+			size_t left_count = 0;
+			AABB left_box;
+			for (int bin=0; bin<LIBGENS_TERRAIN_BLOCK_SAH_BINS-1; bin++) {
+				left_count += bin_counts[bin];
+				left_box.merge(bin_boxes[bin]);
+				if (!left_count || (left_count == (end - begin))) continue;
+
+				float cost = left_count * terrainBlockArea(left_box) + right_costs[bin+1];
+				if ((best_axis < 0) || (cost < best_cost)) {
+					best_axis = axis;
+					best_bin = bin;
+					best_cost = cost;
+				}
+			}
+		}
+
+		// Every center in the same spot, split the list in half
+		if (best_axis < 0) return begin + (end - begin) / 2;
+
+		float axis_start = terrainBlockAxis(centers.start, best_axis);
+		float scale = LIBGENS_TERRAIN_BLOCK_SAH_BINS / (terrainBlockAxis(centers.end, best_axis) - axis_start);
+		vector<TerrainBlockItem>::iterator middle = partition(items.begin() + begin, items.begin() + end, [best_axis, best_bin, axis_start, scale](const TerrainBlockItem &item) {
+			return min((int)((terrainBlockAxis(item.center, best_axis) - axis_start) * scale), LIBGENS_TERRAIN_BLOCK_SAH_BINS - 1) <= best_bin;
+		});
+
+		return middle - items.begin();
+	}
+
+	// Builds the subtree of items [begin, end) at node. Ranges up to task_size are left for the
+	// worker threads when tasks isn't NULL.
+	static void terrainBlockBuildSAH(vector<TerrainBlockItem> &items, size_t begin, size_t end, vector<TerrainBlockBuildNode> &nodes, size_t node,
+		vector<TerrainBlockBuildTask> *tasks, size_t task_size) {
+		if (tasks && ((end - begin) <= task_size)) {
+			TerrainBlockBuildTask task;
+			task.begin = begin;
+			task.end = end;
+			task.node = node;
+			tasks->push_back(task);
+			return;
+		}
+
+		TerrainBlockBuildNode &build_node = nodes[node];
+
+		if (end - begin == 1) {
+			build_node.aabb = items[begin].aabb;
+			build_node.leaf = true;
+			build_node.item = begin;
+			return;
+		}
+
+		size_t middle = terrainBlockSplitSAH(items, begin, end);
+		build_node.leaf = false;
+		build_node.children[0] = node + 1;
+		build_node.children[1] = node + 2 * (middle - begin);
+
+		terrainBlockBuildSAH(items, begin, middle, nodes, build_node.children[0], tasks, task_size);
+		terrainBlockBuildSAH(items, middle, end, nodes, build_node.children[1], tasks, task_size);
+
+		// Boxes of subtrees left for the threads aren't there yet, the top of the tree is refit afterwards
+		if (!tasks) {
+			build_node.aabb = nodes[build_node.children[0]].aabb;
+			build_node.aabb.merge(nodes[build_node.children[1]].aabb);
+		}
+	}
+
+	static void terrainBlockRefit(vector<TerrainBlockBuildNode> &nodes, size_t node, const vector<bool> &task_nodes) {
+		TerrainBlockBuildNode &build_node = nodes[node];
+		if (task_nodes[node] || build_node.leaf) return;
+
+		terrainBlockRefit(nodes, build_node.children[0], task_nodes);
+		terrainBlockRefit(nodes, build_node.children[1], task_nodes);
+		build_node.aabb = nodes[build_node.children[0]].aabb;
+		build_node.aabb.merge(nodes[build_node.children[1]].aabb);
+	}
+
+	// Writes children before parents, like buildRecursively
+	static int terrainBlockEmit(const vector<TerrainBlockItem> &items, const vector<TerrainBlockBuildNode> &nodes, size_t node, TerrainBlock *block) {
+		const TerrainBlockBuildNode &build_node = nodes[node];
+		AABB aabb = build_node.aabb;
+
+		TerrainBlockInstance *instance = new TerrainBlockInstance();
+		instance->setCenter(aabb.center());
+		instance->setRadius(aabb.radius());
+
+		if (build_node.leaf) {
+			instance->setType(LIBGENS_TERRAIN_BLOCK_INSTANCE_TYPE_LEAF);
+			instance->setIdentifierA(items[build_node.item].terrain_group_index);
+			instance->setIdentifierB(items[build_node.item].instance_index);
+		}
+		else {
+			instance->setType(LIBGENS_TERRAIN_BLOCK_INSTANCE_TYPE_BRANCH);
+			instance->setIdentifierA(terrainBlockEmit(items, nodes, build_node.children[0], block));
+			instance->setIdentifierB(terrainBlockEmit(items, nodes, build_node.children[1], block));
+		}
+
+		const int index = block->getBlockInstanceCount();
+		block->addBlockInstance(instance);
+		return index;
+	}
+
+	void TerrainBlock::build(const std::vector<TerrainGroup*>& groups, TerrainBlockBuildMode mode) {
+		if (mode == TERRAIN_BLOCK_BUILD_SAH) buildSAH(groups);
+		else buildCenter(groups);
+	}
+
+	void TerrainBlock::buildSAH(const std::vector<TerrainGroup*>& groups) {
+		vector<TerrainBlockItem> items;
+
+		for (size_t i = 0; i < groups.size(); i++) {
+			std::vector<std::vector<TerrainInstance*>> instance_vectors = groups[i]->getInstanceVectors();
+
+			for (size_t j = 0; j < instance_vectors.size(); j++) {
+				TerrainBlockItem item;
+				for (size_t k = 0; k < instance_vectors[j].size(); k++)
+					item.aabb.merge(instance_vectors[j][k]->getAABB());
+
+				item.center = item.aabb.center();
+				item.terrain_group_index = i;
+				item.instance_index = j;
+				items.push_back(item);
+			}
+		}
+
+		if (items.empty()) {
+			root_instance_index = -1;
+			return;
+		}
+
+		// Split the top of the tree here, then finish the subtrees on every thread
+		vector<TerrainBlockBuildNode> nodes(items.size() * 2 - 1);
+		vector<TerrainBlockBuildTask> tasks;
+		size_t task_size = max((size_t) LIBGENS_TERRAIN_BLOCK_PARALLEL_MIN_ITEMS, items.size() / (Parallel::getThreadCount() * 4));
+		terrainBlockBuildSAH(items, 0, items.size(), nodes, 0, &tasks, task_size);
+
+		Parallel::forEach(tasks.size(), [&](size_t t) {
+			terrainBlockBuildSAH(items, tasks[t].begin, tasks[t].end, nodes, tasks[t].node, NULL, 0);
+		});
+
+		vector<bool> task_nodes(nodes.size(), false);
+		for (size_t t=0; t<tasks.size(); t++) task_nodes[tasks[t].node] = true;
+		terrainBlockRefit(nodes, 0, task_nodes);
+
+		blocks.reserve(blocks.size() + nodes.size());
+		root_instance_index = terrainBlockEmit(items, nodes, 0, this);
+	}
+
+	void TerrainBlock::buildCenter(const std::vector<TerrainGroup*>& groups) {
 		std::vector<const TerrainBlockInstanceCache*> items;
 
 		for (size_t i = 0; i < groups.size(); i++) {
@@ -265,4 +500,69 @@ namespace LibGens {
 		for (size_t i = 0; i < items.size(); i++)
 			delete items[i];
 	}
+
+	static float terrainBlockSphereVolume(float radius) {
+		return (4.0f / 3.0f) * LIBGENS_MATH_PI * radius * radius * radius;
+	}
+
+	static float terrainBlockSphereOverlap(Vector3 center_a, float radius_a, Vector3 center_b, float radius_b) {
+		float d = center_a.distance(center_b);
+		if (d >= radius_a + radius_b) return 0.0f;
+		if (d <= fabs(radius_a - radius_b)) return terrainBlockSphereVolume(min(radius_a, radius_b));
+
+		float r = radius_a + radius_b - d;
+		float difference = radius_a - radius_b;
+		return LIBGENS_MATH_PI * r * r * (d*d + 2.0f*d*(radius_a + radius_b) - 3.0f*difference*difference) / (12.0f * d);
+	}
+
+	void TerrainBlock::getQuality(TerrainBlockQuality *quality) {
+		quality->node_count = 0;
+		quality->leaf_count = 0;
+		quality->max_depth = 0;
+		quality->average_leaf_depth = 0.0f;
+		quality->sah_cost = 0.0f;
+		quality->overlap = 0.0f;
+
+		if ((root_instance_index < 0) || ((size_t) root_instance_index >= blocks.size())) return;
+
+		float root_radius = blocks[root_instance_index]->getRadius();
+		float root_area = root_radius * root_radius;
+		double leaf_depth_sum = 0.0;
+		double overlap_sum = 0.0;
+		unsigned int branch_count = 0;
+
+		vector<pair<size_t, unsigned int> > stack;
+		stack.push_back(pair<size_t, unsigned int>(root_instance_index, 1));
+		while (!stack.empty()) {
+			size_t index = stack.back().first;
+			unsigned int depth = stack.back().second;
+			stack.pop_back();
+
+			TerrainBlockInstance *block = blocks[index];
+			float radius = block->getRadius();
+			quality->node_count++;
+			quality->max_depth = max(quality->max_depth, depth);
+			quality->sah_cost += (root_area > 0.0f) ? (radius * radius) / root_area : 1.0f;
+
+			if (block->getType() == LIBGENS_TERRAIN_BLOCK_INSTANCE_TYPE_LEAF) {
+				quality->leaf_count++;
+				leaf_depth_sum += depth;
+				continue;
+			}
+
+			size_t a = block->getIdentifierA();
+			size_t b = block->getIdentifierB();
+			if ((a >= blocks.size()) || (b >= blocks.size())) continue;
+
+			float smaller_volume = terrainBlockSphereVolume(min(blocks[a]->getRadius(), blocks[b]->getRadius()));
+			if (smaller_volume > 0.0f) overlap_sum += terrainBlockSphereOverlap(blocks[a]->getCenter(), blocks[a]->getRadius(), blocks[b]->getCenter(), blocks[b]->getRadius()) / smaller_volume;
+			branch_count++;
+
+			stack.push_back(pair<size_t, unsigned int>(a, depth + 1));
+			stack.push_back(pair<size_t, unsigned int>(b, depth + 1));
+		}
+
+		if (quality->leaf_count) quality->average_leaf_depth = leaf_depth_sum / quality->leaf_count;
+		if (branch_count) quality->overlap = overlap_sum / branch_count;
+	}
 };
\ No newline at end of file
@@ -25,10 +25,32 @@
 #define LIBGENS_TERRAIN_BLOCK_ROOT_GENERATIONS              0
 #define LIBGENS_TERRAIN_BLOCK_INSTANCE_TYPE_BRANCH			0
 #define LIBGENS_TERRAIN_BLOCK_INSTANCE_TYPE_LEAF			1
+#define LIBGENS_TERRAIN_BLOCK_SAH_BINS                      16
+#define LIBGENS_TERRAIN_BLOCK_PARALLEL_MIN_ITEMS            256
 
 namespace LibGens {
 	class TerrainGroup;
 
+	enum TerrainBlockBuildMode {
+		// Splits at the center of the longest axis of the node's box
+		TERRAIN_BLOCK_BUILD_CENTER,
+
+		// Binned surface area heuristic over all three axes, subtrees built in parallel
+		TERRAIN_BLOCK_BUILD_SAH
+	};
+
+	// Measured on the spheres stored in the tree. sah_cost adds one per node visited, weighted by
+	// the node's surface area relative to the root, so it estimates the nodes tested per query.
+	// overlap averages the shared volume of sibling spheres over the volume of the smaller one.
+	struct TerrainBlockQuality {
+		unsigned int node_count;
+		unsigned int leaf_count;
+		unsigned int max_depth;
+		float average_leaf_depth;
+		float sah_cost;
+		float overlap;
+	};
+
 	class TerrainBlockInstance {
 		protected:
 			Vector3 center;
@@ -47,12 +69,20 @@ namespace LibGens {
 			void setIdentifierB(unsigned int v);
 			void setCenter(Vector3 v);
 			void setRadius(float v);
+			unsigned int getType();
+			unsigned int getIdentifierA();
+			unsigned int getIdentifierB();
+			Vector3 getCenter();
+			float getRadius();
 	};
 
 	class TerrainBlock {
 		protected:
 			vector<TerrainBlockInstance *> blocks;
 			int root_instance_index;
+
+			void buildCenter(const std::vector<TerrainGroup*>& groups);
+			void buildSAH(const std::vector<TerrainGroup*>& groups);
 		public:
 			TerrainBlock() {
 				root_instance_index = -1;
@@ -65,7 +95,8 @@ namespace LibGens {
 			void write(File *file);
 			void addBlockInstance(TerrainBlockInstance *instance);
 			size_t getBlockInstanceCount();
-			void build(const std::vector<TerrainGroup*>& groups);
+			void build(const std::vector<TerrainGroup*>& groups, TerrainBlockBuildMode mode=TERRAIN_BLOCK_BUILD_CENTER);
+			void getQuality(TerrainBlockQuality *quality);
 
 			void clean() {
 				for (vector<TerrainBlockInstance *>::iterator it=blocks.begin(); it!=blocks.end(); it++) {
@@ -111,8 +111,10 @@ namespace LibGens {
 				ArFile *entry=ar_pack->getFile(model_name+LIBGENS_TERRAIN_MODEL_EXTENSION);
 				if (entry) {
 					Model *model;
-					if (entry->getData()) {
-						File ar_data_file(entry->getData(), entry->getSize());
+					vector<unsigned char> buffer;
+					const unsigned char *data=entry->viewData(&buffer);
+					if (data) {
+						File ar_data_file(data, entry->getSize());
 						model = new Model(&ar_data_file, true);
 					}
 					else {
@@ -162,8 +164,10 @@ namespace LibGens {
 					ArFile *entry=ar_pack->getFile(instance_name+LIBGENS_TERRAIN_INSTANCE_EXTENSION);
 					if (entry) {
 						TerrainInstance *instance;
-						if (entry->getData()) {
-							File ar_data_file(entry->getData(), entry->getSize());
+						vector<unsigned char> buffer;
+						const unsigned char *data=entry->viewData(&buffer);
+						if (data) {
+							File ar_data_file(data, entry->getSize());
 							instance = new TerrainInstance(&ar_data_file, &models);
 						}
 						else {
@@ -393,5 +397,14 @@ namespace LibGens {
 			delete (*it);
 		}
 		models.clear();
+		loaded = false;
+	}
+
+	unsigned int TerrainGroup::getEstimatedMemorySize() {
+		unsigned int memory_size = 0;
+		for (vector<Model *>::iterator it=models.begin(); it!=models.end(); it++) {
+			memory_size += (*it)->getEstimatedMemorySize();
+		}
+		return memory_size;
 	}
 };
\ No newline at end of file
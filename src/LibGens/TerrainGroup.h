@@ -72,11 +72,16 @@ namespace LibGens {
 			bool checkDistance(Vector3 position_to_check, float extra_range);
 			float getDistance(Vector3 position_to_check);
 			void unload();
+			unsigned int getEstimatedMemorySize();
 
 			void setCenter(Vector3 center_p) {
 				center = center_p;
 			}
 
+			Vector3 getCenter() {
+				return center;
+			}
+
 			void setRadius(float radius_p) {
 				radius = radius_p;
 			}
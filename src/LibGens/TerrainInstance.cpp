@@ -19,7 +19,11 @@
 
 #include "TerrainInstance.h"
 #include "Model.h"
+#include "Mesh.h"
+#include "Submesh.h"
 #include "Vertex.h"
+#include "VertexFormat.h"
+#include "VertexDecoder.h"
 
 namespace LibGens {
 	TerrainInstance::TerrainInstance() {
@@ -85,21 +89,24 @@ namespace LibGens {
 		file->readInt32BE(&faces_total);
 		file->readInt32BEA(&faces_address);
 
-		light_indices.reserve(light_indices_total);
-		for (size_t i=0; i<light_indices_total; i++) {
-			file->goToAddress(light_indices_address + i * file->getAddressSize());
-			unsigned int identifier=0;
-			file->readInt32BE(&identifier);
-			light_indices.push_back(identifier);
-		}
+		FileReader reader;
 
-		faces.reserve(faces_total);
-		for (size_t i=0; i<faces_total; i++) {
-			file->goToAddress(faces_address + i*2);
-			unsigned short face=0;
-			file->readInt16BE(&face);
-			faces.push_back(face);
+		// Light indices are stored with the stride of an address, so only the 32-bit layout is a plain array.
+		light_indices.resize(light_indices_total);
+		file->prepareReader(&reader, light_indices_address, light_indices_total * file->getAddressSize());
+		if (file->getAddressSize() == sizeof(unsigned int)) {
+			reader.readInt32BEArray(light_indices.data(), light_indices_total);
 		}
+		else {
+			for (size_t i=0; i<light_indices_total; i++) {
+				reader.goToAddress(light_indices_address + i * file->getAddressSize());
+				reader.readInt32BE(&light_indices[i]);
+			}
+		}
+
+		faces.resize(faces_total);
+		file->prepareReader(&reader, faces_address, faces_total * sizeof(unsigned short));
+		reader.readInt16BEArray(faces.data(), faces_total);
 	}
 
 	void TerrainInstanceElement::write(File *file) {
@@ -315,8 +322,9 @@ namespace LibGens {
 		file->readString(&model_name);
 
 		// Matrix
-		file->goToAddress(matrix_address);
-		matrix.read(file);
+		FileReader reader;
+		file->prepareReader(&reader, matrix_address, sizeof(matrix.m));
+		matrix.read(&reader);
 
 		// Instance Name
 		file->goToAddress(name_address);
@@ -421,11 +429,27 @@ namespace LibGens {
 	}
 
 	void TerrainInstance::buildAABB() {
-		list<Vertex *> vertices=getVertexList();
 		aabb.reset();
-		for (list<Vertex *>::iterator it=vertices.begin(); it!=vertices.end(); it++) {
-			aabb.addPoint((*it)->getTPosition(matrix));
+
+		if (model) {
+			vector<Mesh *> meshes=model->getMeshes();
+			for (vector<Mesh *>::iterator it=meshes.begin(); it!=meshes.end(); it++) {
+				vector<Submesh *> *submeshes=(*it)->getSubmeshSlots();
+
+				for (size_t slot=0; slot<LIBGENS_MODEL_SUBMESH_SLOTS; slot++) {
+					for (vector<Submesh *>::iterator it_s=submeshes[slot].begin(); it_s!=submeshes[slot].end(); it_s++) {
+						vector<Vector3> &positions=(*it_s)->getVertexArrays()->positions;
+						for (size_t i=0; i<positions.size(); i++) {
+							aabb.addPoint(matrix * positions[i]);
+						}
+					}
+				}
+			}
 		}
+		else {
+			Error::addMessage(Error::NULL_REFERENCE, LIBGENS_TERRAIN_INSTANCE_ERROR_MESSAGE_NULL_MODEL);
+		}
+
 		aabb.expand(LIBGENS_TERRAIN_INSTANCE_AABB_EXPANSION);
 	}
 
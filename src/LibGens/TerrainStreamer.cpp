@@ -0,0 +1,325 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "TerrainGroup.h"
+#include "TerrainStreamer.h"
+#include "SpatialIndex.h"
+
+namespace LibGens {
+	TerrainStreamer::TerrainStreamer() {
+		stopping = false;
+		worker_count = 0;
+		loading_range = LIBGENS_TERRAIN_STREAMER_DEFAULT_RANGE;
+		rescan_distance = LIBGENS_TERRAIN_STREAMER_DEFAULT_RESCAN_DISTANCE;
+		memory_budget = 0;
+		memory_used = 0;
+		rescan = true;
+		group_index = new SpatialIndex();
+	}
+
+	TerrainStreamer::~TerrainStreamer() {
+		stopWorkers();
+		delete group_index;
+	}
+
+	void TerrainStreamer::setGroups(vector<TerrainGroup *> groups_p) {
+		stopWorkers();
+
+		entries.clear();
+		entry_indices.clear();
+		loaded_entries.clear();
+		queue.clear();
+		completed.clear();
+		events.clear();
+		memory_used = 0;
+		rescan = true;
+
+		vector<void *> objects;
+		vector<AABB> boxes;
+		for (size_t i=0; i<groups_p.size(); i++) {
+			GroupEntry entry;
+			entry.group = groups_p[i];
+			entry.state = Unloaded;
+			entry.distance = 0.0f;
+			entry.memory_size = 0;
+			entry_indices[entry.group] = entries.size();
+			entries.push_back(entry);
+
+			AABB aabb;
+			aabb.addPoint(entry.group->getCenter());
+			aabb.expand(entry.group->getRadius());
+			objects.push_back(entry.group);
+			boxes.push_back(aabb);
+		}
+
+		group_index->build(objects, boxes);
+	}
+
+	void TerrainStreamer::setLoadFunction(function<void(TerrainGroup *)> v) {
+		stopWorkers();
+		load_function = v;
+	}
+
+	void TerrainStreamer::setWorkerCount(unsigned int v) {
+		stopWorkers();
+		worker_count = v;
+	}
+
+	void TerrainStreamer::setLoadingRange(float v) {
+		loading_range = v;
+		rescan = true;
+	}
+
+	void TerrainStreamer::setRescanDistance(float v) {
+		rescan_distance = v;
+	}
+
+	void TerrainStreamer::setMemoryBudget(size_t v) {
+		memory_budget = v;
+		rescan = true;
+	}
+
+	void TerrainStreamer::startWorkers() {
+		if (!workers.empty()) return;
+
+		unsigned int count = worker_count;
+		if (!count) {
+			count = thread::hardware_concurrency();
+			if (!count) count = 1;
+		}
+
+		stopping = false;
+		for (unsigned int i=0; i<count; i++) {
+			workers.push_back(thread(&TerrainStreamer::workerLoop, this));
+		}
+	}
+
+	void TerrainStreamer::stopWorkers() {
+		if (workers.empty()) return;
+
+		{
+			lock_guard<mutex> lock(queue_mutex);
+			stopping = true;
+		}
+		queue_condition.notify_all();
+
+		for (size_t i=0; i<workers.size(); i++) {
+			workers[i].join();
+		}
+		workers.clear();
+		stopping = false;
+	}
+
+	bool TerrainStreamer::canStartLoad() {
+		return !queue.empty() && (!memory_budget || (memory_used < memory_budget));
+	}
+
+	void TerrainStreamer::workerLoop() {
+		unique_lock<mutex> lock(queue_mutex);
+		while (true) {
+			queue_condition.wait(lock, [this]() { return stopping || canStartLoad(); });
+			if (stopping) return;
+
+			// Closest group first
+			pop_heap(queue.begin(), queue.end(), [this](size_t a, size_t b) { return entries[a].distance > entries[b].distance; });
+			size_t index = queue.back();
+			queue.pop_back();
+
+			GroupEntry &entry = entries[index];
+			entry.state = Loading;
+			TerrainGroup *group = entry.group;
+			lock.unlock();
+
+			if (load_function) load_function(group);
+			else group->load();
+			size_t memory_size = group->getEstimatedMemorySize();
+
+			lock.lock();
+			entries[index].memory_size = memory_size;
+			completed.push_back(index);
+		}
+	}
+
+	float TerrainStreamer::getGroupDistance(size_t index, Vector3 position) {
+		TerrainGroup *group = entries[index].group;
+		return group->getCenter().distance(position) - group->getRadius();
+	}
+
+	void TerrainStreamer::buildQueue(Vector3 position) {
+		// Queued groups that are still in range are found again below
+		for (size_t i=0; i<queue.size(); i++) {
+			entries[queue[i]].state = Unloaded;
+		}
+		queue.clear();
+
+		vector<void *> candidates;
+		group_index->querySphere(position, loading_range, &candidates);
+
+		for (size_t i=0; i<candidates.size(); i++) {
+			size_t index = entry_indices[static_cast<TerrainGroup *>(candidates[i])];
+			GroupEntry &entry = entries[index];
+			if (entry.state != Unloaded) continue;
+
+			entry.distance = getGroupDistance(index, position);
+			if (entry.distance < loading_range) {
+				entry.state = Queued;
+				queue.push_back(index);
+			}
+		}
+
+		make_heap(queue.begin(), queue.end(), [this](size_t a, size_t b) { return entries[a].distance > entries[b].distance; });
+
+		// Eviction goes by the distance of the loaded groups
+		for (set<size_t>::iterator it=loaded_entries.begin(); it!=loaded_entries.end(); it++) {
+			entries[*it].distance = getGroupDistance(*it, position);
+		}
+	}
+
+	void TerrainStreamer::evictGroups() {
+		if (!memory_budget) return;
+
+		while (memory_used >= memory_budget) {
+			// Farthest loaded group outside of the range
+			GroupEntry *farthest = NULL;
+			size_t farthest_index = 0;
+			for (set<size_t>::iterator it=loaded_entries.begin(); it!=loaded_entries.end(); it++) {
+				GroupEntry &entry = entries[*it];
+				if ((entry.distance >= loading_range) && (!farthest || (entry.distance > farthest->distance))) {
+					farthest = &entry;
+					farthest_index = *it;
+				}
+			}
+
+			if (!farthest) break;
+
+			loaded_entries.erase(farthest_index);
+			farthest->group->unload();
+			farthest->state = Unloaded;
+			memory_used -= farthest->memory_size;
+			farthest->memory_size = 0;
+
+			// A group evicted before its load was reported doesn't need either event
+			bool pending_load = false;
+			for (list<GroupEvent>::iterator it=events.begin(); it!=events.end(); it++) {
+				if (((*it).group == farthest->group) && (*it).loaded) {
+					events.erase(it);
+					pending_load = true;
+					break;
+				}
+			}
+
+			if (!pending_load) {
+				GroupEvent event;
+				event.group = farthest->group;
+				event.loaded = false;
+				events.push_back(event);
+			}
+		}
+	}
+
+	void TerrainStreamer::update(Vector3 position) {
+		if (entries.empty()) return;
+
+		startWorkers();
+
+		bool notify = false;
+		{
+			lock_guard<mutex> lock(queue_mutex);
+
+			for (size_t i=0; i<completed.size(); i++) {
+				GroupEntry &entry = entries[completed[i]];
+				entry.state = Loaded;
+				entry.distance = getGroupDistance(completed[i], position);
+				memory_used += entry.memory_size;
+				loaded_entries.insert(completed[i]);
+
+				GroupEvent event;
+				event.group = entry.group;
+				event.loaded = true;
+				events.push_back(event);
+			}
+
+			bool reprioritize = rescan || (position.distance(last_position) >= rescan_distance);
+			completed.clear();
+
+			if (reprioritize) {
+				buildQueue(position);
+				last_position = position;
+				rescan = false;
+			}
+
+			evictGroups();
+			notify = canStartLoad();
+		}
+
+		if (notify) queue_condition.notify_all();
+	}
+
+	void TerrainStreamer::setGroupMemorySize(TerrainGroup *group, size_t v) {
+		unordered_map<TerrainGroup *, size_t>::iterator it = entry_indices.find(group);
+		if (it == entry_indices.end()) return;
+
+		bool notify = false;
+		{
+			lock_guard<mutex> lock(queue_mutex);
+			GroupEntry &entry = entries[it->second];
+			if (entry.state != Loaded) return;
+
+			memory_used = memory_used - entry.memory_size + v;
+			entry.memory_size = v;
+			notify = canStartLoad();
+		}
+
+		if (notify) queue_condition.notify_all();
+	}
+
+	bool TerrainStreamer::hasEvents() {
+		return !events.empty();
+	}
+
+	bool TerrainStreamer::popEvent(TerrainGroup **group, bool *loaded) {
+		if (events.empty()) return false;
+
+		*group = events.front().group;
+		*loaded = events.front().loaded;
+		events.pop_front();
+		return true;
+	}
+
+	bool TerrainStreamer::isGroupLoaded(TerrainGroup *group) {
+		unordered_map<TerrainGroup *, size_t>::iterator it = entry_indices.find(group);
+		if (it == entry_indices.end()) return false;
+
+		lock_guard<mutex> lock(queue_mutex);
+		return entries[it->second].state == Loaded;
+	}
+
+	size_t TerrainStreamer::getMemoryUsed() {
+		return memory_used;
+	}
+
+	size_t TerrainStreamer::getQueuedCount() {
+		lock_guard<mutex> lock(queue_mutex);
+		return queue.size();
+	}
+
+	size_t TerrainStreamer::getLoadedCount() {
+		return loaded_entries.size();
+	}
+};
@@ -0,0 +1,124 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#pragma once
+
+#define LIBGENS_TERRAIN_STREAMER_DEFAULT_RANGE            1000.0f
+#define LIBGENS_TERRAIN_STREAMER_DEFAULT_RESCAN_DISTANCE  1.0f
+
+namespace LibGens {
+	class TerrainGroup;
+	class SpatialIndex;
+
+	// Streams terrain groups around a moving reference position on a fixed pool of worker threads.
+	// Groups in range are queued nearest first. The queue is reprioritized whenever the reference
+	// position moves further than the rescan distance, and queued groups that left the range are
+	// dropped from it before a worker picks them up.
+	//
+	// With a memory budget set, loaded groups outside of the range are evicted farthest first once
+	// their estimated memory reaches the budget, and no new loads start until it fits again.
+	// Groups being loaded when the budget fills up still finish, so it can be exceeded by as many
+	// groups as there are workers.
+	//
+	// update() and popEvent() must be called from the same thread.
+	class TerrainStreamer {
+		protected:
+			enum GroupState {
+				Unloaded,
+				Queued,
+				Loading,
+				Loaded
+			};
+
+			struct GroupEntry {
+				TerrainGroup *group;
+				GroupState state;
+				float distance;
+				size_t memory_size;
+			};
+
+			struct GroupEvent {
+				TerrainGroup *group;
+				bool loaded;
+			};
+
+			vector<GroupEntry> entries;
+			unordered_map<TerrainGroup *, size_t> entry_indices;
+			SpatialIndex *group_index;
+			set<size_t> loaded_entries;
+			vector<size_t> queue;
+			vector<size_t> completed;
+			list<GroupEvent> events;
+			vector<thread> workers;
+			mutex queue_mutex;
+			condition_variable queue_condition;
+			bool stopping;
+			function<void(TerrainGroup *)> load_function;
+			unsigned int worker_count;
+			float loading_range;
+			float rescan_distance;
+			size_t memory_budget;
+			size_t memory_used;
+			Vector3 last_position;
+			bool rescan;
+
+			void startWorkers();
+			void stopWorkers();
+			void workerLoop();
+			bool canStartLoad();
+			float getGroupDistance(size_t index, Vector3 position);
+			void buildQueue(Vector3 position);
+			void evictGroups();
+		public:
+			TerrainStreamer();
+			~TerrainStreamer();
+
+			// Resets the streamer. Groups already loaded are left as they are.
+			void setGroups(vector<TerrainGroup *> groups_p);
+
+			// Replaces TerrainGroup::load on the workers, e.g. to extract the group's archive first.
+			void setLoadFunction(function<void(TerrainGroup *)> v);
+
+			// 0 selects the hardware concurrency.
+			void setWorkerCount(unsigned int v);
+			void setLoadingRange(float v);
+			void setRescanDistance(float v);
+
+			// Budget in bytes for TerrainGroup::getEstimatedMemorySize of the loaded groups. 0 disables eviction.
+			void setMemoryBudget(size_t v);
+
+			void update(Vector3 position);
+
+			// Replaces the memory accounted for a loaded group, e.g. once its data was converted and unloaded.
+			void setGroupMemorySize(TerrainGroup *group, size_t v);
+
+			// Returns the next group that finished loading (loaded is true) or that was evicted (loaded is false).
+			// A group that was evicted before its load was popped reports neither event, so events are meant
+			// to be handled as they are popped rather than buffered across calls to update().
+			bool hasEvents();
+			bool popEvent(TerrainGroup **group, bool *loaded);
+
+			// True while the group is loaded and no worker can touch it until update() evicts it.
+			bool isGroupLoaded(TerrainGroup *group);
+
+			size_t getMemoryUsed();
+			size_t getQueuedCount();
+			size_t getLoadedCount();
+	};
+};
@@ -0,0 +1,929 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "TextureCompression.h"
+#include <float.h>
+#include <limits.h>
+
+#ifdef LIBGENS_ENDIAN_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef __AVX2__
+#define LIBGENS_TEXTURE_COMPRESSION_AVX2
+#include <immintrin.h>
+#endif
+
+#define LIBGENS_TEXTURE_COMPRESSION_DDPF_ALPHAPIXELS  0x1
+#define LIBGENS_TEXTURE_COMPRESSION_DDPF_FOURCC       0x4
+#define LIBGENS_TEXTURE_COMPRESSION_DDPF_RGB          0x40
+#define LIBGENS_TEXTURE_COMPRESSION_LEAST_SQUARES     2
+
+namespace LibGens {
+	static inline unsigned int textureRead32(const unsigned char *data) {
+		return data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int) data[3] << 24);
+	}
+
+	static inline void textureWrite32(unsigned char *data, unsigned int v) {
+		data[0] = v & 0xFF;
+		data[1] = (v >> 8) & 0xFF;
+		data[2] = (v >> 16) & 0xFF;
+		data[3] = (v >> 24) & 0xFF;
+	}
+
+	static inline void textureExpand565(unsigned short color, int *rgb) {
+		int r = (color >> 11) & 0x1F;
+		int g = (color >> 5) & 0x3F;
+		int b = color & 0x1F;
+		rgb[0] = (r << 3) | (r >> 2);
+		rgb[1] = (g << 2) | (g >> 4);
+		rgb[2] = (b << 3) | (b >> 2);
+	}
+
+	static inline unsigned short textureQuantize565(const float *rgb) {
+		int r = (int) (min(max(rgb[0], 0.0f), 255.0f) * (31.0f / 255.0f) + 0.5f);
+		int g = (int) (min(max(rgb[1], 0.0f), 255.0f) * (63.0f / 255.0f) + 0.5f);
+		int b = (int) (min(max(rgb[2], 0.0f), 255.0f) * (31.0f / 255.0f) + 0.5f);
+		return (unsigned short) ((r << 11) | (g << 5) | b);
+	}
+
+	// Same palette on both sides, so the encoder measures exactly what the decoder produces.
+	static void textureColorPalette(unsigned short color_0, unsigned short color_1, bool four_colors, int palette[4][4]) {
+		textureExpand565(color_0, palette[0]);
+		textureExpand565(color_1, palette[1]);
+		palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+
+		for (size_t c=0; c<3; c++) {
+			if (four_colors || (color_0 > color_1)) {
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+			else {
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+
+		if (!four_colors && (color_0 <= color_1)) {
+			palette[3][3] = 0;
+		}
+	}
+
+	static void textureAlphaPalette(int alpha_0, int alpha_1, int palette[8]) {
+		palette[0] = alpha_0;
+		palette[1] = alpha_1;
+		if (alpha_0 > alpha_1) {
+			for (int i=1; i<7; i++) palette[i+1] = ((7-i) * alpha_0 + i * alpha_1) / 7;
+		}
+		else {
+			for (int i=1; i<5; i++) palette[i+1] = ((5-i) * alpha_0 + i * alpha_1) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+
+	//***********************************
+	//  Decoding
+	//***********************************
+
+	static void textureDecodeColorBlock(const unsigned char *block, unsigned char *pixels, bool four_colors) {
+		unsigned short color_0 = block[0] | (block[1] << 8);
+		unsigned short color_1 = block[2] | (block[3] << 8);
+		unsigned int indices = textureRead32(block + 4);
+
+		int palette[4][4];
+		textureColorPalette(color_0, color_1, four_colors, palette);
+		for (size_t i=0; i<16; i++) {
+			const int *color = palette[(indices >> (i*2)) & 0x3];
+			for (size_t c=0; c<4; c++) pixels[i*4 + c] = color[c];
+		}
+	}
+
+	static void textureDecodeExplicitAlphaBlock(const unsigned char *block, unsigned char *pixels) {
+		for (size_t i=0; i<16; i++) {
+			unsigned char alpha = (block[i/2] >> ((i & 1) * 4)) & 0xF;
+			pixels[i*4 + 3] = alpha * 17;
+		}
+	}
+
+	static void textureDecodeAlphaBlock(const unsigned char *block, unsigned char *pixels, size_t channel) {
+		int palette[8];
+		textureAlphaPalette(block[0], block[1], palette);
+
+		unsigned long long indices = 0;
+		for (size_t i=0; i<6; i++) indices |= ((unsigned long long) block[2+i]) << (i*8);
+
+		for (size_t i=0; i<16; i++) {
+			pixels[i*4 + channel] = palette[(indices >> (i*3)) & 0x7];
+		}
+	}
+
+	static void textureDecodeBlock(const unsigned char *block, TextureCompressionFormat format, unsigned char *pixels) {
+		switch (format) {
+			case TEXTURE_COMPRESSION_BC1:
+				textureDecodeColorBlock(block, pixels, false);
+				break;
+			case TEXTURE_COMPRESSION_BC2:
+				textureDecodeColorBlock(block + 8, pixels, true);
+				textureDecodeExplicitAlphaBlock(block, pixels);
+				break;
+			case TEXTURE_COMPRESSION_BC3:
+				textureDecodeColorBlock(block + 8, pixels, true);
+				textureDecodeAlphaBlock(block, pixels, 3);
+				break;
+			case TEXTURE_COMPRESSION_BC4:
+			case TEXTURE_COMPRESSION_BC5:
+				for (size_t i=0; i<16; i++) {
+					pixels[i*4 + 1] = pixels[i*4 + 2] = 0;
+					pixels[i*4 + 3] = 255;
+				}
+
+				textureDecodeAlphaBlock(block, pixels, 0);
+				if (format == TEXTURE_COMPRESSION_BC5) textureDecodeAlphaBlock(block + 8, pixels, 1);
+				break;
+		}
+	}
+
+
+	//***********************************
+	//  Color Blocks
+	//***********************************
+
+	// Picks the nearest palette entry for every pixel and returns the summed squared error.
+	static float textureNearestColors(const float *r, const float *g, const float *b, int palette[4][4], unsigned char *indices) {
+		float total = 0.0f;
+		size_t i = 0;
+
+#if defined(LIBGENS_TEXTURE_COMPRESSION_AVX2)
+		__m256 total_8 = _mm256_setzero_ps();
+		for (; i < 16; i += 8) {
+			__m256 pixel_r = _mm256_loadu_ps(r + i);
+			__m256 pixel_g = _mm256_loadu_ps(g + i);
+			__m256 pixel_b = _mm256_loadu_ps(b + i);
+			__m256 best = _mm256_set1_ps(FLT_MAX);
+			__m256 best_index = _mm256_setzero_ps();
+			for (int k=0; k<4; k++) {
+				__m256 dr = _mm256_sub_ps(pixel_r, _mm256_set1_ps((float) palette[k][0]));
+				__m256 dg = _mm256_sub_ps(pixel_g, _mm256_set1_ps((float) palette[k][1]));
+				__m256 db = _mm256_sub_ps(pixel_b, _mm256_set1_ps((float) palette[k][2]));
+				__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dr, dr), _mm256_mul_ps(dg, dg)), _mm256_mul_ps(db, db));
+				__m256 closer = _mm256_cmp_ps(distance, best, _CMP_LT_OQ);
+				best = _mm256_min_ps(distance, best);
+				best_index = _mm256_blendv_ps(best_index, _mm256_set1_ps((float) k), closer);
+			}
+
+			total_8 = _mm256_add_ps(total_8, best);
+
+			int best_indices[8];
+			_mm256_storeu_si256((__m256i *) best_indices, _mm256_cvtps_epi32(best_index));
+			for (size_t j=0; j<8; j++) indices[i+j] = best_indices[j];
+		}
+
+		float totals[8];
+		_mm256_storeu_ps(totals, total_8);
+		for (size_t j=0; j<8; j++) total += totals[j];
+#elif defined(LIBGENS_ENDIAN_SSE2)
+		__m128 total_4 = _mm_setzero_ps();
+		for (; i < 16; i += 4) {
+			__m128 pixel_r = _mm_loadu_ps(r + i);
+			__m128 pixel_g = _mm_loadu_ps(g + i);
+			__m128 pixel_b = _mm_loadu_ps(b + i);
+			__m128 best = _mm_set1_ps(FLT_MAX);
+			__m128i best_index = _mm_setzero_si128();
+			for (int k=0; k<4; k++) {
+				__m128 dr = _mm_sub_ps(pixel_r, _mm_set1_ps((float) palette[k][0]));
+				__m128 dg = _mm_sub_ps(pixel_g, _mm_set1_ps((float) palette[k][1]));
+				__m128 db = _mm_sub_ps(pixel_b, _mm_set1_ps((float) palette[k][2]));
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+				__m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, best));
+				best = _mm_min_ps(distance, best);
+				best_index = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(k)), _mm_andnot_si128(closer, best_index));
+			}
+
+			total_4 = _mm_add_ps(total_4, best);
+
+			int best_indices[4];
+			_mm_storeu_si128((__m128i *) best_indices, best_index);
+			for (size_t j=0; j<4; j++) indices[i+j] = best_indices[j];
+		}
+
+		float totals[4];
+		_mm_storeu_ps(totals, total_4);
+		total = totals[0] + totals[1] + totals[2] + totals[3];
+#endif
+
+		for (; i < 16; i++) {
+			float best = FLT_MAX;
+			for (int k=0; k<4; k++) {
+				float dr = r[i] - palette[k][0];
+				float dg = g[i] - palette[k][1];
+				float db = b[i] - palette[k][2];
+				float distance = dr*dr + dg*dg + db*db;
+				if (distance < best) {
+					best = distance;
+					indices[i] = k;
+				}
+			}
+			total += best;
+		}
+
+		return total;
+	}
+
+	// Rounds the position of every pixel along the endpoint line to the closest of the four steps.
+	static void textureProjectColors(const float *r, const float *g, const float *b, int palette[4][4], unsigned char *indices) {
+		static const unsigned char step_indices[4] = { 1, 3, 2, 0 };
+		float axis[3] = { (float) (palette[0][0] - palette[1][0]), (float) (palette[0][1] - palette[1][1]), (float) (palette[0][2] - palette[1][2]) };
+		float length = axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2];
+		float scale = (length > 0.0f) ? (3.0f / length) : 0.0f;
+
+		for (size_t i=0; i<16; i++) {
+			float t = ((r[i] - palette[1][0]) * axis[0] + (g[i] - palette[1][1]) * axis[1] + (b[i] - palette[1][2]) * axis[2]) * scale;
+			int step = (int) (min(max(t, 0.0f), 3.0f) + 0.5f);
+			indices[i] = step_indices[step];
+		}
+	}
+
+	// Least squares endpoints for the current indices. Returns false if the indices don't constrain both endpoints.
+	static bool textureSolveColorEndpoints(const float *r, const float *g, const float *b, const unsigned char *indices, float *end, float *start) {
+		static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+		float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		float ap[3] = { 0.0f, 0.0f, 0.0f };
+		float bp[3] = { 0.0f, 0.0f, 0.0f };
+
+		for (size_t i=0; i<16; i++) {
+			float a = weights[indices[i]];
+			float w = 1.0f - a;
+			aa += a*a;
+			ab += a*w;
+			bb += w*w;
+			ap[0] += a*r[i]; ap[1] += a*g[i]; ap[2] += a*b[i];
+			bp[0] += w*r[i]; bp[1] += w*g[i]; bp[2] += w*b[i];
+		}
+
+		float determinant = aa*bb - ab*ab;
+		if (fabs(determinant) < 1e-6f) {
+			return false;
+		}
+
+		float inverse = 1.0f / determinant;
+		for (size_t c=0; c<3; c++) {
+			end[c] = (bb*ap[c] - ab*bp[c]) * inverse;
+			start[c] = (aa*bp[c] - ab*ap[c]) * inverse;
+		}
+		return true;
+	}
+
+	static void textureEncodeColorBlock(const unsigned char *pixels, TextureCompressionQuality quality, unsigned char *block) {
+		float r[16], g[16], b[16];
+		float minimum[3] = { 255.0f, 255.0f, 255.0f };
+		float maximum[3] = { 0.0f, 0.0f, 0.0f };
+		float mean[3] = { 0.0f, 0.0f, 0.0f };
+		for (size_t i=0; i<16; i++) {
+			r[i] = pixels[i*4];
+			g[i] = pixels[i*4 + 1];
+			b[i] = pixels[i*4 + 2];
+			float color[3] = { r[i], g[i], b[i] };
+			for (size_t c=0; c<3; c++) {
+				minimum[c] = min(minimum[c], color[c]);
+				maximum[c] = max(maximum[c], color[c]);
+				mean[c] += color[c];
+			}
+		}
+
+		for (size_t c=0; c<3; c++) mean[c] /= 16.0f;
+
+		unsigned char indices[16];
+		unsigned short color_0, color_1;
+		if ((minimum[0] == maximum[0]) && (minimum[1] == maximum[1]) && (minimum[2] == maximum[2])) {
+			color_0 = color_1 = textureQuantize565(minimum);
+			memset(indices, 0, sizeof(indices));
+		}
+		else {
+			float covariance[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+			for (size_t i=0; i<16; i++) {
+				float dr = r[i] - mean[0];
+				float dg = g[i] - mean[1];
+				float db = b[i] - mean[2];
+				covariance[0] += dr*dr;
+				covariance[1] += dr*dg;
+				covariance[2] += dr*db;
+				covariance[3] += dg*dg;
+				covariance[4] += dg*db;
+				covariance[5] += db*db;
+			}
+
+			float start[3], end[3];
+			if (quality == TEXTURE_COMPRESSION_FAST) {
+				// Bounding box diagonal, flipped along the channels that go against the dominant one, inset by 1/16.
+				for (size_t c=0; c<3; c++) {
+					start[c] = minimum[c];
+					end[c] = maximum[c];
+				}
+
+				float variances[3] = { covariance[0], covariance[3], covariance[5] };
+				size_t dominant = (variances[0] >= variances[1]) ? ((variances[0] >= variances[2]) ? 0 : 2) : ((variances[1] >= variances[2]) ? 1 : 2);
+				static const size_t covariance_index[3][3] = { { 0, 1, 2 }, { 1, 3, 4 }, { 2, 4, 5 } };
+				for (size_t c=0; c<3; c++) {
+					if ((c != dominant) && (covariance[covariance_index[dominant][c]] < 0.0f)) swap(start[c], end[c]);
+
+					float inset = (end[c] - start[c]) / 16.0f;
+					start[c] += inset;
+					end[c] -= inset;
+				}
+			}
+			else {
+				// Principal axis by power iteration, starting from the bounding box diagonal.
+				float axis[3] = { maximum[0] - minimum[0], maximum[1] - minimum[1], maximum[2] - minimum[2] };
+				for (size_t iteration=0; iteration<8; iteration++) {
+					float next[3] = {
+						covariance[0]*axis[0] + covariance[1]*axis[1] + covariance[2]*axis[2],
+						covariance[1]*axis[0] + covariance[3]*axis[1] + covariance[4]*axis[2],
+						covariance[2]*axis[0] + covariance[4]*axis[1] + covariance[5]*axis[2]
+					};
+
+					float length = max(fabs(next[0]), max(fabs(next[1]), fabs(next[2])));
+					if (length <= 0.0f) break;
+					for (size_t c=0; c<3; c++) axis[c] = next[c] / length;
+				}
+
+				float length = axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2];
+				float projection_minimum = FLT_MAX;
+				float projection_maximum = -FLT_MAX;
+				for (size_t i=0; i<16; i++) {
+					float t = ((r[i] - mean[0]) * axis[0] + (g[i] - mean[1]) * axis[1] + (b[i] - mean[2]) * axis[2]) / length;
+					projection_minimum = min(projection_minimum, t);
+					projection_maximum = max(projection_maximum, t);
+				}
+
+				for (size_t c=0; c<3; c++) {
+					start[c] = mean[c] + axis[c] * projection_minimum;
+					end[c] = mean[c] + axis[c] * projection_maximum;
+				}
+			}
+
+			color_0 = textureQuantize565(end);
+			color_1 = textureQuantize565(start);
+
+			int palette[4][4];
+			textureColorPalette(color_0, color_1, true, palette);
+			if (quality == TEXTURE_COMPRESSION_FAST) {
+				textureProjectColors(r, g, b, palette, indices);
+			}
+			else {
+				float error = textureNearestColors(r, g, b, palette, indices);
+
+				if (quality == TEXTURE_COMPRESSION_HIGH) {
+					for (size_t iteration=0; iteration<LIBGENS_TEXTURE_COMPRESSION_LEAST_SQUARES; iteration++) {
+						if (!textureSolveColorEndpoints(r, g, b, indices, end, start)) break;
+
+						unsigned short refined_0 = textureQuantize565(end);
+						unsigned short refined_1 = textureQuantize565(start);
+						if ((refined_0 == color_0) && (refined_1 == color_1)) break;
+
+						unsigned char refined_indices[16];
+						textureColorPalette(refined_0, refined_1, true, palette);
+						float refined_error = textureNearestColors(r, g, b, palette, refined_indices);
+						if (refined_error >= error) break;
+
+						error = refined_error;
+						color_0 = refined_0;
+						color_1 = refined_1;
+						memcpy(indices, refined_indices, sizeof(indices));
+					}
+				}
+			}
+
+			// BC1 only decodes four colors when the first endpoint is the bigger one.
+			if (color_0 < color_1) {
+				swap(color_0, color_1);
+				for (size_t i=0; i<16; i++) indices[i] ^= 1;
+			}
+			else if (color_0 == color_1) {
+				memset(indices, 0, sizeof(indices));
+			}
+		}
+
+		unsigned int packed_indices = 0;
+		for (size_t i=0; i<16; i++) packed_indices |= (unsigned int) indices[i] << (i*2);
+
+		block[0] = color_0 & 0xFF;
+		block[1] = color_0 >> 8;
+		block[2] = color_1 & 0xFF;
+		block[3] = color_1 >> 8;
+		textureWrite32(block + 4, packed_indices);
+	}
+
+
+	//***********************************
+	//  Alpha Blocks
+	//***********************************
+
+	// Picks the nearest of the eight palette entries for every value and returns the summed squared error.
+	static int textureNearestAlphas(const unsigned char *values, const int palette[8], unsigned char *indices) {
+#ifdef LIBGENS_ENDIAN_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		__m128i value_bytes = _mm_loadu_si128((const __m128i *) values);
+		__m128i value_words[2] = { _mm_unpacklo_epi8(value_bytes, zero), _mm_unpackhi_epi8(value_bytes, zero) };
+		__m128i total = _mm_setzero_si128();
+
+		for (size_t half=0; half<2; half++) {
+			__m128i best = _mm_set1_epi16(0x7FFF);
+			__m128i best_index = _mm_setzero_si128();
+			for (int k=0; k<8; k++) {
+				__m128i entry = _mm_set1_epi16((short) palette[k]);
+				__m128i distance = _mm_max_epi16(_mm_sub_epi16(value_words[half], entry), _mm_sub_epi16(entry, value_words[half]));
+				__m128i closer = _mm_cmplt_epi16(distance, best);
+				best = _mm_min_epi16(distance, best);
+				best_index = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi16((short) k)), _mm_andnot_si128(closer, best_index));
+			}
+
+			total = _mm_add_epi32(total, _mm_madd_epi16(best, best));
+
+			short best_indices[8];
+			_mm_storeu_si128((__m128i *) best_indices, best_index);
+			for (size_t j=0; j<8; j++) indices[half*8 + j] = (unsigned char) best_indices[j];
+		}
+
+		int totals[4];
+		_mm_storeu_si128((__m128i *) totals, total);
+		return totals[0] + totals[1] + totals[2] + totals[3];
+#else
+		int total = 0;
+		for (size_t i=0; i<16; i++) {
+			int best = INT_MAX;
+			for (int k=0; k<8; k++) {
+				int distance = abs(values[i] - palette[k]);
+				if (distance < best) {
+					best = distance;
+					indices[i] = k;
+				}
+			}
+			total += best * best;
+		}
+		return total;
+#endif
+	}
+
+	static void textureWriteAlphaBlock(int alpha_0, int alpha_1, const unsigned char *indices, unsigned char *block) {
+		unsigned long long packed_indices = 0;
+		for (size_t i=0; i<16; i++) packed_indices |= ((unsigned long long) indices[i]) << (i*3);
+
+		block[0] = alpha_0;
+		block[1] = alpha_1;
+		for (size_t i=0; i<6; i++) block[2+i] = (packed_indices >> (i*8)) & 0xFF;
+	}
+
+	// Encodes one channel of a block. The values are packed contiguously.
+	static void textureEncodeAlphaBlock(const unsigned char *values, TextureCompressionQuality quality, unsigned char *block) {
+		int minimum = 255;
+		int maximum = 0;
+		for (size_t i=0; i<16; i++) {
+			minimum = min(minimum, (int) values[i]);
+			maximum = max(maximum, (int) values[i]);
+		}
+
+		unsigned char indices[16];
+		if (minimum == maximum) {
+			memset(indices, 0, sizeof(indices));
+			textureWriteAlphaBlock(minimum, minimum, indices, block);
+			return;
+		}
+
+		if (quality == TEXTURE_COMPRESSION_FAST) {
+			// Eight value mode between the extremes. Step 0 is the minimum (index 1), step 7 the maximum (index 0).
+			float scale = 7.0f / (maximum - minimum);
+			for (size_t i=0; i<16; i++) {
+				int step = (int) ((values[i] - minimum) * scale + 0.5f);
+				indices[i] = (step == 7) ? 0 : ((step == 0) ? 1 : (8 - step));
+			}
+
+			textureWriteAlphaBlock(maximum, minimum, indices, block);
+			return;
+		}
+
+		int palette[8];
+		textureAlphaPalette(maximum, minimum, palette);
+		int best_error = textureNearestAlphas(values, palette, indices);
+		int best_alpha_0 = maximum;
+		int best_alpha_1 = minimum;
+
+		if (quality == TEXTURE_COMPRESSION_HIGH) {
+			unsigned char candidate_indices[16];
+
+			// Pull the eight value endpoints inwards, which spends the steps on the bulk of the values.
+			for (int inset_0=0; inset_0<=2; inset_0++) {
+				for (int inset_1=0; inset_1<=2; inset_1++) {
+					int alpha_0 = maximum - inset_0;
+					int alpha_1 = minimum + inset_1;
+					if ((alpha_0 <= alpha_1) || (!inset_0 && !inset_1)) continue;
+
+					textureAlphaPalette(alpha_0, alpha_1, palette);
+					int error = textureNearestAlphas(values, palette, candidate_indices);
+					if (error < best_error) {
+						best_error = error;
+						best_alpha_0 = alpha_0;
+						best_alpha_1 = alpha_1;
+						memcpy(indices, candidate_indices, sizeof(indices));
+					}
+				}
+			}
+
+			// Six value mode covers the inner values while 0 and 255 stay exact.
+			int inner_minimum = 255;
+			int inner_maximum = 0;
+			for (size_t i=0; i<16; i++) {
+				if ((values[i] == 0) || (values[i] == 255)) continue;
+				inner_minimum = min(inner_minimum, (int) values[i]);
+				inner_maximum = max(inner_maximum, (int) values[i]);
+			}
+
+			if (inner_minimum > inner_maximum) {
+				inner_minimum = inner_maximum = 0;
+			}
+
+			textureAlphaPalette(inner_minimum, inner_maximum, palette);
+			int error = textureNearestAlphas(values, palette, candidate_indices);
+			if (error < best_error) {
+				best_error = error;
+				best_alpha_0 = inner_minimum;
+				best_alpha_1 = inner_maximum;
+				memcpy(indices, candidate_indices, sizeof(indices));
+			}
+		}
+
+		textureWriteAlphaBlock(best_alpha_0, best_alpha_1, indices, block);
+	}
+
+	static void textureEncodeExplicitAlphaBlock(const unsigned char *values, unsigned char *block) {
+		memset(block, 0, 8);
+		for (size_t i=0; i<16; i++) {
+			unsigned char alpha = (values[i] * 15 + 127) / 255;
+			block[i/2] |= alpha << ((i & 1) * 4);
+		}
+	}
+
+
+	//***********************************
+	//  Images
+	//***********************************
+
+	static void textureLoadBlock(const unsigned char *pixels, unsigned int width, unsigned int height, unsigned int block_x, unsigned int block_y, unsigned char *block) {
+		unsigned int x = block_x * 4;
+		unsigned int y = block_y * 4;
+		if ((x + 4 <= width) && (y + 4 <= height)) {
+			for (unsigned int row=0; row<4; row++) {
+				memcpy(block + row*16, pixels + ((size_t) (y + row) * width + x) * 4, 16);
+			}
+			return;
+		}
+
+		// Edge blocks repeat the last row and column.
+		for (unsigned int row=0; row<4; row++) {
+			unsigned int source_y = min(y + row, height - 1);
+			for (unsigned int column=0; column<4; column++) {
+				unsigned int source_x = min(x + column, width - 1);
+				memcpy(block + (row*4 + column) * 4, pixels + ((size_t) source_y * width + source_x) * 4, 4);
+			}
+		}
+	}
+
+	static void textureEncodeBlock(const unsigned char *pixels, TextureCompressionFormat format, TextureCompressionQuality quality, unsigned char *block) {
+		unsigned char channel[16];
+		switch (format) {
+			case TEXTURE_COMPRESSION_BC1:
+				textureEncodeColorBlock(pixels, quality, block);
+				break;
+			case TEXTURE_COMPRESSION_BC2:
+				for (size_t i=0; i<16; i++) channel[i] = pixels[i*4 + 3];
+				textureEncodeExplicitAlphaBlock(channel, block);
+				textureEncodeColorBlock(pixels, quality, block + 8);
+				break;
+			case TEXTURE_COMPRESSION_BC3:
+				for (size_t i=0; i<16; i++) channel[i] = pixels[i*4 + 3];
+				textureEncodeAlphaBlock(channel, quality, block);
+				textureEncodeColorBlock(pixels, quality, block + 8);
+				break;
+			case TEXTURE_COMPRESSION_BC4:
+			case TEXTURE_COMPRESSION_BC5:
+				for (size_t i=0; i<16; i++) channel[i] = pixels[i*4];
+				textureEncodeAlphaBlock(channel, quality, block);
+				if (format == TEXTURE_COMPRESSION_BC5) {
+					for (size_t i=0; i<16; i++) channel[i] = pixels[i*4 + 1];
+					textureEncodeAlphaBlock(channel, quality, block + 8);
+				}
+				break;
+		}
+	}
+
+	// Encodes the four pixel rows starting at row block_y*4. Uncompressed rows are swizzled to BGRA.
+	static void textureEncodeRow(const unsigned char *pixels, unsigned int width, unsigned int height, unsigned int block_y, TextureCompressionFormat format, TextureCompressionQuality quality, unsigned char *data) {
+		if (format == TEXTURE_COMPRESSION_NONE) {
+			unsigned int last_row = min(block_y*4 + 4, height);
+			for (unsigned int y=block_y*4; y<last_row; y++) {
+				const unsigned char *source = pixels + (size_t) y * width * 4;
+				unsigned char *target = data + (size_t) (y - block_y*4) * width * 4;
+				for (unsigned int x=0; x<width; x++) {
+					target[0] = source[2];
+					target[1] = source[1];
+					target[2] = source[0];
+					target[3] = source[3];
+					source += 4;
+					target += 4;
+				}
+			}
+			return;
+		}
+
+		size_t block_size = TextureCompression::getBlockSize(format);
+		unsigned int blocks_x = (width + 3) / 4;
+		unsigned char block_pixels[16 * 4];
+		for (unsigned int block_x=0; block_x<blocks_x; block_x++) {
+			textureLoadBlock(pixels, width, height, block_x, block_y, block_pixels);
+			textureEncodeBlock(block_pixels, format, quality, data + block_x * block_size);
+		}
+	}
+
+	static size_t textureRowSize(TextureCompressionFormat format, unsigned int width) {
+		if (format == TEXTURE_COMPRESSION_NONE) return (size_t) width * 4 * 4;
+		return ((width + 3) / 4) * TextureCompression::getBlockSize(format);
+	}
+
+	size_t TextureCompression::getBlockSize(TextureCompressionFormat format) {
+		switch (format) {
+			case TEXTURE_COMPRESSION_BC1:
+			case TEXTURE_COMPRESSION_BC4:
+				return 8;
+			case TEXTURE_COMPRESSION_BC2:
+			case TEXTURE_COMPRESSION_BC3:
+			case TEXTURE_COMPRESSION_BC5:
+				return 16;
+		}
+		return 0;
+	}
+
+	size_t TextureCompression::getEncodedSize(TextureCompressionFormat format, unsigned int width, unsigned int height) {
+		if (format == TEXTURE_COMPRESSION_NONE) return (size_t) width * height * 4;
+		return (size_t) ((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(format);
+	}
+
+	void TextureCompression::encode(const unsigned char *pixels, unsigned int width, unsigned int height, TextureCompressionFormat format, TextureCompressionQuality quality, unsigned char *data) {
+		if (!pixels || !data || !width || !height) {
+			return;
+		}
+
+		size_t row_size = textureRowSize(format, width);
+		Parallel::forEach((height + 3) / 4, [&](size_t block_y) {
+			textureEncodeRow(pixels, width, height, block_y, format, quality, data + block_y * row_size);
+		});
+	}
+
+	void TextureCompression::decode(const unsigned char *data, unsigned int width, unsigned int height, TextureCompressionFormat format, unsigned char *pixels) {
+		if (!pixels || !data || !width || !height) {
+			return;
+		}
+
+		if (format == TEXTURE_COMPRESSION_NONE) {
+			size_t pixel_count = (size_t) width * height;
+			for (size_t i=0; i<pixel_count; i++) {
+				pixels[i*4] = data[i*4 + 2];
+				pixels[i*4 + 1] = data[i*4 + 1];
+				pixels[i*4 + 2] = data[i*4];
+				pixels[i*4 + 3] = data[i*4 + 3];
+			}
+			return;
+		}
+
+		size_t block_size = getBlockSize(format);
+		unsigned int blocks_x = (width + 3) / 4;
+		unsigned int blocks_y = (height + 3) / 4;
+		unsigned char block_pixels[16 * 4];
+		for (unsigned int block_y=0; block_y<blocks_y; block_y++) {
+			for (unsigned int block_x=0; block_x<blocks_x; block_x++) {
+				textureDecodeBlock(data + ((size_t) block_y * blocks_x + block_x) * block_size, format, block_pixels);
+
+				unsigned int copy_width = min(4u, width - block_x*4);
+				unsigned int copy_height = min(4u, height - block_y*4);
+				for (unsigned int y=0; y<copy_height; y++) {
+					memcpy(pixels + ((size_t) (block_y*4 + y) * width + block_x*4) * 4, block_pixels + y*16, copy_width * 4);
+				}
+			}
+		}
+	}
+
+	void TextureCompression::downsample(const unsigned char *pixels, unsigned int width, unsigned int height, vector<unsigned char> *target) {
+		unsigned int target_width = max(width / 2, 1u);
+		unsigned int target_height = max(height / 2, 1u);
+		target->resize((size_t) target_width * target_height * 4);
+
+		for (unsigned int y=0; y<target_height; y++) {
+			const unsigned char *row_0 = pixels + (size_t) min(y*2, height - 1) * width * 4;
+			const unsigned char *row_1 = pixels + (size_t) min(y*2 + 1, height - 1) * width * 4;
+			unsigned char *target_row = target->data() + (size_t) y * target_width * 4;
+			for (unsigned int x=0; x<target_width; x++) {
+				unsigned int x_0 = min(x*2, width - 1) * 4;
+				unsigned int x_1 = min(x*2 + 1, width - 1) * 4;
+				for (size_t c=0; c<4; c++) {
+					target_row[x*4 + c] = (row_0[x_0 + c] + row_0[x_1 + c] + row_1[x_0 + c] + row_1[x_1 + c] + 2) / 4;
+				}
+			}
+		}
+	}
+
+	void TextureCompression::writeDDS(const unsigned char *pixels, unsigned int width, unsigned int height, TextureCompressionFormat format, TextureCompressionQuality quality, bool mipmaps, vector<unsigned char> *data) {
+		if (!pixels || !data || !width || !height) {
+			return;
+		}
+
+		struct MipLevel {
+			const unsigned char *pixels;
+			unsigned int width;
+			unsigned int height;
+			size_t offset;
+		};
+
+		// Every level is downsampled up front, so the rows of all levels can be encoded in a single batch.
+		list<vector<unsigned char>> mip_pixels;
+		vector<MipLevel> levels;
+		size_t data_size = LIBGENS_TEXTURE_COMPRESSION_DDS_HEADER_SIZE;
+		MipLevel level = { pixels, width, height, data_size };
+		while (true) {
+			level.offset = data_size;
+			levels.push_back(level);
+			data_size += getEncodedSize(format, level.width, level.height);
+
+			if (!mipmaps || ((level.width == 1) && (level.height == 1))) break;
+
+			mip_pixels.push_back(vector<unsigned char>());
+			downsample(level.pixels, level.width, level.height, &mip_pixels.back());
+			level.pixels = mip_pixels.back().data();
+			level.width = max(level.width / 2, 1u);
+			level.height = max(level.height / 2, 1u);
+		}
+
+		vector<pair<size_t, unsigned int>> rows;
+		for (size_t l=0; l<levels.size(); l++) {
+			for (unsigned int block_y=0; block_y<(levels[l].height + 3) / 4; block_y++) rows.push_back(make_pair(l, block_y));
+		}
+
+		data->assign(data_size, 0);
+		unsigned char *header = data->data();
+		memcpy(header, "DDS ", 4);
+		textureWrite32(header + 4, 124);
+		textureWrite32(header + 8, 0x1 | 0x2 | 0x4 | 0x1000 | (mipmaps ? 0x20000 : 0) | ((format == TEXTURE_COMPRESSION_NONE) ? 0x8 : 0x80000));
+		textureWrite32(header + 12, height);
+		textureWrite32(header + 16, width);
+		textureWrite32(header + 20, (format == TEXTURE_COMPRESSION_NONE) ? (width * 4) : (unsigned int) getEncodedSize(format, width, height));
+		textureWrite32(header + 28, levels.size());
+		textureWrite32(header + 76, 32);
+		textureWrite32(header + 108, 0x1000 | (mipmaps ? (0x8 | 0x400000) : 0));
+
+		if (format == TEXTURE_COMPRESSION_NONE) {
+			textureWrite32(header + 80, LIBGENS_TEXTURE_COMPRESSION_DDPF_RGB | LIBGENS_TEXTURE_COMPRESSION_DDPF_ALPHAPIXELS);
+			textureWrite32(header + 88, 32);
+			textureWrite32(header + 92, 0x00FF0000);
+			textureWrite32(header + 96, 0x0000FF00);
+			textureWrite32(header + 100, 0x000000FF);
+			textureWrite32(header + 104, 0xFF000000);
+		}
+		else {
+			static const char *four_ccs[] = { "DXT1", "DXT3", "DXT5", "ATI1", "ATI2" };
+			textureWrite32(header + 80, LIBGENS_TEXTURE_COMPRESSION_DDPF_FOURCC);
+			memcpy(header + 84, four_ccs[format], 4);
+		}
+
+		unsigned char *target = data->data();
+		Parallel::forEach(rows.size(), [&](size_t i) {
+			const MipLevel &row_level = levels[rows[i].first];
+			unsigned int block_y = rows[i].second;
+			textureEncodeRow(row_level.pixels, row_level.width, row_level.height, block_y, format, quality, target + row_level.offset + block_y * textureRowSize(format, row_level.width));
+		});
+	}
+
+	static inline unsigned char textureExpandMasked(unsigned int value, unsigned int mask) {
+		if (!mask) return 255;
+
+		unsigned int shift = 0;
+		while (!((mask >> shift) & 1)) shift++;
+
+		unsigned int bits = 0;
+		while ((shift + bits < 32) && ((mask >> (shift + bits)) & 1)) bits++;
+
+		unsigned int v = (value & mask) >> shift;
+		if (bits == 8) return v;
+		if (bits > 8) return v >> (bits - 8);
+		return (v * 255) / ((1 << bits) - 1);
+	}
+
+	bool TextureCompression::readDDS(const unsigned char *data, size_t size, unsigned int *width, unsigned int *height, vector<unsigned char> *pixels) {
+		if (!data || !width || !height || !pixels || (size < LIBGENS_TEXTURE_COMPRESSION_DDS_HEADER_SIZE) || memcmp(data, "DDS ", 4)) {
+			return false;
+		}
+
+		unsigned int dds_height = textureRead32(data + 12);
+		unsigned int dds_width = textureRead32(data + 16);
+		unsigned int pixel_flags = textureRead32(data + 80);
+		const unsigned char *four_cc = data + 84;
+		unsigned int bit_count = textureRead32(data + 88);
+		unsigned int masks[4] = { textureRead32(data + 92), textureRead32(data + 96), textureRead32(data + 100), textureRead32(data + 104) };
+		size_t data_offset = LIBGENS_TEXTURE_COMPRESSION_DDS_HEADER_SIZE;
+
+		// NONE stands for any masked uncompressed layout here.
+		int format = -1;
+		if (pixel_flags & LIBGENS_TEXTURE_COMPRESSION_DDPF_FOURCC) {
+			if (!memcmp(four_cc, "DXT1", 4)) format = TEXTURE_COMPRESSION_BC1;
+			else if (!memcmp(four_cc, "DXT2", 4) || !memcmp(four_cc, "DXT3", 4)) format = TEXTURE_COMPRESSION_BC2;
+			else if (!memcmp(four_cc, "DXT4", 4) || !memcmp(four_cc, "DXT5", 4)) format = TEXTURE_COMPRESSION_BC3;
+			else if (!memcmp(four_cc, "ATI1", 4) || !memcmp(four_cc, "BC4U", 4)) format = TEXTURE_COMPRESSION_BC4;
+			else if (!memcmp(four_cc, "ATI2", 4) || !memcmp(four_cc, "BC5U", 4)) format = TEXTURE_COMPRESSION_BC5;
+			else if (!memcmp(four_cc, "DX10", 4)) {
+				if (size < LIBGENS_TEXTURE_COMPRESSION_DDS_HEADER_SIZE + LIBGENS_TEXTURE_COMPRESSION_DDS_DX10_HEADER_SIZE) {
+					return false;
+				}
+
+				data_offset += LIBGENS_TEXTURE_COMPRESSION_DDS_DX10_HEADER_SIZE;
+				switch (textureRead32(data + LIBGENS_TEXTURE_COMPRESSION_DDS_HEADER_SIZE)) {
+					case 71: case 72: format = TEXTURE_COMPRESSION_BC1; break;
+					case 74: case 75: format = TEXTURE_COMPRESSION_BC2; break;
+					case 77: case 78: format = TEXTURE_COMPRESSION_BC3; break;
+					case 80: format = TEXTURE_COMPRESSION_BC4; break;
+					case 83: format = TEXTURE_COMPRESSION_BC5; break;
+					case 28: case 29:
+						format = TEXTURE_COMPRESSION_NONE;
+						bit_count = 32;
+						masks[0] = 0x000000FF;
+						masks[1] = 0x0000FF00;
+						masks[2] = 0x00FF0000;
+						masks[3] = 0xFF000000;
+						break;
+					case 87: case 91:
+						format = TEXTURE_COMPRESSION_NONE;
+						bit_count = 32;
+						masks[0] = 0x00FF0000;
+						masks[1] = 0x0000FF00;
+						masks[2] = 0x000000FF;
+						masks[3] = 0xFF000000;
+						break;
+				}
+			}
+		}
+		else if ((pixel_flags & LIBGENS_TEXTURE_COMPRESSION_DDPF_RGB) && ((bit_count == 24) || (bit_count == 32))) {
+			format = TEXTURE_COMPRESSION_NONE;
+			if (!(pixel_flags & LIBGENS_TEXTURE_COMPRESSION_DDPF_ALPHAPIXELS)) masks[3] = 0;
+		}
+
+		if ((format < 0) || !dds_width || !dds_height) {
+			return false;
+		}
+
+		const unsigned char *source = data + data_offset;
+		size_t source_size = size - data_offset;
+
+		if (format == TEXTURE_COMPRESSION_NONE) {
+			size_t pixel_size = bit_count / 8;
+			if (source_size < (size_t) dds_width * dds_height * pixel_size) {
+				return false;
+			}
+
+			pixels->resize((size_t) dds_width * dds_height * 4);
+			unsigned char *target = pixels->data();
+			size_t pixel_count = (size_t) dds_width * dds_height;
+			for (size_t i=0; i<pixel_count; i++) {
+				unsigned int value = source[0] | (source[1] << 8) | (source[2] << 16);
+				if (pixel_size == 4) value |= (unsigned int) source[3] << 24;
+				for (size_t c=0; c<4; c++) target[c] = textureExpandMasked(value, masks[c]);
+				source += pixel_size;
+				target += 4;
+			}
+		}
+		else {
+			if (source_size < getEncodedSize((TextureCompressionFormat) format, dds_width, dds_height)) {
+				return false;
+			}
+
+			pixels->resize((size_t) dds_width * dds_height * 4);
+			decode(source, dds_width, dds_height, (TextureCompressionFormat) format, pixels->data());
+		}
+
+		*width = dds_width;
+		*height = dds_height;
+		return true;
+	}
+};
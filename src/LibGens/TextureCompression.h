@@ -0,0 +1,67 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#pragma once
+
+#define LIBGENS_TEXTURE_COMPRESSION_DDS_HEADER_SIZE       128
+#define LIBGENS_TEXTURE_COMPRESSION_DDS_DX10_HEADER_SIZE  20
+
+namespace LibGens {
+	enum TextureCompressionFormat {
+		TEXTURE_COMPRESSION_BC1,
+		TEXTURE_COMPRESSION_BC2,
+		TEXTURE_COMPRESSION_BC3,
+		TEXTURE_COMPRESSION_BC4,
+		TEXTURE_COMPRESSION_BC5,
+		TEXTURE_COMPRESSION_NONE
+	};
+
+	enum TextureCompressionQuality {
+		TEXTURE_COMPRESSION_FAST,
+		TEXTURE_COMPRESSION_NORMAL,
+		TEXTURE_COMPRESSION_HIGH
+	};
+
+	// Block compression of linear 8-bit RGBA images, rows stored top to bottom without padding.
+	// BC1 stores opaque color, BC2 and BC3 add explicit and interpolated alpha, BC4 stores the red
+	// channel and BC5 red and green. Rows of blocks are encoded on LibGens::Parallel.
+	//
+	// FAST fits the endpoints to the bounding box and projects the pixels onto them. NORMAL fits the
+	// principal axis of the colors and picks the nearest palette entry for each pixel. HIGH refines
+	// NORMAL's color endpoints with least squares and searches more alpha endpoints, including the
+	// six value mode.
+	class TextureCompression {
+		public:
+			static size_t getBlockSize(TextureCompressionFormat format);
+			static size_t getEncodedSize(TextureCompressionFormat format, unsigned int width, unsigned int height);
+
+			static void encode(const unsigned char *pixels, unsigned int width, unsigned int height, TextureCompressionFormat format, TextureCompressionQuality quality, unsigned char *data);
+			static void decode(const unsigned char *data, unsigned int width, unsigned int height, TextureCompressionFormat format, unsigned char *pixels);
+
+			// Box filters into the next mip level.
+			static void downsample(const unsigned char *pixels, unsigned int width, unsigned int height, vector<unsigned char> *target);
+
+			// Writes a DX9 style DDS, with a box filtered mip chain if requested. BC4 and BC5 use the ATI1
+			// and ATI2 FourCCs and NONE writes uncompressed A8R8G8B8.
+			static void writeDDS(const unsigned char *pixels, unsigned int width, unsigned int height, TextureCompressionFormat format, TextureCompressionQuality quality, bool mipmaps, vector<unsigned char> *data);
+
+			// Decodes the top level of a DDS in any of the formats above, including their DX10 variants, or of an uncompressed 24/32-bit one.
+			static bool readDDS(const unsigned char *data, size_t size, unsigned int *width, unsigned int *height, vector<unsigned char> *pixels);
+	};
+};
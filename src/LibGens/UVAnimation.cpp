@@ -85,6 +85,10 @@ namespace LibGens {
 		return NULL;
 	}
 
+	vector<UVAnimationSet *> UVAnimation::getAnimationSets() {
+		return animation_sets;
+	}
+
 	string UVAnimation::getMaterialName() {
 		return material_name;
 	}
@@ -33,6 +33,7 @@ namespace LibGens {
 			UVAnimation(string filename);
 			void readAnimations(File *file);
 			UVAnimationSet *getAnimationSet(string animation_name="");
+			vector<UVAnimationSet *> getAnimationSets();
 			string getMaterialName();
 			string getTexsetName();
 	};
@@ -0,0 +1,415 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "Vertex.h"
+#include "VertexFormat.h"
+#include "VertexDecoder.h"
+
+#ifdef LIBGENS_ENDIAN_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace LibGens {
+	// The column kernels write straight into the float members of these classes.
+	static_assert(sizeof(Vector2) == sizeof(float) * 2, "Vector2 must be tightly packed");
+	static_assert(sizeof(Vector3) == sizeof(float) * 3, "Vector3 must be tightly packed");
+	static_assert(sizeof(Color) == sizeof(float) * 4, "Color must be tightly packed");
+
+	struct PackedNormalLayout {
+		unsigned int shift[3];
+		unsigned int mask[3];
+		unsigned int sign[3];
+		float scale[3];
+	};
+
+	// Same bit layouts as Vector3::fromNormal360 and Vector3::fromNormalForces.
+	static const PackedNormalLayout PackedNormal360 = {
+		{ 0, 11, 22 },
+		{ 0x3FF, 0x3FF, 0x1FF },
+		{ 0x00000400, 0x00200000, 0x80000000 },
+		{ 1.0f / 1024.0f, 1.0f / 1024.0f, 1.0f / 512.0f }
+	};
+
+	static const PackedNormalLayout PackedNormalForces = {
+		{ 0, 10, 20 },
+		{ 0x1FF, 0x1FF, 0x1FF },
+		{ 0x00000200, 0x00080000, 0x20000000 },
+		{ 1.0f / 512.0f, 1.0f / 512.0f, 1.0f / 512.0f }
+	};
+
+
+	static void gatherElement(void *dest, const unsigned char *source, size_t count, size_t stride, size_t size) {
+		unsigned char *out = (unsigned char *) dest;
+		for (size_t i=0; i<count; i++) {
+			memcpy(out, source, size);
+			out += size;
+			source += stride;
+		}
+	}
+
+
+	static void decodeHalfArray(float *dest, const unsigned short *source, size_t count) {
+		size_t i=0;
+
+#ifdef LIBGENS_ENDIAN_SSE2
+		// Lane version of dequantizeHalf: rebias the exponent, flush denormals to zero and push
+		// infinity/NaN to the float maximum exponent.
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i sign_mask = _mm_set1_epi32(0x8000);
+		const __m128i value_mask = _mm_set1_epi32(0x7FFF);
+		const __m128i exponent_bias = _mm_set1_epi32(112 << 10);
+		const __m128i denormal_limit = _mm_set1_epi32(1 << 10);
+		const __m128i infinity_limit = _mm_set1_epi32((31 << 10) - 1);
+		const __m128i infinity_bias = _mm_set1_epi32(112 << 23);
+
+		for (; i + 4 <= count; i += 4) {
+			__m128i half = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(source + i)), zero);
+			__m128i sign = _mm_slli_epi32(_mm_and_si128(half, sign_mask), 16);
+			__m128i value = _mm_and_si128(half, value_mask);
+			__m128i result = _mm_slli_epi32(_mm_add_epi32(value, exponent_bias), 13);
+			result = _mm_andnot_si128(_mm_cmplt_epi32(value, denormal_limit), result);
+			result = _mm_add_epi32(result, _mm_and_si128(_mm_cmpgt_epi32(value, infinity_limit), infinity_bias));
+			_mm_storeu_si128((__m128i *)(dest + i), _mm_or_si128(sign, result));
+		}
+#endif
+
+		for (; i<count; i++) {
+			dest[i] = dequantizeHalf(source[i]);
+		}
+	}
+
+
+	static void decodePackedNormalArray(Vector3 *dest, const unsigned int *source, size_t count, const PackedNormalLayout &layout) {
+		size_t i=0;
+
+#ifdef LIBGENS_ENDIAN_SSE2
+		const __m128 negative_one = _mm_set1_ps(-1.0f);
+
+		for (; i + 4 <= count; i += 4) {
+			__m128i packed = _mm_loadu_si128((const __m128i *)(source + i));
+			__m128 components[4];
+
+			for (size_t c=0; c<3; c++) {
+				__m128i field = _mm_and_si128(_mm_srl_epi32(packed, _mm_cvtsi32_si128(layout.shift[c])), _mm_set1_epi32(layout.mask[c]));
+				__m128 value = _mm_mul_ps(_mm_cvtepi32_ps(field), _mm_set1_ps(layout.scale[c]));
+				__m128i sign = _mm_set1_epi32(layout.sign[c]);
+				__m128i negative = _mm_cmpeq_epi32(_mm_and_si128(packed, sign), sign);
+				components[c] = _mm_add_ps(value, _mm_and_ps(_mm_castsi128_ps(negative), negative_one));
+			}
+			components[3] = _mm_setzero_ps();
+
+			// Transpose XXXX/YYYY/ZZZZ into four XYZ_ rows and store them overlapping, 12 bytes apart.
+			_MM_TRANSPOSE4_PS(components[0], components[1], components[2], components[3]);
+			float *out = &dest[i].x;
+			_mm_storeu_ps(out, components[0]);
+			_mm_storeu_ps(out + 3, components[1]);
+			_mm_storeu_ps(out + 6, components[2]);
+
+			float last[4];
+			_mm_storeu_ps(last, components[3]);
+			memcpy(out + 9, last, sizeof(float) * 3);
+		}
+#endif
+
+		for (; i<count; i++) {
+			if (&layout == &PackedNormal360) dest[i].fromNormal360(source[i]);
+			else dest[i].fromNormalForces(source[i]);
+		}
+	}
+
+
+	VertexArrays::VertexArrays() {
+		count = 0;
+	}
+
+
+	void VertexArrays::clear() {
+		count = 0;
+		positions.clear();
+		normals.clear();
+		tangents.clear();
+		binormals.clear();
+		for (size_t channel=0; channel<LIBGENS_VERTEX_UV_CHANNELS; channel++) uvs[channel].clear();
+		colors.clear();
+		bone_indices.clear();
+		bone_weights.clear();
+	}
+
+
+	void VertexArrays::allocate(size_t count_p) {
+		count = count_p;
+		positions.assign(count, Vector3());
+		normals.assign(count, Vector3());
+		tangents.assign(count, Vector3());
+		binormals.assign(count, Vector3());
+		for (size_t channel=0; channel<LIBGENS_VERTEX_UV_CHANNELS; channel++) uvs[channel].assign(count, Vector2());
+		colors.assign(count, Color());
+
+		bone_indices.resize(count * 4);
+		bone_weights.resize(count * 4);
+		for (size_t i=0; i<count; i++) {
+			for (size_t j=0; j<4; j++) {
+				bone_indices[i*4 + j] = (j==0 ? 0    : 0xFFFF);
+				bone_weights[i*4 + j] = (j==0 ? 0xFF : 0);
+			}
+		}
+	}
+
+
+	void VertexArrays::copyToVertex(size_t index, Vertex *vertex) {
+		if (!positions.empty()) vertex->setPosition(positions[index]);
+		if (!normals.empty()) vertex->setNormal(normals[index]);
+		if (!tangents.empty()) vertex->setTangent(tangents[index]);
+		if (!binormals.empty()) vertex->setBinormal(binormals[index]);
+
+		for (size_t channel=0; channel<LIBGENS_VERTEX_UV_CHANNELS; channel++) {
+			if (!uvs[channel].empty()) vertex->setUV(uvs[channel][index], channel);
+		}
+
+		if (!colors.empty()) vertex->setColor(colors[index]);
+
+		if (!bone_indices.empty()) {
+			for (size_t i=0; i<4; i++) vertex->setBoneIndex(bone_indices[index*4 + i], i);
+		}
+
+		if (!bone_weights.empty()) {
+			for (size_t i=0; i<4; i++) vertex->setBoneWeight(bone_weights[index*4 + i], i);
+		}
+	}
+
+
+	void VertexArrays::copyFromVertex(size_t index, Vertex *vertex) {
+		if (!positions.empty()) positions[index] = vertex->getPosition();
+		if (!normals.empty()) normals[index] = vertex->getNormal();
+		if (!tangents.empty()) tangents[index] = vertex->getTangent();
+		if (!binormals.empty()) binormals[index] = vertex->getBinormal();
+
+		for (size_t channel=0; channel<LIBGENS_VERTEX_UV_CHANNELS; channel++) {
+			if (!uvs[channel].empty()) uvs[channel][index] = vertex->getUV(channel);
+		}
+
+		if (!colors.empty()) colors[index] = vertex->getColor();
+
+		if (!bone_indices.empty()) {
+			for (size_t i=0; i<4; i++) bone_indices[index*4 + i] = vertex->getBoneIndex(i);
+		}
+
+		if (!bone_weights.empty()) {
+			for (size_t i=0; i<4; i++) bone_weights[index*4 + i] = vertex->getBoneWeight(i);
+		}
+	}
+
+
+	size_t VertexArrays::getMemorySize() {
+		size_t size = (positions.capacity() + normals.capacity() + tangents.capacity() + binormals.capacity()) * sizeof(Vector3);
+		for (size_t channel=0; channel<LIBGENS_VERTEX_UV_CHANNELS; channel++) size += uvs[channel].capacity() * sizeof(Vector2);
+		size += colors.capacity() * sizeof(Color);
+		size += bone_indices.capacity() * sizeof(unsigned short);
+		size += bone_weights.capacity() * sizeof(unsigned char);
+		return size;
+	}
+
+
+	VertexDecoder::VertexDecoder(VertexFormat *vformat) {
+		stride = vformat->getSize();
+		required_size = 0;
+
+		for (list<VertexFormatElement>::iterator it = vformat->elements.begin(); it != vformat->elements.end(); it++) {
+			VertexDecoderOperation operation;
+			operation.id = (*it).getID();
+			operation.offset = (*it).getOffset();
+			operation.index = (*it).getIndex();
+
+			VertexElementData data = (*it).getData();
+			unsigned int size = 0;
+
+			switch (operation.id) {
+			case POSITION:
+				if (data == FLOAT3) { operation.kernel = DECODE_FLOAT3_BE; size = 12; }
+				break;
+			case NORMAL:
+			case TANGENT:
+			case BINORMAL:
+				if (data == FLOAT3) { operation.kernel = DECODE_FLOAT3_BE; size = 12; }
+				else if (data == DEC3N_360) { operation.kernel = DECODE_DEC3N_360_BE; size = 4; }
+				else if (data == DEC3N) { operation.kernel = DECODE_DEC3N_BE; size = 4; }
+				break;
+			case UV:
+				if (operation.index >= LIBGENS_VERTEX_UV_CHANNELS) break;
+				if (data == FLOAT2) { operation.kernel = DECODE_FLOAT2_BE; size = 8; }
+				else if (data == FLOAT2_HALF) { operation.kernel = DECODE_FLOAT2_HALF_BE; size = 4; }
+				break;
+			case COLOR:
+				if (data == FLOAT4) { operation.kernel = DECODE_FLOAT4_COLOR_BE; size = 16; }
+				else if (data == UBYTE4N) { operation.kernel = DECODE_UBYTE4N_COLOR_ABGR; size = 4; }
+				break;
+			case BONE_WEIGHTS:
+				if (data == UBYTE4N) { operation.kernel = DECODE_UBYTE4N_BONE_WEIGHTS; size = 4; }
+				break;
+			case BONE_INDICES:
+				if (data == USHORT4) { operation.kernel = DECODE_USHORT4_BONE_INDICES_BE; size = 8; }
+				else if ((data == UBYTE4) || (data == UBYTE4_2)) { operation.kernel = DECODE_UBYTE4_BONE_INDICES; size = 4; }
+				break;
+			}
+
+			if (!size) continue;
+
+			operations.push_back(operation);
+			if (operation.offset + size > required_size) required_size = operation.offset + size;
+		}
+	}
+
+
+	size_t VertexDecoder::decode(const unsigned char *data, size_t data_size, size_t count, VertexArrays *arrays) {
+		// Allocate every channel the format provides with the default vertex values.
+		arrays->clear();
+		arrays->count = count;
+
+		for (vector<VertexDecoderOperation>::iterator it = operations.begin(); it != operations.end(); it++) {
+			switch ((*it).id) {
+			case POSITION:
+				arrays->positions.assign(count, Vector3());
+				break;
+			case NORMAL:
+				arrays->normals.assign(count, Vector3());
+				break;
+			case TANGENT:
+				arrays->tangents.assign(count, Vector3());
+				break;
+			case BINORMAL:
+				arrays->binormals.assign(count, Vector3());
+				break;
+			case UV:
+				arrays->uvs[(*it).index].assign(count, Vector2());
+				break;
+			case COLOR:
+				arrays->colors.assign(count, Color());
+				break;
+			case BONE_WEIGHTS:
+				arrays->bone_weights.resize(count * 4);
+				for (size_t i=0; i<count; i++) {
+					arrays->bone_weights[i*4]     = 0xFF;
+					arrays->bone_weights[i*4 + 1] = 0;
+					arrays->bone_weights[i*4 + 2] = 0;
+					arrays->bone_weights[i*4 + 3] = 0;
+				}
+				break;
+			case BONE_INDICES:
+				arrays->bone_indices.resize(count * 4);
+				for (size_t i=0; i<count; i++) {
+					arrays->bone_indices[i*4]     = 0;
+					arrays->bone_indices[i*4 + 1] = 0xFFFF;
+					arrays->bone_indices[i*4 + 2] = 0xFFFF;
+					arrays->bone_indices[i*4 + 3] = 0xFFFF;
+				}
+				break;
+			}
+		}
+
+		size_t decoded = 0;
+		if (data && (data_size >= required_size)) {
+			decoded = stride ? (data_size - required_size) / stride + 1 : count;
+			if (decoded > count) decoded = count;
+		}
+
+		vector<unsigned int> scratch;
+
+		// Elements are decoded in declaration order so a later element overrides an earlier one
+		// targeting the same attribute, as Vertex::readElements does.
+		if (decoded) {
+			for (vector<VertexDecoderOperation>::iterator it = operations.begin(); it != operations.end(); it++) {
+				const unsigned char *source = data + (*it).offset;
+
+				Vector3 *vectors = NULL;
+				switch ((*it).id) {
+				case POSITION: vectors = &arrays->positions[0]; break;
+				case NORMAL: vectors = &arrays->normals[0]; break;
+				case TANGENT: vectors = &arrays->tangents[0]; break;
+				case BINORMAL: vectors = &arrays->binormals[0]; break;
+				}
+
+				switch ((*it).kernel) {
+				case DECODE_FLOAT3_BE:
+					gatherElement(vectors, source, decoded, stride, 12);
+					Endian::swapArray((unsigned int *) vectors, vectors, decoded * 3);
+					break;
+				case DECODE_DEC3N_360_BE:
+				case DECODE_DEC3N_BE:
+					scratch.resize(decoded);
+					gatherElement(&scratch[0], source, decoded, stride, 4);
+					Endian::swapArray(&scratch[0], &scratch[0], decoded);
+					decodePackedNormalArray(vectors, &scratch[0], decoded, ((*it).kernel == DECODE_DEC3N_360_BE) ? PackedNormal360 : PackedNormalForces);
+					break;
+				case DECODE_FLOAT2_BE: {
+					Vector2 *uvs = &arrays->uvs[(*it).index][0];
+					gatherElement(uvs, source, decoded, stride, 8);
+					Endian::swapArray((unsigned int *) uvs, uvs, decoded * 2);
+					break;
+				}
+				case DECODE_FLOAT2_HALF_BE: {
+					scratch.resize(decoded);
+					unsigned short *halves = (unsigned short *) &scratch[0];
+					gatherElement(halves, source, decoded, stride, 4);
+					Endian::swapArray(halves, halves, decoded * 2);
+					decodeHalfArray(&arrays->uvs[(*it).index][0].x, halves, decoded * 2);
+					break;
+				}
+				case DECODE_FLOAT4_COLOR_BE:
+					gatherElement(&arrays->colors[0], source, decoded, stride, 16);
+					Endian::swapArray((unsigned int *) &arrays->colors[0], &arrays->colors[0], decoded * 4);
+					break;
+				case DECODE_UBYTE4N_COLOR_ABGR:
+					for (size_t i=0; i<decoded; i++, source += stride) {
+						Color &color = arrays->colors[i];
+						color.a = ((float) source[0]) / LIBGENS_MATH_COLOR_CHAR;
+						color.b = ((float) source[1]) / LIBGENS_MATH_COLOR_CHAR;
+						color.g = ((float) source[2]) / LIBGENS_MATH_COLOR_CHAR;
+						color.r = ((float) source[3]) / LIBGENS_MATH_COLOR_CHAR;
+					}
+					break;
+				case DECODE_UBYTE4N_BONE_WEIGHTS:
+					gatherElement(&arrays->bone_weights[0], source, decoded, stride, 4);
+					break;
+				case DECODE_USHORT4_BONE_INDICES_BE:
+					gatherElement(&arrays->bone_indices[0], source, decoded, stride, 8);
+					Endian::swapArray(&arrays->bone_indices[0], &arrays->bone_indices[0], decoded * 4);
+					break;
+				case DECODE_UBYTE4_BONE_INDICES:
+					for (size_t i=0; i<decoded; i++, source += stride) {
+						for (size_t j=0; j<4; j++) {
+							arrays->bone_indices[i*4 + j] = (source[j] == 0xFF) ? 0xFFFF : source[j];
+						}
+					}
+					break;
+				}
+			}
+		}
+
+		// Verify Bone Weights
+		if (!arrays->bone_weights.empty()) {
+			unsigned char *weights = &arrays->bone_weights[0];
+			for (size_t i=0; i<count; i++, weights += 4) {
+				unsigned char total_weight = weights[0] + weights[1] + weights[2] + weights[3];
+				if (total_weight != 0xFF) weights[0] += 0xFF - total_weight;
+			}
+		}
+
+		return decoded;
+	}
+};
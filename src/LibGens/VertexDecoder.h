@@ -0,0 +1,86 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+
+#pragma once
+
+#define LIBGENS_VERTEX_UV_CHANNELS    4
+
+namespace LibGens {
+	class Vertex;
+	class VertexFormat;
+
+	// Vertex attributes stored as one contiguous array per attribute.
+	// Attributes the vertex format doesn't contain are left empty and read back as the Vertex defaults.
+	class VertexArrays {
+		public:
+			size_t count;
+			vector<Vector3> positions;
+			vector<Vector3> normals;
+			vector<Vector3> tangents;
+			vector<Vector3> binormals;
+			vector<Vector2> uvs[LIBGENS_VERTEX_UV_CHANNELS];
+			vector<Color> colors;
+			vector<unsigned short> bone_indices;
+			vector<unsigned char> bone_weights;
+
+			VertexArrays();
+			void clear();
+			void allocate(size_t count_p);
+			void copyToVertex(size_t index, Vertex *vertex);
+			void copyFromVertex(size_t index, Vertex *vertex);
+			size_t getMemorySize();
+	};
+
+	enum VertexDecoderKernel {
+		DECODE_FLOAT3_BE,
+		DECODE_DEC3N_360_BE,
+		DECODE_DEC3N_BE,
+		DECODE_FLOAT2_BE,
+		DECODE_FLOAT2_HALF_BE,
+		DECODE_FLOAT4_COLOR_BE,
+		DECODE_UBYTE4N_COLOR_ABGR,
+		DECODE_UBYTE4N_BONE_WEIGHTS,
+		DECODE_USHORT4_BONE_INDICES_BE,
+		DECODE_UBYTE4_BONE_INDICES
+	};
+
+	struct VertexDecoderOperation {
+		VertexDecoderKernel kernel;
+		VertexElementID id;
+		unsigned int offset;
+		unsigned int index;
+	};
+
+	// Decoder compiled once from a VertexFormat. Rather than walking the element list and doing
+	// a seek plus a read per element for every vertex, each element is decoded across the whole
+	// vertex block by a column kernel: gather, byte swap and convert with SSE2 where possible.
+	class VertexDecoder {
+		protected:
+			vector<VertexDecoderOperation> operations;
+			unsigned int stride;
+			unsigned int required_size;
+		public:
+			VertexDecoder(VertexFormat *vformat);
+
+			// Decodes count vertices from a big endian vertex block into the arrays and returns how many
+			// vertices were fully available in the data. Missing vertices keep the default Vertex values.
+			size_t decode(const unsigned char *data, size_t data_size, size_t count, VertexArrays *arrays);
+	};
+};
@@ -83,6 +83,7 @@ namespace LibGens {
 
 	class VertexFormat {
 		friend class VertexFormat;
+		friend class VertexDecoder;
 
 		protected:
 			list<VertexFormatElement> elements;
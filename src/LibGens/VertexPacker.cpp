@@ -0,0 +1,256 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "VertexFormat.h"
+#include "VertexDecoder.h"
+#include "VertexPacker.h"
+
+namespace LibGens {
+	static const unsigned short VertexPackerDefaultBoneIndices[4] = { 0, 0xFFFF, 0xFFFF, 0xFFFF };
+	static const unsigned char VertexPackerDefaultBoneWeights[4] = { 0xFF, 0, 0, 0 };
+
+	static inline int packSignedNormalized(float v, float scale) {
+		if (v > 1.0f) v = 1.0f;
+		if (v < -1.0f) v = -1.0f;
+		return (int)(v * scale + (v >= 0.0f ? 0.5f : -0.5f));
+	}
+
+	static inline unsigned char packUnsignedNormalized(float v) {
+		if (v > 1.0f) v = 1.0f;
+		if (v < 0.0f) v = 0.0f;
+		return (unsigned char)(v * 255.0f + 0.5f);
+	}
+
+	// Attributes missing from the arrays are packed from a single default value: step is 0 for those.
+	template<typename T> static const T *packerSource(const vector<T> &source, const T &fallback, size_t *step) {
+		*step = source.empty() ? 0 : 1;
+		return source.empty() ? &fallback : &source[0];
+	}
+
+	static void packVector3Column(unsigned char *out, size_t stride, const Vector3 *source, size_t step, size_t count, VertexElementData data) {
+		for (size_t i=0; i<count; i++, out+=stride) {
+			const Vector3 &v = source[i*step];
+
+			if (data == FLOAT3) {
+				memcpy(out, &v.x, sizeof(float) * 3);
+			}
+			else if (data == SHORT4N) {
+				short packed[4] = { (short) packSignedNormalized(v.x, 32767.0f), (short) packSignedNormalized(v.y, 32767.0f), (short) packSignedNormalized(v.z, 32767.0f), 32767 };
+				memcpy(out, packed, sizeof(packed));
+			}
+			else if (data == DEC3N) {
+				unsigned int packed = ((unsigned int) packSignedNormalized(v.x, 511.0f) & 0x3FF) |
+									  (((unsigned int) packSignedNormalized(v.y, 511.0f) & 0x3FF) << 10) |
+									  (((unsigned int) packSignedNormalized(v.z, 511.0f) & 0x3FF) << 20);
+				memcpy(out, &packed, sizeof(packed));
+			}
+		}
+	}
+
+	static void packUVColumn(unsigned char *out, size_t stride, const Vector2 *source, size_t step, size_t count, VertexElementData data) {
+		for (size_t i=0; i<count; i++, out+=stride) {
+			const Vector2 &v = source[i*step];
+
+			if (data == FLOAT2) {
+				memcpy(out, &v.x, sizeof(float) * 2);
+			}
+			else if (data == FLOAT2_HALF) {
+				unsigned short packed[2] = { quantizeHalf(v.x), quantizeHalf(v.y) };
+				memcpy(out, packed, sizeof(packed));
+			}
+		}
+	}
+
+	static void packColorColumn(unsigned char *out, size_t stride, const Color *source, size_t step, size_t count, VertexElementData data) {
+		for (size_t i=0; i<count; i++, out+=stride) {
+			const Color &c = source[i*step];
+
+			if (data == FLOAT4) {
+				memcpy(out, &c.r, sizeof(float) * 4);
+			}
+			else if (data == UBYTE4N) {
+				out[0] = packUnsignedNormalized(c.r);
+				out[1] = packUnsignedNormalized(c.g);
+				out[2] = packUnsignedNormalized(c.b);
+				out[3] = packUnsignedNormalized(c.a);
+			}
+			else if (data == D3DCOLOR) {
+				out[0] = packUnsignedNormalized(c.b);
+				out[1] = packUnsignedNormalized(c.g);
+				out[2] = packUnsignedNormalized(c.r);
+				out[3] = packUnsignedNormalized(c.a);
+			}
+		}
+	}
+
+	static void packBoneIndexColumn(unsigned char *out, size_t stride, const unsigned short *source, size_t step, size_t count, VertexElementData data) {
+		for (size_t i=0; i<count; i++, out+=stride) {
+			const unsigned short *indices = source + i*step*4;
+
+			if (data == USHORT4) {
+				memcpy(out, indices, sizeof(unsigned short) * 4);
+			}
+			else {
+				for (size_t j=0; j<4; j++) out[j] = (unsigned char) indices[j];
+			}
+		}
+	}
+
+	static void packBoneWeightColumn(unsigned char *out, size_t stride, const unsigned char *source, size_t step, size_t count) {
+		for (size_t i=0; i<count; i++, out+=stride) {
+			memcpy(out, source + i*step*4, 4);
+		}
+	}
+
+
+	VertexPacker::VertexPacker() {
+		stride = 0;
+	}
+
+	VertexPacker::VertexPacker(unsigned int layout) {
+		stride = 0;
+
+		VertexElementData vector_data = (layout == LIBGENS_VERTEX_PACKER_LAYOUT_COMPACT) ? DEC3N : FLOAT3;
+		VertexElementData uv_data = (layout == LIBGENS_VERTEX_PACKER_LAYOUT_COMPACT) ? FLOAT2_HALF : FLOAT2;
+		VertexElementData color_data = FLOAT4;
+		if (layout == LIBGENS_VERTEX_PACKER_LAYOUT_D3D9) color_data = D3DCOLOR;
+		else if (layout == LIBGENS_VERTEX_PACKER_LAYOUT_COMPACT) color_data = UBYTE4N;
+
+		addElement(POSITION, FLOAT3);
+		addElement(NORMAL, vector_data);
+		addElement(TANGENT, vector_data);
+		addElement(BINORMAL, vector_data);
+		for (unsigned int channel=0; channel<LIBGENS_VERTEX_UV_CHANNELS; channel++) {
+			addElement(UV, uv_data, channel);
+		}
+		addElement(COLOR, color_data);
+	}
+
+	unsigned int VertexPacker::getElementSize(VertexElementID id, VertexElementData data) {
+		switch (id) {
+			case POSITION:
+				if (data == FLOAT3) return 12;
+				break;
+			case NORMAL:
+			case TANGENT:
+			case BINORMAL:
+				if (data == FLOAT3) return 12;
+				if (data == SHORT4N) return 8;
+				if (data == DEC3N) return 4;
+				break;
+			case UV:
+				if (data == FLOAT2) return 8;
+				if (data == FLOAT2_HALF) return 4;
+				break;
+			case COLOR:
+				if (data == FLOAT4) return 16;
+				if ((data == UBYTE4N) || (data == D3DCOLOR)) return 4;
+				break;
+			case BONE_INDICES:
+				if (data == UBYTE4) return 4;
+				if (data == USHORT4) return 8;
+				break;
+			case BONE_WEIGHTS:
+				if (data == UBYTE4N) return 4;
+				break;
+		}
+
+		return 0;
+	}
+
+	bool VertexPacker::addElement(VertexElementID id, VertexElementData data, unsigned int index) {
+		unsigned int size = getElementSize(id, data);
+		if (!size) return false;
+		if ((id == UV) && (index >= LIBGENS_VERTEX_UV_CHANNELS)) return false;
+
+		VertexPackerElement element;
+		element.id = id;
+		element.data = data;
+		element.index = index;
+		element.offset = stride;
+		elements.push_back(element);
+
+		stride += size;
+		return true;
+	}
+
+	size_t VertexPacker::getElementCount() {
+		return elements.size();
+	}
+
+	VertexPackerElement VertexPacker::getElement(size_t index) {
+		return elements[index];
+	}
+
+	unsigned int VertexPacker::getStride() {
+		return stride;
+	}
+
+	size_t VertexPacker::getBufferSize(size_t vertex_count) {
+		return vertex_count * stride;
+	}
+
+	size_t VertexPacker::pack(VertexArrays *arrays, void *buffer, size_t buffer_size) {
+		if (!arrays || !buffer || !stride) return 0;
+
+		size_t count = arrays->count;
+		if (count > buffer_size / stride) count = buffer_size / stride;
+
+		const Vector3 zero_vector;
+		const Vector2 zero_uv;
+		const Color white;
+
+		for (vector<VertexPackerElement>::iterator it=elements.begin(); it!=elements.end(); it++) {
+			unsigned char *out = (unsigned char *) buffer + (*it).offset;
+			size_t step = 0;
+
+			switch ((*it).id) {
+				case POSITION:
+				case NORMAL:
+				case TANGENT:
+				case BINORMAL: {
+					const vector<Vector3> &column = ((*it).id == POSITION) ? arrays->positions : (((*it).id == NORMAL) ? arrays->normals : (((*it).id == TANGENT) ? arrays->tangents : arrays->binormals));
+					const Vector3 *source = packerSource(column, zero_vector, &step);
+					packVector3Column(out, stride, source, step, count, (*it).data);
+					break;
+				}
+				case UV: {
+					const Vector2 *source = packerSource(arrays->uvs[(*it).index], zero_uv, &step);
+					packUVColumn(out, stride, source, step, count, (*it).data);
+					break;
+				}
+				case COLOR: {
+					const Color *source = packerSource(arrays->colors, white, &step);
+					packColorColumn(out, stride, source, step, count, (*it).data);
+					break;
+				}
+				case BONE_INDICES:
+					if (arrays->bone_indices.empty()) packBoneIndexColumn(out, stride, VertexPackerDefaultBoneIndices, 0, count, (*it).data);
+					else packBoneIndexColumn(out, stride, &arrays->bone_indices[0], 1, count, (*it).data);
+					break;
+				case BONE_WEIGHTS:
+					if (arrays->bone_weights.empty()) packBoneWeightColumn(out, stride, VertexPackerDefaultBoneWeights, 0, count);
+					else packBoneWeightColumn(out, stride, &arrays->bone_weights[0], 1, count);
+					break;
+			}
+		}
+
+		return count;
+	}
+};
@@ -0,0 +1,72 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#pragma once
+
+#define LIBGENS_VERTEX_PACKER_LAYOUT_FLOAT      0
+#define LIBGENS_VERTEX_PACKER_LAYOUT_D3D9       1
+#define LIBGENS_VERTEX_PACKER_LAYOUT_COMPACT    2
+
+namespace LibGens {
+	class VertexArrays;
+
+	struct VertexPackerElement {
+		VertexElementID id;
+		VertexElementData data;
+		unsigned int index;
+		unsigned int offset;
+	};
+
+	// Interleaved vertex layout for GPU upload. pack writes VertexArrays straight into a caller provided
+	// buffer in host (little endian) byte order, one element column at a time, so nothing goes through
+	// Vertex objects or intermediate float arrays.
+	//
+	// Supported element data:
+	//   POSITION                    FLOAT3
+	//   NORMAL, TANGENT, BINORMAL   FLOAT3, SHORT4N (w = 1), DEC3N (10:10:10 signed, x in the low bits)
+	//   UV                          FLOAT2, FLOAT2_HALF
+	//   COLOR                       FLOAT4, UBYTE4N (bytes r, g, b, a), D3DCOLOR (bytes b, g, r, a)
+	//   BONE_INDICES                UBYTE4, USHORT4
+	//   BONE_WEIGHTS                UBYTE4N
+	//
+	// The layouts built in are:
+	//   LIBGENS_VERTEX_PACKER_LAYOUT_FLOAT     96 bytes, every attribute as floats.
+	//   LIBGENS_VERTEX_PACKER_LAYOUT_D3D9      84 bytes, floats with a D3DCOLOR color, for renderers without half types.
+	//   LIBGENS_VERTEX_PACKER_LAYOUT_COMPACT   44 bytes, DEC3N normal/tangent/binormal, half UVs and a UBYTE4N color.
+	class VertexPacker {
+		protected:
+			vector<VertexPackerElement> elements;
+			unsigned int stride;
+		public:
+			VertexPacker();
+			VertexPacker(unsigned int layout);
+
+			// Appends an element at the end of the vertex. Returns false if the data type isn't supported for id.
+			bool addElement(VertexElementID id, VertexElementData data, unsigned int index=0);
+			size_t getElementCount();
+			VertexPackerElement getElement(size_t index);
+			unsigned int getStride();
+			size_t getBufferSize(size_t vertex_count);
+
+			// Packs as many vertices as fit in buffer_size bytes and returns how many were written.
+			size_t pack(VertexArrays *arrays, void *buffer, size_t buffer_size);
+
+			static unsigned int getElementSize(VertexElementID id, VertexElementData data);
+	};
+};
@@ -0,0 +1,363 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "XMLReader.h"
+#include <float.h>
+#include <limits.h>
+
+namespace LibGens {
+	static const float xml_reader_powers[]={ 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+	static inline bool isXMLSpace(char c) {
+		return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+	}
+
+	static const char *findXML(const char *begin, const char *end, const char *token) {
+		size_t token_size=strlen(token);
+		for (const char *c=begin; c + token_size <= end; c++) {
+			if (!memcmp(c, token, token_size)) return c + token_size;
+		}
+
+		return end;
+	}
+
+	XMLReader::XMLReader(const char *data_p, size_t size) {
+		data = data_p;
+		data_end = data_p + size;
+		position = data_p;
+		name = data_p;
+		name_size = 0;
+		depth = 0;
+		empty_element = false;
+	}
+
+	bool XMLReader::nextChild(size_t parent_depth) {
+		while (depth >= parent_depth) {
+			// A self-closing child closes itself before anything after it is read.
+			bool end_tag=empty_element;
+			empty_element = false;
+
+			if (!end_tag) {
+				position = (const char *) memchr(position, '<', data_end - position);
+				if (!position || (position + 1 >= data_end)) {
+					position = data_end;
+					return false;
+				}
+
+				const char *tag=position + 1;
+				if (*tag == '!') {
+					if ((data_end - tag >= 3) && !memcmp(tag, "!--", 3)) position = findXML(tag, data_end, "-->");
+					else if ((data_end - tag >= 8) && !memcmp(tag, "![CDATA[", 8)) position = findXML(tag, data_end, "]]>");
+					else position = findXML(tag, data_end, ">");
+					continue;
+				}
+				else if (*tag == '?') {
+					position = findXML(tag, data_end, "?>");
+					continue;
+				}
+				else if (*tag == '/') {
+					position = findXML(tag, data_end, ">");
+					end_tag = true;
+				}
+				else {
+					const char *tag_name=tag;
+					while ((tag < data_end) && !isXMLSpace(*tag) && (*tag != '/') && (*tag != '>')) tag++;
+					size_t tag_name_size=tag - tag_name;
+
+					char quote=0;
+					bool self_closing=false;
+					for (; tag < data_end; tag++) {
+						if (quote) {
+							if (*tag == quote) quote = 0;
+						}
+						else if ((*tag == '"') || (*tag == '\'')) quote = *tag;
+						else if (*tag == '>') break;
+					}
+					if ((tag < data_end) && (tag[-1] == '/')) self_closing = true;
+					position = (tag < data_end) ? tag + 1 : data_end;
+
+					if (depth == parent_depth) {
+						depth++;
+						name = tag_name;
+						name_size = tag_name_size;
+						empty_element = self_closing;
+						return true;
+					}
+
+					if (!self_closing) depth++;
+					continue;
+				}
+			}
+
+			if (!depth) continue;
+			depth--;
+			if (depth < parent_depth) return false;
+		}
+
+		return false;
+	}
+
+	size_t XMLReader::getDepth() {
+		return depth;
+	}
+
+	string XMLReader::getName() {
+		return string(name, name_size);
+	}
+
+	bool XMLReader::isName(const char *value) {
+		return (strlen(value) == name_size) && !memcmp(name, value, name_size);
+	}
+
+	bool XMLReader::getTextRange(const char **begin, const char **end) {
+		if (empty_element) return false;
+
+		const char *text_begin=position;
+		const char *text_end=(const char *) memchr(position, '<', data_end - position);
+		if (!text_end) text_end = data_end;
+
+		while ((text_begin < text_end) && isXMLSpace(*text_begin)) text_begin++;
+		while ((text_end > text_begin) && isXMLSpace(text_end[-1])) text_end--;
+		if (text_begin == text_end) return false;
+
+		*begin = text_begin;
+		*end = text_end;
+		return true;
+	}
+
+	bool XMLReader::hasText() {
+		const char *begin=NULL;
+		const char *end=NULL;
+		return getTextRange(&begin, &end);
+	}
+
+	bool XMLReader::readText(string *text) {
+		const char *begin=NULL;
+		const char *end=NULL;
+		if (!getTextRange(&begin, &end)) return false;
+
+		text->clear();
+		text->reserve(end - begin);
+
+		for (const char *c=begin; c < end; c++) {
+			if (isXMLSpace(*c)) {
+				while ((c + 1 < end) && isXMLSpace(c[1])) c++;
+				text->push_back(' ');
+			}
+			else if (*c == '&') {
+				const char *entity_end=(const char *) memchr(c, ';', end - c);
+				string entity=entity_end ? string(c + 1, entity_end) : "";
+				unsigned int code=0;
+
+				if      (entity == "amp")  text->push_back('&');
+				else if (entity == "lt")   text->push_back('<');
+				else if (entity == "gt")   text->push_back('>');
+				else if (entity == "quot") text->push_back('"');
+				else if (entity == "apos") text->push_back('\'');
+				else if ((entity.size() > 1) && (entity[0] == '#')) {
+					code = (entity[1] == 'x') ? strtoul(entity.c_str() + 2, NULL, 16) : strtoul(entity.c_str() + 1, NULL, 10);
+
+					if (code < 0x80) {
+						text->push_back((char) code);
+					}
+					else if (code < 0x800) {
+						text->push_back((char) (0xC0 | (code >> 6)));
+						text->push_back((char) (0x80 | (code & 0x3F)));
+					}
+					else if (code < 0x10000) {
+						text->push_back((char) (0xE0 | (code >> 12)));
+						text->push_back((char) (0x80 | ((code >> 6) & 0x3F)));
+						text->push_back((char) (0x80 | (code & 0x3F)));
+					}
+					else {
+						text->push_back((char) (0xF0 | (code >> 18)));
+						text->push_back((char) (0x80 | ((code >> 12) & 0x3F)));
+						text->push_back((char) (0x80 | ((code >> 6) & 0x3F)));
+						text->push_back((char) (0x80 | (code & 0x3F)));
+					}
+				}
+				else {
+					text->push_back('&');
+					continue;
+				}
+
+				c = entity_end;
+			}
+			else {
+				text->push_back(*c);
+			}
+		}
+
+		return true;
+	}
+
+	bool XMLReader::readFloat(float *value) {
+		const char *begin=NULL;
+		const char *end=NULL;
+		if (!getTextRange(&begin, &end)) return false;
+		return parseFloat(begin, end, value);
+	}
+
+	bool XMLReader::readUInt(unsigned int *value) {
+		const char *begin=NULL;
+		const char *end=NULL;
+		if (!getTextRange(&begin, &end)) return false;
+
+		unsigned long long result=0;
+		bool valid=parseUnsigned(begin, end, UINT_MAX, &result);
+		*value = (unsigned int) result;
+		return valid;
+	}
+
+	bool XMLReader::readSizeT(size_t *value) {
+		const char *begin=NULL;
+		const char *end=NULL;
+		if (!getTextRange(&begin, &end)) return false;
+
+		unsigned long long result=0;
+		bool valid=parseUnsigned(begin, end, (size_t) -1, &result);
+		*value = (size_t) result;
+		return valid;
+	}
+
+	bool XMLReader::parseFloat(const char *begin, const char *end, float *value) {
+		const char *c=begin;
+		while ((c < end) && isXMLSpace(*c)) c++;
+		const char *number=c;
+
+		bool negative=false;
+		if ((c < end) && ((*c == '-') || (*c == '+'))) {
+			negative = (*c == '-');
+			c++;
+		}
+
+		// Up to 19 significant digits fit the mantissa exactly; exponent counts the decimal shift.
+		unsigned long long mantissa=0;
+		int digits=0;
+		int exponent=0;
+		bool any_digit=false;
+		bool truncated=false;
+
+		for (; (c < end) && (*c >= '0') && (*c <= '9'); c++) {
+			any_digit = true;
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*c - '0');
+				if (mantissa) digits++;
+			}
+			else {
+				exponent++;
+				if (*c != '0') truncated = true;
+			}
+		}
+
+		if ((c < end) && (*c == '.')) {
+			c++;
+			for (; (c < end) && (*c >= '0') && (*c <= '9'); c++) {
+				any_digit = true;
+				if (digits < 19) {
+					mantissa = mantissa * 10 + (*c - '0');
+					if (mantissa) digits++;
+					exponent--;
+				}
+				else if (*c != '0') truncated = true;
+			}
+		}
+
+		if (!any_digit) {
+			*value = 0.0f;
+			return false;
+		}
+
+		if ((c < end) && ((*c == 'e') || (*c == 'E'))) {
+			const char *e=c + 1;
+			bool exponent_negative=false;
+			if ((e < end) && ((*e == '-') || (*e == '+'))) {
+				exponent_negative = (*e == '-');
+				e++;
+			}
+
+			if ((e < end) && (*e >= '0') && (*e <= '9')) {
+				int exponent_value=0;
+				for (; (e < end) && (*e >= '0') && (*e <= '9'); e++) {
+					if (exponent_value < 100000) exponent_value = exponent_value * 10 + (*e - '0');
+				}
+				exponent += exponent_negative ? -exponent_value : exponent_value;
+				c = e;
+			}
+		}
+
+		// Exact mantissa and power of ten in a float make a single correctly rounded operation. Anything
+		// else, like long mantissas or large exponents, goes through strtod on the same characters.
+		if (!mantissa) {
+			*value = negative ? -0.0f : 0.0f;
+		}
+		else if (!truncated && (mantissa <= (1 << 24)) && (exponent >= -10) && (exponent <= 10)) {
+			float result=(float) mantissa;
+			result = (exponent < 0) ? (result / xml_reader_powers[-exponent]) : (result * xml_reader_powers[exponent]);
+			*value = negative ? -result : result;
+		}
+		else {
+			string text(number, c);
+			*value = strtof(text.c_str(), NULL);
+
+			if ((*value > FLT_MAX) || (*value < -FLT_MAX)) {
+				*value = negative ? -FLT_MAX : FLT_MAX;
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool XMLReader::parseUnsigned(const char *begin, const char *end, unsigned long long max, unsigned long long *value) {
+		const char *c=begin;
+		while ((c < end) && isXMLSpace(*c)) c++;
+
+		bool negative=false;
+		if ((c < end) && ((*c == '-') || (*c == '+'))) {
+			negative = (*c == '-');
+			c++;
+		}
+
+		if ((c >= end) || (*c < '0') || (*c > '9')) {
+			*value = 0;
+			return false;
+		}
+
+		unsigned long long result=0;
+		for (; (c < end) && (*c >= '0') && (*c <= '9'); c++) {
+			unsigned long long digit = *c - '0';
+
+			// Like the stream extraction, out of range values fail and saturate.
+			// Checked before accumulating so max can be the largest value of the type.
+			if (result > (max - digit) / 10) {
+				*value = max;
+				return false;
+			}
+
+			result = result * 10 + digit;
+		}
+
+		// Negative values wrap around like they do for unsigned stream extraction.
+		if (negative && result) result = max - result + 1;
+
+		*value = result;
+		return true;
+	}
+};
@@ -0,0 +1,70 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#pragma once
+
+namespace LibGens {
+	// Pull parser over an XML document already in memory, e.g. a memory mapped File. It builds no tree:
+	// nextChild walks the start tags of the element at a given depth, skipping whatever nested content
+	// the caller didn't read, and the text of the element it stops at can be read in place.
+	//
+	//   size_t depth=reader->getDepth();
+	//   while (reader->nextChild(depth)) {
+	//       if (reader->isName("x")) reader->readFloat(&x);
+	//   }
+	//
+	// Text follows TinyXML's GetText with condensed white space: only text before the first child
+	// element counts, and text that is only white space is no text. Attributes and CDATA sections are
+	// skipped. The buffer has to outlive the reader, and a copy of the reader is a cheap lookahead.
+	class XMLReader {
+		protected:
+			const char *data;
+			const char *data_end;
+			const char *position;
+			const char *name;
+			size_t name_size;
+			size_t depth;
+			bool empty_element;
+
+			bool getTextRange(const char **begin, const char **end);
+		public:
+			XMLReader(const char *data_p, size_t size);
+
+			// Moves to the next child of the element at the given depth, or past its end tag and returns false.
+			// The document root is the child of depth 0.
+			bool nextChild(size_t parent_depth);
+			size_t getDepth();
+			string getName();
+			bool isName(const char *value);
+
+			// Text of the current element. Values stay untouched when it has none; text that doesn't parse
+			// reads 0 and out of range numbers saturate, like stream extraction.
+			bool hasText();
+			bool readText(string *text);
+			bool readFloat(float *value);
+			bool readUInt(unsigned int *value);
+			bool readSizeT(size_t *value);
+
+			// Number parsing with the results of FromString with std::dec over the same text, without
+			// a stringstream. Leading white space is skipped and parsing stops at the first character that
+			// can't continue the number. Floats are correctly rounded.
+			static bool parseFloat(const char *begin, const char *end, float *value);
+			static bool parseUnsigned(const char *begin, const char *end, unsigned long long max, unsigned long long *value);
+	};
+};
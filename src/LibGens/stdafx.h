@@ -19,7 +19,19 @@
 
 using namespace std;
 
+#ifdef _WIN32
 #include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#define __debugbreak() __builtin_trap()
+#endif
 
 #include <stack>
 #include <list>
@@ -28,7 +40,13 @@ using namespace std;
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <algorithm>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <ctype.h>
 
 // Common Headers only should be pre-compiled
@@ -39,4 +57,6 @@ using namespace std;
 #include "MathGens.h"
 #include "Error.h"
 #include "Endian.h"
-#include "File.h"
\ No newline at end of file
+#include "File.h"
+#include "FileReader.h"
+#include "Parallel.h"
\ No newline at end of file
@@ -23,55 +23,317 @@
 #include "PAC.h"
 #include "AR.h"
 
-/** EditorHash */
+#ifdef _WIN32
+#include <winioctl.h>
+#elif defined(__linux__)
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
 
-EditorHash::EditorHash() {
-	for (int i=0; i<5; i++) {
-		hash_data[i] = 0;
+static EditorHash toEditorHash(XXH128_hash_t hash) {
+	return EditorHash(hash.low64, hash.high64);
+}
+
+// Hash of a whole file, derived from the names and content hashes of its entries.
+static EditorHash combineEntryHashes(const EditorEntryHashes &hashes) {
+	XXH3_state_t state;
+	XXH3_128bits_reset(&state);
+
+	for (EditorEntryHashes::const_iterator it = hashes.begin(); it != hashes.end(); it++) {
+		QByteArray name = it.key().toUtf8();
+		QByteArray value = it.value().toString().toLatin1();
+		XXH3_128bits_update(&state, name.constData(), name.size() + 1);
+		XXH3_128bits_update(&state, value.constData(), value.size());
 	}
+
+	return toEditorHash(XXH3_128bits_digest(&state));
 }
 
-EditorHash::EditorHash(int *v) {
-	for (int i=0; i<5; i++) {
-		hash_data[i] = v[i];
+static bool hashFile(QString filename, EditorHash *hash) {
+	QFileInfo info(filename);
+	if (!info.exists()) {
+		return false;
 	}
+
+	// Empty files can't be mapped
+	if (!info.size()) {
+		*hash = toEditorHash(XXH3_128bits(NULL, 0));
+		return true;
+	}
+
+	LibGens::File file(filename.toStdString(), LIBGENS_FILE_READ_BINARY);
+	if (!file.valid()) {
+		return false;
+	}
+
+	size_t size = 0;
+	const unsigned char *data = file.getMemoryData(&size);
+	if (data) {
+		*hash = toEditorHash(XXH3_128bits(data, size));
+	}
+	else {
+		vector<unsigned char> buffer(file.getFileSize());
+		size = file.read(buffer.data(), buffer.size());
+		*hash = toEditorHash(XXH3_128bits(buffer.data(), size));
+	}
+
+	file.close();
+	return true;
 }
 
-EditorHash::EditorHash(QString hash_string) {
-	QStringList hash_string_list = hash_string.split(".");
-	if (hash_string_list.size() == 5) {
-		for (int i=0; i<5; i++) {
-			hash_data[i] = hash_string_list[i].toInt();
+// Hashes every file in the directory, keyed by entry name (the filename without the unpack suffix).
+static EditorEntryHashes hashDirectory(QString directory, QString suffix) {
+	QDir dir(directory);
+	dir.setFilter(QDir::Files);
+	QStringList file_list = dir.entryList();
+
+	vector<EditorHash> file_hashes(file_list.size());
+	vector<char> file_valid(file_list.size(), 0);
+	LibGens::Parallel::forEach(file_list.size(), [&](size_t i) {
+		file_valid[i] = hashFile(directory + "/" + file_list[i], &file_hashes[i]);
+	});
+
+	EditorEntryHashes hashes;
+	for (int i=0; i<file_list.size(); i++) {
+		if (!file_valid[i]) {
+			continue;
 		}
+
+		QString entry_name = file_list[i];
+		if (!suffix.isEmpty() && entry_name.endsWith(suffix)) {
+			entry_name.chop(suffix.size());
+		}
+		hashes[entry_name] = file_hashes[i];
 	}
+
+	return hashes;
 }
 
-QString EditorHash::toString() {
-	return QString("%1.%2.%3.%4.%5").arg(hash_data[0]).arg(hash_data[1]).arg(hash_data[2]).arg(hash_data[3]).arg(hash_data[4]);
+static void removeFilesExcept(QString directory, const QSet<QString> &keep_files) {
+	QDir dir(directory);
+	dir.setFilter(QDir::Files);
+	QStringList file_list = dir.entryList();
+	foreach(QString file, file_list) {
+		if (!keep_files.contains(file)) {
+			dir.remove(file);
+		}
+	}
 }
 
-bool EditorHash::operator==(const EditorHash &h) const {
-	for (int i=0; i<5; i++) {
-		if (h.hash_data[i] != hash_data[i]) {
-			return false;
+// Moves every file in source_directory over the file with the same name in target_directory. The original is
+// renamed out of the way first and only removed once the new file is in place.
+static bool replaceFiles(QString source_directory, QString target_directory, QSet<QString> *replaced_files) {
+	QDir dir(source_directory);
+	dir.setFilter(QDir::Files);
+	QStringList file_list = dir.entryList();
+
+	bool replaced = true;
+	foreach(QString file, file_list) {
+		QString source = source_directory + "/" + file;
+		QString target = target_directory + "/" + file;
+		QString backup = target + ".bak";
+
+		QFile::remove(backup);
+		if (QFile::exists(target) && !QFile::rename(target, backup)) {
+			replaced = false;
+			continue;
+		}
+
+		if (!QFile::rename(source, target)) {
+			QFile::rename(backup, target);
+			replaced = false;
+			continue;
 		}
+
+		QFile::remove(backup);
+		replaced_files->insert(file);
 	}
 
-	return true;
+	return replaced;
+}
+
+// Removes the numbered volumes (volume_base + "01", "02"...) left over from a bigger archive.
+static void removeStaleVolumes(QString volume_base, int first_index, const QSet<QString> &written_files) {
+	for (int index=first_index; ; index++) {
+		QString volume = volume_base + QString("%1").arg(index, 2, 10, QChar('0'));
+		if (!QFile::exists(volume)) {
+			break;
+		}
+
+		if (!written_files.contains(QFileInfo(volume).fileName())) {
+			QFile::remove(volume);
+		}
+	}
+}
+
+// Clones source into target so both share their data until either is written: block cloning on ReFS, FICLONE on
+// Linux filesystems that support it. Returns false when the filesystem can't, leaving no target behind.
+static bool cloneFile(QString source, QString target) {
+#ifdef _WIN32
+	HANDLE source_handle = CreateFileW((LPCWSTR) QDir::toNativeSeparators(source).utf16(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
+	if (source_handle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	// Only volumes that report a cluster size here can clone
+	FSCTL_GET_INTEGRITY_INFORMATION_BUFFER integrity;
+	DWORD bytes = 0;
+	LARGE_INTEGER size;
+	if (!DeviceIoControl(source_handle, FSCTL_GET_INTEGRITY_INFORMATION, NULL, 0, &integrity, sizeof(integrity), &bytes, NULL) || !GetFileSizeEx(source_handle, &size)) {
+		CloseHandle(source_handle);
+		return false;
+	}
+
+	HANDLE target_handle = CreateFileW((LPCWSTR) QDir::toNativeSeparators(target).utf16(), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+	if (target_handle == INVALID_HANDLE_VALUE) {
+		CloseHandle(source_handle);
+		return false;
+	}
+
+	FILE_END_OF_FILE_INFO end_of_file;
+	end_of_file.EndOfFile = size;
+	bool cloned = SetFileInformationByHandle(target_handle, FileEndOfFileInfo, &end_of_file, sizeof(end_of_file)) != 0;
+
+	// Regions are whole clusters and a single clone is limited to less than 4 GB
+	const LONGLONG cluster_size = integrity.ClusterSizeInBytes;
+	const LONGLONG chunk_size = (0x80000000LL / cluster_size) * cluster_size;
+	LONGLONG clone_size = ((size.QuadPart + cluster_size - 1) / cluster_size) * cluster_size;
+	for (LONGLONG offset=0; cloned && (offset < clone_size); offset += chunk_size) {
+		DUPLICATE_EXTENTS_DATA extents;
+		extents.FileHandle = source_handle;
+		extents.SourceFileOffset.QuadPart = offset;
+		extents.TargetFileOffset.QuadPart = offset;
+		extents.ByteCount.QuadPart = min(chunk_size, clone_size - offset);
+		cloned = DeviceIoControl(target_handle, FSCTL_DUPLICATE_EXTENTS_TO_FILE, &extents, sizeof(extents), NULL, 0, &bytes, NULL) != 0;
+	}
+
+	CloseHandle(target_handle);
+	CloseHandle(source_handle);
+#elif defined(__linux__)
+	int source_fd = open(source.toLocal8Bit().constData(), O_RDONLY);
+	if (source_fd < 0) {
+		return false;
+	}
+
+	int target_fd = open(target.toLocal8Bit().constData(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (target_fd < 0) {
+		close(source_fd);
+		return false;
+	}
+
+	bool cloned = ioctl(target_fd, FICLONE, source_fd) == 0;
+	close(target_fd);
+	close(source_fd);
+#else
+	bool cloned = false;
+#endif
+
+	if (!cloned) {
+		QFile::remove(target);
+	}
+
+	return cloned;
+}
+
+static void removeBlob(QString blob_filename) {
+	QFile::setPermissions(blob_filename, QFile::permissions(blob_filename) | QFile::WriteOwner | QFile::WriteUser);
+	QFile::remove(blob_filename);
+}
+
+/** EditorHash */
+
+EditorHash::EditorHash() {
+	hash_data[0] = 0;
+	hash_data[1] = 0;
+}
+
+EditorHash::EditorHash(unsigned long long low, unsigned long long high) {
+	hash_data[0] = low;
+	hash_data[1] = high;
+}
+
+EditorHash::EditorHash(QString hash_string) {
+	hash_data[0] = 0;
+	hash_data[1] = 0;
+
+	if (hash_string.size() == 32) {
+		bool high_valid = false;
+		bool low_valid = false;
+		unsigned long long high = hash_string.left(16).toULongLong(&high_valid, 16);
+		unsigned long long low = hash_string.mid(16).toULongLong(&low_valid, 16);
+		if (high_valid && low_valid) {
+			hash_data[0] = low;
+			hash_data[1] = high;
+		}
+	}
+}
+
+QString EditorHash::toString() const {
+	return QString("%1%2").arg(hash_data[1], 16, 16, QChar('0')).arg(hash_data[0], 16, 16, QChar('0'));
+}
+
+bool EditorHash::operator==(const EditorHash &h) const {
+	return (h.hash_data[0] == hash_data[0]) && (h.hash_data[1] == hash_data[1]);
+}
+
+bool EditorHash::operator!=(const EditorHash &h) const {
+	return !(*this == h);
 }
 
 /** EditorCacheHash */
 const QString EditorCacheHash::DocumentRoot = "CacheHash";
 const QString EditorCacheHash::DocumentHashRoot = "Hash";
+const QString EditorCacheHash::DocumentEntryRoot = "Entry";
 
 EditorCacheHash::EditorCacheHash() {
 	file_hashes.clear();
+	entry_hashes.clear();
 }
 
 void EditorCacheHash::addFileHash(QString name, EditorHash hash) {
 	file_hashes[name] = hash;
 }
 
+EditorEntryHashes EditorCacheHash::getEntryHashes(QString name) {
+	return entry_hashes.value(name);
+}
+
+void EditorCacheHash::setEntryHashes(QString name, const EditorEntryHashes &hashes) {
+	entry_hashes[name] = hashes;
+}
+
+QStringList EditorCacheHash::orderEntries(QString name, const EditorEntryHashes &hashes) {
+	// Entries without a recorded position go after the ones with one
+	QStringList order;
+	QSet<QString> ordered;
+	foreach(QString entry_name, entry_orders.value(name)) {
+		if (hashes.contains(entry_name) && !ordered.contains(entry_name)) {
+			order.append(entry_name);
+			ordered.insert(entry_name);
+		}
+	}
+
+	for (EditorEntryHashes::const_iterator it = hashes.begin(); it != hashes.end(); it++) {
+		if (!ordered.contains(it.key())) {
+			order.append(it.key());
+		}
+	}
+
+	return order;
+}
+
+void EditorCacheHash::setEntryOrder(QString name, const QStringList &order) {
+	entry_orders[name] = order;
+}
+
+void EditorCacheHash::collectEntryHashes(QSet<QString> *hash_strings) {
+	for (QMap<QString, EditorEntryHashes>::iterator it = entry_hashes.begin(); it != entry_hashes.end(); it++) {
+		for (EditorEntryHashes::iterator it_e = it.value().begin(); it_e != it.value().end(); it_e++) {
+			hash_strings->insert(it_e.value().toString());
+		}
+	}
+}
+
 void EditorCacheHash::setStageName(const QString &name) {
 	stage_name = name;
 }
@@ -97,8 +359,24 @@ void EditorCacheHash::readDocument(QDomElement &element) {
 			QString hash_name = child_element.attribute("name");
 			QString hash_value = child_element.attribute("value");
 			if (!hash_name.isEmpty() && !hash_value.isEmpty()) {
-				EditorHash hash(hash_value);
-				file_hashes[hash_name] = hash_value;
+				file_hashes[hash_name] = EditorHash(hash_value);
+
+				// Content hash of every entry inside the file, used to only unpack and pack what changed.
+				// Entries are stored in the order they have inside the file.
+				EditorEntryHashes hashes;
+				QStringList order;
+				QDomElement entry_element = child_element.firstChildElement(DocumentEntryRoot);
+				while (!entry_element.isNull()) {
+					QString entry_name = entry_element.attribute("name");
+					QString entry_value = entry_element.attribute("value");
+					if (!entry_name.isEmpty() && !entry_value.isEmpty()) {
+						hashes[entry_name] = EditorHash(entry_value);
+						order.append(entry_name);
+					}
+					entry_element = entry_element.nextSiblingElement(DocumentEntryRoot);
+				}
+				entry_hashes[hash_name] = hashes;
+				entry_orders[hash_name] = order;
 			}
 		}
 		child_element = child_element.nextSiblingElement();
@@ -113,6 +391,15 @@ void EditorCacheHash::writeDocument(QDomDocument &document, QDomElement &element
 		QDomElement child_element = document.createElement(DocumentHashRoot);
 		child_element.setAttribute("name", it.key());
 		child_element.setAttribute("value", it.value().toString());
+
+		EditorEntryHashes hashes = entry_hashes.value(it.key());
+		foreach(QString entry_name, orderEntries(it.key(), hashes)) {
+			QDomElement entry_element = document.createElement(DocumentEntryRoot);
+			entry_element.setAttribute("name", entry_name);
+			entry_element.setAttribute("value", hashes.value(entry_name).toString());
+			child_element.appendChild(entry_element);
+		}
+
 		element.appendChild(child_element);
 	}
 }
@@ -121,6 +408,8 @@ void EditorCacheHash::writeDocument(QDomDocument &document, QDomElement &element
 const QString EditorCache::DocumentRoot = "EditorCache";
 const QString EditorCache::CachePath = "/cache";
 const QString EditorCache::CacheHashPath = "hashes.xml";
+const QString EditorCache::BlobPath = "blobs";
+const QString EditorCache::PackTemplate = "pack-XXXXXX";
 
 #ifdef SONICGLVL_LOST_WORLD
 const QString EditorCache::ConfigPath = "config.lua";
@@ -145,6 +434,7 @@ const QString EditorCache::PfdExtension = ".pfd";
 EditorCache::EditorCache(QString program_path) {
 	path = program_path + CachePath;
 	QDir().mkpath(path);
+	clone_support = CloneUnknown;
 }
 
 bool EditorCache::loadHashes() {
@@ -212,49 +502,240 @@ QString EditorCache::absolutePath() {
 	return path;
 }
 
+QString EditorCache::blobFilename(EditorHash hash) {
+	QString hash_string = hash.toString();
+	return absolutePath() + "/" + BlobPath + "/" + hash_string.left(2) + "/" + hash_string;
+}
+
+bool EditorCache::canCloneFiles() {
+	if (clone_support != CloneUnknown) {
+		return clone_support == CloneSupported;
+	}
+
+	// Probed once by cloning a small file where the blobs would be stored
+	QString blob_directory = absolutePath() + "/" + BlobPath;
+	QDir().mkpath(blob_directory);
+
+	clone_support = CloneUnsupported;
+	QTemporaryFile probe_file(blob_directory + "/clone-probe");
+	if (probe_file.open()) {
+		probe_file.write("SonicGLvl");
+		probe_file.close();
+
+		QString probe_clone = probe_file.fileName() + ".clone";
+		if (cloneFile(probe_file.fileName(), probe_clone)) {
+			clone_support = CloneSupported;
+			QFile::remove(probe_clone);
+		}
+	}
+
+	return clone_support == CloneSupported;
+}
+
+bool EditorCache::storeBlob(EditorHash hash, LibGens::ArFile *entry) {
+	QString blob_filename = blobFilename(hash);
+	if (QFileInfo(blob_filename).exists()) {
+		return true;
+	}
+
+	// Written under a name of its own and renamed into place, so concurrent writers of the same blob
+	// never see it half-written
+	QDir().mkpath(QFileInfo(blob_filename).absolutePath());
+	QTemporaryFile temp_file(blob_filename);
+	if (!temp_file.open()) {
+		return false;
+	}
+	QString temp_filename = temp_file.fileName();
+	temp_file.close();
+
+	entry->save(temp_filename.toStdString());
+	QFile::setPermissions(temp_filename, QFile::ReadOwner | QFile::ReadUser | QFile::ReadGroup | QFile::ReadOther);
+	temp_file.setAutoRemove(false);
+
+	if (!QFile::rename(temp_filename, blob_filename)) {
+		removeBlob(temp_filename);
+		return QFileInfo(blob_filename).exists();
+	}
+
+	return true;
+}
+
+void EditorCache::collectBlobs() {
+	// Without cloning no blob is kept, so leftovers from a cache that could clone are removed too
+	QSet<QString> referenced_hashes;
+	if (canCloneFiles()) {
+		for (QList<EditorCacheHash>::iterator it = hashes.begin(); it != hashes.end(); it++) {
+			(*it).collectEntryHashes(&referenced_hashes);
+		}
+	}
+
+	QDirIterator blob_iterator(absolutePath() + "/" + BlobPath, QDir::Files, QDirIterator::Subdirectories);
+	while (blob_iterator.hasNext()) {
+		QString blob_filename = blob_iterator.next();
+		if (!referenced_hashes.contains(blob_iterator.fileName())) {
+			removeBlob(blob_filename);
+		}
+	}
+}
+
 void EditorCache::unpackFileSafe(QString stage_name, QString filename, QString logic_name, QProgressDialog &progress, QString suffix) {
 	progress.setLabelText(QString("Verifying %1").arg(logic_name));
 
-	// Check if it already exists in cache
-	int sha1_hash[5];
+	EditorCacheHash &hash = getEditorCacheHash(stage_name);
+	QString file_directory = stagePath(stage_name) + "/" + logic_name;
+
 #ifdef SONICGLVL_LOST_WORLD
+	// Pac entries are relinked against the set's string tables on extraction, so a changed set is unpacked whole
 	LibGens::PacSet set(filename.toStdString());
-	for (int i=0; i<5; i++) sha1_hash[i] = set.getSHA1Hash(i);
+	EditorHash file_hash = toEditorHash(set.computeHash());
+	if (hash.compareFileHash(logic_name, file_hash)) {
+		return;
+	}
+
+	progress.setLabelText(QString("Extracting %1").arg(logic_name));
+	QDir().mkpath(file_directory);
+	removeFilesExcept(file_directory, QSet<QString>());
+	set.extract(file_directory.toStdString() + "/");
+
+	hash.setEntryHashes(logic_name, hashDirectory(file_directory, suffix));
+	hash.addFileHash(logic_name, file_hash);
 #elif SONICGLVL_GENERATIONS
-	LibGens::ArPack pack(filename.toStdString());
-	for (int i=0; i<5; i++) sha1_hash[i] = pack.getHash()[i];
+	// Only the entry index is read, entries are hashed and copied straight out of the mapped archive
+	LibGens::ArPack pack(filename.toStdString(), false);
+	size_t entry_count = pack.getFileCount();
+
+	vector<EditorHash> current_hashes(entry_count);
+	LibGens::Parallel::forEach(entry_count, [&](size_t i) {
+		current_hashes[i] = toEditorHash(pack.getFileByIndex(i)->computeHash());
+	});
+
+	vector<QString> entry_names(entry_count);
+	EditorEntryHashes entry_hashes;
+	QStringList entry_order;
+	for (size_t i=0; i<entry_count; i++) {
+		entry_names[i] = QString::fromStdString(pack.getFileByIndex(i)->getName());
+		entry_hashes[entry_names[i]] = current_hashes[i];
+		entry_order.append(entry_names[i]);
+	}
+
+	// The archive order is what packing writes back, even if nothing needs to be unpacked
+	hash.setEntryOrder(logic_name, entry_order);
+
+	EditorHash file_hash = combineEntryHashes(entry_hashes);
+	if (hash.compareFileHash(logic_name, file_hash)) {
+		return;
+	}
+
+	progress.setLabelText(QString("Extracting %1").arg(logic_name));
+	QDir().mkpath(file_directory);
+
+	// Entries that haven't changed since the last unpack keep their file
+	EditorEntryHashes cached_hashes = hash.getEntryHashes(logic_name);
+	QSet<QString> entry_filenames;
+	vector<size_t> dirty_entries;
+	for (size_t i=0; i<entry_count; i++) {
+		QString entry_filename = entry_names[i] + suffix;
+		entry_filenames.insert(entry_filename);
+
+		EditorEntryHashes::iterator it = cached_hashes.find(entry_names[i]);
+		if ((it != cached_hashes.end()) && (it.value() == current_hashes[i]) && QFileInfo(file_directory + "/" + entry_filename).exists()) {
+			continue;
+		}
+
+		dirty_entries.push_back(i);
+	}
+
+	removeFilesExcept(file_directory, entry_filenames);
+
+	// Where the cache can clone files, changed entries come from the blob store, which only extracts content
+	// that no stage has yet. Otherwise a blob would only be a second copy, so entries are written straight
+	// from the archive.
+	bool use_blobs = canCloneFiles();
+	LibGens::Parallel::forEach(dirty_entries.size(), [&](size_t d) {
+		size_t i = dirty_entries[d];
+		QString entry_filename = file_directory + "/" + entry_names[i] + suffix;
+		if (!use_blobs || !storeBlob(current_hashes[i], pack.getFileByIndex(i)) || !cloneFile(blobFilename(current_hashes[i]), entry_filename)) {
+			pack.getFileByIndex(i)->save(entry_filename.toStdString());
+		}
+	});
+
+	hash.setEntryHashes(logic_name, entry_hashes);
+	hash.addFileHash(logic_name, file_hash);
 #endif
+}
+
+bool EditorCache::packFileSafe(QString stage_name, QString filename, QString logic_name, QString suffix) {
+	QString file_directory = stagePath(stage_name) + "/" + logic_name;
+	if (!QDir(file_directory).exists()) {
+		return false;
+	}
 
-	EditorHash file_hash(sha1_hash);
+	// Nothing to do if the directory still matches what was last unpacked or packed
 	EditorCacheHash &hash = getEditorCacheHash(stage_name);
-	bool hash_found = hash.compareFileHash(logic_name, file_hash);
-
-	// Only extract and make the directory if the hash wasn't found already
-	if (!hash_found) {
-		progress.setLabelText(QString("Extracting %1").arg(logic_name));
-
-		// Make directory
-		QString file_directory = stagePath(stage_name) + "/" + logic_name;
-		QDir().mkpath(file_directory);
-
-		// Remove all files from directory
-		QDir dir(file_directory);
-		dir.setNameFilters(QStringList() << "*.*");
-		dir.setFilter(QDir::Files);
-		QStringList file_list = dir.entryList();
-		foreach(QString file, file_list) {
-			dir.remove(file);
-		}
+	EditorEntryHashes entry_hashes = hashDirectory(file_directory, suffix);
+	if (entry_hashes == hash.getEntryHashes(logic_name)) {
+		return false;
+	}
+
+	// The archive is written to a temporary folder next to the original and only moved over it once complete,
+	// so a failed pack never leaves the game with a half-written archive.
+	QFileInfo file_info(filename);
+	QString target_directory = file_info.absolutePath();
+	QTemporaryDir temp_directory(target_directory + "/" + PackTemplate);
+	if (!temp_directory.isValid()) {
+		return false;
+	}
+
+	QString temp_filename = temp_directory.path() + "/" + file_info.fileName();
 
-		// Extract files to directory
 #ifdef SONICGLVL_LOST_WORLD
-		set.extract(file_directory.toStdString() + "/");
+	LibGens::PacSet set;
+	set.addFolder(file_directory.toStdString() + "/");
+	set.splitPacks();
+	set.save(temp_filename.toStdString());
+
+	EditorHash file_hash = toEditorHash(set.computeHash());
+	QString volume_base = filename + ".";
+	int first_volume = 0;
 #elif SONICGLVL_GENERATIONS
-		pack.extract(file_directory.toStdString() + "/", suffix.toStdString());
+	// Entries keep the order they had in the archive when it was unpacked
+	QStringList entry_order = hash.orderEntries(logic_name, entry_hashes);
+
+	LibGens::ArPack pack;
+	foreach(QString entry_name, entry_order) {
+		pack.addFile((file_directory + "/" + entry_name + suffix).toStdString(), entry_name.toStdString(), false);
+	}
+
+	// Split archives get their .arl written by save
+	pack.save(temp_filename.toStdString());
+
+	if (filename.endsWith(PfdExtension)) {
+		QString base_filename = file_info.fileName().left(file_info.fileName().size() - PfdExtension.size());
+		pack.savePFI((temp_directory.path() + "/" + base_filename + ".pfi").toStdString());
+	}
+
+	EditorHash file_hash = combineEntryHashes(entry_hashes);
+	QString volume_base = filename.endsWith(ArExtension) ? filename.left(filename.size() - 2) : QString();
+	int first_volume = 1;
+	hash.setEntryOrder(logic_name, entry_order);
 #endif
 
-		hash.addFileHash(logic_name, file_hash);
+	if (!QFileInfo(temp_filename).exists()) {
+		return false;
 	}
+
+	QSet<QString> written_files;
+	if (!replaceFiles(temp_directory.path(), target_directory, &written_files)) {
+		return false;
+	}
+
+	if (!volume_base.isEmpty()) {
+		removeStaleVolumes(volume_base, first_volume, written_files);
+	}
+
+	hash.addFileHash(logic_name, file_hash);
+	hash.setEntryHashes(logic_name, entry_hashes);
+	return true;
 }
 
 EditorCacheHash &EditorCache::getEditorCacheHash(QString stage_name) {
@@ -270,58 +751,75 @@ EditorCacheHash &EditorCache::getEditorCacheHash(QString stage_name) {
 	return hashes.last();
 }
 
-bool EditorCache::unpackStage(QString stage_name, QString path, QWidget *parent) {
+QList<EditorCacheArchive> EditorCache::stageArchives(QString stage_name, QString path) {
+	QList<EditorCacheArchive> archives;
+
 	QFileInfo info(path);
-	if (info.exists()) {
-		QDir dir = info.dir();
-		QString dir_base_name = dir.absolutePath();
+	QString dir_base_name = info.dir().absolutePath();
 
-		int current_progress = 0;
 #ifdef SONICGLVL_LOST_WORLD
-		int max_progress_count = 5;
+	QStringList pac_paths;
+	pac_paths << FarPath << MiscPath << ObjPath << SkyPath << TrrCmnPath;
+	foreach(QString pac_path, pac_paths) {
+		EditorCacheArchive archive = { dir_base_name + "/" + stage_name + "_" + pac_path + PacExtension, pac_path, QString() };
+		archives.append(archive);
+	}
 #elif SONICGLVL_GENERATIONS
-		int max_progress_count = 4;
+	EditorCacheArchive data_archive = { dir_base_name + "/#" + stage_name + ArExtension, DataPath, QString() };
+	EditorCacheArchive resources_archive = { dir_base_name + "/" + PackedPath + "/" + stage_name + "/" + stage_name + ArExtension, ResourcesPath, QString() };
+	EditorCacheArchive terrain_archive = { dir_base_name + "/" + PackedPath + "/" + stage_name + "/" + StagePath + PfdExtension, TerrainPath, ".cab" };
+	EditorCacheArchive terrain_add_archive = { dir_base_name + "/" + PackedPath + "/" + stage_name + "/" + StageAddPath + PfdExtension, TerrainAddPath, ".cab" };
+	archives << data_archive << resources_archive << terrain_archive << terrain_add_archive;
 #endif
 
+	return archives;
+}
+
+bool EditorCache::unpackStage(QString stage_name, QString path, QWidget *parent) {
+	QFileInfo info(path);
+	if (info.exists()) {
+		QList<EditorCacheArchive> archives = stageArchives(stage_name, path);
+
+		int current_progress = 0;
+		int max_progress_count = archives.size();
+
 		QProgressDialog progress(QString(), QString(), 0, max_progress_count, parent);
 		progress.setWindowTitle("Unpacking Stage to Cache...");
 		progress.setWindowModality(Qt::WindowModal);
 		progress.setMinimumDuration(0);
 
-#ifdef SONICGLVL_LOST_WORLD
-		unpackFileSafe(stage_name, dir_base_name + "/" + stage_name + "_" + FarPath + PacExtension, FarPath, progress);
-		progress.setValue(current_progress++);
-		unpackFileSafe(stage_name, dir_base_name + "/" + stage_name + "_" + MiscPath + PacExtension, MiscPath, progress);
-		progress.setValue(current_progress++);
-		unpackFileSafe(stage_name, dir_base_name + "/" + stage_name + "_" + ObjPath + PacExtension, ObjPath, progress);
-		progress.setValue(current_progress++);
-		unpackFileSafe(stage_name, dir_base_name + "/" + stage_name + "_" + SkyPath + PacExtension, SkyPath, progress);
-		progress.setValue(current_progress++);
-		unpackFileSafe(stage_name, dir_base_name + "/" + stage_name + "_" + TrrCmnPath + PacExtension, TrrCmnPath, progress);
-		progress.setValue(current_progress++);
-#elif SONICGLVL_GENERATIONS
-		unpackFileSafe(stage_name, dir_base_name + "/#" + stage_name + ArExtension, DataPath, progress);
-		progress.setValue(current_progress++);
-
-		unpackFileSafe(stage_name, dir_base_name + "/" + PackedPath + "/" + stage_name + "/" + stage_name + ArExtension, ResourcesPath, progress);
-		progress.setValue(current_progress++);
-
-		unpackFileSafe(stage_name, dir_base_name + "/" + PackedPath + "/" + stage_name + "/" + StagePath + PfdExtension, TerrainPath, progress, ".cab");
-		progress.setValue(current_progress++);
-
-		unpackFileSafe(stage_name, dir_base_name + "/" + PackedPath + "/" + stage_name + "/" + StageAddPath + PfdExtension, TerrainAddPath, progress, ".cab");
-		progress.setValue(current_progress++);
-#endif
+		foreach(EditorCacheArchive archive, archives) {
+			unpackFileSafe(stage_name, archive.filename, archive.logic_name, progress, archive.suffix);
+			progress.setValue(current_progress++);
+		}
 
 		progress.setValue(max_progress_count);
 
+		collectBlobs();
 		saveHashes();
 	}
 	return false;
 }
 
 bool EditorCache::packStage(QString stage_name, QString path) {
-	return false;
+	QFileInfo info(path);
+	if (!info.exists()) {
+		return false;
+	}
+
+	bool packed = false;
+	foreach(EditorCacheArchive archive, stageArchives(stage_name, path)) {
+		if (packFileSafe(stage_name, archive.filename, archive.logic_name, archive.suffix)) {
+			packed = true;
+		}
+	}
+
+	if (packed) {
+		collectBlobs();
+		saveHashes();
+	}
+
+	return packed;
 }
 
 QString EditorCache::stagePath(QString stage_name) {
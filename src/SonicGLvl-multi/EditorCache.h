@@ -1,42 +1,76 @@
 #pragma once
 
+namespace LibGens {
+	class ArFile;
+}
+
 class EditorHash {
 friend class EditorHash;
 protected:
-	int hash_data[5];
+	unsigned long long hash_data[2];
 public:
 	EditorHash();
-	EditorHash(int *v);
+	EditorHash(unsigned long long low, unsigned long long high);
 	EditorHash(QString hash_string);
-	QString toString();
+	QString toString() const;
 	bool operator==(const EditorHash &h) const;
+	bool operator!=(const EditorHash &h) const;
 };
 
+typedef QMap<QString, EditorHash> EditorEntryHashes;
+
 class EditorCacheHash {
 protected:
 	QString stage_name;
 	QMap<QString, EditorHash> file_hashes;
+	QMap<QString, EditorEntryHashes> entry_hashes;
+	QMap<QString, QStringList> entry_orders;
 public:
 	static const QString DocumentRoot;
 	static const QString DocumentHashRoot;
+	static const QString DocumentEntryRoot;
 
 	EditorCacheHash();
 	bool compareFileHash(QString name, EditorHash hash);
 	void addFileHash(QString name, EditorHash hash);
+	EditorEntryHashes getEntryHashes(QString name);
+	void setEntryHashes(QString name, const EditorEntryHashes &hashes);
+
+	/** Returns the names in hashes in the order recorded with setEntryOrder, followed by any names it doesn't have. */
+	QStringList orderEntries(QString name, const EditorEntryHashes &hashes);
+	void setEntryOrder(QString name, const QStringList &order);
+
+	/** Adds the content hash of every entry of every file to hash_strings. */
+	void collectEntryHashes(QSet<QString> *hash_strings);
 	void readDocument(QDomElement &element);
 	void writeDocument(QDomDocument &document, QDomElement &element);
 	void setStageName(const QString &name);
 	const QString &getStageName();
 };
 
+struct EditorCacheArchive {
+	QString filename;
+	QString logic_name;
+	QString suffix;
+};
+
 class EditorCache {
 protected:
+	enum CloneSupport {
+		CloneUnknown,
+		CloneSupported,
+		CloneUnsupported
+	};
+
 	QString path;
 	QList<EditorCacheHash> hashes;
+	CloneSupport clone_support;
 public:
 	static const QString DocumentRoot;
 	static const QString CachePath;
 	static const QString CacheHashPath;
+	static const QString BlobPath;
+	static const QString PackTemplate;
 
 #ifdef SONICGLVL_LOST_WORLD
 	static const QString ConfigPath;
@@ -62,18 +96,38 @@ public:
 	bool loadHashes();
 	bool saveHashes();
 
-	/** Verifies if the file to be unpacked is already on cache by comparing the hashes. If it isn't, clean the contents 
-		of the directory and unpacked the new contents.
+	/** Verifies if the file to be unpacked is already on cache by comparing the hashes. If it isn't, only the entries
+		whose content hash changed are unpacked again, and entries that are no longer in the file are removed.
+		Unpacked entries go through the blob store shared by all stages.
 
 		@param stage_name Current stage being unpacked.
 		@param filename Full filename to be unpacked.
 		@param logic_name Logical name of the file to be stored inside the hashes.
 	*/
 	void unpackFileSafe(QString stage_name, QString filename, QString logic_name, QProgressDialog &progress, QString suffix = QString());
+
+	/** Packs the cached directory back into its file, but only if its contents differ from the hashes
+		recorded when it was unpacked or last packed. The file is written to a temporary folder first and
+		then moved over the original.
+
+		@return True if the file was written.
+	*/
+	bool packFileSafe(QString stage_name, QString filename, QString logic_name, QString suffix = QString());
 	bool unpackStage(QString stage_name, QString path, QWidget *parent);
 	bool packStage(QString stage_name, QString path);
+	QList<EditorCacheArchive> stageArchives(QString stage_name, QString path);
 	QString hashFilename();
 	QString absolutePath();
+
+	/** Blobs are read-only files named after the content hash of an archive entry, shared by every stage in the cache.
+		Stage folders get clones of them, so editing an unpacked entry never changes the blob. Blobs are only kept
+		when the filesystem of the cache can clone files, checked once by canCloneFiles. Blobs no stage refers
+		to anymore are removed by collectBlobs.
+	*/
+	bool canCloneFiles();
+	QString blobFilename(EditorHash hash);
+	bool storeBlob(EditorHash hash, LibGens::ArFile *entry);
+	void collectBlobs();
 	QString stagePath(QString stage_name);
 	EditorCacheHash &getEditorCacheHash(QString stage_name);
 
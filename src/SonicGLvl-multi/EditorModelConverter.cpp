@@ -52,6 +52,7 @@ QList<Ogre::String> EditorModelConverter::convertModel(LibGens::Model *model, Og
 						vertices[i*nVertCount+20] = col.r;    vertices[i*nVertCount+21] = col.g;     
 						vertices[i*nVertCount+22] = col.b;    vertices[i*nVertCount+23] = col.a;
 					}
+					submesh->releaseVertexViews();
  
 					Ogre::RenderSystem* rs = Ogre::Root::getSingleton().getRenderSystem();
 					const size_t ibufCount = submesh_faces.size() * 3;
@@ -8,6 +8,13 @@ EditorNode::EditorNode(Ogre::SceneManager *scene_manager, Ogre::SceneNode *paren
 
 EditorNode::~EditorNode() {
 	Ogre::SceneManager *scene_manager = scene_node->getCreator();
+
+	// Entities are created per node, so they go away with it
+	while (scene_node->numAttachedObjects()) {
+		Ogre::MovableObject *object = scene_node->detachObject((unsigned short) 0);
+		scene_manager->destroyMovableObject(object);
+	}
+
 	scene_manager->destroySceneNode(scene_node);
 }
 
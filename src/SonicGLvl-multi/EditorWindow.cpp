@@ -102,6 +102,7 @@ EditorWindow::EditorWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::Ed
 
 	terrain_streamer = new EditorTerrainStreamer();
 	terrain_streamer->setMaxLoaders(QThread::idealThreadCount() - 1);
+	terrain_streamer->setMemoryBudget(SONICGLVL_TERRAIN_MEMORY_BUDGET);
 	terrain = NULL;
 
 	connect(ui->action_close, SIGNAL(triggered()), this, SLOT(close()));
@@ -144,18 +145,24 @@ void EditorWindow::updateStreamer() {
 			EditorTerrainStreamer::Group group_result = terrain_streamer->popPendingGroup();
 			LibGens::TerrainGroup *group = group_result.first;
 
-			// Load group into scene
-			if (group_result.second) {
+			// Load group into scene, unless it was evicted since
+			if (group_result.second && terrain_streamer->isGroupLoaded(group)) {
 				// Create an Ogre Resource group for this group.
 				Ogre::ResourceGroupManager::getSingleton().createResourceGroup(group->getName(), false);
 
 				// Convert all models in group to Ogre meshes.
 				vector<LibGens::Model *> models = group->getModels();
 				QMap<string, QList<Ogre::String>> ogre_mesh_map;
+				size_t converted_size = 0;
 
 				for (size_t i=0; i < models.size(); i++) {
 					QList<Ogre::String> mesh_names = EditorModelConverter::convertModel(models[i], group->getName());
 					ogre_mesh_map[models[i]->getName()] = mesh_names;
+
+					foreach(Ogre::String mesh_name, mesh_names) {
+						Ogre::MeshPtr mesh = Ogre::MeshManager::getSingleton().getByName(mesh_name, group->getName());
+						if (!mesh.isNull()) converted_size += mesh->getSize();
+					}
 				}
 
 				// Create nodes for all instances in the group.
@@ -170,6 +177,7 @@ void EditorWindow::updateStreamer() {
 
 							EditorNode *editor_node = new EditorNode(stage_scene_manager, stage_scene_manager->getRootSceneNode());
 							editor_node->setTransform(tm);
+							terrain_group_nodes[group].append(editor_node);
 
 							foreach(Ogre::String mesh_name, mesh_names) {
 								editor_node->attachEntity(mesh_name);
@@ -178,10 +186,16 @@ void EditorWindow::updateStreamer() {
 					}
 				}
 
+				// The group's data now lives in the Ogre meshes, so the budget tracks those instead
+				terrain_streamer->setGroupMemorySize(group, converted_size);
 				group->unload();
 			}
 			// Delete group from scene
 			else {
+				foreach(EditorNode *editor_node, terrain_group_nodes.take(group)) {
+					delete editor_node;
+				}
+
 				Ogre::ResourceGroupManager::getSingleton().destroyResourceGroup(group->getName());
 			}
 		}
@@ -262,6 +276,7 @@ void EditorWindow::openStage() {
 			QString terrain_file_path = resources_path + "/terrain.terrain";
 			QString terrain_path = editor_cache->terrainPath(editor_stage->stageName());
 			terrain = new LibGens::Terrain(terrain_file_path.toStdString(), resources_path.toStdString() + "/", resources_path.toStdString() + "/", terrain_path.toStdString() + "/", "", false);
+			terrain_group_nodes.clear();
 			terrain_streamer->setTerrain(terrain);
 			terrain_streamer->setTerrainFolder(terrain_path);
 #endif
@@ -27,6 +27,7 @@ namespace LibGens {
 	class ShaderLibrary;
 	class ObjectLibrary;
 	class Terrain;
+	class TerrainGroup;
 }
 
 class EditorDefaultCamera;
@@ -38,6 +39,7 @@ class EditorGIListener;
 class EditorSky;
 class EditorObjects;
 class EditorTerrainStreamer;
+class EditorNode;
 class OgreSystem;
 class OgreViewportWidget;
 
@@ -75,6 +77,7 @@ private:
 	LibGens::ShaderLibrary *shader_library;
 	LibGens::ObjectLibrary *object_library;
 	LibGens::Terrain *terrain;
+	QMap<LibGens::TerrainGroup *, QList<EditorNode *>> terrain_group_nodes;
     int timer_index;
     QElapsedTimer timer_elapsed;
 
@@ -1,4 +1,5 @@
 #define SONICGLVL_INDENT  4
+#define SONICGLVL_TERRAIN_MEMORY_BUDGET  (768 * 1024 * 1024)
 
 #include <QApplication>
 #include <QMainWindow>
@@ -8,9 +9,13 @@
 #include <QMouseEvent>
 #include <QString>
 #include <QStringList>
+#include <QSet>
 #include <QDomDocument>
 #include <QTextStream>
 #include <QDir>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+#include <QDirIterator>
 #include <QMessageBox>
 #include <QStyle>
 #include <QDesktopWidget>
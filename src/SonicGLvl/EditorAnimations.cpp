@@ -22,11 +22,15 @@
 
 
 void EditorAnimationTexcoordOffset::updateParameters() {
-	float offset_x=animation_set->getCurrentValue(0x00010000);
-	float offset_y=animation_set->getCurrentValue(0x01010000);
+	static const unsigned int flags[4]={ 0x00010000, 0x01010000, 0x00000000, 0x01000000 };
+	float values[4];
+	animation_set->getCurrentValues(flags, values, 4);
 
-	float offset_x_unl=animation_set->getCurrentValue(0x00000000);
-	float offset_y_unl=animation_set->getCurrentValue(0x01000000);
+	float offset_x=values[0];
+	float offset_y=values[1];
+
+	float offset_x_unl=values[2];
+	float offset_y_unl=values[3];
 
 	Ogre::Vector4 value(0.0, 0.0, 0.0, 0.0);
 
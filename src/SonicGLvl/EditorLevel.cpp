@@ -372,7 +372,8 @@ void EditorLevel::unpackResources() {
 
 
 void EditorLevel::loadData(LibGens::ObjectLibrary* library, ObjectNodeManager* object_node_manager) {
-	level = new LibGens::Level(data_cache_folder + "/", game_mode);
+	// The snapshot stays out of the data folder, since everything in there is packed back into the stage archive
+	level = new LibGens::Level(data_cache_folder + "/", game_mode, cache_folder + SONICGLVL_LEVEL_SNAPSHOT_FILENAME);
 
 	// Fix anything inside the level to fit with the library
 	level->learnFromLibrary(library);
@@ -50,6 +50,7 @@
 #define SONICGLVL_LEVEL_HASH_RESOURCES         "Resources"
 #define SONICGLVL_LEVEL_HASH_VALUE_ATTRIBUTE   "hash-"
 #define SONICGLVL_LEVEL_HASH_FILENAME          "Hashes.xml"
+#define SONICGLVL_LEVEL_SNAPSHOT_FILENAME      "Level.snapshot"
 
 
 class EditorLevelEntry;
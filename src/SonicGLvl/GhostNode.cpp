@@ -54,6 +54,7 @@ GhostNode::GhostNode(LibGens::Ghost *ghost_p, Ogre::SceneManager *scene_manager,
 	selected = false;
 	play = false;
 	current_time = 0;
+	current_cursor = 0;
 	current_animation_name = "";
 	current_animation_state = NULL;
 	current_movement_mode = MOVEMENT_MODE_3D;
@@ -75,7 +76,7 @@ void GhostNode::addTime(float time) {
 	string animation_name;
 	float animation_frame;
 	bool animation_ball;
-	ghost->calculate(current_time, pv, ov, animation_name, animation_frame, animation_ball);
+	ghost->calculate(current_time, pv, ov, animation_name, animation_frame, animation_ball, &current_cursor);
 
 	//ghost_entity->setVisible(!animation_ball);
 	//ghost_spin_entity->setVisible(animation_ball);
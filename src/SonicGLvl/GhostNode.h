@@ -43,6 +43,7 @@ class GhostNode : public EditorNode {
 	protected:
 		LibGens::Ghost *ghost;
 		float current_time;
+		size_t current_cursor;
 		float duration;
 		bool play;
 		Ogre::Entity *ghost_entity;
@@ -78,6 +79,7 @@ class GhostNode : public EditorNode {
 			if (ghost_p) {
 				ghost = ghost_p;
 				duration = ghost->calculateDuration();
+				current_cursor = 0;
 			}
 		}
 		
@@ -28,6 +28,9 @@
 #include "Mesh.h"
 #include "Submesh.h"
 #include "Vertex.h"
+#include "VertexFormat.h"
+#include "VertexDecoder.h"
+#include "VertexPacker.h"
 #include "Bone.h"
 #include "DefaultShaderParameters.h"
 
@@ -181,7 +184,170 @@ void prepareSkeletonAndAnimation(string skeleton_id, string animation_id, string
 	}
 }
 
-void setShaderParameters(Ogre::Pass *pass, Ogre::GpuProgramParametersSharedPtr program_params, LibGens::Material *material, LibGens::ShaderParams *shader_params, LibGens::UVAnimation *uv_animation, LibGens::ArFile* shader_code) {
+enum ShaderBindingType {
+	SHADER_BINDING_IGNORE,
+	SHADER_BINDING_AUTO,
+	SHADER_BINDING_AUTO_REAL,
+	SHADER_BINDING_CONSTANT,
+	SHADER_BINDING_BACKGROUND_SCALE,
+	SHADER_BINDING_GI0_SCALE,
+	SHADER_BINDING_TEXCOORD_OFFSET,
+	SHADER_BINDING_LIGHT_SCATTERING_RAY_MIE,
+	SHADER_BINDING_LIGHT_SCATTERING_CONST_G,
+	SHADER_BINDING_LIGHT_SCATTERING_FAR_NEAR,
+	SHADER_BINDING_LIGHT_SCATTERING_COLOR,
+	SHADER_BINDING_LIGHT_FIELD,
+	SHADER_BINDING_SKY_PARAM,
+	SHADER_BINDING_WHITE_TEXTURE
+};
+
+struct ShaderBindingKind {
+	size_t slot;
+	const char *name;
+	ShaderBindingType type;
+	float value[4];
+	Ogre::GpuProgramParameters::AutoConstantType auto_constant;
+	size_t extra;
+};
+
+// Every shader parameter the editor knows how to bind. The index in this table is the binding kind
+// registered in the shader library, so setShaderParameters only walks the cached binding tables.
+static const ShaderBindingKind shader_binding_kinds[] = {
+	{ 0, "g_MtxProjection", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_PROJECTION_MATRIX },
+	{ 0, "g_MtxInvProjection", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_INVERSE_PROJECTION_MATRIX },
+	{ 0, "g_MtxView", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_VIEW_MATRIX },
+	{ 0, "g_MtxInvView", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_INVERSE_VIEW_MATRIX },
+	{ 0, "g_MtxWorld", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_WORLD_MATRIX },
+	{ 0, "g_MtxWorldIT", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_INVERSE_TRANSPOSE_WORLD_MATRIX },
+	{ 0, "g_MtxPrevView", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_VIEW_MATRIX },
+	{ 0, "g_MtxPrevWorld", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_WORLD_MATRIX },
+	{ 0, "g_MtxLightViewProjection", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_TEXTURE_VIEWPROJ_MATRIX },
+	{ 0, "g_MtxVerticalLightViewProjection", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_TEXTURE_VIEWPROJ_MATRIX },
+	{ 0, "g_MtxBillboardY", SHADER_BINDING_IGNORE },
+	{ 0, "g_MtxPalette", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_WORLD_MATRIX_ARRAY_3x4 },
+	{ 0, "g_MtxPrevPalette", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_WORLD_MATRIX_ARRAY_3x4 },
+	{ 0, "g_EyePosition", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_CAMERA_POSITION },
+	{ 0, "g_EyeDirection", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_VIEW_DIRECTION },
+	{ 0, "g_ViewportSize", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_VIEWPORT_SIZE },
+	{ 0, "g_CameraNearFarAspect", SHADER_BINDING_CONSTANT },
+	{ 0, "mrgAmbientColor", SHADER_BINDING_CONSTANT },
+	{ 0, "mrgGroundColor", SHADER_BINDING_CONSTANT },
+	{ 0, "mrgSkyColor", SHADER_BINDING_CONSTANT },
+	{ 0, "mrgPowerGlossLevel", SHADER_BINDING_CONSTANT },
+	{ 0, "mrgEmissionPower", SHADER_BINDING_CONSTANT },
+	{ 0, "mrgGlobalLight_Direction", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_POSITION, 0 },
+	{ 0, "mrgGlobalLight_Direction_View", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_POSITION_VIEW_SPACE, 0 },
+	{ 0, "mrgGlobalLight_Diffuse", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_DIFFUSE_COLOUR, 0 },
+	{ 0, "mrgGlobalLight_Specular", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_SPECULAR_COLOUR, 0 },
+	{ 0, "mrgLocallightIndexArray", SHADER_BINDING_CONSTANT },
+	{ 0, "mrgLocalLight0_Position", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_POSITION, 1 },
+	{ 0, "mrgLocalLight0_Color", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_DIFFUSE_COLOUR, 1 },
+	{ 0, "mrgLocalLight0_Range", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 1 },
+	{ 0, "mrgLocalLight0_Attribute", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 1 },
+	{ 0, "mrgLocalLight1_Position", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_POSITION, 2 },
+	{ 0, "mrgLocalLight1_Color", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_DIFFUSE_COLOUR, 2 },
+	{ 0, "mrgLocalLight1_Range", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 2 },
+	{ 0, "mrgLocalLight1_Attribute", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 2 },
+	{ 0, "mrgLocalLight2_Position", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_POSITION, 3 },
+	{ 0, "mrgLocalLight2_Color", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_DIFFUSE_COLOUR, 3 },
+	{ 0, "mrgLocalLight2_Range", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 3 },
+	{ 0, "mrgLocalLight2_Attribute", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 3 },
+	{ 0, "mrgLocalLight3_Position", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_POSITION, 4 },
+	{ 0, "mrgLocalLight3_Color", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_DIFFUSE_COLOUR, 4 },
+	{ 0, "mrgLocalLight3_Range", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 4 },
+	{ 0, "mrgLocalLight3_Attribute", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 4 },
+	{ 0, "mrgLocalLight4_Position", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_POSITION, 5 },
+	{ 0, "mrgLocalLight4_Color", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_DIFFUSE_COLOUR, 5 },
+	{ 0, "mrgLocalLight4_Range", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 5 },
+	{ 0, "mrgLocalLight4_Attribute", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 5 },
+	{ 0, "mrgEyeLight_Diffuse", SHADER_BINDING_CONSTANT, { 0, 0, 0, 1 } },
+	{ 0, "mrgEyeLight_Specular", SHADER_BINDING_CONSTANT, { 0.1f, 0.1f, 0.1f, 1 } },
+	{ 0, "mrgEyeLight_Range", SHADER_BINDING_CONSTANT, { 1, 1, 0, 40 } },
+	{ 0, "mrgEyeLight_Attribute", SHADER_BINDING_CONSTANT, { 1, 1, 1, 2 } },
+	{ 0, "mrgLuminanceRange", SHADER_BINDING_CONSTANT },
+	{ 0, "mrgInShadowScale", SHADER_BINDING_CONSTANT },
+	{ 0, "g_ShadowMapParams", SHADER_BINDING_CONSTANT },
+	{ 0, "mrgVsmEpsilon", SHADER_BINDING_CONSTANT },
+	{ 0, "mrgColourCompressFactor", SHADER_BINDING_CONSTANT },
+	{ 0, "g_BackGroundScale", SHADER_BINDING_BACKGROUND_SCALE },
+	{ 0, "g_GIModeParam", SHADER_BINDING_CONSTANT },
+	{ 0, "g_OffsetParam", SHADER_BINDING_CONSTANT },
+	{ 0, "g_WaterParam", SHADER_BINDING_CONSTANT },
+	{ 0, "g_IceParam", SHADER_BINDING_CONSTANT },
+	{ 0, "g_GI0Scale", SHADER_BINDING_GI0_SCALE },
+	{ 0, "g_GI1Scale", SHADER_BINDING_CONSTANT, { 1, 1, 1, 1 } },
+	{ 0, "g_MotionBlur_AlphaRef_VelocityLimit_VelocityCutoff_BlurMagnitude", SHADER_BINDING_CONSTANT },
+	{ 0, "mrgDebugDistortionParam", SHADER_BINDING_CONSTANT },
+	{ 0, "mrgEdgeEmissionParam", SHADER_BINDING_CONSTANT },
+	{ 0, "g_DebugValue", SHADER_BINDING_CONSTANT },
+	{ 0, "mrgGIAtlasParam", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_CUSTOM },
+	{ 0, "mrgTexcoordIndex", SHADER_BINDING_CONSTANT },
+	{ 0, "mrgTexcoordOffset", SHADER_BINDING_TEXCOORD_OFFSET },
+	{ 0, "mrgFresnelParam", SHADER_BINDING_CONSTANT },
+	{ 0, "mrgMorphWeight", SHADER_BINDING_CONSTANT },
+	{ 0, "mrgZOffsetRate", SHADER_BINDING_CONSTANT },
+	{ 0, "g_IndexCount", SHADER_BINDING_CONSTANT },
+	{ 0, "g_TransColorMask", SHADER_BINDING_CONSTANT },
+	{ 0, "g_ChaosWaveParamEx", SHADER_BINDING_CONSTANT },
+	{ 0, "g_ChaosWaveParamY", SHADER_BINDING_CONSTANT },
+	{ 0, "g_ChaosWaveParamXZ", SHADER_BINDING_CONSTANT },
+	{ 0, "g_ChaosWaveParamXY", SHADER_BINDING_CONSTANT },
+	{ 0, "g_ChaosWaveParamZX", SHADER_BINDING_CONSTANT },
+	{ 0, "g_IgnoreLightParam", SHADER_BINDING_CONSTANT },
+	{ 0, "g_LightScattering_Ray_Mie_Ray2_Mie2", SHADER_BINDING_LIGHT_SCATTERING_RAY_MIE },
+	{ 0, "g_LightScattering_ConstG_FogDensity", SHADER_BINDING_LIGHT_SCATTERING_CONST_G },
+	{ 0, "g_LightScatteringFarNearScale", SHADER_BINDING_LIGHT_SCATTERING_FAR_NEAR },
+	{ 0, "g_LightScatteringColor", SHADER_BINDING_LIGHT_SCATTERING_COLOR },
+	{ 0, "g_LightScatteringMode", SHADER_BINDING_CONSTANT, { 4, 1, 1, 1 } },
+	{ 0, "g_VerticalLightDirection", SHADER_BINDING_AUTO, {}, Ogre::GpuProgramParameters::ACT_LIGHT_POSITION, 0 },
+	{ 0, "g_aLightField", SHADER_BINDING_LIGHT_FIELD },
+	{ 0, "g_TimeParam", SHADER_BINDING_AUTO_REAL, { 1 }, Ogre::GpuProgramParameters::ACT_TIME },
+	{ 0, "diffuse", SHADER_BINDING_CONSTANT, { 1, 1, 1, 1 } },
+	{ 0, "ambient", SHADER_BINDING_CONSTANT, { 1, 1, 1, 1 } },
+	{ 0, "specular", SHADER_BINDING_CONSTANT, { 1, 1, 1, 1 } },
+	{ 0, "emissive", SHADER_BINDING_CONSTANT },
+	{ 0, "opacity_reflection_refraction_spectype", SHADER_BINDING_CONSTANT, { 1, 0, 1, 3 } },
+	{ 0, "power_gloss_level", SHADER_BINDING_CONSTANT, { 50, 0.3f, 0.19f, 0 } },
+	{ 0, "g_SonicSkinFalloffParam", SHADER_BINDING_CONSTANT, { 0.15f, 2, 3, 0 } },
+	{ 0, "g_SkyParam", SHADER_BINDING_SKY_PARAM },
+	{ 0, "g_ViewZAlphaFade", SHADER_BINDING_CONSTANT },
+	{ 0, "g_ForceAlphaColor", SHADER_BINDING_CONSTANT, { 1, 1, 1, 1 } },
+	{ 0, "g_ChrPlayableMenuParam", SHADER_BINDING_CONSTANT, { 1, 1, 1, 1 } },
+	{ 0, "mrgPlayableParam", SHADER_BINDING_CONSTANT, { -1, 1, 1, 1 } },
+	{ 2, "mrgHasBone", SHADER_BINDING_IGNORE },
+	{ 2, "g_IsShadowMapEnable", SHADER_BINDING_IGNORE },
+	{ 2, "g_IsLightScatteringEnable", SHADER_BINDING_IGNORE },
+	{ 2, "mrgIsEnableHemisphere", SHADER_BINDING_IGNORE },
+	{ 2, "g_IsAlphaDepthBlur", SHADER_BINDING_IGNORE },
+	{ 2, "g_IsGIEnabled", SHADER_BINDING_IGNORE },
+	{ 2, "g_IsSoftParticle", SHADER_BINDING_IGNORE },
+	{ 3, "TerrainDiffusemapMask", SHADER_BINDING_IGNORE },
+	{ 3, "GI", SHADER_BINDING_WHITE_TEXTURE },
+	{ 3, "Framebuffer", SHADER_BINDING_IGNORE },
+	{ 3, "Depth", SHADER_BINDING_WHITE_TEXTURE },
+	{ 3, "ShadowMap", SHADER_BINDING_WHITE_TEXTURE },
+	{ 3, "VerticalShadowMap", SHADER_BINDING_WHITE_TEXTURE },
+	{ 3, "ShadowMapJitter", SHADER_BINDING_IGNORE },
+	{ 3, "ReflectionMap", SHADER_BINDING_IGNORE },
+	{ 3, "ReflectionMap2", SHADER_BINDING_IGNORE },
+	{ 3, "INDEXEDLIGHTMAP", SHADER_BINDING_IGNORE },
+	{ 3, "PamNpcEye", SHADER_BINDING_IGNORE },
+	{ 3, "diffuse", SHADER_BINDING_IGNORE },
+	{ 3, "specular", SHADER_BINDING_IGNORE },
+	{ 3, "reflection", SHADER_BINDING_IGNORE },
+	{ 3, "normal", SHADER_BINDING_IGNORE },
+	{ 3, "displacement", SHADER_BINDING_IGNORE },
+	{ 3, "gloss", SHADER_BINDING_IGNORE },
+	{ 3, "opacity", SHADER_BINDING_IGNORE }
+};
+
+void registerShaderBindingKinds(LibGens::ShaderLibrary *shader_library) {
+	for (size_t i=0; i<sizeof(shader_binding_kinds) / sizeof(ShaderBindingKind); i++) {
+		shader_library->setBindingKind(shader_binding_kinds[i].slot, shader_binding_kinds[i].name, (int) i);
+	}
+}
+
+void setShaderParameters(Ogre::Pass *pass, Ogre::GpuProgramParametersSharedPtr program_params, LibGens::Material *material, LibGens::ShaderParams *shader_params, LibGens::UVAnimation *uv_animation, LibGens::ArFile* shader_code, LibGens::ShaderLibrary *shader_library) {
 	EditorLevel *current_editor_level = editor_application->getCurrentLevel();
 	LibGens::Level *current_level = NULL;
 
@@ -192,298 +358,73 @@ void setShaderParameters(Ogre::Pass *pass, Ogre::GpuProgramParametersSharedPtr p
 	vector<string> texture_units_used;
 	texture_units_used.clear();
 
-	for (size_t slot=0; slot<5; slot++) {
-		vector<LibGens::ShaderParam *> shader_param_list=shader_params->getParameterList(slot);
-
-		for (size_t param=0; param<shader_param_list.size(); param++) {
-			LibGens::ShaderParam *shader_parameter = shader_param_list[param];
+	const vector<LibGens::ShaderParamBinding> &bindings = shader_library->getBindings(shader_params, shader_code);
+	for (size_t param=0; param<bindings.size(); param++) {
+		const LibGens::ShaderParamBinding &binding = bindings[param];
+		const string &shader_parameter_name = binding.name;
+		size_t slot = binding.slot;
+		unsigned char index = binding.index;
+		const ShaderBindingKind *kind = (binding.kind != LIBGENS_SHADER_BINDING_UNKNOWN) ? &shader_binding_kinds[binding.kind] : NULL;
 
-			string shader_parameter_name = shader_parameter->getName();
-			unsigned char index = shader_parameter->getIndex();
-			unsigned char size = shader_parameter->getSize();
-
-			if (slot == 0) {
-				LibGens::Parameter *material_parameter = material->getParameterByName(shader_parameter_name);
-
-				if (material_parameter) {
-					LibGens::Color color = material_parameter->getColor();
-					
-					if (shader_parameter_name == "diffuse")  color.a = 1.0;
-					if (shader_parameter_name == "specular") color.a = 1.0;
-					if (shader_parameter_name == "ambient")  color.a = 1.0;
+		if (slot == 0) {
+			LibGens::Parameter *material_parameter = material->getParameterByName(shader_parameter_name);
 
-					program_params->setConstant((size_t)index, Ogre::Vector4(color.r, color.g, color.b, color.a));
-					continue;
-				}
+			if (material_parameter) {
+				LibGens::Color color = material_parameter->getColor();
+				
+				if (shader_parameter_name == "diffuse")  color.a = 1.0;
+				if (shader_parameter_name == "specular") color.a = 1.0;
+				if (shader_parameter_name == "ambient")  color.a = 1.0;
 
-				const char* haystack_begin = reinterpret_cast<const char*>(shader_code->getData());
-				const char* haystack_end = haystack_begin + shader_code->getSize();
+				program_params->setConstant((size_t)index, Ogre::Vector4(color.r, color.g, color.b, color.a));
+				continue;
+			}
 
-				const char* needle_begin = shader_parameter_name.data();
-				const char* needle_end = needle_begin + shader_parameter_name.size();
+			if (!binding.used) {
+				continue;
+			}
 
-				if (search(haystack_begin, haystack_end, needle_begin, needle_end) == haystack_end) {
-					continue;
-				}
+			if (!kind) {
+				printf(("Unhandled constant/variable float4 " + shader_parameter_name + " with index " + ToString((int)index) + " on the Shader " + ToString(material->getShader()) + ". Handle it!\n").c_str());
+				program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
+				continue;
+			}
 
-				if (shader_parameter_name == "g_MtxProjection") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_PROJECTION_MATRIX);
-				}
-				else if (shader_parameter_name == "g_MtxInvProjection") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_INVERSE_PROJECTION_MATRIX);
-				}
-				else if (shader_parameter_name == "g_MtxView") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_VIEW_MATRIX);
-				}
-				else if (shader_parameter_name == "g_MtxInvView") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_INVERSE_VIEW_MATRIX);
-				}
-				else if (shader_parameter_name == "g_MtxWorld") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_WORLD_MATRIX);
-				}
-				else if (shader_parameter_name == "g_MtxWorldIT") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_INVERSE_TRANSPOSE_WORLD_MATRIX);
-				}
-				else if (shader_parameter_name == "g_MtxPrevView") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_VIEW_MATRIX);
-				}
-				else if (shader_parameter_name == "g_MtxPrevWorld") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_WORLD_MATRIX);
-				}
-				else if (shader_parameter_name == "g_MtxLightViewProjection") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_TEXTURE_VIEWPROJ_MATRIX);
-				}
-				else if (shader_parameter_name == "g_MtxVerticalLightViewProjection") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_TEXTURE_VIEWPROJ_MATRIX);
-				}
-				else if (shader_parameter_name == "g_MtxBillboardY") {
-					// Incomplete
-				}
-				else if (shader_parameter_name == "g_MtxPalette") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_WORLD_MATRIX_ARRAY_3x4);
-				}
-				else if (shader_parameter_name == "g_MtxPrevPalette") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_WORLD_MATRIX_ARRAY_3x4);
-				}
-				else if (shader_parameter_name == "g_EyePosition") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_CAMERA_POSITION);
-				}
-				else if (shader_parameter_name == "g_EyeDirection") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_VIEW_DIRECTION);
-				}
-				else if (shader_parameter_name == "g_ViewportSize") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_VIEWPORT_SIZE);
-				}
-				else if (shader_parameter_name == "g_CameraNearFarAspect") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "mrgAmbientColor") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "mrgGroundColor") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "mrgSkyColor") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "mrgPowerGlossLevel") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "mrgEmissionPower") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "mrgGlobalLight_Direction") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_POSITION, 0);
-				}
-				else if (shader_parameter_name == "mrgGlobalLight_Direction_View") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_POSITION_VIEW_SPACE, 0);
-				}
-				else if (shader_parameter_name == "mrgGlobalLight_Diffuse") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_DIFFUSE_COLOUR, 0);
-				}
-				else if (shader_parameter_name == "mrgGlobalLight_Specular") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_SPECULAR_COLOUR, 0);
-				}
-				else if (shader_parameter_name == "mrgLocallightIndexArray") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "mrgLocalLight0_Position") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_POSITION, 1);
-				}
-				else if (shader_parameter_name == "mrgLocalLight0_Color") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_DIFFUSE_COLOUR, 1);
-				}
-				else if (shader_parameter_name == "mrgLocalLight0_Range") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 1);
-				}
-				else if (shader_parameter_name == "mrgLocalLight0_Attribute") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 1);
-				}
-				else if (shader_parameter_name == "mrgLocalLight1_Position") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_POSITION, 2);
-				}
-				else if (shader_parameter_name == "mrgLocalLight1_Color") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_DIFFUSE_COLOUR, 2);
-				}
-				else if (shader_parameter_name == "mrgLocalLight1_Range") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 2);
-				}
-				else if (shader_parameter_name == "mrgLocalLight1_Attribute") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 2);
-				}
-				else if (shader_parameter_name == "mrgLocalLight2_Position") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_POSITION, 3);
-				}
-				else if (shader_parameter_name == "mrgLocalLight2_Color") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_DIFFUSE_COLOUR, 3);
-				}
-				else if (shader_parameter_name == "mrgLocalLight2_Range") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 3);
-				}
-				else if (shader_parameter_name == "mrgLocalLight2_Attribute") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 3);
-				}
-				else if (shader_parameter_name == "mrgLocalLight3_Position") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_POSITION, 4);
-				}
-				else if (shader_parameter_name == "mrgLocalLight3_Color") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_DIFFUSE_COLOUR, 4);
-				}
-				else if (shader_parameter_name == "mrgLocalLight3_Range") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 4);
-				}
-				else if (shader_parameter_name == "mrgLocalLight3_Attribute") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 4);
-				}
-				else if (shader_parameter_name == "mrgLocalLight4_Position") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_POSITION, 5);
-				}
-				else if (shader_parameter_name == "mrgLocalLight4_Color") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_DIFFUSE_COLOUR, 5);
-				}
-				else if (shader_parameter_name == "mrgLocalLight4_Range") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 5);
-				}
-				else if (shader_parameter_name == "mrgLocalLight4_Attribute") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_ATTENUATION, 5);
-				}
-				else if (shader_parameter_name == "mrgEyeLight_Diffuse") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 1));
-				}
-				else if (shader_parameter_name == "mrgEyeLight_Specular") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0.1, 0.1, 0.1, 1));
-				}
-				else if (shader_parameter_name == "mrgEyeLight_Range") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(1, 1, 0, 40));
-				}
-				else if (shader_parameter_name == "mrgEyeLight_Attribute") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(1, 1, 1, 2));
-				}
-				else if (shader_parameter_name == "mrgLuminanceRange") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "mrgInShadowScale") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_ShadowMapParams") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "mrgVsmEpsilon") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "mrgColourCompressFactor") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_BackGroundScale") {
+			switch (kind->type) {
+				case SHADER_BINDING_AUTO:
+					program_params->setAutoConstant((size_t)index, kind->auto_constant, kind->extra);
+					break;
+				case SHADER_BINDING_AUTO_REAL:
+					program_params->setAutoConstantReal((size_t)index, kind->auto_constant, kind->value[0]);
+					break;
+				case SHADER_BINDING_CONSTANT:
+					program_params->setConstant((size_t)index, Ogre::Vector4(kind->value[0], kind->value[1], kind->value[2], kind->value[3]));
+					break;
+				case SHADER_BINDING_BACKGROUND_SCALE: {
 					float background_scale = 1.0f;
 					if (current_level) {
 						background_scale=current_level->getSceneEffect().sky_intensity_scale;
 					}
 
 					program_params->setConstant((size_t)index, Ogre::Vector4(background_scale));
+					break;
 				}
-				else if (shader_parameter_name == "g_GIModeParam") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_OffsetParam") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_WaterParam") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_IceParam") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_GI0Scale") {
+				case SHADER_BINDING_GI0_SCALE:
 					if (editor_application->getCurrentLevel() != NULL && editor_application->getCurrentLevel()->getGameMode() == LIBGENS_LEVEL_GAME_UNLEASHED) {
 						program_params->setConstant((size_t)index, Ogre::Vector4(1, 1, 1, 0));
 					}
 					else {
 						program_params->setConstant((size_t)index, Ogre::Vector4(1, 1, 1, 1));
 					}
-				}
-				else if (shader_parameter_name == "g_GI1Scale") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(1, 1, 1, 1));
-				}
-				else if (shader_parameter_name == "g_MotionBlur_AlphaRef_VelocityLimit_VelocityCutoff_BlurMagnitude") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "mrgDebugDistortionParam") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "mrgEdgeEmissionParam") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_DebugValue") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "mrgGIAtlasParam") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_CUSTOM);
-				}
-				else if (shader_parameter_name == "mrgTexcoordIndex") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "mrgTexcoordOffset") {
+					break;
+				case SHADER_BINDING_TEXCOORD_OFFSET:
 					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
 
 					if (uv_animation) {
 						editor_application->getAnimationsList()->addTexcoordAnimation(uv_animation, program_params, (size_t)index);
 					}
-				}
-				else if (shader_parameter_name == "mrgFresnelParam") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "mrgMorphWeight") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "mrgZOffsetRate") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_IndexCount") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_TransColorMask") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_ChaosWaveParamEx") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_ChaosWaveParamY") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_ChaosWaveParamXZ") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_ChaosWaveParamXY") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_ChaosWaveParamZX") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_IgnoreLightParam") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_LightScattering_Ray_Mie_Ray2_Mie2") {
+					break;
+				case SHADER_BINDING_LIGHT_SCATTERING_RAY_MIE: {
 					LibGens::Color lsrm(0.291f,0.96f, 0.017543f, 0.075757f);
 					if (current_level) {
 						LibGens::SceneEffect& scene_effect = current_level->getSceneEffect();
@@ -498,8 +439,9 @@ void setShaderParameters(Ogre::Pass *pass, Ogre::GpuProgramParametersSharedPtr p
 
 					// 0.291, 0.96, 0.017543, 0.075757
 					// 0.1, 0.01, 0.005952, 0.0007974481
+					break;
 				}
-				else if (shader_parameter_name == "g_LightScattering_ConstG_FogDensity") {
+				case SHADER_BINDING_LIGHT_SCATTERING_CONST_G: {
 					LibGens::Color lsgf(0.0f, 0.0f, 0.0f, 0.0f);
 					if (current_level) {
 						LibGens::SceneEffect& scene_effect = current_level->getSceneEffect();
@@ -509,8 +451,9 @@ void setShaderParameters(Ogre::Pass *pass, Ogre::GpuProgramParametersSharedPtr p
 						lsgf.b = scene_effect.light_scattering_g * -2.0f;
 					}
 					program_params->setConstant((size_t)index, Ogre::Vector4(lsgf.r, lsgf.g, lsgf.b, lsgf.a));
+					break;
 				}
-				else if (shader_parameter_name == "g_LightScatteringFarNearScale") {
+				case SHADER_BINDING_LIGHT_SCATTERING_FAR_NEAR: {
 					LibGens::Color lsfn(3200.0f,380.0f,1.2f,114.0f);
 					if (current_level) {
 						LibGens::SceneEffect& scene_effect = current_level->getSceneEffect();
@@ -526,21 +469,17 @@ void setShaderParameters(Ogre::Pass *pass, Ogre::GpuProgramParametersSharedPtr p
 					}
 
 					program_params->setConstant((size_t)index, Ogre::Vector4(lsfn.r, lsfn.g, lsfn.b, lsfn.a));
+					break;
 				}
-				else if (shader_parameter_name == "g_LightScatteringColor") {
+				case SHADER_BINDING_LIGHT_SCATTERING_COLOR: {
 					LibGens::Color lsc(0.11,0.35,0.760001,1);
 					if (current_level) {
 						lsc=current_level->getSceneEffect().light_scattering_color;
 					}
 					program_params->setConstant((size_t)index, Ogre::Vector4(lsc.r, lsc.g, lsc.b, 1));
+					break;
 				}
-				else if (shader_parameter_name == "g_LightScatteringMode") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(4, 1, 1, 1));
-				}
-				else if (shader_parameter_name == "g_VerticalLightDirection") {
-					program_params->setAutoConstant((size_t)index, Ogre::GpuProgramParameters::ACT_LIGHT_POSITION, 0);
-				}
-				else if (shader_parameter_name == "g_aLightField") {
+				case SHADER_BINDING_LIGHT_FIELD: {
 					float lightfield_cube[24];
 					for (size_t i=0; i<24; i++) {
 						lightfield_cube[i] = 0.5f;
@@ -548,155 +487,58 @@ void setShaderParameters(Ogre::Pass *pass, Ogre::GpuProgramParametersSharedPtr p
 					lightfield_cube[3] = 1.0f;
 
 					program_params->setConstant((size_t)index, lightfield_cube, 6);
+					break;
 				}
-				else if (shader_parameter_name == "g_TimeParam") {
-					//program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-					program_params->setAutoConstantReal((size_t)index, Ogre::GpuProgramParameters::ACT_TIME, 1.0f);
-				}
-				else if (shader_parameter_name == "diffuse") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(1, 1, 1, 1));
-				}
-				else if (shader_parameter_name == "ambient") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(1, 1, 1, 1));
-				}
-				else if (shader_parameter_name == "specular") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(1, 1, 1, 1));
-				}
-				else if (shader_parameter_name == "emissive") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "opacity_reflection_refraction_spectype") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(1, 0, 1, 3));
-				}
-				else if (shader_parameter_name == "power_gloss_level") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(50, 0.3, 0.19, 0));
-				}
-				else if (shader_parameter_name == "g_SonicSkinFalloffParam") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0.15, 2, 3, 0));
-				}
-				else if (shader_parameter_name == "g_SkyParam") {
+				case SHADER_BINDING_SKY_PARAM: {
 					float sky_follow_y_ratio = 1.0f;
 					if (current_level) {
 						sky_follow_y_ratio=current_level->getSceneEffect().sky_follow_up_ratio_y;
 					}
 
 					program_params->setConstant((size_t)index, Ogre::Vector4(1, sky_follow_y_ratio, 1, 1));
+					break;
 				}
-				else if (shader_parameter_name == "g_ViewZAlphaFade") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
-				else if (shader_parameter_name == "g_ForceAlphaColor") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(1, 1, 1, 1));
-				}
-				else if (shader_parameter_name == "g_ChrPlayableMenuParam") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(1, 1, 1, 1));
-				}	
-				else if (shader_parameter_name == "mrgPlayableParam") {
-					program_params->setConstant((size_t)index, Ogre::Vector4(-1, 1, 1, 1));
-				}
-				else {
-					printf(("Unhandled constant/variable float4 " + shader_parameter_name + " with index " + ToString((int)index) + " on the Shader " + ToString(material->getShader()) + ". Handle it!\n").c_str());
-					program_params->setConstant((size_t)index, Ogre::Vector4(0, 0, 0, 0));
-				}
+				default:
+					break;
 			}
-			else if (slot == 2) {
-				if (shader_parameter_name == "mrgHasBone") {
-					// Unhandled, how do I set a bool
-				}
-				else if (shader_parameter_name == "g_IsShadowMapEnable") {
-					// Unhandled, how do I set a bool
-				}
-				else if (shader_parameter_name == "g_IsLightScatteringEnable") {
-					// Unhandled, how do I set a bool
-				}
-				else if (shader_parameter_name == "mrgIsEnableHemisphere") {
-					// Unhandled, how do I set a bool
-				}
-				else if (shader_parameter_name == "g_IsAlphaDepthBlur") {
-					// Unhandled, how do I set a bool
-				}
-				else if (shader_parameter_name == "g_IsGIEnabled") {
-					// Unhandled, how do I set a bool
-				}
-				else if (shader_parameter_name == "g_IsSoftParticle") {
-					// Unhandled, how do I set a bool
-				}
-				else {
-					ERROR_MSG(("Unhandled constant/variable bool " + shader_parameter_name + " with index " + ToString((int)index) + " on the Shader " + ToString(material->getShader()) + ". Handle it!").c_str());
-				}
+		}
+		else if (slot == 2) {
+			// Known bools are unhandled, how do I set a bool
+			if (!kind) {
+				ERROR_MSG(("Unhandled constant/variable bool " + shader_parameter_name + " with index " + ToString((int)index) + " on the Shader " + ToString(material->getShader()) + ". Handle it!").c_str());
 			}
-			else if (slot == 3) {
-				index &= 0xF;
-				string texture_unit = shader_parameter_name;
-
-				size_t texture_unit_used_count=0;
-				for (size_t i=0; i<texture_units_used.size(); i++) {
-					if (texture_units_used[i] == texture_unit) {
-						texture_unit_used_count++;
-					}
-				}
+		}
+		else if (slot == 3) {
+			index &= 0xF;
+			const string &texture_unit = shader_parameter_name;
 
-				// get rid of old textures to refresh units
-				pass->getTextureUnitState((size_t)index)->setTextureName("");
-				LibGens::Texture *material_texture = material->getTextureByUnit(texture_unit, texture_unit_used_count);
-				if (material_texture) {
-					pass->getTextureUnitState((size_t)index)->setTextureFiltering(Ogre::TextureFilterOptions::TFO_TRILINEAR);
-					pass->getTextureUnitState((size_t)index)->setTextureName(material_texture->getName()+LIBGENS_TEXTURE_FILE_EXTENSION);
-					texture_units_used.push_back(texture_unit);
-					continue;
+			size_t texture_unit_used_count=0;
+			for (size_t i=0; i<texture_units_used.size(); i++) {
+				if (texture_units_used[i] == texture_unit) {
+					texture_unit_used_count++;
 				}
+			}
 
+			// get rid of old textures to refresh units
+			pass->getTextureUnitState((size_t)index)->setTextureName("");
+			LibGens::Texture *material_texture = material->getTextureByUnit(texture_unit, texture_unit_used_count);
+			if (material_texture) {
+				pass->getTextureUnitState((size_t)index)->setTextureFiltering(Ogre::TextureFilterOptions::TFO_TRILINEAR);
+				pass->getTextureUnitState((size_t)index)->setTextureName(material_texture->getName()+LIBGENS_TEXTURE_FILE_EXTENSION);
+				texture_units_used.push_back(texture_unit);
+				continue;
+			}
 
-				if (shader_parameter_name == "TerrainDiffusemapMask") {
-				}
-				else if (shader_parameter_name == "GI") {
-					pass->getTextureUnitState((size_t)index)->setTextureName("white.dds");
-				}
-				else if (shader_parameter_name == "Framebuffer") {
-					//pass->getTextureUnitState((size_t)index)->setTextureName("ColorTex");
-				}
-				else if (shader_parameter_name == "Depth") {
-					//pass->getTextureUnitState((size_t)index)->setTextureName("DepthTex");
-					pass->getTextureUnitState((size_t)index)->setTextureName("white.dds");
-				}
-				else if (shader_parameter_name == "ShadowMap") {
-					pass->getTextureUnitState((size_t)index)->setTextureName("white.dds");
-				}
-				else if (shader_parameter_name == "VerticalShadowMap") {
-					pass->getTextureUnitState((size_t)index)->setTextureName("white.dds");
-				}
-				else if (shader_parameter_name == "ShadowMapJitter") {
-				}
-				else if (shader_parameter_name == "ReflectionMap") {
-				}
-				else if (shader_parameter_name == "ReflectionMap2") {
-				}
-				else if (shader_parameter_name == "INDEXEDLIGHTMAP") {
-				}
-				else if (shader_parameter_name == "PamNpcEye") {
-				}
-				else if (shader_parameter_name == "diffuse") {
-				}
-				else if (shader_parameter_name == "specular") {
-				}
-				else if (shader_parameter_name == "reflection") {
-				}
-				else if (shader_parameter_name == "normal") {
-				}
-				else if (shader_parameter_name == "displacement") {
-				}
-				else if (shader_parameter_name == "gloss") {
-				}
-				else if (shader_parameter_name == "opacity") {
-				}
-				else {
-					ERROR_MSG(("Unhandled constant/variable sampler " + shader_parameter_name + " with index " + ToString((int)index) + " on the Shader " + ToString(material->getShader()) + ". Handle it!").c_str());
-				}
+			if (!kind) {
+				ERROR_MSG(("Unhandled constant/variable sampler " + shader_parameter_name + " with index " + ToString((int)index) + " on the Shader " + ToString(material->getShader()) + ". Handle it!").c_str());
 			}
-			else {
-				ERROR_MSG(("Unhandled slot " + ToString(slot) + ". Handle it!").c_str());
+			else if (kind->type == SHADER_BINDING_WHITE_TEXTURE) {
+				pass->getTextureUnitState((size_t)index)->setTextureName("white.dds");
 			}
 		}
+		else {
+			ERROR_MSG(("Unhandled slot " + ToString(slot) + ". Handle it!").c_str());
+		}
 	}
 }
 
@@ -742,6 +584,10 @@ void updateMaterialShaderParameters(Ogre::Material *ogre_material, LibGens::Mate
 		return;
 	}
 
+	if (!shader_library->hasBindingKinds()) {
+		registerShaderBindingKinds(shader_library);
+	}
+
 	// Search for shaders based on the material's shader
 	string shader_name = material->getShader();
 	LibGens::Shader *vertex_shader=NULL;
@@ -771,7 +617,7 @@ void updateMaterialShaderParameters(Ogre::Material *ogre_material, LibGens::Mate
 				LibGens::ShaderParams *shader_params=shader_library->getVertexShaderParams(shader_parameter_filenames[i]);
 
 				if (shader_params) {
-					setShaderParameters(pass, vp_parameters, material, shader_params, uv_animation, vertex_shader_code_file);
+					setShaderParameters(pass, vp_parameters, material, shader_params, uv_animation, vertex_shader_code_file, shader_library);
 				}
 			}
 		}
@@ -797,7 +643,7 @@ void updateMaterialShaderParameters(Ogre::Material *ogre_material, LibGens::Mate
 				LibGens::ShaderParams *shader_params=shader_library->getPixelShaderParams(shader_parameter_filenames[i]);
 
 				if (shader_params) {
-					setShaderParameters(pass, fp_parameters, material, shader_params, uv_animation, pixel_shader_code_file);
+					setShaderParameters(pass, fp_parameters, material, shader_params, uv_animation, pixel_shader_code_file, shader_library);
 				}
 			}
 		}
@@ -839,6 +685,62 @@ void buildMaterial(LibGens::Material *material, string material_name, string res
 }
 
 
+// Ogre 1.9 has no normalized short, 10:10:10 or half types, so packer layouts using them are rejected.
+bool getOgreVertexElementType(LibGens::VertexElementData data, Ogre::VertexElementType *type) {
+	switch (data) {
+		case LibGens::FLOAT1:
+			*type = Ogre::VET_FLOAT1;
+			return true;
+		case LibGens::FLOAT2:
+			*type = Ogre::VET_FLOAT2;
+			return true;
+		case LibGens::FLOAT3:
+			*type = Ogre::VET_FLOAT3;
+			return true;
+		case LibGens::FLOAT4:
+			*type = Ogre::VET_FLOAT4;
+			return true;
+		case LibGens::D3DCOLOR:
+			*type = Ogre::VET_COLOUR_ARGB;
+			return true;
+		case LibGens::UBYTE4:
+			*type = Ogre::VET_UBYTE4;
+			return true;
+		case LibGens::SHORT2:
+			*type = Ogre::VET_SHORT2;
+			return true;
+		case LibGens::SHORT4:
+			*type = Ogre::VET_SHORT4;
+			return true;
+		case LibGens::USHORT4:
+			*type = Ogre::VET_USHORT4;
+			return true;
+	}
+
+	return false;
+}
+
+Ogre::VertexElementSemantic getOgreVertexElementSemantic(LibGens::VertexElementID id) {
+	switch (id) {
+		case LibGens::NORMAL:
+			return Ogre::VES_NORMAL;
+		case LibGens::TANGENT:
+			return Ogre::VES_TANGENT;
+		case LibGens::BINORMAL:
+			return Ogre::VES_BINORMAL;
+		case LibGens::UV:
+			return Ogre::VES_TEXTURE_COORDINATES;
+		case LibGens::COLOR:
+			return Ogre::VES_DIFFUSE;
+		case LibGens::BONE_INDICES:
+			return Ogre::VES_BLEND_INDICES;
+		case LibGens::BONE_WEIGHTS:
+			return Ogre::VES_BLEND_WEIGHTS;
+	}
+
+	return Ogre::VES_POSITION;
+}
+
 void buildMesh(Ogre::SceneNode *scene_node, LibGens::Mesh *mesh, Ogre::SceneManager *scene_manager, LibGens::MaterialLibrary *material_library, string root_name, Ogre::uint32 query_flags, string resource_group, bool global_illumination, string skeleton_name, Ogre::Entity *&shared_entity, vector<LibGens::Bone *> model_bones, LibGens::ShaderLibrary *shader_library) {
 	vector<LibGens::Submesh *> *submeshes=mesh->getSubmeshSlots();
 	unsigned int i=0;
@@ -848,6 +750,15 @@ void buildMesh(Ogre::SceneNode *scene_node, LibGens::Mesh *mesh, Ogre::SceneMana
 		create_resource = false;
 	}
 
+	LibGens::VertexPacker vertex_packer(LIBGENS_VERTEX_PACKER_LAYOUT_D3D9);
+	vector<Ogre::VertexElementType> element_types(vertex_packer.getElementCount());
+	for (size_t i=0; i<element_types.size(); i++) {
+		if (!getOgreVertexElementType(vertex_packer.getElement(i).data, &element_types[i])) {
+			LibGens::Error::addMessage(LibGens::Error::EXCEPTION, "Vertex layout for " + root_name + " has an element type Ogre can't describe.");
+			return;
+		}
+	}
+
 	for (size_t mesh_slot=0; mesh_slot<LIBGENS_MODEL_SUBMESH_SLOTS; mesh_slot++) {
 		string ent_name=root_name + "_" + ToString(mesh_slot);
 
@@ -866,102 +777,34 @@ void buildMesh(Ogre::SceneNode *scene_node, LibGens::Mesh *mesh, Ogre::SceneMana
 				LibGens::Submesh *submesh=submeshes[mesh_slot][submesh_slot];
 				
 				// Get LibGens Data
-				vector<LibGens::Vertex *> submesh_vertices = submesh->getVertices();
-				vector<LibGens::Polygon> submesh_faces = submesh->getFaces();
+				LibGens::VertexArrays *vertex_arrays = submesh->getVertexArrays();
+				for (size_t i=0; i<vertex_arrays->positions.size(); i++) {
+					mesh_aabb.addPoint(vertex_arrays->positions[i]);
+				}
 
 				// Create Ogre Submesh
 				Ogre::SubMesh* sub = msh->createSubMesh();
-				const size_t nVertices = submesh_vertices.size();
-				const size_t nVertCount = 24;
-				const size_t vbufCount = nVertCount*nVertices;
-				float *vertices = (float *) malloc(sizeof(float)*vbufCount);
-
-				for (size_t i=0; i<submesh_vertices.size(); i++) {
-					vertices[i*nVertCount]   = submesh_vertices[i]->getPosition().x;
-					vertices[i*nVertCount+1] = submesh_vertices[i]->getPosition().y;
-					vertices[i*nVertCount+2] = submesh_vertices[i]->getPosition().z;
-
-					mesh_aabb.addPoint(submesh_vertices[i]->getPosition());
-
-					vertices[i*nVertCount+3] = submesh_vertices[i]->getNormal().x;
-					vertices[i*nVertCount+4] = submesh_vertices[i]->getNormal().y;
-					vertices[i*nVertCount+5] = submesh_vertices[i]->getNormal().z;
-
-					vertices[i*nVertCount+6] = submesh_vertices[i]->getTangent().x;
-					vertices[i*nVertCount+7] = submesh_vertices[i]->getTangent().y;
-					vertices[i*nVertCount+8] = submesh_vertices[i]->getTangent().z;
-
-					vertices[i*nVertCount+9]  = submesh_vertices[i]->getBinormal().x;
-					vertices[i*nVertCount+10] = submesh_vertices[i]->getBinormal().y;
-					vertices[i*nVertCount+11] = submesh_vertices[i]->getBinormal().z;
-
-					vertices[i*nVertCount+12] = submesh_vertices[i]->getUV(0).x;
-					vertices[i*nVertCount+13] = submesh_vertices[i]->getUV(0).y;
-
-					vertices[i*nVertCount+14] = submesh_vertices[i]->getUV(1).x;
-					vertices[i*nVertCount+15] = submesh_vertices[i]->getUV(1).y;
-
-					vertices[i*nVertCount+16] = submesh_vertices[i]->getUV(2).x;
-					vertices[i*nVertCount+17] = submesh_vertices[i]->getUV(2).y;
-
-					vertices[i*nVertCount+18] = submesh_vertices[i]->getUV(3).x;
-					vertices[i*nVertCount+19] = submesh_vertices[i]->getUV(3).y;
-
-					vertices[i*nVertCount+20] = submesh_vertices[i]->getColor().r;
-					vertices[i*nVertCount+21] = submesh_vertices[i]->getColor().g;
-					vertices[i*nVertCount+22] = submesh_vertices[i]->getColor().b;
-					vertices[i*nVertCount+23] = submesh_vertices[i]->getColor().a;
-				}
- 
-				Ogre::RenderSystem* rs = Ogre::Root::getSingleton().getRenderSystem();
-				const size_t ibufCount = submesh_faces.size()*3;
-				unsigned short *faces = (unsigned short *) malloc(sizeof(unsigned short) * ibufCount);
-
-				for (size_t i=0; i<submesh_faces.size(); i++) {
-					faces[i*3]   = submesh_faces[i].a;
-					faces[i*3+1] = submesh_faces[i].b;
-					faces[i*3+2] = submesh_faces[i].c;
-				}
+				const size_t nVertices = vertex_arrays->count;
+				const size_t ibufCount = submesh->getFacesSize()*3;
 
 				sub->vertexData = new Ogre::VertexData();
 				sub->vertexData->vertexCount = nVertices;
 
 				Ogre::VertexDeclaration* decl = sub->vertexData->vertexDeclaration;
-				size_t offset = 0;
-
-				decl->addElement(0, offset, Ogre::VET_FLOAT3, Ogre::VES_POSITION);
-				offset += Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT3);
-
-				decl->addElement(0, offset, Ogre::VET_FLOAT3, Ogre::VES_NORMAL);
-				offset += Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT3);
-
-				decl->addElement(0, offset, Ogre::VET_FLOAT3, Ogre::VES_TANGENT);
-				offset += Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT3);
-
-				decl->addElement(0, offset, Ogre::VET_FLOAT3, Ogre::VES_BINORMAL);
-				offset += Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT3);
-
-				decl->addElement(0, offset, Ogre::VET_FLOAT2, Ogre::VES_TEXTURE_COORDINATES);
-				offset += Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT2);
-
-				decl->addElement(0, offset, Ogre::VET_FLOAT2, Ogre::VES_TEXTURE_COORDINATES, 1);
-				offset += Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT2);
-
-				decl->addElement(0, offset, Ogre::VET_FLOAT2, Ogre::VES_TEXTURE_COORDINATES, 2);
-				offset += Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT2);
-
-				decl->addElement(0, offset, Ogre::VET_FLOAT2, Ogre::VES_TEXTURE_COORDINATES, 3);
-				offset += Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT2);
-
-				decl->addElement(0, offset, Ogre::VET_FLOAT4, Ogre::VES_DIFFUSE);
-				offset += Ogre::VertexElement::getTypeSize(Ogre::VET_FLOAT4);
+				for (size_t i=0; i<vertex_packer.getElementCount(); i++) {
+					LibGens::VertexPackerElement element = vertex_packer.getElement(i);
+					decl->addElement(0, element.offset, element_types[i], getOgreVertexElementSemantic(element.id), element.index);
+				}
 
-				Ogre::HardwareVertexBufferSharedPtr vbuf = Ogre::HardwareBufferManager::getSingleton().createVertexBuffer(offset, sub->vertexData->vertexCount, Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY);
-				vbuf->writeData(0, vbuf->getSizeInBytes(), vertices, true);
+				// Pack straight into the locked hardware buffers
+				Ogre::HardwareVertexBufferSharedPtr vbuf = Ogre::HardwareBufferManager::getSingleton().createVertexBuffer(vertex_packer.getStride(), sub->vertexData->vertexCount, Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY);
+				submesh->packVertices(&vertex_packer, vbuf->lock(Ogre::HardwareBuffer::HBL_DISCARD), vbuf->getSizeInBytes());
+				vbuf->unlock();
 				Ogre::VertexBufferBinding* bind = sub->vertexData->vertexBufferBinding; 
 				bind->setBinding(0, vbuf);
 				Ogre::HardwareIndexBufferSharedPtr ibuf = Ogre::HardwareBufferManager::getSingleton().createIndexBuffer(Ogre::HardwareIndexBuffer::IT_16BIT, ibufCount, Ogre::HardwareBuffer::HBU_STATIC_WRITE_ONLY);
-				ibuf->writeData(0, ibuf->getSizeInBytes(), faces, true);
+				submesh->packIndices((unsigned short *) ibuf->lock(Ogre::HardwareBuffer::HBL_DISCARD), ibufCount);
+				ibuf->unlock();
 				sub->useSharedVertices = false;
 				sub->indexData->indexBuffer = ibuf;
 				sub->indexData->indexCount = ibufCount;
@@ -1013,11 +856,10 @@ void buildMesh(Ogre::SceneNode *scene_node, LibGens::Mesh *mesh, Ogre::SceneMana
 						for (size_t i = 0; i < nVertices; i++) {
 							Ogre::VertexBoneAssignment vba;
 							vba.vertexIndex = static_cast<unsigned int>(i);
-							LibGens::Vertex *vertex=submesh_vertices[i];
 
 							for (size_t j = 0; j < 4; j++) {
-								unsigned short bone_index  = vertex->getBoneIndex(j);
-								unsigned char bone_weight = vertex->getBoneWeight(j);
+								unsigned short bone_index  = vertex_arrays->bone_indices.empty() ? (j ? 0xFFFF : 0) : vertex_arrays->bone_indices[i*4 + j];
+								unsigned char bone_weight = vertex_arrays->bone_weights.empty() ? (j ? 0 : 0xFF) : vertex_arrays->bone_weights[i*4 + j];
 
 								if ((bone_index == 0xFFFF) && j) {
 									break;
@@ -1041,10 +883,6 @@ void buildMesh(Ogre::SceneNode *scene_node, LibGens::Mesh *mesh, Ogre::SceneMana
 						sub->vertexData->reorganiseBuffers(decl->getAutoOrganisedDeclaration(true, false, false));
 					}
 				}
-
-				// Cleanup
-				free(faces);
-				free(vertices);
 			}
 
 			msh->_setBounds(Ogre::AxisAlignedBox(mesh_aabb.start.x, mesh_aabb.start.y, mesh_aabb.start.z, mesh_aabb.end.x, mesh_aabb.end.y, mesh_aabb.end.z));
@@ -1121,6 +959,9 @@ void buildModel(Ogre::SceneNode *scene_node, LibGens::Model *model, string model
 	if (!model) return;
 	if (!scene_manager) return;
 	if (!material_library) return;
+
+	list<string> material_names=model->getMaterialNames();
+	material_library->prefetch(vector<string>(material_names.begin(), material_names.end()));
 	
 	Ogre::Entity *shared_entity=NULL;
 	vector<LibGens::Mesh *> meshes=model->getMeshes();
@@ -0,0 +1,83 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+
+#pragma once
+
+#include <chrono>
+
+#ifdef _WIN32
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Headless benchmarks selectable from the cmdtest command line, e.g. "cmdtest bench-file Stage.pfd".
+// Every benchmark receives the arguments that follow its name and returns the process exit code.
+class BenchmarkTimer {
+	protected:
+		std::chrono::high_resolution_clock::time_point start_time;
+	public:
+		BenchmarkTimer() {
+			reset();
+		}
+
+		void reset() {
+			start_time = std::chrono::high_resolution_clock::now();
+		}
+
+		double elapsedMilliseconds() const {
+			return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
+		}
+};
+
+inline double benchmarkMegabytesPerSecond(size_t bytes, double milliseconds) {
+	if (milliseconds <= 0.0) return 0.0;
+	return (bytes / (1024.0 * 1024.0)) / (milliseconds / 1000.0);
+}
+
+// Peak resident memory of the process so far, in bytes.
+inline size_t benchmarkPeakMemoryBytes() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return counters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) return (size_t) usage.ru_maxrss * 1024;
+#endif
+	return 0;
+}
+
+int benchmarkAnimationSampling(int argc, char** argv);
+int benchmarkCompression(int argc, char** argv);
+int benchmarkFile(int argc, char** argv);
+int benchmarkGIAtlas(int argc, char** argv);
+int benchmarkGIAtlasPacker(int argc, char** argv);
+int benchmarkHavokEndianSwap(int argc, char** argv);
+int benchmarkLevelSnapshot(int argc, char** argv);
+int benchmarkLightFieldSampling(int argc, char** argv);
+int benchmarkObjectLibrary(int argc, char** argv);
+int benchmarkPacSave(int argc, char** argv);
+int benchmarkSetLoading(int argc, char** argv);
+int benchmarkSpatialIndex(int argc, char** argv);
+int benchmarkStageMemory(int argc, char** argv);
+int benchmarkTerrainBlock(int argc, char** argv);
+int benchmarkTerrainStreaming(int argc, char** argv);
+int benchmarkTextureCompression(int argc, char** argv);
+int benchmarkVertexPacker(int argc, char** argv);
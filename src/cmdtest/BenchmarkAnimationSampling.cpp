@@ -0,0 +1,254 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "LibGens.h"
+#include "AnimationSet.h"
+#include "Keyframe.h"
+#include "KeyframeSet.h"
+#include "UVAnimation.h"
+#include "UVAnimationSet.h"
+#include "Ghost.h"
+#include "GhostNode.h"
+#include "Benchmark.h"
+
+#define BENCHMARK_ANIMATION_SAMPLING_STEPS 100000
+
+static bool benchmarkAnimationSamplingIsGhost(string filename) {
+	string extension = LIBGENS_GHOST_EXTENSION;
+	return (filename.size() >= extension.size()) && (filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0);
+}
+
+static bool benchmarkAnimationSamplingEqual(const LibGens::GhostSample &a, const LibGens::GhostSample &b) {
+	return (a.position.x == b.position.x) && (a.position.y == b.position.y) && (a.position.z == b.position.z) &&
+	       (a.rotation.x == b.rotation.x) && (a.rotation.y == b.rotation.y) && (a.rotation.z == b.rotation.z) && (a.rotation.w == b.rotation.w) &&
+	       (a.animation_index == b.animation_index) && (a.animation_frame == b.animation_frame) && (a.animation_ball == b.animation_ball);
+}
+
+// The forward scan over the node timers Ghost::calculate used before node_times, kept as the reference.
+static void benchmarkAnimationSamplingScanGhost(const vector<LibGens::GhostNode *> &nodes, float time, LibGens::GhostSample *sample) {
+	LibGens::GhostNode *previous_node=NULL;
+	LibGens::GhostNode *next_node=NULL;
+	float total_time=0;
+
+	for (size_t i=0; i<nodes.size(); i++) {
+		previous_node = next_node;
+		next_node = nodes[i];
+		total_time += next_node->getTimer();
+
+		if (total_time > time) {
+			break;
+		}
+	}
+
+	if (previous_node && next_node) {
+		float previous_time = total_time - next_node->getTimer();
+		float factor = (time - (previous_time)) / (next_node->getTimer());
+		sample->position = previous_node->getPosition() + ((next_node->getPosition() - previous_node->getPosition()) * factor);
+		sample->rotation = sample->rotation.slerp(factor, previous_node->getRotation(), next_node->getRotation());
+		sample->animation_index = previous_node->getAnimationIndex();
+		sample->animation_frame = previous_node->getAnimationFrame() + ((next_node->getAnimationFrame() - previous_node->getAnimationFrame()) * factor);
+		sample->animation_ball = previous_node->getAnimationBall();
+	}
+	else if (next_node) {
+		sample->position = next_node->getPosition();
+		sample->rotation = next_node->getRotation();
+		sample->animation_index = next_node->getAnimationIndex();
+		sample->animation_frame = next_node->getAnimationFrame();
+		sample->animation_ball = next_node->getAnimationBall();
+	}
+}
+
+// The forward scan over the keys KeyframeSet::getValue used before the binary search, kept as the reference.
+static float benchmarkAnimationSamplingScanKeyframes(const vector<LibGens::Keyframe *> &keyframes, float current_frame) {
+	LibGens::Keyframe *previous_key=NULL;
+	LibGens::Keyframe *next_key=NULL;
+
+	for (size_t i=0; i<keyframes.size(); i++) {
+		previous_key = next_key;
+		next_key = keyframes[i];
+
+		if (next_key->getFrame() > current_frame) {
+			break;
+		}
+	}
+
+	if (previous_key && next_key) {
+		float frame_offset = current_frame - previous_key->getFrame();
+		float frame_gap    = next_key->getFrame() - previous_key->getFrame();
+		float factor = frame_offset / frame_gap;
+
+		return previous_key->getValue() + ((next_key->getValue() - previous_key->getValue()) * factor);
+	}
+	else if (next_key) {
+		return next_key->getValue();
+	}
+
+	return 0.0f;
+}
+
+// Plays a ghost back at a fixed step the way GhostNode does: with the old linear scan, every sample searched
+// from scratch, with a playback cursor, and as one batched call. Every path is checked against the scan.
+static void benchmarkAnimationSamplingGhost(string filename) {
+	LibGens::Ghost ghost(filename);
+	float duration = ghost.calculateDuration();
+	float step = duration / BENCHMARK_ANIMATION_SAMPLING_STEPS;
+
+	vector<float> times(BENCHMARK_ANIMATION_SAMPLING_STEPS);
+	for (size_t i=0; i<times.size(); i++) {
+		times[i] = i * step;
+	}
+
+	vector<LibGens::GhostNode *> nodes = ghost.getGhostNodes();
+	vector<LibGens::GhostSample> scanned(times.size());
+	vector<LibGens::GhostSample> searched(times.size());
+	vector<LibGens::GhostSample> cursored(times.size());
+	vector<LibGens::GhostSample> batched(times.size());
+
+	BenchmarkTimer timer;
+	for (size_t i=0; i<times.size(); i++) {
+		benchmarkAnimationSamplingScanGhost(nodes, times[i], &scanned[i]);
+	}
+	double scanned_time = timer.elapsedMilliseconds();
+
+	timer.reset();
+	for (size_t i=0; i<times.size(); i++) {
+		ghost.calculate(times[i], &searched[i]);
+	}
+	double searched_time = timer.elapsedMilliseconds();
+
+	timer.reset();
+	size_t cursor = 0;
+	for (size_t i=0; i<times.size(); i++) {
+		ghost.calculate(times[i], &cursored[i], &cursor);
+	}
+	double cursored_time = timer.elapsedMilliseconds();
+
+	timer.reset();
+	ghost.sample(times.data(), times.size(), batched.data());
+	double batched_time = timer.elapsedMilliseconds();
+
+	size_t mismatches = 0;
+	for (size_t i=0; i<times.size(); i++) {
+		if (!benchmarkAnimationSamplingEqual(scanned[i], searched[i]) || !benchmarkAnimationSamplingEqual(scanned[i], cursored[i]) ||
+		    !benchmarkAnimationSamplingEqual(scanned[i], batched[i])) {
+			mismatches++;
+		}
+	}
+
+	printf("%s: %.2f s, %zu samples\n", filename.c_str(), duration, times.size());
+	printf("  scan %9.2f ms, search %9.2f ms, cursor %9.2f ms, batch %9.2f ms, %zu mismatches\n", scanned_time, searched_time, cursored_time, batched_time, mismatches);
+}
+
+// Advances every animation set of a UV animation at 60 fps the way EditorAnimationsList does, sampling
+// the four texcoord offset channels one by one and as a batch, and compares them and stateless sampling
+// against the old linear scan over the keys.
+static void benchmarkAnimationSamplingUV(string filename) {
+	static const unsigned int flags[4]={ 0x00010000, 0x01010000, 0x00000000, 0x01000000 };
+
+	LibGens::UVAnimation animation(filename);
+	vector<LibGens::UVAnimationSet *> animation_sets = animation.getAnimationSets();
+	printf("%s: %zu animation sets\n", filename.c_str(), animation_sets.size());
+
+	for (size_t s=0; s<animation_sets.size(); s++) {
+		LibGens::UVAnimationSet *animation_set = animation_sets[s];
+		if (animation_set->getEndTime() <= animation_set->getStartTime()) {
+			continue;
+		}
+
+		vector<float> frames(BENCHMARK_ANIMATION_SAMPLING_STEPS);
+		vector<float> batched_frames(frames.size());
+		vector<float> single(frames.size() * 4);
+		vector<float> batched(frames.size() * 4);
+		vector<float> stateless(frames.size() * 4);
+		vector<float> scanned(frames.size() * 4);
+
+		vector<LibGens::Keyframe *> keyframes[4];
+		for (size_t c=0; c<4; c++) {
+			LibGens::KeyframeSet *keyframe_set = animation_set->getKeyframeSet(flags[c]);
+			if (keyframe_set) keyframes[c] = keyframe_set->getKeyframes();
+		}
+
+		BenchmarkTimer timer;
+		for (size_t i=0; i<frames.size(); i++) {
+			animation_set->addTime(1.0f / 60.0f);
+			frames[i] = animation_set->getCurrentFrame();
+			for (size_t c=0; c<4; c++) {
+				single[i*4 + c] = animation_set->getCurrentValue(flags[c]);
+			}
+		}
+		double single_time = timer.elapsedMilliseconds();
+
+		timer.reset();
+		for (size_t i=0; i<frames.size(); i++) {
+			animation_set->addTime(1.0f / 60.0f);
+			batched_frames[i] = animation_set->getCurrentFrame();
+			animation_set->getCurrentValues(flags, &batched[i*4], 4);
+		}
+		double batched_time = timer.elapsedMilliseconds();
+
+		timer.reset();
+		for (size_t i=0; i<frames.size(); i++) {
+			animation_set->sample(frames[i], flags, &stateless[i*4], 4);
+		}
+		double stateless_time = timer.elapsedMilliseconds();
+
+		timer.reset();
+		for (size_t i=0; i<frames.size(); i++) {
+			for (size_t c=0; c<4; c++) {
+				scanned[i*4 + c] = benchmarkAnimationSamplingScanKeyframes(keyframes[c], frames[i]);
+			}
+		}
+		double scanned_time = timer.elapsedMilliseconds();
+
+		// The batched pass starts where the single pass stopped, so it is checked at its own frames.
+		size_t mismatches = 0;
+		for (size_t i=0; i<frames.size(); i++) {
+			for (size_t c=0; c<4; c++) {
+				if (single[i*4 + c] != scanned[i*4 + c]) mismatches++;
+				if (stateless[i*4 + c] != scanned[i*4 + c]) mismatches++;
+				if (batched[i*4 + c] != benchmarkAnimationSamplingScanKeyframes(keyframes[c], batched_frames[i])) mismatches++;
+			}
+		}
+
+		printf("  %-24s scan %9.2f ms, single %9.2f ms, batch %9.2f ms, stateless %9.2f ms, %zu mismatches\n", animation_set->getName().c_str(),
+			scanned_time, single_time, batched_time, stateless_time, mismatches);
+	}
+}
+
+// Times keyframe and ghost sampling over real .uv-anim and .gst.bin files against the old linear scans,
+// and checks that the search, cursor, batched and stateless paths give the same results as the scans.
+int benchmarkAnimationSampling(int argc, char** argv) {
+	if (argc < 1) {
+		printf("Usage: bench-animation-sampling file.uv-anim|file.gst.bin [...]\n");
+		return 1;
+	}
+
+	for (int a=0; a<argc; a++) {
+		string filename = ToString(argv[a]);
+
+		if (benchmarkAnimationSamplingIsGhost(filename)) {
+			benchmarkAnimationSamplingGhost(filename);
+		}
+		else {
+			benchmarkAnimationSamplingUV(filename);
+		}
+	}
+
+	return 0;
+}
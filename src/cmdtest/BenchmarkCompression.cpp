@@ -0,0 +1,115 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "LibGens.h"
+#include "Compression.h"
+#include "Benchmark.h"
+
+#define BENCHMARK_COMPRESSION_ITERATIONS 3
+
+static const char *benchmarkCompressionName(LibGens::CompressionType type) {
+	switch (type) {
+		case LibGens::COMPRESSION_CAB:  return "cab";
+		case LibGens::COMPRESSION_X:    return "xcompress";
+		case LibGens::COMPRESSION_SEGS: return "segs";
+	}
+	return "unknown";
+}
+
+// Decompresses the same stream at every thread count and reports the best run as MB/s of
+// uncompressed output. CAB decodes a single LZX stream and stays serial, so its numbers
+// should stay flat; XCompress and SEGS split into independent blocks.
+static void benchmarkDecompression(LibGens::File *compressed_file, LibGens::CompressionType type, const vector<unsigned int> &thread_counts) {
+	for (size_t t=0; t<thread_counts.size(); t++) {
+		LibGens::Parallel::setThreadCount(thread_counts[t]);
+
+		double best_time = 0.0;
+		size_t uncompressed_size = 0;
+
+		for (size_t i=0; i<BENCHMARK_COMPRESSION_ITERATIONS; i++) {
+			compressed_file->goToAddress(0);
+
+			BenchmarkTimer timer;
+			LibGens::File out_file;
+			LibGens::Compression::decompress(compressed_file, &out_file, type);
+			double time = timer.elapsedMilliseconds();
+
+			uncompressed_size = out_file.getFileSize();
+			if (!i || (time < best_time)) best_time = time;
+		}
+
+		printf("  %-10s %2u threads: %9.2f ms (%8.2f MB/s, %zu -> %zu bytes)\n", benchmarkCompressionName(type), thread_counts[t],
+			best_time, benchmarkMegabytesPerSecond(uncompressed_size, best_time), compressed_file->getFileSize(), uncompressed_size);
+	}
+}
+
+int benchmarkCompression(int argc, char** argv) {
+	if (argc < 1) {
+		printf("Usage: cmdtest bench-compression archive.ar [archive.arl ...]\n");
+		return 1;
+	}
+
+	unsigned int previous_thread_count = LibGens::Parallel::getThreadCount();
+	unsigned int hardware_thread_count = thread::hardware_concurrency();
+
+	vector<unsigned int> thread_counts;
+	for (unsigned int count=1; count<hardware_thread_count; count*=2) thread_counts.push_back(count);
+	thread_counts.push_back(hardware_thread_count ? hardware_thread_count : 1);
+
+	char entry_name[] = "benchmark";
+
+	for (int arg=0; arg<argc; arg++) {
+		string filename = ToString(argv[arg]);
+		LibGens::File file(filename, LIBGENS_FILE_READ_BINARY);
+		if (!file.valid()) {
+			printf("Couldn't open %s\n", filename.c_str());
+			continue;
+		}
+
+		unsigned int signature = 0;
+		file.readInt32(&signature);
+		file.goToAddress(0);
+
+		printf("Best of %d runs over %s\n", BENCHMARK_COMPRESSION_ITERATIONS, filename.c_str());
+
+		if (LibGens::Compression::check(signature)) {
+			benchmarkDecompression(&file, LibGens::CompressionType(signature), thread_counts);
+		}
+		else {
+			// Uncompressed input: measure both codecs the tools can write.
+			LibGens::CompressionType types[] = { LibGens::COMPRESSION_CAB, LibGens::COMPRESSION_X };
+			for (size_t i=0; i<2; i++) {
+				file.goToAddress(0);
+
+				BenchmarkTimer timer;
+				LibGens::File compressed_file;
+				LibGens::Compression::compress(&file, &compressed_file, types[i], entry_name);
+				double time = timer.elapsedMilliseconds();
+
+				printf("  %-10s compress:   %9.2f ms (%8.2f MB/s)\n", benchmarkCompressionName(types[i]), time, benchmarkMegabytesPerSecond(file.getFileSize(), time));
+				benchmarkDecompression(&compressed_file, types[i], thread_counts);
+			}
+		}
+
+		file.close();
+	}
+
+	LibGens::Parallel::setThreadCount(previous_thread_count);
+	return 0;
+}
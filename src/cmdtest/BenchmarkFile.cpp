@@ -0,0 +1,120 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+
+#include "LibGens.h"
+#include "AR.h"
+#include "Benchmark.h"
+
+#define BENCHMARK_FILE_ITERATIONS 5
+
+// Keeps the scalar read loop from being optimized away.
+static volatile unsigned int benchmark_file_checksum = 0;
+
+// Compares the buffered DiskFile backend against the memory mapped backend that
+// File(filename, "rb") selects by default, both on a full archive parse and on
+// the scalar readInt32BE path most of the format parsers use.
+static void benchmarkFileBackend(string filename, bool prefer_disk_file) {
+	double best_archive_time = 0.0;
+	double best_scalar_time = 0.0;
+	size_t file_size = 0;
+	unsigned int entry_count = 0;
+
+	for (size_t i=0; i<BENCHMARK_FILE_ITERATIONS; i++) {
+		BenchmarkTimer timer;
+		LibGens::File file(filename, LIBGENS_FILE_READ_BINARY, prefer_disk_file);
+		if (!file.valid()) {
+			printf("Couldn't open %s\n", filename.c_str());
+			return;
+		}
+
+		LibGens::ArPack pack;
+		pack.read(&file);
+		double archive_time = timer.elapsedMilliseconds();
+		entry_count = pack.getFileCount();
+
+		file_size = file.getFileSize();
+		file.goToAddress(0);
+
+		timer.reset();
+		unsigned int value = 0;
+		unsigned int checksum = 0;
+		for (size_t word=0; word<file_size/4; word++) {
+			file.readInt32BE(&value);
+			checksum ^= value;
+		}
+		double scalar_time = timer.elapsedMilliseconds();
+		file.close();
+
+		if (!i || (archive_time < best_archive_time)) best_archive_time = archive_time;
+		if (!i || (scalar_time < best_scalar_time)) best_scalar_time = scalar_time;
+		benchmark_file_checksum = checksum;
+	}
+
+	printf("%-8s archive read: %9.2f ms (%8.2f MB/s, %u entries)   scalar readInt32BE: %9.2f ms (%8.2f MB/s)\n",
+		prefer_disk_file ? "disk" : "mapped",
+		best_archive_time, benchmarkMegabytesPerSecond(file_size, best_archive_time), entry_count,
+		best_scalar_time, benchmarkMegabytesPerSecond(file_size, best_scalar_time));
+}
+
+// Index-only open: only the entry headers of the mapped archive are walked, and getFile
+// returns views into the mapping through the name index.
+static void benchmarkIndexOpen(string filename) {
+	double best_open_time = 0.0;
+	double best_lookup_time = 0.0;
+	unsigned int entry_count = 0;
+
+	for (size_t i=0; i<BENCHMARK_FILE_ITERATIONS; i++) {
+		BenchmarkTimer timer;
+		LibGens::ArPack pack(filename, false);
+		double open_time = timer.elapsedMilliseconds();
+		entry_count = pack.getFileCount();
+
+		vector<string> names;
+		for (unsigned int e=0; e<entry_count; e++) names.push_back(pack.getFileByIndex(e)->getName());
+
+		timer.reset();
+		unsigned int checksum = 0;
+		for (size_t e=0; e<names.size(); e++) {
+			LibGens::ArFile *entry = pack.getFile(names[e]);
+			if (entry && entry->getData() && entry->getSize()) checksum ^= entry->getData()[0];
+		}
+		double lookup_time = timer.elapsedMilliseconds();
+
+		if (!i || (open_time < best_open_time)) best_open_time = open_time;
+		if (!i || (lookup_time < best_lookup_time)) best_lookup_time = lookup_time;
+		benchmark_file_checksum = checksum;
+	}
+
+	printf("%-8s index open:   %9.2f ms (%u entries)   getFile for every entry: %9.2f ms\n", "mapped", best_open_time, entry_count, best_lookup_time);
+}
+
+int benchmarkFile(int argc, char** argv) {
+	if (argc < 1) {
+		printf("Usage: cmdtest bench-file archive.ar\n");
+		return 1;
+	}
+
+	string filename = ToString(argv[0]);
+	printf("Best of %d runs over %s\n", BENCHMARK_FILE_ITERATIONS, filename.c_str());
+	benchmarkFileBackend(filename, true);
+	benchmarkFileBackend(filename, false);
+	benchmarkIndexOpen(filename);
+	return 0;
+}
@@ -0,0 +1,123 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "LibGens.h"
+#include "AR.h"
+#include "GITextureGroup.h"
+#include "GIAtlas.h"
+#include "Benchmark.h"
+
+struct BenchmarkGIAtlasTimes {
+	double open;
+	double decode;
+	double extract;
+	double organize;
+	double write;
+	size_t subtextures;
+	size_t output_pixels;
+	size_t output_bytes;
+};
+
+// Runs every stage of the GI atlas pipeline over all groups of a stage once. Groups are rebuilt from
+// their own content, without imports or overrides, and written as uncompressed DDS textures.
+static void benchmarkGIAtlasRun(string info_filename, string stage_folder, string stage_add_folder, string output_folder, BenchmarkGIAtlasTimes *times) {
+	memset(times, 0, sizeof(BenchmarkGIAtlasTimes));
+
+	LibGens::GITextureGroupInfo info(info_filename);
+	vector<LibGens::GITextureGroup *> groups = info.getGroups();
+	LibGens::GIAtlasPipeline pipeline;
+
+	for (size_t g=0; g<groups.size(); g++) {
+		string folder = (groups[g]->getQualityLevel() == LIBGENS_GI_TEXTURE_GROUP_LOWEST_QUALITY) ? stage_folder : stage_add_folder;
+		string group_filename = folder + "/" + LIBGENS_GI_TEXTURE_GROUP_FOLDER_BEFORE + ToString(g) + LIBGENS_GI_TEXTURE_GROUP_FOLDER_AFTER;
+
+		BenchmarkTimer timer;
+		LibGens::ArPack group_pack(group_filename);
+		pipeline.open(groups[g], &group_pack);
+		times->open += timer.elapsedMilliseconds();
+		times->subtextures += pipeline.getSubtextureCount();
+
+		timer.reset();
+		pipeline.decode();
+		times->decode += timer.elapsedMilliseconds();
+
+		timer.reset();
+		pipeline.extract();
+		times->extract += timer.elapsedMilliseconds();
+
+		timer.reset();
+		pipeline.organize(0);
+		times->organize += timer.elapsedMilliseconds();
+
+		LibGens::ArPack output_pack;
+		timer.reset();
+		pipeline.write(&output_pack);
+		times->write += timer.elapsedMilliseconds();
+		pipeline.clear();
+
+		list<LibGens::GITexture *> textures = groups[g]->getTextures();
+		for (list<LibGens::GITexture *>::iterator it=textures.begin(); it!=textures.end(); it++) {
+			times->output_pixels += (size_t) (*it)->getWidth() * (*it)->getHeight();
+		}
+
+		for (unsigned int i=0; i<output_pack.getFileCount(); i++) {
+			times->output_bytes += output_pack.getFileByIndex(i)->getSize();
+		}
+
+		if (!output_folder.empty()) {
+			output_pack.save(output_folder + "/" + LIBGENS_GI_TEXTURE_GROUP_FOLDER_BEFORE + ToString(g) + LIBGENS_GI_TEXTURE_GROUP_FOLDER_AFTER);
+		}
+	}
+}
+
+int benchmarkGIAtlas(int argc, char** argv) {
+	if (argc < 2) {
+		printf("Usage: cmdtest bench-gi-atlas gi-texture.gi-texture-group-info stage_folder [stage_add_folder] [output_folder]\n");
+		return 1;
+	}
+
+	string info_filename = ToString(argv[0]);
+	string stage_folder = ToString(argv[1]);
+	string stage_add_folder = (argc > 2) ? ToString(argv[2]) : stage_folder;
+	string output_folder = (argc > 3) ? ToString(argv[3]) : "";
+
+	unsigned int previous_thread_count = LibGens::Parallel::getThreadCount();
+	unsigned int hardware_thread_count = thread::hardware_concurrency();
+
+	vector<unsigned int> thread_counts;
+	for (unsigned int count=1; count<hardware_thread_count; count*=2) thread_counts.push_back(count);
+	thread_counts.push_back(hardware_thread_count ? hardware_thread_count : 1);
+
+	for (size_t t=0; t<thread_counts.size(); t++) {
+		LibGens::Parallel::setThreadCount(thread_counts[t]);
+
+		BenchmarkGIAtlasTimes times;
+		BenchmarkTimer timer;
+		benchmarkGIAtlasRun(info_filename, stage_folder, stage_add_folder, (t + 1 == thread_counts.size()) ? output_folder : "", &times);
+		double total_time = timer.elapsedMilliseconds();
+
+		printf("%2u threads: %9.2f ms total, %.2f MPix/s (%zu subtextures, %zu bytes written)\n", thread_counts[t], total_time,
+			(total_time > 0.0) ? (times.output_pixels / 1000000.0) / (total_time / 1000.0) : 0.0, times.subtextures, times.output_bytes);
+		printf("  open %9.2f ms, decode %9.2f ms, extract %9.2f ms, organize %9.2f ms, write %9.2f ms\n",
+			times.open, times.decode, times.extract, times.organize, times.write);
+	}
+
+	LibGens::Parallel::setThreadCount(previous_thread_count);
+	return 0;
+}
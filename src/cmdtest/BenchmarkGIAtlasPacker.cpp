@@ -0,0 +1,154 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "LibGens.h"
+#include "AR.h"
+#include "GITextureGroup.h"
+#include "Benchmark.h"
+
+struct BenchmarkGIAtlasPackerStats {
+	double time;
+	size_t atlases;
+	size_t subtextures;
+	size_t overlaps;
+	unsigned long long atlas_pixels;
+	unsigned long long subtexture_pixels;
+};
+
+// Reads the pixel size of every subtexture in a group's atlasinfo from the headers of its DDS textures.
+static bool benchmarkGIAtlasPackerReadSizes(string group_filename, vector<pair<string, pair<unsigned int, unsigned int>>> *sizes) {
+	LibGens::ArPack pack(group_filename);
+	LibGens::ArFile *atlasinfo = pack.getFile(LIBGENS_GI_TEXTURE_GROUP_ATLASINFO_FILE);
+	if (!atlasinfo || !atlasinfo->getData()) {
+		return false;
+	}
+
+	LibGens::GITextureGroup atlas_group;
+	atlas_group.setQualityLevel(0);
+	LibGens::File atlasinfo_file(atlasinfo->getData(), atlasinfo->getSize());
+	atlas_group.readAtlasinfo(&atlasinfo_file);
+
+	list<LibGens::GITexture *> textures = atlas_group.getTextures();
+	for (list<LibGens::GITexture *>::iterator it=textures.begin(); it!=textures.end(); it++) {
+		LibGens::ArFile *texture_file = pack.getFile((*it)->getName() + ".dds");
+		if (!texture_file || !texture_file->getData() || (texture_file->getSize() < 20)) continue;
+
+		const unsigned char *header = texture_file->getData();
+		unsigned int height = header[12] | (header[13] << 8) | (header[14] << 16) | (header[15] << 24);
+		unsigned int width = header[16] | (header[17] << 8) | (header[18] << 16) | (header[19] << 24);
+
+		list<LibGens::GISubtexture *> subtextures = (*it)->getSubtextures();
+		for (list<LibGens::GISubtexture *>::iterator it2=subtextures.begin(); it2!=subtextures.end(); it2++) {
+			unsigned int subtexture_width = (unsigned int) ((*it2)->getWidth() * width + 0.5f);
+			unsigned int subtexture_height = (unsigned int) ((*it2)->getHeight() * height + 0.5f);
+			sizes->push_back(make_pair((*it2)->getName(), make_pair(subtexture_width, subtexture_height)));
+		}
+	}
+
+	return true;
+}
+
+static void benchmarkGIAtlasPackerRun(const vector<pair<string, pair<unsigned int, unsigned int>>> &sizes, unsigned int max_texture_size, bool packer, BenchmarkGIAtlasPackerStats *stats) {
+	LibGens::GITextureGroup group;
+	group.setQualityLevel(0);
+	for (size_t i=0; i<sizes.size(); i++) {
+		LibGens::GISubtexture *subtexture = new LibGens::GISubtexture();
+		subtexture->setName(sizes[i].first);
+		subtexture->setPixelWidth(sizes[i].second.first);
+		subtexture->setPixelHeight(sizes[i].second.second);
+		group.addSubtextureToOrganize(subtexture);
+	}
+
+	BenchmarkTimer timer;
+	if (packer) group.packSubtextures(max_texture_size);
+	else group.organizeSubtextures(max_texture_size);
+	stats->time += timer.elapsedMilliseconds();
+
+	list<LibGens::GITexture *> textures = group.getTextures();
+	stats->atlases += textures.size();
+	for (list<LibGens::GITexture *>::iterator it=textures.begin(); it!=textures.end(); it++) {
+		unsigned int width = (*it)->getWidth();
+		unsigned int height = (*it)->getHeight();
+		stats->atlas_pixels += (unsigned long long) width * height;
+
+		list<LibGens::GISubtexture *> subtextures = (*it)->getSubtextures();
+		vector<LibGens::GISubtexture *> placed(subtextures.begin(), subtextures.end());
+		for (size_t i=0; i<placed.size(); i++) {
+			stats->subtextures++;
+			stats->subtexture_pixels += (unsigned long long) placed[i]->getPixelWidth() * placed[i]->getPixelHeight();
+
+			unsigned int x = placed[i]->getX() * width;
+			unsigned int y = placed[i]->getY() * height;
+			for (size_t j=i+1; j<placed.size(); j++) {
+				unsigned int other_x = placed[j]->getX() * width;
+				unsigned int other_y = placed[j]->getY() * height;
+				if ((x < other_x + placed[j]->getPixelWidth()) && (other_x < x + placed[i]->getPixelWidth()) &&
+					(y < other_y + placed[j]->getPixelHeight()) && (other_y < y + placed[i]->getPixelHeight())) {
+					stats->overlaps++;
+				}
+			}
+		}
+	}
+}
+
+static void benchmarkGIAtlasPackerPrint(const char *name, const BenchmarkGIAtlasPackerStats &stats) {
+	double fill_ratio = stats.atlas_pixels ? (double) stats.subtexture_pixels / (double) stats.atlas_pixels : 0.0;
+	printf("  %-12s %9.2f ms, %5zu atlases, %12llu atlas pixels, fill ratio %6.2f%%, %zu subtextures placed, %zu overlaps\n",
+		name, stats.time, stats.atlases, stats.atlas_pixels, fill_ratio * 100.0, stats.subtextures, stats.overlaps);
+}
+
+int benchmarkGIAtlasPacker(int argc, char** argv) {
+	if (argc < 2) {
+		printf("Usage: cmdtest bench-gi-atlas-packer gi-texture.gi-texture-group-info stage_folder [stage_add_folder] [max_texture_size]\n");
+		return 1;
+	}
+
+	string info_filename = ToString(argv[0]);
+	string stage_folder = ToString(argv[1]);
+	string stage_add_folder = (argc > 2) ? ToString(argv[2]) : stage_folder;
+	unsigned int max_texture_size = (argc > 3) ? atoi(argv[3]) : 2048;
+
+	LibGens::GITextureGroupInfo info(info_filename);
+	vector<LibGens::GITextureGroup *> groups = info.getGroups();
+
+	BenchmarkGIAtlasPackerStats tree_stats, packer_stats;
+	memset(&tree_stats, 0, sizeof(BenchmarkGIAtlasPackerStats));
+	memset(&packer_stats, 0, sizeof(BenchmarkGIAtlasPackerStats));
+	for (size_t g=0; g<groups.size(); g++) {
+		string folder = (groups[g]->getQualityLevel() == LIBGENS_GI_TEXTURE_GROUP_LOWEST_QUALITY) ? stage_folder : stage_add_folder;
+		string group_filename = folder + "/" + LIBGENS_GI_TEXTURE_GROUP_FOLDER_BEFORE + ToString(g) + LIBGENS_GI_TEXTURE_GROUP_FOLDER_AFTER;
+
+		vector<pair<string, pair<unsigned int, unsigned int>>> sizes;
+		if (!benchmarkGIAtlasPackerReadSizes(group_filename, &sizes)) {
+			printf("Couldn't read the atlasinfo of %s\n", group_filename.c_str());
+			continue;
+		}
+
+		unsigned int group_max_texture_size = max_texture_size;
+		for (size_t i=0; i<sizes.size(); i++) group_max_texture_size = max(group_max_texture_size, max(sizes[i].second.first, sizes[i].second.second));
+
+		benchmarkGIAtlasPackerRun(sizes, group_max_texture_size, false, &tree_stats);
+		benchmarkGIAtlasPackerRun(sizes, group_max_texture_size, true, &packer_stats);
+	}
+
+	printf("%zu groups, maximum atlas size %u\n", groups.size(), max_texture_size);
+	benchmarkGIAtlasPackerPrint("GITextureTree", tree_stats);
+	benchmarkGIAtlasPackerPrint("GIAtlasPacker", packer_stats);
+	return 0;
+}
@@ -0,0 +1,123 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "LibGens.h"
+#include "HavokEndianSwap.h"
+#include "Benchmark.h"
+
+static bool benchmarkHavokEndianSwapRead(string filename, vector<unsigned char> *data) {
+	if (!LibGens::File::check(filename)) return false;
+
+	LibGens::File file(filename, LIBGENS_FILE_READ_BINARY);
+	if (!file.valid()) return false;
+
+	data->resize(file.getFileSize());
+	file.read(data->data(), data->size());
+	file.close();
+	return true;
+}
+
+// Converts every big endian .hkx packfile of a folder to little endian, one after another and then as a
+// parallel batch, and checks that both give the same bytes. With a golden folder, the serial results are
+// also compared against the files of the same name in it, e.g. the output of a known good converter.
+int benchmarkHavokEndianSwap(int argc, char** argv) {
+	if (argc < 1) {
+		printf("Usage: bench-havok-endian-swap folder/ [golden_folder/]\n");
+		return 1;
+	}
+
+	string folder = ToString(argv[0]);
+	if (folder.size() && (folder[folder.size()-1] != '/') && (folder[folder.size()-1] != '\\')) folder += "/";
+
+	string golden_folder = "";
+	if (argc > 1) {
+		golden_folder = ToString(argv[1]);
+		if (golden_folder.size() && (golden_folder[golden_folder.size()-1] != '/') && (golden_folder[golden_folder.size()-1] != '\\')) golden_folder += "/";
+	}
+
+	vector<string> names;
+	WIN32_FIND_DATA FindFileData;
+	HANDLE hFind = FindFirstFile((folder+"*.hkx").c_str(), &FindFileData);
+	if (hFind != INVALID_HANDLE_VALUE) {
+		do {
+			const char *name=FindFileData.cFileName;
+			if (name[0]=='.') continue;
+			names.push_back(ToString(name));
+		} while (FindNextFile(hFind, &FindFileData) != 0);
+		FindClose(hFind);
+	}
+
+	if (names.empty()) {
+		printf("No .hkx files in %s\n", folder.c_str());
+		return 1;
+	}
+
+	BenchmarkTimer timer;
+	size_t total_bytes = 0;
+
+	timer.reset();
+	vector<vector<unsigned char>> results(names.size());
+	for (size_t i=0; i<names.size(); i++) {
+		LibGens::File file(folder + names[i], LIBGENS_FILE_READ_BINARY);
+		if (!file.valid()) continue;
+
+		total_bytes += file.getFileSize();
+		results[i] = LibGens::endianSwapHKX(&file);
+		file.close();
+	}
+	double serial_time = timer.elapsedMilliseconds();
+
+	vector<string> sources(names.size());
+	vector<string> destinations(names.size());
+	for (size_t i=0; i<names.size(); i++) {
+		sources[i] = folder + names[i];
+		destinations[i] = folder + names[i] + ".bench-swapped";
+	}
+
+	timer.reset();
+	bool batch_converted = LibGens::endianSwapHKX(sources, destinations);
+	double batch_time = timer.elapsedMilliseconds();
+
+	size_t batch_mismatches = 0;
+	size_t golden_mismatches = 0;
+	size_t golden_missing = 0;
+	for (size_t i=0; i<names.size(); i++) {
+		vector<unsigned char> data;
+		if (!benchmarkHavokEndianSwapRead(destinations[i], &data) || (data != results[i])) batch_mismatches++;
+		LibGens::File::remove(destinations[i]);
+
+		if (golden_folder.size()) {
+			if (!benchmarkHavokEndianSwapRead(golden_folder + names[i], &data)) golden_missing++;
+			else if (data != results[i]) {
+				printf("  %s differs from its golden file\n", names[i].c_str());
+				golden_mismatches++;
+			}
+		}
+	}
+
+	printf("%zu packfiles, %zu bytes\n", names.size(), total_bytes);
+	printf("  serial               %9.2f ms  %8.2f MB/s\n", serial_time, benchmarkMegabytesPerSecond(total_bytes, serial_time));
+	printf("  batch, %2u threads    %9.2f ms  %8.2f MB/s\n", LibGens::Parallel::getThreadCount(), batch_time, benchmarkMegabytesPerSecond(total_bytes, batch_time));
+	printf("  batch                %s (%zu mismatches)\n", batch_converted ? "converted" : "FAILED", batch_mismatches);
+	if (golden_folder.size()) {
+		printf("  golden               %zu mismatches, %zu missing\n", golden_mismatches, golden_missing);
+	}
+
+	return (batch_converted && !batch_mismatches && !golden_mismatches && !golden_missing) ? 0 : 2;
+}
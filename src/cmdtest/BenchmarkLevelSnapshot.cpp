@@ -0,0 +1,135 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "LibGens.h"
+#include "Level.h"
+#include "Object.h"
+#include "ObjectSet.h"
+#include "Path.h"
+#include "Benchmark.h"
+
+// Everything a level would write back out through the XML writers, as one string.
+static string benchmarkLevelSnapshotXML(LibGens::Level *level) {
+	string result="";
+
+	list<LibGens::ObjectSet *> sets=level->getSets();
+	for (list<LibGens::ObjectSet *>::iterator it=sets.begin(); it!=sets.end(); it++) {
+		TiXmlElement root(LIBGENS_OBJECT_SET_ROOT);
+		list<LibGens::Object *> objects=(*it)->getObjects();
+		for (list<LibGens::Object *>::iterator obj=objects.begin(); obj!=objects.end(); obj++) {
+			(*obj)->writeXML(&root);
+		}
+
+		TiXmlPrinter printer;
+		root.Accept(&printer);
+		result += (*it)->getName() + " " + (*it)->getFilename() + "\n" + printer.Str();
+	}
+
+	list<LibGens::Path *> paths=level->getPaths();
+	for (list<LibGens::Path *>::iterator it=paths.begin(); it!=paths.end(); it++) {
+		TiXmlElement root(LIBGENS_PATH_XML_ROOT);
+		if ((*it)->getLibrary()) (*it)->getLibrary()->writeXML(&root);
+		if ((*it)->getScene()) (*it)->getScene()->writeXML(&root);
+
+		TiXmlPrinter printer;
+		root.Accept(&printer);
+		result += printer.Str();
+	}
+
+	LibGens::SceneEffect &scene_effect=level->getSceneEffect();
+	float scene_effect_values[]={ scene_effect.light_scattering_color.r, scene_effect.light_scattering_color.g, scene_effect.light_scattering_color.b,
+		scene_effect.light_scattering_depth_scale, scene_effect.light_scattering_in_scattering_scale, scene_effect.light_scattering_rayleigh,
+		scene_effect.light_scattering_mie, scene_effect.light_scattering_g, scene_effect.light_scattering_z_near, scene_effect.light_scattering_z_far,
+		scene_effect.sky_follow_up_ratio_y, scene_effect.sky_intensity_scale };
+	for (size_t i=0; i<sizeof(scene_effect_values)/sizeof(float); i++) {
+		result += ToString(scene_effect_values[i]) + " ";
+	}
+
+	list<LibGens::LevelCollisionEntry *> collision_entries=level->getCollisionEntries();
+	for (list<LibGens::LevelCollisionEntry *>::iterator it=collision_entries.begin(); it!=collision_entries.end(); it++) {
+		result += "\n" + (*it)->name + ((*it)->rendering ? " true" : " false");
+	}
+
+	list<LibGens::LevelSetEntry *> set_entries=level->getSetEntries();
+	for (list<LibGens::LevelSetEntry *>::iterator it=set_entries.begin(); it!=set_entries.end(); it++) {
+		result += "\n" + (*it)->name + " " + (*it)->color + " " + (*it)->filename + " " + ToString((*it)->index) + ((*it)->active ? " true" : " false");
+	}
+
+	LibGens::Vector3 spawn_position=level->getSpawnPosition();
+	result += "\n" + level->getSpawnType() + " " + ToString(level->getSpawnYaw()) + " " + ToString(level->getSpawnDeadHeight()) + " " + level->getSpawnCameraView() + " " +
+		ToString(spawn_position.x) + " " + ToString(spawn_position.y) + " " + ToString(spawn_position.z) + " " + level->getSpawnMode() + " " +
+		ToString(level->getSpawnSpeed()) + " " + ToString(level->getSpawnTime());
+
+	result += "\n" + level->getTerrainInfo() + " " + level->getDirectLight() + " " + level->getSkybox() + "\n";
+	return result;
+}
+
+// Opens a stage folder (an unpacked #Stage.ar) the way the editor does, from the XML files and then from
+// the binary snapshot written on the first open, and checks that the last open really came from the snapshot
+// and that both write back out the same XML, spawn and set entries.
+int benchmarkLevelSnapshot(int argc, char** argv) {
+	if (argc < 1) {
+		printf("Usage: bench-level-snapshot stage_folder/ [Unleashed]\n");
+		return 1;
+	}
+
+	string folder = ToString(argv[0]);
+	if (folder.size() && (folder[folder.size()-1] != '/') && (folder[folder.size()-1] != '\\')) folder += "/";
+
+	size_t game_mode = LIBGENS_LEVEL_GAME_GENERATIONS;
+	if ((argc > 1) && (ToString(argv[1]) == LIBGENS_LEVEL_GAME_STRING_UNLEASHED)) game_mode = LIBGENS_LEVEL_GAME_UNLEASHED;
+
+	string snapshot_filename = folder + "bench-level.snapshot";
+	if (LibGens::File::check(snapshot_filename)) {
+		LibGens::File::remove(snapshot_filename);
+	}
+
+	BenchmarkTimer timer;
+
+	timer.reset();
+	LibGens::Level xml_level(folder, game_mode);
+	double xml_time = timer.elapsedMilliseconds();
+
+	timer.reset();
+	LibGens::Level cold_level(folder, game_mode, snapshot_filename);
+	double cold_time = timer.elapsedMilliseconds();
+
+	timer.reset();
+	LibGens::Level warm_level(folder, game_mode, snapshot_filename);
+	double warm_time = timer.elapsedMilliseconds();
+
+	size_t object_count = 0;
+	list<LibGens::ObjectSet *> sets = warm_level.getSets();
+	for (list<LibGens::ObjectSet *>::iterator it=sets.begin(); it!=sets.end(); it++) {
+		object_count += (*it)->getObjects().size();
+	}
+
+	string xml = benchmarkLevelSnapshotXML(&xml_level);
+	bool identical = (xml == benchmarkLevelSnapshotXML(&warm_level));
+	bool snapshot_hit = !cold_level.isFromSnapshot() && warm_level.isFromSnapshot();
+
+	printf("%zu sets, %zu objects, %zu paths\n", sets.size(), object_count, warm_level.getPaths().size());
+	printf("  XML                  %9.2f ms\n", xml_time);
+	printf("  XML, write snapshot  %9.2f ms\n", cold_time);
+	printf("  snapshot             %9.2f ms (%s)\n", warm_time, snapshot_hit ? "loaded from snapshot" : "SNAPSHOT NOT USED");
+	printf("  round trip           %s (%zu bytes of XML)\n", identical ? "identical" : "DIFFERENT", xml.size());
+
+	LibGens::File::remove(snapshot_filename);
+	return (snapshot_hit && identical) ? 0 : 2;
+}
@@ -0,0 +1,145 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "LibGens.h"
+#include "LightField.h"
+#include "Benchmark.h"
+#include <random>
+
+#define BENCHMARK_LIGHTFIELD_SAMPLING_DEFAULT_POINTS 1000000
+
+// Samples by walking the LightFieldCube tree and its SamplingPoint corners directly.
+static LibGens::LightFieldSample benchmarkLightFieldSamplingTree(LibGens::LightField *light_field, LibGens::Vector3 position) {
+	LibGens::AABB world=light_field->getAABB();
+	position.x = max(world.start.x, min(world.end.x, position.x));
+	position.y = max(world.start.y, min(world.end.y, position.y));
+	position.z = max(world.start.z, min(world.end.z, position.z));
+
+	LibGens::LightFieldCube *cube=light_field->getCube();
+	while (cube && (cube->getType() <= LIBGENS_LIGHTFIELD_CUBE_Z_SPLIT) && cube->getLeft() && cube->getRight()) {
+		LibGens::AABB aabb=cube->getAABB();
+		float coordinate=(cube->getType() == LIBGENS_LIGHTFIELD_CUBE_X_SPLIT) ? position.x : ((cube->getType() == LIBGENS_LIGHTFIELD_CUBE_Y_SPLIT) ? position.y : position.z);
+		float center=(cube->getType() == LIBGENS_LIGHTFIELD_CUBE_X_SPLIT) ? aabb.centerX() : ((cube->getType() == LIBGENS_LIGHTFIELD_CUBE_Y_SPLIT) ? aabb.centerY() : aabb.centerZ());
+		cube = (coordinate < center) ? cube->getLeft() : cube->getRight();
+	}
+
+	LibGens::AABB aabb=(cube ? cube->getAABB() : world);
+	float weights[3]={
+		(aabb.sizeX() > 0.0f) ? (position.x - aabb.start.x) / (aabb.end.x - aabb.start.x) : 0.0f,
+		(aabb.sizeY() > 0.0f) ? (position.y - aabb.start.y) / (aabb.end.y - aabb.start.y) : 0.0f,
+		(aabb.sizeZ() > 0.0f) ? (position.z - aabb.start.z) / (aabb.end.z - aabb.start.z) : 0.0f
+	};
+
+	LibGens::LightFieldSample result;
+	for (size_t j=0; j<LIBGENS_LIGHTFIELD_CORNER_COUNT; j++) {
+		float weight=((j & 1) ? weights[0] : 1.0f - weights[0]) * ((j & 2) ? weights[1] : 1.0f - weights[1]) * ((j & 4) ? weights[2] : 1.0f - weights[2]) / 255.0f;
+		LibGens::SamplingPoint *corner=(cube ? cube->getCorner(j) : NULL);
+		LibGens::ColorPoint color=((corner && corner->color) ? *corner->color : LibGens::ColorPoint());
+
+		for (size_t x=0; x<8; x++) {
+			for (size_t y=0; y<3; y++) {
+				result.rgb[x][y] += color.rgb[x][y] * weight;
+			}
+		}
+		result.flag += color.flag * weight;
+	}
+
+	return result;
+}
+
+static float benchmarkLightFieldSamplingDifference(const LibGens::LightFieldSample &a, const LibGens::LightFieldSample &b) {
+	float difference=fabs(a.flag - b.flag);
+	for (size_t x=0; x<8; x++) {
+		for (size_t y=0; y<3; y++) {
+			difference = max(difference, (float) fabs(a.rgb[x][y] - b.rgb[x][y]));
+		}
+	}
+	return difference;
+}
+
+// Samples random points of a .lft light field through the cube tree, through LightFieldSampler one at a
+// time and as one parallel batch, and reports the largest difference between the results.
+int benchmarkLightFieldSampling(int argc, char** argv) {
+	if (argc < 1) {
+		printf("Usage: bench-lightfield-sampling file.lft [points]\n");
+		return 1;
+	}
+
+	string filename = ToString(argv[0]);
+	size_t count = (argc > 1) ? atoi(argv[1]) : BENCHMARK_LIGHTFIELD_SAMPLING_DEFAULT_POINTS;
+
+	if (!LibGens::File::check(filename)) {
+		printf("Couldn't open %s\n", filename.c_str());
+		return 1;
+	}
+
+	BenchmarkTimer timer;
+	LibGens::LightField light_field(filename);
+	double load_time = timer.elapsedMilliseconds();
+
+	timer.reset();
+	LibGens::LightFieldSampler sampler(&light_field);
+	double compile_time = timer.elapsedMilliseconds();
+
+	// Points spread a little past the light field, so clamping is covered too
+	LibGens::AABB world = light_field.getAABB();
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> unit(-0.05f, 1.05f);
+	vector<LibGens::Vector3> positions(count);
+	for (size_t i=0; i<count; i++) {
+		positions[i] = LibGens::Vector3(world.start.x + unit(random) * world.sizeX(), world.start.y + unit(random) * world.sizeY(), world.start.z + unit(random) * world.sizeZ());
+	}
+
+	vector<LibGens::LightFieldSample> tree_samples(count);
+	vector<LibGens::LightFieldSample> single_samples(count);
+	vector<LibGens::LightFieldSample> batch_samples(count);
+
+	timer.reset();
+	for (size_t i=0; i<count; i++) {
+		tree_samples[i] = benchmarkLightFieldSamplingTree(&light_field, positions[i]);
+	}
+	double tree_time = timer.elapsedMilliseconds();
+
+	timer.reset();
+	for (size_t i=0; i<count; i++) {
+		single_samples[i] = sampler.sample(positions[i]);
+	}
+	double single_time = timer.elapsedMilliseconds();
+
+	timer.reset();
+	sampler.sample(positions.data(), positions.size(), batch_samples.data());
+	double batch_time = timer.elapsedMilliseconds();
+
+	float tree_difference = 0.0f;
+	float batch_difference = 0.0f;
+	for (size_t i=0; i<count; i++) {
+		tree_difference = max(tree_difference, benchmarkLightFieldSamplingDifference(tree_samples[i], single_samples[i]));
+		batch_difference = max(batch_difference, benchmarkLightFieldSamplingDifference(batch_samples[i], single_samples[i]));
+	}
+
+	printf("%zu nodes, %zu palette colors, %zu points\n", sampler.getNodeCount(), sampler.getPaletteSize(), count);
+	printf("  load                 %9.2f ms\n", load_time);
+	printf("  compile              %9.2f ms\n", compile_time);
+	printf("  cube tree            %9.2f ms\n", tree_time);
+	printf("  sampler              %9.2f ms\n", single_time);
+	printf("  sampler, %2d threads  %9.2f ms\n", LibGens::Parallel::getThreadCount(), batch_time);
+	printf("  largest difference   %g to the cube tree, %g to the batch\n", tree_difference, batch_difference);
+
+	return ((tree_difference == 0.0f) && (batch_difference == 0.0f)) ? 0 : 2;
+}
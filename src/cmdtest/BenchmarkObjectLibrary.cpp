@@ -0,0 +1,119 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "LibGens.h"
+#include "Object.h"
+#include "ObjectCategory.h"
+#include "ObjectLibrary.h"
+#include "Benchmark.h"
+
+static size_t benchmarkObjectLibraryTemplateCount(LibGens::ObjectLibrary *library) {
+	size_t count = 0;
+	vector<LibGens::ObjectCategory *> categories = library->getCategories();
+	for (size_t c=0; c<categories.size(); c++) {
+		count += categories[c]->getTemplates().size();
+	}
+	return count;
+}
+
+// Loads an object database the way the editor does at startup: cold on one thread, cold in parallel,
+// cold while writing the compiled cache, and warm from the cache. Then times a template lookup for every
+// template name through the library index against the category-by-category list scan it replaces.
+int benchmarkObjectLibrary(int argc, char** argv) {
+	if (argc < 2) {
+		printf("Usage: bench-object-library GenerationsObjectsDatabase.xml objects_folder/\n");
+		return 1;
+	}
+
+	string database = ToString(argv[0]);
+	string folder = ToString(argv[1]);
+	string cache_filename = LibGens::ObjectLibrary::getCacheFilename(database);
+	if (LibGens::File::check(cache_filename)) {
+		LibGens::File::remove(cache_filename);
+	}
+
+	unsigned int thread_count = LibGens::Parallel::getThreadCount();
+	BenchmarkTimer timer;
+
+	LibGens::Parallel::setThreadCount(1);
+	timer.reset();
+	LibGens::ObjectLibrary serial_library(folder);
+	serial_library.loadDatabase(database, false);
+	double serial_time = timer.elapsedMilliseconds();
+	LibGens::Parallel::setThreadCount(thread_count);
+
+	timer.reset();
+	LibGens::ObjectLibrary parallel_library(folder);
+	parallel_library.loadDatabase(database, false);
+	double parallel_time = timer.elapsedMilliseconds();
+
+	timer.reset();
+	LibGens::ObjectLibrary cold_library(folder);
+	cold_library.loadDatabase(database);
+	double cold_time = timer.elapsedMilliseconds();
+
+	timer.reset();
+	LibGens::ObjectLibrary warm_library(folder);
+	warm_library.loadDatabase(database);
+	double warm_time = timer.elapsedMilliseconds();
+
+	size_t template_count = benchmarkObjectLibraryTemplateCount(&warm_library);
+	printf("%zu categories, %zu templates (%zu parsed)\n", warm_library.getCategories().size(), template_count, benchmarkObjectLibraryTemplateCount(&parallel_library));
+	printf("  cold, 1 thread    %9.2f ms\n", serial_time);
+	printf("  cold, %2u threads  %9.2f ms\n", LibGens::Parallel::getThreadCount(), parallel_time);
+	printf("  cold, write cache %9.2f ms\n", cold_time);
+	printf("  warm, from cache  %9.2f ms\n", warm_time);
+
+	vector<string> names;
+	vector<LibGens::ObjectCategory *> categories = warm_library.getCategories();
+	for (size_t c=0; c<categories.size(); c++) {
+		vector<LibGens::Object *> templates = categories[c]->getTemplates();
+		for (size_t i=0; i<templates.size(); i++) {
+			names.push_back(templates[i]->getName());
+		}
+	}
+
+	timer.reset();
+	size_t scan_found = 0;
+	for (size_t n=0; n<names.size(); n++) {
+		bool found = false;
+		for (size_t c=0; (c<categories.size()) && !found; c++) {
+			vector<LibGens::Object *> templates = categories[c]->getTemplates();
+			for (size_t i=0; i<templates.size(); i++) {
+				if (templates[i]->getName() == names[n]) {
+					found = true;
+					break;
+				}
+			}
+		}
+		if (found) scan_found++;
+	}
+	double scan_time = timer.elapsedMilliseconds();
+
+	timer.reset();
+	size_t index_found = 0;
+	for (size_t n=0; n<names.size(); n++) {
+		if (warm_library.getTemplate(names[n])) index_found++;
+	}
+	double index_time = timer.elapsedMilliseconds();
+
+	printf("  lookup, list scan %9.2f ms (%zu found)\n", scan_time, scan_found);
+	printf("  lookup, index     %9.2f ms (%zu found)\n", index_time, index_found);
+	return 0;
+}
@@ -0,0 +1,87 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "LibGens.h"
+#include "PAC.h"
+#include "StringTable.h"
+#include "Benchmark.h"
+
+#define BENCHMARK_PAC_ITERATIONS          5
+#define BENCHMARK_STRING_TABLE_REFERENCES 200000
+#define BENCHMARK_STRING_TABLE_UNIQUE     40000
+
+// Names shaped like the ones in a stage pac: many unique resources, each referenced several times.
+static void benchmarkStringTable() {
+	vector<string> names(BENCHMARK_STRING_TABLE_REFERENCES);
+	for (size_t i=0; i<names.size(); i++) {
+		char name[64];
+		sprintf(name, "w1a01_terrain_block_%05u", (unsigned int) ((i * 7919) % BENCHMARK_STRING_TABLE_UNIQUE));
+		names[i] = (i % 50) ? name : "";
+	}
+
+	double best_time = 0.0;
+	size_t string_count = 0;
+	for (size_t i=0; i<BENCHMARK_PAC_ITERATIONS; i++) {
+		LibGens::File file;
+		LibGens::GensStringTable table;
+
+		BenchmarkTimer timer;
+		for (size_t n=0; n<names.size(); n++) {
+			table.writeString(&file, names[n]);
+		}
+		table.write(&file, false);
+		file.sortAddressTable();
+		double time = timer.elapsedMilliseconds();
+
+		string_count = table.getStringCount();
+		if (!i || (time < best_time)) best_time = time;
+	}
+
+	printf("string table: %9.2f ms (%u references, %u unique strings)\n", best_time, BENCHMARK_STRING_TABLE_REFERENCES, (unsigned int) string_count);
+}
+
+int benchmarkPacSave(int argc, char** argv) {
+	benchmarkStringTable();
+
+	if (argc < 2) {
+		printf("Usage: cmdtest bench-pac-save input.pac output.pac\n");
+		return 1;
+	}
+
+	string input_filename = ToString(argv[0]);
+	string output_filename = ToString(argv[1]);
+
+	BenchmarkTimer timer;
+	LibGens::PacSet set(input_filename);
+	double read_time = timer.elapsedMilliseconds();
+	size_t file_count = set.getFileList().size();
+
+	double best_save_time = 0.0;
+	for (size_t i=0; i<BENCHMARK_PAC_ITERATIONS; i++) {
+		timer.reset();
+		set.save(output_filename);
+		double save_time = timer.elapsedMilliseconds();
+
+		if (!i || (save_time < best_save_time)) best_save_time = save_time;
+	}
+
+	printf("PacSet read:  %9.2f ms (%u files)\n", read_time, (unsigned int) file_count);
+	printf("PacSet save:  %9.2f ms (best of %d)\n", best_save_time, BENCHMARK_PAC_ITERATIONS);
+	return 0;
+}
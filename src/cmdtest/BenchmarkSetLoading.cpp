@@ -0,0 +1,149 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "LibGens.h"
+#include "Object.h"
+#include "ObjectSet.h"
+#include "XMLReader.h"
+#include "Benchmark.h"
+
+static void benchmarkSetLoadingCollectTexts(LibGens::XMLReader *reader, vector<string> *texts) {
+	size_t depth=reader->getDepth();
+	while (reader->nextChild(depth)) {
+		string text;
+		if (reader->readText(&text)) texts->push_back(text);
+		else benchmarkSetLoadingCollectTexts(reader, texts);
+	}
+}
+
+// Loads every setdata_*.set.xml of a stage folder the way Level::loadSets does, on one thread and in
+// parallel, next to a TinyXML pass that only builds the document trees the old loader started from.
+// Then parses the text of every leaf element as a float through stream extraction and through
+// XMLReader::parseFloat, and counts the values that differ.
+int benchmarkSetLoading(int argc, char** argv) {
+	if (argc < 1) {
+		printf("Usage: bench-set-loading stage_folder/\n");
+		return 1;
+	}
+
+	string folder = ToString(argv[0]);
+	if (folder.size() && (folder[folder.size()-1] != '/') && (folder[folder.size()-1] != '\\')) folder += "/";
+
+	vector<string> filenames;
+	WIN32_FIND_DATA FindFileData;
+	HANDLE hFind = FindFirstFile((folder+"setdata_*.set.xml").c_str(), &FindFileData);
+	if (hFind != INVALID_HANDLE_VALUE) {
+		do {
+			const char *name=FindFileData.cFileName;
+			if (name[0]=='.') continue;
+			filenames.push_back(folder+ToString(name));
+		} while (FindNextFile(hFind, &FindFileData) != 0);
+		FindClose(hFind);
+	}
+
+	if (filenames.empty()) {
+		printf("No setdata_*.set.xml files found in %s\n", folder.c_str());
+		return 1;
+	}
+
+	unsigned int thread_count = LibGens::Parallel::getThreadCount();
+	BenchmarkTimer timer;
+
+	timer.reset();
+	size_t dom_objects = 0;
+	for (size_t i=0; i<filenames.size(); i++) {
+		TiXmlDocument doc(filenames[i]);
+		if (!doc.LoadFile()) continue;
+		TiXmlElement *root=doc.FirstChildElement();
+		if (!root) continue;
+		for (TiXmlElement *element=root->FirstChildElement(); element; element=element->NextSiblingElement()) {
+			dom_objects++;
+		}
+	}
+	double dom_time = timer.elapsedMilliseconds();
+
+	vector<LibGens::ObjectSet *> sets(filenames.size(), NULL);
+	LibGens::Parallel::setThreadCount(1);
+	timer.reset();
+	LibGens::Parallel::forEach(filenames.size(), [&](size_t i) {
+		sets[i] = new LibGens::ObjectSet(filenames[i]);
+	});
+	double serial_time = timer.elapsedMilliseconds();
+	LibGens::Parallel::setThreadCount(thread_count);
+
+	size_t object_count = 0;
+	for (size_t i=0; i<sets.size(); i++) {
+		object_count += sets[i]->getObjects().size();
+		delete sets[i];
+	}
+
+	timer.reset();
+	LibGens::Parallel::forEach(filenames.size(), [&](size_t i) {
+		sets[i] = new LibGens::ObjectSet(filenames[i]);
+	});
+	double parallel_time = timer.elapsedMilliseconds();
+
+	for (size_t i=0; i<sets.size(); i++) {
+		delete sets[i];
+	}
+
+	printf("%zu set files, %zu objects (%zu elements in the TinyXML trees)\n", filenames.size(), object_count, dom_objects);
+	printf("  TinyXML, trees only %9.2f ms\n", dom_time);
+	printf("  reader, 1 thread    %9.2f ms\n", serial_time);
+	printf("  reader, %2u threads  %9.2f ms\n", LibGens::Parallel::getThreadCount(), parallel_time);
+
+	vector<string> texts;
+	for (size_t i=0; i<filenames.size(); i++) {
+		LibGens::File file(filenames[i], LIBGENS_FILE_READ_BINARY);
+		size_t size=0;
+		const char *data=(const char *) file.getMemoryData(&size);
+		if (!data) continue;
+
+		LibGens::XMLReader reader(data, size);
+		if (reader.nextChild(0)) benchmarkSetLoadingCollectTexts(&reader, &texts);
+	}
+
+	vector<float> stream_values(texts.size(), 0.0f);
+	vector<float> reader_values(texts.size(), 0.0f);
+
+	timer.reset();
+	for (size_t i=0; i<texts.size(); i++) {
+		FromString<float>(stream_values[i], texts[i], std::dec);
+	}
+	double stream_time = timer.elapsedMilliseconds();
+
+	timer.reset();
+	for (size_t i=0; i<texts.size(); i++) {
+		LibGens::XMLReader::parseFloat(texts[i].c_str(), texts[i].c_str() + texts[i].size(), &reader_values[i]);
+	}
+	double parse_time = timer.elapsedMilliseconds();
+
+	size_t mismatches = 0;
+	for (size_t i=0; i<texts.size(); i++) {
+		if (memcmp(&stream_values[i], &reader_values[i], sizeof(float))) {
+			if (mismatches < 10) printf("  mismatch: \"%s\" stream %.9g, reader %.9g\n", texts[i].c_str(), stream_values[i], reader_values[i]);
+			mismatches++;
+		}
+	}
+
+	printf("%zu leaf texts\n", texts.size());
+	printf("  floats, stream      %9.2f ms\n", stream_time);
+	printf("  floats, parseFloat  %9.2f ms (%zu mismatches)\n", parse_time, mismatches);
+	return mismatches ? 2 : 0;
+}
@@ -0,0 +1,225 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "LibGens.h"
+#include "Terrain.h"
+#include "TerrainInstance.h"
+#include "SpatialIndex.h"
+#include "Benchmark.h"
+#include <random>
+#include <cfloat>
+
+#define BENCHMARK_SPATIAL_INDEX_DEFAULT_COUNT   20000
+#define BENCHMARK_SPATIAL_INDEX_QUERIES         1000
+#define BENCHMARK_SPATIAL_INDEX_STAGE_SIZE      10000.0f
+#define BENCHMARK_SPATIAL_INDEX_QUERY_RADIUS    500.0f
+#define BENCHMARK_SPATIAL_INDEX_VIEW_DISTANCE   2000.0f
+
+static bool benchmarkSpatialIndexSphere(const LibGens::AABB &aabb, LibGens::Vector3 center, float radius) {
+	float x = max(max(aabb.start.x - center.x, 0.0f), center.x - aabb.end.x);
+	float y = max(max(aabb.start.y - center.y, 0.0f), center.y - aabb.end.y);
+	float z = max(max(aabb.start.z - center.z, 0.0f), center.z - aabb.end.z);
+	return (x*x + y*y + z*z) <= (radius * radius);
+}
+
+static bool benchmarkSpatialIndexRay(const LibGens::AABB &aabb, LibGens::Vector3 origin, LibGens::Vector3 direction, float max_distance) {
+	float origins[3] = { origin.x, origin.y, origin.z };
+	float directions[3] = { direction.x, direction.y, direction.z };
+	float starts[3] = { aabb.start.x, aabb.start.y, aabb.start.z };
+	float ends[3] = { aabb.end.x, aabb.end.y, aabb.end.z };
+
+	float near_t = -FLT_MAX;
+	float far_t = FLT_MAX;
+	for (int axis=0; axis<3; axis++) {
+		float t1 = (starts[axis] - origins[axis]) / directions[axis];
+		float t2 = (ends[axis] - origins[axis]) / directions[axis];
+		near_t = max(near_t, min(t1, t2));
+		far_t = min(far_t, max(t1, t2));
+	}
+	return (far_t >= 0.0f) && (near_t <= far_t) && (near_t <= max_distance);
+}
+
+// 90 degree frustum looking along a horizontal direction
+static LibGens::Frustum benchmarkSpatialIndexFrustum(LibGens::Vector3 position, float angle) {
+	LibGens::Vector3 forward(cos(angle), 0.0f, sin(angle));
+	LibGens::Vector3 right(-sin(angle), 0.0f, cos(angle));
+	LibGens::Vector3 up(0.0f, 1.0f, 0.0f);
+
+	LibGens::Frustum frustum;
+	LibGens::Vector3 normals[4] = { forward + right, forward - right, forward + up, forward - up };
+	for (int i=0; i<4; i++) frustum.setPlane(i, normals[i], -normals[i].dotProduct(position));
+	frustum.setPlane(4, forward, -forward.dotProduct(position) - 0.1f);
+	frustum.setPlane(5, forward * -1.0f, forward.dotProduct(position) + BENCHMARK_SPATIAL_INDEX_VIEW_DISTANCE);
+	return frustum;
+}
+
+// Compares SpatialIndex sphere, frustum and ray queries with a linear scan over every box, like
+// Terrain::getInstances followed by a distance check. Uses the instances of a stage when one is
+// given, or random boxes spread over a stage sized area otherwise.
+int benchmarkSpatialIndex(int argc, char** argv) {
+	size_t count = BENCHMARK_SPATIAL_INDEX_DEFAULT_COUNT;
+	if (argc == 1) count = atoi(argv[0]);
+	else if ((argc != 0) && (argc < 3)) {
+		printf("Usage: bench-spatial-index [instance_count]\n");
+		printf("       bench-spatial-index terrain.terrain groups_folder resources_folder [terrain_folder]\n");
+		return 1;
+	}
+
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	vector<void *> objects;
+	vector<LibGens::AABB> boxes;
+	LibGens::Terrain *terrain = NULL;
+	LibGens::AABB world;
+
+	if (argc >= 3) {
+		terrain = new LibGens::Terrain(argv[0], argv[1], argv[2], (argc > 3) ? argv[3] : "", "", true);
+		list<LibGens::TerrainInstance *> instances = terrain->getInstances();
+		for (list<LibGens::TerrainInstance *>::iterator it=instances.begin(); it!=instances.end(); it++) {
+			objects.push_back(*it);
+			boxes.push_back((*it)->getAABB());
+			world.merge((*it)->getAABB());
+		}
+	}
+	else {
+		for (size_t i=0; i<count; i++) {
+			LibGens::Vector3 center(unit(random) * BENCHMARK_SPATIAL_INDEX_STAGE_SIZE, unit(random) * BENCHMARK_SPATIAL_INDEX_STAGE_SIZE * 0.1f, unit(random) * BENCHMARK_SPATIAL_INDEX_STAGE_SIZE);
+			LibGens::AABB aabb;
+			aabb.addPoint(center);
+			aabb.expand(1.0f + unit(random) * unit(random) * 50.0f);
+			objects.push_back((void *)(i + 1));
+			boxes.push_back(aabb);
+			world.merge(aabb);
+		}
+	}
+
+	if (objects.empty()) {
+		printf("No instances to index\n");
+		return 1;
+	}
+
+	printf("%zu boxes\n", objects.size());
+
+	BenchmarkTimer timer;
+	LibGens::SpatialIndex index;
+	index.build(objects, boxes);
+	printf("Build:       %9.2f ms, height %d\n", timer.elapsedMilliseconds(), index.getHeight());
+
+	timer.reset();
+	LibGens::SpatialIndex incremental_index;
+	for (size_t i=0; i<objects.size(); i++) incremental_index.insert(objects[i], boxes[i]);
+	printf("Insert:      %9.2f ms, height %d\n", timer.elapsedMilliseconds(), incremental_index.getHeight());
+
+	// Query positions inside the stage
+	vector<LibGens::Vector3> positions;
+	vector<float> angles;
+	for (size_t q=0; q<BENCHMARK_SPATIAL_INDEX_QUERIES; q++) {
+		positions.push_back(LibGens::Vector3(world.start.x + unit(random) * world.sizeX(), world.start.y + unit(random) * world.sizeY(), world.start.z + unit(random) * world.sizeZ()));
+		angles.push_back(unit(random) * 6.2831853f);
+	}
+
+	vector<void *> results;
+	size_t linear_hits = 0;
+	size_t index_hits = 0;
+	double linear_time = 0.0;
+	double index_time = 0.0;
+
+	// Sphere
+	timer.reset();
+	for (size_t q=0; q<positions.size(); q++) {
+		for (size_t i=0; i<boxes.size(); i++) {
+			if (benchmarkSpatialIndexSphere(boxes[i], positions[q], BENCHMARK_SPATIAL_INDEX_QUERY_RADIUS)) linear_hits++;
+		}
+	}
+	linear_time = timer.elapsedMilliseconds();
+
+	timer.reset();
+	for (size_t q=0; q<positions.size(); q++) {
+		results.clear();
+		index.querySphere(positions[q], BENCHMARK_SPATIAL_INDEX_QUERY_RADIUS, &results);
+		index_hits += results.size();
+	}
+	index_time = timer.elapsedMilliseconds();
+	printf("Sphere:      linear %9.4f ms, index %9.4f ms per query (%.1fx), %zu / %zu hits\n", linear_time / positions.size(), index_time / positions.size(),
+		index_time > 0.0 ? linear_time / index_time : 0.0, index_hits, linear_hits);
+
+	// Frustum
+	linear_hits = index_hits = 0;
+	timer.reset();
+	for (size_t q=0; q<positions.size(); q++) {
+		LibGens::Frustum frustum = benchmarkSpatialIndexFrustum(positions[q], angles[q]);
+		for (size_t i=0; i<boxes.size(); i++) {
+			if (frustum.intersects(boxes[i])) linear_hits++;
+		}
+	}
+	linear_time = timer.elapsedMilliseconds();
+
+	timer.reset();
+	for (size_t q=0; q<positions.size(); q++) {
+		LibGens::Frustum frustum = benchmarkSpatialIndexFrustum(positions[q], angles[q]);
+		results.clear();
+		index.queryFrustum(frustum, &results);
+		index_hits += results.size();
+	}
+	index_time = timer.elapsedMilliseconds();
+	printf("Frustum:     linear %9.4f ms, index %9.4f ms per query (%.1fx), %zu / %zu hits\n", linear_time / positions.size(), index_time / positions.size(),
+		index_time > 0.0 ? linear_time / index_time : 0.0, index_hits, linear_hits);
+
+	// Picking ray
+	linear_hits = index_hits = 0;
+	timer.reset();
+	for (size_t q=0; q<positions.size(); q++) {
+		LibGens::Vector3 direction(cos(angles[q]), -0.1f, sin(angles[q]));
+		for (size_t i=0; i<boxes.size(); i++) {
+			if (benchmarkSpatialIndexRay(boxes[i], positions[q], direction, BENCHMARK_SPATIAL_INDEX_VIEW_DISTANCE)) linear_hits++;
+		}
+	}
+	linear_time = timer.elapsedMilliseconds();
+
+	timer.reset();
+	for (size_t q=0; q<positions.size(); q++) {
+		LibGens::Vector3 direction(cos(angles[q]), -0.1f, sin(angles[q]));
+		results.clear();
+		index.queryRay(positions[q], direction, BENCHMARK_SPATIAL_INDEX_VIEW_DISTANCE, &results);
+		index_hits += results.size();
+	}
+	index_time = timer.elapsedMilliseconds();
+	printf("Ray:         linear %9.4f ms, index %9.4f ms per query (%.1fx), %zu / %zu hits\n", linear_time / positions.size(), index_time / positions.size(),
+		index_time > 0.0 ? linear_time / index_time : 0.0, index_hits, linear_hits);
+
+	// Move a tenth of the boxes a little, then a tenth by a lot
+	size_t moved = objects.size() / 10;
+	float distances[2] = { 0.5f, 200.0f };
+	for (int pass=0; pass<2; pass++) {
+		size_t reinserted = 0;
+		timer.reset();
+		for (size_t m=0; m<moved; m++) {
+			size_t i = random() % objects.size();
+			LibGens::Vector3 offset((unit(random) - 0.5f) * distances[pass], (unit(random) - 0.5f) * distances[pass], (unit(random) - 0.5f) * distances[pass]);
+			boxes[i].start = boxes[i].start + offset;
+			boxes[i].end = boxes[i].end + offset;
+			if (index.update(objects[i], boxes[i])) reinserted++;
+		}
+		printf("Update:      %zu boxes by up to %.1f units in %9.2f ms, %zu reinserted, height %d\n", moved, distances[pass], timer.elapsedMilliseconds(), reinserted, index.getHeight());
+	}
+
+	delete terrain;
+	return 0;
+}
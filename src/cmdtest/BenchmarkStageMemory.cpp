@@ -0,0 +1,85 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "LibGens.h"
+#include "Terrain.h"
+#include "TerrainGroup.h"
+#include "Model.h"
+#include "Mesh.h"
+#include "Submesh.h"
+#include "Vertex.h"
+#include "VertexFormat.h"
+#include "VertexDecoder.h"
+#include "Benchmark.h"
+
+// Loads every terrain group of a stage and reports the peak memory of the process.
+// Passing --vertex-objects also builds the per-vertex Vertex objects old callers get
+// from Submesh::getVertices, which reproduces the memory layout before the vertex arrays.
+int benchmarkStageMemory(int argc, char** argv) {
+	if (argc < 3) {
+		printf("Usage: bench-stage-memory terrain.terrain groups_folder resources_folder [terrain_folder] [--vertex-objects]\n");
+		return 1;
+	}
+
+	string terrain_folder = "";
+	bool vertex_objects = false;
+	for (int i=3; i<argc; i++) {
+		if (strcmp(argv[i], "--vertex-objects") == 0) vertex_objects = true;
+		else terrain_folder = argv[i];
+	}
+
+	BenchmarkTimer timer;
+	LibGens::Terrain terrain(argv[0], argv[1], argv[2], terrain_folder, "", true);
+	double load_time = timer.elapsedMilliseconds();
+
+	size_t group_count = 0;
+	size_t model_count = 0;
+	size_t submesh_count = 0;
+	size_t vertex_count = 0;
+	size_t vertex_array_bytes = 0;
+
+	vector<LibGens::TerrainGroup *> groups = terrain.getGroups();
+	for (size_t g=0; g<groups.size(); g++) {
+		if (!groups[g]->isLoaded()) continue;
+		group_count++;
+
+		vector<LibGens::Model *> models = groups[g]->getModels();
+		for (size_t m=0; m<models.size(); m++) {
+			model_count++;
+
+			vector<LibGens::Mesh *> meshes = models[m]->getMeshes();
+			for (size_t i=0; i<meshes.size(); i++) {
+				vector<LibGens::Submesh *> submeshes = meshes[i]->getSubmeshes();
+				for (size_t s=0; s<submeshes.size(); s++) {
+					submesh_count++;
+					vertex_count += submeshes[s]->getVerticesSize();
+					vertex_array_bytes += submeshes[s]->getVertexArrays()->getMemorySize();
+					if (vertex_objects) submeshes[s]->getVertices();
+				}
+			}
+		}
+	}
+
+	printf("Loaded %zu groups, %zu models, %zu submeshes in %.2f ms\n", group_count, model_count, submesh_count, load_time);
+	printf("%zu vertices, %.2f MB in vertex arrays", vertex_count, vertex_array_bytes / (1024.0 * 1024.0));
+	if (vertex_objects) printf(", %.2f MB in Vertex objects", vertex_count * (sizeof(LibGens::Vertex) + sizeof(LibGens::Vertex *)) / (1024.0 * 1024.0));
+	printf("\n");
+	printf("Peak memory: %.2f MB\n", benchmarkPeakMemoryBytes() / (1024.0 * 1024.0));
+	return 0;
+}
@@ -0,0 +1,63 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "LibGens.h"
+#include "Terrain.h"
+#include "TerrainBlock.h"
+#include "Benchmark.h"
+
+static void benchmarkTerrainBlockQuality(const char *name, LibGens::TerrainBlock *block, double time) {
+	LibGens::TerrainBlockQuality quality;
+	block->getQuality(&quality);
+
+	printf("  %-8s", name);
+	if (time >= 0.0) printf(" %9.2f ms", time);
+	printf("  %6u nodes, depth %3u (leaves %6.2f), SAH cost %9.2f, overlap %.3f\n", quality.node_count, quality.max_depth,
+		quality.average_leaf_depth, quality.sah_cost, quality.overlap);
+}
+
+// Builds the terrain block of a stage with every build mode and compares build time and tree quality.
+// The stage's own terrain-block.tbst is measured too when given.
+int benchmarkTerrainBlock(int argc, char** argv) {
+	if (argc < 3) {
+		printf("Usage: bench-terrain-block terrain.terrain groups_folder resources_folder [terrain_folder] [terrain-block.tbst]\n");
+		return 1;
+	}
+
+	string terrain_folder = (argc > 3) ? ToString(argv[3]) : "";
+	LibGens::Terrain terrain(argv[0], argv[1], argv[2], terrain_folder, "", true);
+	vector<LibGens::TerrainGroup *> groups = terrain.getGroups();
+	printf("%zu groups\n", groups.size());
+
+	if (argc > 4) {
+		LibGens::TerrainBlock original(ToString(argv[4]));
+		benchmarkTerrainBlockQuality("file", &original, -1.0);
+	}
+
+	const char *names[] = { "center", "sah" };
+	LibGens::TerrainBlockBuildMode modes[] = { LibGens::TERRAIN_BLOCK_BUILD_CENTER, LibGens::TERRAIN_BLOCK_BUILD_SAH };
+	for (size_t m=0; m<2; m++) {
+		LibGens::TerrainBlock block;
+		BenchmarkTimer timer;
+		block.build(groups, modes[m]);
+		benchmarkTerrainBlockQuality(names[m], &block, timer.elapsedMilliseconds());
+	}
+
+	return 0;
+}
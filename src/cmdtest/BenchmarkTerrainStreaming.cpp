@@ -0,0 +1,185 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "LibGens.h"
+#include "Terrain.h"
+#include "TerrainGroup.h"
+#include "TerrainStreamer.h"
+#include "Benchmark.h"
+
+#define BENCHMARK_TERRAIN_STREAMING_DRAIN_TIMEOUT 60000.0
+
+// Camera path as one "x y z" point per line. Without a file, the camera flies over the group
+// centers sorted along the X axis, which crosses the whole stage.
+static vector<LibGens::Vector3> benchmarkTerrainStreamingPath(string path_filename, const vector<LibGens::TerrainGroup *> &groups) {
+	vector<LibGens::Vector3> points;
+
+	if (path_filename.size()) {
+		FILE *fp = fopen(path_filename.c_str(), "rt");
+		if (fp) {
+			float x, y, z;
+			while (fscanf(fp, "%f %f %f", &x, &y, &z) == 3) points.push_back(LibGens::Vector3(x, y, z));
+			fclose(fp);
+		}
+	}
+	else {
+		for (size_t i=0; i<groups.size(); i++) points.push_back(groups[i]->getCenter());
+		sort(points.begin(), points.end(), [](const LibGens::Vector3 &a, const LibGens::Vector3 &b) { return a.x < b.x; });
+	}
+
+	return points;
+}
+
+static double benchmarkTerrainStreamingPercentile(vector<double> values, double percentile) {
+	if (values.empty()) return 0.0;
+	sort(values.begin(), values.end());
+	size_t index = (size_t)(percentile * (values.size() - 1) + 0.5);
+	return values[index];
+}
+
+// Replays a camera path over a stage and streams its terrain groups with LibGens::TerrainStreamer,
+// the same scheduler the editor uses. Latency is measured from the first frame a group enters the
+// loading range until the streamer reports it loaded. Groups must be extracted already, the
+// streamer doesn't expand .cab files here.
+int benchmarkTerrainStreaming(int argc, char** argv) {
+	if (argc < 4) {
+		printf("Usage: bench-terrain-streaming terrain.terrain groups_folder resources_folder terrain_folder\n");
+		printf("       [--path camera.txt] [--workers N] [--range units] [--budget MB] [--speed units_per_frame] [--frame-ms ms]\n");
+		return 1;
+	}
+
+	string path_filename = "";
+	unsigned int worker_count = 0;
+	float loading_range = LIBGENS_TERRAIN_STREAMER_DEFAULT_RANGE;
+	size_t memory_budget = 0;
+	float speed = 10.0f;
+	double frame_time = 16.0;
+
+	for (int i=4; i+1<argc; i+=2) {
+		if (strcmp(argv[i], "--path") == 0) path_filename = argv[i+1];
+		else if (strcmp(argv[i], "--workers") == 0) worker_count = atoi(argv[i+1]);
+		else if (strcmp(argv[i], "--range") == 0) loading_range = (float) atof(argv[i+1]);
+		else if (strcmp(argv[i], "--budget") == 0) memory_budget = (size_t)(atof(argv[i+1]) * 1024.0 * 1024.0);
+		else if (strcmp(argv[i], "--speed") == 0) speed = (float) atof(argv[i+1]);
+		else if (strcmp(argv[i], "--frame-ms") == 0) frame_time = atof(argv[i+1]);
+	}
+
+	string terrain_folder = ToString(argv[3]);
+	if (terrain_folder.size() && (terrain_folder.back() != '/') && (terrain_folder.back() != '\\')) terrain_folder += "/";
+
+	LibGens::Terrain terrain(argv[0], argv[1], argv[2], terrain_folder, "", false);
+	vector<LibGens::TerrainGroup *> groups = terrain.getGroups();
+	vector<LibGens::Vector3> points = benchmarkTerrainStreamingPath(path_filename, groups);
+	if (groups.empty() || points.empty()) {
+		printf("Nothing to stream: %zu groups, %zu path points\n", groups.size(), points.size());
+		return 1;
+	}
+
+	// Frame positions along the path at a constant speed
+	vector<LibGens::Vector3> frames;
+	frames.push_back(points[0]);
+	for (size_t i=1; i<points.size(); i++) {
+		LibGens::Vector3 delta = points[i] - points[i-1];
+		float length = points[i].distance(points[i-1]);
+		size_t steps = (size_t)(length / speed) + 1;
+		for (size_t s=1; s<=steps; s++) frames.push_back(points[i-1] + delta * ((float)s / steps));
+	}
+
+	LibGens::TerrainStreamer streamer;
+	streamer.setGroups(groups);
+	streamer.setWorkerCount(worker_count);
+	streamer.setLoadingRange(loading_range);
+	streamer.setMemoryBudget(memory_budget);
+
+	map<LibGens::TerrainGroup *, double> request_times;
+	set<LibGens::TerrainGroup *> loaded_groups;
+	vector<double> latencies;
+	size_t evictions = 0;
+	size_t peak_memory_used = 0;
+
+	BenchmarkTimer timer;
+	double next_frame = 0.0;
+	double drain_start = 0.0;
+	size_t frame = 0;
+	LibGens::Vector3 position = frames[0];
+
+	while (true) {
+		double now = timer.elapsedMilliseconds();
+
+		// Once the path ends, keep updating at the last position until the requested groups finish
+		if (frame < frames.size()) {
+			position = frames[frame];
+			drain_start = now;
+		}
+		else if (request_times.empty() || (now - drain_start > BENCHMARK_TERRAIN_STREAMING_DRAIN_TIMEOUT)) break;
+
+		for (size_t i=0; i<groups.size(); i++) {
+			if (loaded_groups.count(groups[i]) || request_times.count(groups[i])) continue;
+			if (groups[i]->getCenter().distance(position) - groups[i]->getRadius() < loading_range) request_times[groups[i]] = now;
+		}
+
+		streamer.update(position);
+
+		LibGens::TerrainGroup *group = NULL;
+		bool loaded = false;
+		now = timer.elapsedMilliseconds();
+		while (streamer.popEvent(&group, &loaded)) {
+			if (loaded) {
+				loaded_groups.insert(group);
+
+				map<LibGens::TerrainGroup *, double>::iterator it = request_times.find(group);
+				if (it != request_times.end()) {
+					latencies.push_back(now - it->second);
+					request_times.erase(it);
+				}
+			}
+			else {
+				loaded_groups.erase(group);
+				evictions++;
+			}
+		}
+
+		// Groups that left the range before loading were cancelled
+		for (map<LibGens::TerrainGroup *, double>::iterator it = request_times.begin(); it != request_times.end();) {
+			if (it->first->getCenter().distance(position) - it->first->getRadius() >= loading_range) it = request_times.erase(it);
+			else it++;
+		}
+
+		if (streamer.getMemoryUsed() > peak_memory_used) peak_memory_used = streamer.getMemoryUsed();
+
+		frame++;
+		next_frame += frame_time;
+		double wait = next_frame - timer.elapsedMilliseconds();
+		if (wait > 0.0) this_thread::sleep_for(std::chrono::microseconds((long long)(wait * 1000.0)));
+	}
+
+	double total_time = timer.elapsedMilliseconds();
+	double latency_sum = 0.0;
+	for (size_t i=0; i<latencies.size(); i++) latency_sum += latencies[i];
+
+	printf("%zu groups, %zu frames along %zu path points, %.2f s\n", groups.size(), frames.size(), points.size(), total_time / 1000.0);
+	printf("Loaded %zu groups, evicted %zu, %zu still loaded (%.2f MB estimated, peak %.2f MB)\n", latencies.size(), evictions, streamer.getLoadedCount(),
+		streamer.getMemoryUsed() / (1024.0 * 1024.0), peak_memory_used / (1024.0 * 1024.0));
+	if (!latencies.empty()) {
+		printf("Load latency: mean %.2f ms, p50 %.2f ms, p95 %.2f ms, max %.2f ms\n", latency_sum / latencies.size(),
+			benchmarkTerrainStreamingPercentile(latencies, 0.5), benchmarkTerrainStreamingPercentile(latencies, 0.95), benchmarkTerrainStreamingPercentile(latencies, 1.0));
+	}
+	printf("Peak memory: %.2f MB\n", benchmarkPeakMemoryBytes() / (1024.0 * 1024.0));
+	return 0;
+}
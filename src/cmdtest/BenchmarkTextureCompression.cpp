@@ -0,0 +1,230 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "LibGens.h"
+#include "TextureCompression.h"
+#include "FreeImage.h"
+#include "Benchmark.h"
+#include <DirectXTex.h>
+
+#define BENCHMARK_TEXTURE_COMPRESSION_REPEATS 3
+
+struct BenchmarkTextureCompressionImage {
+	string name;
+	unsigned int width;
+	unsigned int height;
+	vector<unsigned char> pixels;
+};
+
+struct BenchmarkTextureCompressionFormat {
+	const char *name;
+	LibGens::TextureCompressionFormat format;
+	DXGI_FORMAT dxgi_format;
+	size_t first_channel;
+	size_t channel_count;
+};
+
+static const BenchmarkTextureCompressionFormat benchmark_texture_compression_formats[] = {
+	{ "BC1", LibGens::TEXTURE_COMPRESSION_BC1, DXGI_FORMAT_BC1_UNORM, 0, 3 },
+	{ "BC3", LibGens::TEXTURE_COMPRESSION_BC3, DXGI_FORMAT_BC3_UNORM, 0, 4 },
+	{ "BC4", LibGens::TEXTURE_COMPRESSION_BC4, DXGI_FORMAT_BC4_UNORM, 0, 1 },
+	{ "BC5", LibGens::TEXTURE_COMPRESSION_BC5, DXGI_FORMAT_BC5_UNORM, 0, 2 }
+};
+
+static const char *benchmark_texture_compression_qualities[] = { "fast", "normal", "high" };
+
+// Loads any image FreeImage supports as top-down RGBA.
+static bool benchmarkTextureCompressionLoad(string filename, BenchmarkTextureCompressionImage *image) {
+	FREE_IMAGE_FORMAT format = FreeImage_GetFileType(filename.c_str(), 0);
+	if (format == FIF_UNKNOWN) format = FreeImage_GetFIFFromFilename(filename.c_str());
+	if (format == FIF_UNKNOWN) return false;
+
+	FIBITMAP *bitmap = FreeImage_Load(format, filename.c_str());
+	if (!bitmap) return false;
+
+	FIBITMAP *bitmap_32 = FreeImage_ConvertTo32Bits(bitmap);
+	FreeImage_Unload(bitmap);
+	if (!bitmap_32) return false;
+
+	image->name = filename;
+	image->width = FreeImage_GetWidth(bitmap_32);
+	image->height = FreeImage_GetHeight(bitmap_32);
+	image->pixels.resize((size_t) image->width * image->height * 4);
+	for (unsigned int y=0; y<image->height; y++) {
+		const unsigned char *source = FreeImage_GetScanLine(bitmap_32, image->height - 1 - y);
+		unsigned char *target = image->pixels.data() + (size_t) y * image->width * 4;
+		for (unsigned int x=0; x<image->width; x++) {
+			target[x*4] = source[x*4 + FI_RGBA_RED];
+			target[x*4 + 1] = source[x*4 + FI_RGBA_GREEN];
+			target[x*4 + 2] = source[x*4 + FI_RGBA_BLUE];
+			target[x*4 + 3] = source[x*4 + FI_RGBA_ALPHA];
+		}
+	}
+
+	FreeImage_Unload(bitmap_32);
+	return true;
+}
+
+// Smooth gradients with noise and hard edged alpha, close enough to baked lightmaps to compare encoders.
+static void benchmarkTextureCompressionSynthetic(BenchmarkTextureCompressionImage *image) {
+	image->name = "synthetic 1024x1024";
+	image->width = image->height = 1024;
+	image->pixels.resize((size_t) image->width * image->height * 4);
+
+	unsigned int seed = 1;
+	for (unsigned int y=0; y<image->height; y++) {
+		for (unsigned int x=0; x<image->width; x++) {
+			seed = seed * 1103515245 + 12345;
+			int noise = (int) ((seed >> 16) & 0xF) - 8;
+			unsigned char *pixel = image->pixels.data() + ((size_t) y * image->width + x) * 4;
+			pixel[0] = (unsigned char) max(0, min(255, (int) (x / 4) + noise));
+			pixel[1] = (unsigned char) max(0, min(255, (int) (y / 4) + noise));
+			pixel[2] = (unsigned char) (((x / 64) + (y / 64)) & 1 ? 192 : 64);
+			pixel[3] = (unsigned char) ((((x / 32) % 3) == 0) ? 255 : ((x + y) / 8) & 0xFF);
+		}
+	}
+}
+
+static double benchmarkTextureCompressionPSNR(const BenchmarkTextureCompressionImage &image, const vector<unsigned char> &decoded, const BenchmarkTextureCompressionFormat &format) {
+	double squared_error = 0.0;
+	size_t pixel_count = (size_t) image.width * image.height;
+	for (size_t i=0; i<pixel_count; i++) {
+		for (size_t c=format.first_channel; c<format.first_channel + format.channel_count; c++) {
+			double difference = (double) image.pixels[i*4 + c] - (double) decoded[i*4 + c];
+			squared_error += difference * difference;
+		}
+	}
+
+	if (squared_error <= 0.0) return 99.99;
+	return 10.0 * log10(255.0 * 255.0 * pixel_count * format.channel_count / squared_error);
+}
+
+static double benchmarkTextureCompressionMegapixels(const BenchmarkTextureCompressionImage &image, double milliseconds) {
+	if (milliseconds <= 0.0) return 0.0;
+	return ((double) image.width * image.height / 1000000.0) / (milliseconds / 1000.0);
+}
+
+// Best of a few runs of the LibGens encoder.
+static double benchmarkTextureCompressionEncode(const BenchmarkTextureCompressionImage &image, const BenchmarkTextureCompressionFormat &format, LibGens::TextureCompressionQuality quality, vector<unsigned char> *encoded) {
+	encoded->resize(LibGens::TextureCompression::getEncodedSize(format.format, image.width, image.height));
+
+	double best_time = 0.0;
+	for (size_t r=0; r<BENCHMARK_TEXTURE_COMPRESSION_REPEATS; r++) {
+		BenchmarkTimer timer;
+		LibGens::TextureCompression::encode(image.pixels.data(), image.width, image.height, format.format, quality, encoded->data());
+		double time = timer.elapsedMilliseconds();
+		if (!r || (time < best_time)) best_time = time;
+	}
+
+	return best_time;
+}
+
+// Best of a few runs of DirectXTex, the encoder the tools used before. Returns a negative time if it fails.
+static double benchmarkTextureCompressionEncodeDirectXTex(const BenchmarkTextureCompressionImage &image, const BenchmarkTextureCompressionFormat &format, DirectX::TEX_COMPRESS_FLAGS flags, vector<unsigned char> *encoded) {
+	DirectX::Image source;
+	source.width = image.width;
+	source.height = image.height;
+	source.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	source.rowPitch = source.width * 4;
+	source.slicePitch = source.rowPitch * source.height;
+	source.pixels = (uint8_t *) image.pixels.data();
+
+	double best_time = 0.0;
+	for (size_t r=0; r<BENCHMARK_TEXTURE_COMPRESSION_REPEATS; r++) {
+		DirectX::ScratchImage compressed;
+		BenchmarkTimer timer;
+		if (FAILED(DirectX::Compress(source, format.dxgi_format, flags, DirectX::TEX_THRESHOLD_DEFAULT, compressed))) {
+			return -1.0;
+		}
+
+		double time = timer.elapsedMilliseconds();
+		if (!r || (time < best_time)) best_time = time;
+		encoded->assign(compressed.GetPixels(), compressed.GetPixels() + compressed.GetPixelsSize());
+	}
+
+	return best_time;
+}
+
+static void benchmarkTextureCompressionImage(const BenchmarkTextureCompressionImage &image, const vector<unsigned int> &thread_counts) {
+	printf("%s (%ux%u)\n", image.name.c_str(), image.width, image.height);
+
+	vector<unsigned char> encoded;
+	vector<unsigned char> decoded((size_t) image.width * image.height * 4);
+	for (const BenchmarkTextureCompressionFormat &format : benchmark_texture_compression_formats) {
+		for (size_t q=0; q<3; q++) {
+			printf("  %s %-6s", format.name, benchmark_texture_compression_qualities[q]);
+
+			for (size_t t=0; t<thread_counts.size(); t++) {
+				LibGens::Parallel::setThreadCount(thread_counts[t]);
+				double time = benchmarkTextureCompressionEncode(image, format, (LibGens::TextureCompressionQuality) q, &encoded);
+				printf(" %2u threads %8.2f MPix/s", thread_counts[t], benchmarkTextureCompressionMegapixels(image, time));
+			}
+
+			LibGens::TextureCompression::decode(encoded.data(), image.width, image.height, format.format, decoded.data());
+			printf(", PSNR %6.2f dB\n", benchmarkTextureCompressionPSNR(image, decoded, format));
+		}
+
+		const DirectX::TEX_COMPRESS_FLAGS directxtex_flags[] = { DirectX::TEX_COMPRESS_DEFAULT, DirectX::TEX_COMPRESS_PARALLEL };
+		const char *directxtex_names[] = { "serial", "parallel" };
+		for (size_t f=0; f<2; f++) {
+			double time = benchmarkTextureCompressionEncodeDirectXTex(image, format, directxtex_flags[f], &encoded);
+			if (time < 0.0) {
+				printf("  %s DirectXTex %s failed\n", format.name, directxtex_names[f]);
+				continue;
+			}
+
+			LibGens::TextureCompression::decode(encoded.data(), image.width, image.height, format.format, decoded.data());
+			printf("  %s DirectXTex %-8s %8.2f MPix/s, PSNR %6.2f dB\n", format.name, directxtex_names[f], benchmarkTextureCompressionMegapixels(image, time),
+				benchmarkTextureCompressionPSNR(image, decoded, format));
+		}
+	}
+}
+
+int benchmarkTextureCompression(int argc, char** argv) {
+	vector<BenchmarkTextureCompressionImage> images;
+	for (int i=0; i<argc; i++) {
+		BenchmarkTextureCompressionImage image;
+		if (!benchmarkTextureCompressionLoad(ToString(argv[i]), &image)) {
+			printf("Couldn't load %s\n", argv[i]);
+			continue;
+		}
+
+		images.push_back(image);
+	}
+
+	if (!argc) {
+		printf("Usage: cmdtest bench-texture-compression [image files]\nNo images given, using a synthetic one.\n");
+		images.resize(1);
+		benchmarkTextureCompressionSynthetic(&images[0]);
+	}
+
+	unsigned int previous_thread_count = LibGens::Parallel::getThreadCount();
+	unsigned int hardware_thread_count = thread::hardware_concurrency();
+
+	vector<unsigned int> thread_counts;
+	thread_counts.push_back(1);
+	if (hardware_thread_count > 1) thread_counts.push_back(hardware_thread_count);
+
+	for (size_t i=0; i<images.size(); i++) {
+		benchmarkTextureCompressionImage(images[i], thread_counts);
+	}
+
+	LibGens::Parallel::setThreadCount(previous_thread_count);
+	return 0;
+}
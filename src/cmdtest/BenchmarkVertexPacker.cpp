@@ -0,0 +1,183 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor 
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//    
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+#include "LibGens.h"
+#include "Model.h"
+#include "Mesh.h"
+#include "Submesh.h"
+#include "Vertex.h"
+#include "VertexFormat.h"
+#include "VertexDecoder.h"
+#include "VertexPacker.h"
+#include "Benchmark.h"
+
+// Worst case rounding of a DEC3N component (half a 1/511 step) and of a half float (relative 2^-11), with slack
+#define BENCHMARK_VERTEX_PACKER_VECTOR_TOLERANCE  (1.0f / 511.0f)
+#define BENCHMARK_VERTEX_PACKER_UV_TOLERANCE      (1.0f / 1024.0f)
+
+// Largest difference between the arrays and a COMPACT packed buffer decoded back, per attribute kind.
+static void benchmarkVertexPackerError(LibGens::VertexArrays *arrays, const unsigned char *buffer, LibGens::VertexPacker *packer, float *vector_error, float *uv_error) {
+	for (size_t e=0; e<packer->getElementCount(); e++) {
+		LibGens::VertexPackerElement element = packer->getElement(e);
+
+		for (size_t i=0; i<arrays->count; i++) {
+			const unsigned char *data = buffer + i * packer->getStride() + element.offset;
+
+			if (element.data == LibGens::DEC3N) {
+				const vector<LibGens::Vector3> &source = (element.id == LibGens::NORMAL) ? arrays->normals : ((element.id == LibGens::TANGENT) ? arrays->tangents : arrays->binormals);
+				if (source.empty()) continue;
+
+				unsigned int packed = 0;
+				memcpy(&packed, data, 4);
+				float original[3] = { source[i].x, source[i].y, source[i].z };
+				for (size_t c=0; c<3; c++) {
+					int value = (int)((packed >> (c * 10)) & 0x3FF);
+					if (value & 0x200) value -= 0x400;
+					float decoded = value / 511.0f;
+					float expected = max(-1.0f, min(1.0f, original[c]));
+					*vector_error = max(*vector_error, fabs(decoded - expected));
+				}
+			}
+			else if (element.data == LibGens::FLOAT2_HALF) {
+				const vector<LibGens::Vector2> &source = arrays->uvs[element.index];
+				if (source.empty()) continue;
+
+				unsigned short packed[2];
+				memcpy(packed, data, 4);
+				float original[2] = { source[i].x, source[i].y };
+				for (size_t c=0; c<2; c++) {
+					float decoded = LibGens::dequantizeHalf(packed[c]);
+					*uv_error = max(*uv_error, fabs(decoded - original[c]) / max(1.0f, fabs(original[c])));
+				}
+			}
+		}
+	}
+}
+
+// Converts the submeshes of the given models the way buildMesh used to (Vertex views and by-value getters
+// into 24 floats per vertex) and with VertexPacker for every built in layout, then compares time, upload
+// size and the quantization error of the compact layout. Runs without a GPU. Returns 2 if the compact layout
+// loses more precision than its formats allow.
+int benchmarkVertexPacker(int argc, char** argv) {
+	if (argc < 1) {
+		printf("Usage: bench-vertex-packer file.model [file.model...]\n");
+		return 1;
+	}
+
+	vector<LibGens::Submesh *> submeshes;
+	vector<LibGens::Model *> models;
+	size_t vertex_count = 0;
+	size_t index_count = 0;
+	for (int a=0; a<argc; a++) {
+		LibGens::Model *model = new LibGens::Model(ToString(argv[a]));
+		models.push_back(model);
+
+		vector<LibGens::Mesh *> meshes = model->getMeshes();
+		for (size_t i=0; i<meshes.size(); i++) {
+			vector<LibGens::Submesh *> mesh_submeshes = meshes[i]->getSubmeshes();
+			for (size_t s=0; s<mesh_submeshes.size(); s++) {
+				submeshes.push_back(mesh_submeshes[s]);
+				vertex_count += mesh_submeshes[s]->getVerticesSize();
+				index_count += mesh_submeshes[s]->getFacesSize() * 3;
+			}
+		}
+	}
+	printf("%zu submeshes, %zu vertices, %zu indices\n", submeshes.size(), vertex_count, index_count);
+
+	vector<float> legacy_vertices;
+	vector<unsigned short> indices(index_count);
+	BenchmarkTimer timer;
+	for (size_t s=0; s<submeshes.size(); s++) {
+		vector<LibGens::Vertex *> submesh_vertices = submeshes[s]->getVertices();
+		vector<LibGens::Polygon> submesh_faces = submeshes[s]->getFaces();
+		legacy_vertices.resize(submesh_vertices.size() * 24);
+
+		for (size_t i=0; i<submesh_vertices.size(); i++) {
+			float *out = &legacy_vertices[i*24];
+			out[0] = submesh_vertices[i]->getPosition().x;
+			out[1] = submesh_vertices[i]->getPosition().y;
+			out[2] = submesh_vertices[i]->getPosition().z;
+			out[3] = submesh_vertices[i]->getNormal().x;
+			out[4] = submesh_vertices[i]->getNormal().y;
+			out[5] = submesh_vertices[i]->getNormal().z;
+			out[6] = submesh_vertices[i]->getTangent().x;
+			out[7] = submesh_vertices[i]->getTangent().y;
+			out[8] = submesh_vertices[i]->getTangent().z;
+			out[9] = submesh_vertices[i]->getBinormal().x;
+			out[10] = submesh_vertices[i]->getBinormal().y;
+			out[11] = submesh_vertices[i]->getBinormal().z;
+			for (size_t c=0; c<4; c++) {
+				out[12 + c*2] = submesh_vertices[i]->getUV(c).x;
+				out[13 + c*2] = submesh_vertices[i]->getUV(c).y;
+			}
+			out[20] = submesh_vertices[i]->getColor().r;
+			out[21] = submesh_vertices[i]->getColor().g;
+			out[22] = submesh_vertices[i]->getColor().b;
+			out[23] = submesh_vertices[i]->getColor().a;
+		}
+
+		for (size_t i=0; i<submesh_faces.size(); i++) {
+			indices[i*3] = submesh_faces[i].a;
+			indices[i*3+1] = submesh_faces[i].b;
+			indices[i*3+2] = submesh_faces[i].c;
+		}
+
+		submeshes[s]->releaseVertexViews();
+	}
+	double legacy_time = timer.elapsedMilliseconds();
+	printf("  %-8s %9.2f ms %9.2f MB\n", "legacy", legacy_time, vertex_count * 24 * sizeof(float) / (1024.0 * 1024.0));
+
+	bool within_tolerance = true;
+	const char *names[] = { "float", "d3d9", "compact" };
+	unsigned int layouts[] = { LIBGENS_VERTEX_PACKER_LAYOUT_FLOAT, LIBGENS_VERTEX_PACKER_LAYOUT_D3D9, LIBGENS_VERTEX_PACKER_LAYOUT_COMPACT };
+	for (size_t l=0; l<3; l++) {
+		LibGens::VertexPacker packer(layouts[l]);
+		vector<unsigned char> buffer;
+		float vector_error = 0.0f;
+		float uv_error = 0.0f;
+		double time = 0.0;
+
+		for (size_t s=0; s<submeshes.size(); s++) {
+			buffer.resize(packer.getBufferSize(submeshes[s]->getVerticesSize()));
+
+			timer.reset();
+			submeshes[s]->packVertices(&packer, buffer.data(), buffer.size());
+			submeshes[s]->packIndices(indices.data(), indices.size());
+			time += timer.elapsedMilliseconds();
+
+			if (layouts[l] == LIBGENS_VERTEX_PACKER_LAYOUT_COMPACT) {
+				benchmarkVertexPackerError(submeshes[s]->getVertexArrays(), buffer.data(), &packer, &vector_error, &uv_error);
+			}
+		}
+
+		printf("  %-8s %9.2f ms %9.2f MB (%u bytes per vertex)", names[l], time, packer.getBufferSize(vertex_count) / (1024.0 * 1024.0), packer.getStride());
+		if (layouts[l] == LIBGENS_VERTEX_PACKER_LAYOUT_COMPACT) {
+			bool passed = (vector_error <= BENCHMARK_VERTEX_PACKER_VECTOR_TOLERANCE) && (uv_error <= BENCHMARK_VERTEX_PACKER_UV_TOLERANCE);
+			printf(", max error: vectors %.5f, uvs %.5f (relative) %s", vector_error, uv_error, passed ? "ok" : "FAILED");
+			within_tolerance = within_tolerance && passed;
+		}
+		printf("\n");
+	}
+
+	for (size_t m=0; m<models.size(); m++) {
+		delete models[m];
+	}
+
+	return within_tolerance ? 0 : 2;
+}
@@ -21,10 +21,48 @@
 #include "Light.h"
 #include "GITextureGroup.h"
 #include "FreeImage.h"
+#include "Benchmark.h"
+
+struct BenchmarkEntry {
+	const char *name;
+	int (*function)(int argc, char** argv);
+};
+
+static const BenchmarkEntry benchmarks[] = {
+	{ "bench-animation-sampling", benchmarkAnimationSampling },
+	{ "bench-compression", benchmarkCompression },
+	{ "bench-file", benchmarkFile },
+	{ "bench-gi-atlas", benchmarkGIAtlas },
+	{ "bench-gi-atlas-packer", benchmarkGIAtlasPacker },
+	{ "bench-havok-endian-swap", benchmarkHavokEndianSwap },
+	{ "bench-level-snapshot", benchmarkLevelSnapshot },
+	{ "bench-lightfield-sampling", benchmarkLightFieldSampling },
+	{ "bench-object-library", benchmarkObjectLibrary },
+	{ "bench-pac-save", benchmarkPacSave },
+	{ "bench-set-loading", benchmarkSetLoading },
+	{ "bench-spatial-index", benchmarkSpatialIndex },
+	{ "bench-stage-memory", benchmarkStageMemory },
+	{ "bench-terrain-block", benchmarkTerrainBlock },
+	{ "bench-terrain-streaming", benchmarkTerrainStreaming },
+	{ "bench-texture-compression", benchmarkTextureCompression },
+	{ "bench-vertex-packer", benchmarkVertexPacker }
+};
 
 int main(int argc, char** argv) {
 	LibGens::initialize();
 	LibGens::Error::setLogging(true);
+
+	if (argc >= 2) {
+		for (const BenchmarkEntry &benchmark : benchmarks) {
+			if (strcmp(argv[1], benchmark.name) == 0) {
+				return benchmark.function(argc-2, argv+2);
+			}
+		}
+
+		printf("Unknown benchmark %s\n", argv[1]);
+		return 1;
+	}
+
 	FreeImage_Initialise();
 
 	LibGens::GITextureGroup group;
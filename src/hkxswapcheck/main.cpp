@@ -0,0 +1,122 @@
+//=========================================================================
+//	  Copyright (c) 2016 SonicGLvl
+//
+//    This file is part of SonicGLvl, a community-created free level editor
+//    for the PC version of Sonic Generations.
+//
+//    SonicGLvl is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    SonicGLvl is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+//
+//
+//    Read AUTHORS.txt, LICENSE.txt and COPYRIGHT.txt for more details.
+//=========================================================================
+
+// Checks the Havok packfile endian swapper against golden files. Every big endian packfile given
+// is converted from a File, from memory and as part of a parallel batch, and all three results must
+// match the file of the same name in the golden folder byte for byte.
+//
+// golden/big holds synthetic big endian packfiles and golden/little what the converter that came
+// before the indexed one wrote for them. Neither the checker nor the converter need the Havok SDK,
+// so it also builds outside of Windows, e.g. from this folder:
+//
+//   g++ -std=c++14 -I../LibGens -I../LibGens-externals -include stdafx.h main.cpp
+//       ../LibGens/HavokEndianSwap.cpp ../LibGens/File.cpp ../LibGens/FileReader.cpp
+//       ../LibGens/Endian.cpp ../LibGens/Error.cpp ../LibGens/Parallel.cpp -lpthread -o hkxswapcheck
+//   ./hkxswapcheck golden/little/ golden/big/*.hkx
+
+#include "LibGens.h"
+#include "HavokEndianSwap.h"
+
+static bool readWholeFile(string filename, vector<unsigned char> *data) {
+	if (!LibGens::File::check(filename)) return false;
+
+	LibGens::File file(filename, LIBGENS_FILE_READ_BINARY);
+	if (!file.valid()) return false;
+
+	data->resize(file.getFileSize());
+	file.read(data->data(), data->size());
+	file.close();
+	return true;
+}
+
+static bool checkResult(string name, string path, const vector<unsigned char> &result, const vector<unsigned char> &golden) {
+	if (result == golden) return true;
+
+	size_t offset = 0;
+	while ((offset < result.size()) && (offset < golden.size()) && (result[offset] == golden[offset])) offset++;
+	printf("  %s: %s differs from its golden file at 0x%zx (%zu bytes, golden %zu bytes)\n", name.c_str(), path.c_str(), offset, result.size(), golden.size());
+	return false;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		printf("Usage: hkxswapcheck golden_folder/ big_endian.hkx [big_endian.hkx ...]\n");
+		return 1;
+	}
+
+	string golden_folder = ToString(argv[1]);
+	if (golden_folder.size() && (golden_folder[golden_folder.size()-1] != '/') && (golden_folder[golden_folder.size()-1] != '\\')) golden_folder += "/";
+
+	vector<string> sources;
+	vector<string> destinations;
+	vector<vector<unsigned char>> goldens;
+	size_t failures = 0;
+
+	for (int i=2; i<argc; i++) {
+		string source = ToString(argv[i]);
+		string name = LibGens::File::nameFromFilename(source);
+
+		vector<unsigned char> data;
+		vector<unsigned char> golden;
+		if (!readWholeFile(source, &data)) {
+			printf("  %s: can't read %s\n", name.c_str(), source.c_str());
+			failures++;
+			continue;
+		}
+
+		if (!readWholeFile(golden_folder + name, &golden)) {
+			printf("  %s: no golden file in %s\n", name.c_str(), golden_folder.c_str());
+			failures++;
+			continue;
+		}
+
+		bool matches = checkResult(name, "memory", LibGens::endianSwapHKX(data.data(), data.size()), golden);
+
+		LibGens::File file(source, LIBGENS_FILE_READ_BINARY);
+		matches = checkResult(name, "file", LibGens::endianSwapHKX(&file), golden) && matches;
+		file.close();
+
+		if (!matches) failures++;
+
+		sources.push_back(source);
+		destinations.push_back(source + ".swapped");
+		goldens.push_back(golden);
+	}
+
+	bool batch_converted = LibGens::endianSwapHKX(sources, destinations);
+	if (!batch_converted) {
+		printf("  batch: conversion failed\n");
+		failures++;
+	}
+
+	for (size_t i=0; i<destinations.size(); i++) {
+		vector<unsigned char> data;
+		string name = LibGens::File::nameFromFilename(sources[i]);
+		if (!readWholeFile(destinations[i], &data)) {
+			printf("  %s: batch wrote no file\n", name.c_str());
+			failures++;
+		}
+		else if (!checkResult(name, "batch", data, goldens[i])) failures++;
+
+		LibGens::File::remove(destinations[i]);
+	}
+
+	printf("%d packfiles, %zu failures\n", argc-2, failures);
+	return failures ? 2 : 0;
+}
@@ -30,7 +30,7 @@ int main(int argc, char** argv) {
 	string pack_name = ToString(argv[1]);
     string source = ToString(argv[2]);
 
-	LibGens::ArPack pack(source + "/");
+	LibGens::ArPack pack(source + "/", false);
 
 	if (pack_name.find(".ar") != string::npos) {
 		pack.save(pack_name);